@@ -232,7 +232,8 @@ static inline void fixNumericLocale(char* begin, char* end) {
 #endif
 
 static int const stackLimit_g = 1000;
-static int       stackDepth_g = 0;  // see readValue()
+// libdisir: thread local, such that documents may be parsed concurrently.
+static thread_local int stackDepth_g = 0;  // see readValue()
 
 namespace Json {
 
@@ -2151,6 +2151,8 @@ inline void Writer::writeTable(const Value& value, const std::string& key)
     std::string post("");
 
     bool hasKeyvals = tableContainsKeyval(value);
+    // An empty table has nothing below it to imply its key - it must be written explicitly.
+    bool writeKey = hasKeyvals || value.table_->empty();
 
     // We may write this inline if we are not root, and the FORMAT_TABLE_INLINE option is
     // set either on the global options or on the value specific formatting options.
@@ -2168,7 +2170,7 @@ inline void Writer::writeTable(const Value& value, const std::string& key)
     // If we are the first entry, (and we are not inline) we should buffer one newline above us.
     // Not applicable to root entry.
     if (key.empty() == false && writingTableInline_ == false &&
-        writingTableCurrentIndex_ != 0 && hasKeyvals)
+        writingTableCurrentIndex_ != 0 && writeKey)
     {
         output_ << separator_;
     }
@@ -2176,7 +2178,7 @@ inline void Writer::writeTable(const Value& value, const std::string& key)
     // Write the table key. Skip writing non-inline key for a table that only contains sub-tables
     // Not applicable to root entry.
     if (key.empty() == false &&
-        ((writingTableInline_ == false && hasKeyvals) || writingTableInline_))
+        ((writingTableInline_ == false && writeKey) || writingTableInline_))
     {
         if (writingTableInline_ == false)
         {
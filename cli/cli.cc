@@ -20,6 +20,8 @@
 #include <disir/cli/command_export.h>
 #include <disir/cli/command_import.h>
 #include <disir/cli/command_remove.h>
+#include <disir/cli/command_mold.h>
+#include <disir/cli/command_stats.h>
 
 using namespace disir;
 
@@ -289,6 +291,12 @@ Cli::add_default_commands (void)
 
     command_ptr = std::make_shared<CommandRemove> ();
     add_command (command_ptr);
+
+    command_ptr = std::make_shared<CommandMold> ();
+    add_command (command_ptr);
+
+    command_ptr = std::make_shared<CommandStats> ();
+    add_command (command_ptr);
 }
 
 void
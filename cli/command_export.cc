@@ -51,6 +51,16 @@ CommandExport::handle_command (std::vector<std::string> &args)
                            "Append configuration entries to an existing archive",
                            args::Matcher{"append"});
 
+    args::ValueFlag<std::string> opt_codec (parser, "CODEC",
+                                            "Compression of the archive: xz, zstd, gzip" \
+                                            " or none. Default is xz.",
+                                            args::Matcher {"codec"});
+
+    args::ValueFlag<int> opt_level (parser, "LEVEL",
+                                    "Compression level of the codec. 0-9 for xz and gzip," \
+                                    " 1-22 for zstd.",
+                                    args::Matcher {"level"});
+
     args::PositionalList<std::string> opt_entries (parser, "entry",
                                                    "A list of entries to file.");
 
@@ -84,6 +94,29 @@ CommandExport::handle_command (std::vector<std::string> &args)
         m_cli->group_id (group_id);
     }
 
+    if (opt_codec)
+    {
+        const std::string codec = args::get (opt_codec);
+        if (codec == "xz")
+            m_codec = DISIR_ARCHIVE_CODEC_XZ;
+        else if (codec == "zstd")
+            m_codec = DISIR_ARCHIVE_CODEC_ZSTD;
+        else if (codec == "gzip")
+            m_codec = DISIR_ARCHIVE_CODEC_GZIP;
+        else if (codec == "none")
+            m_codec = DISIR_ARCHIVE_CODEC_NONE;
+        else
+        {
+            std::cerr << "Unknown codec: " << codec << std::endl;
+            return (1);
+        }
+    }
+
+    if (opt_level)
+    {
+        m_level = args::get (opt_level);
+    }
+
     std::set<std::string> entries_to_file;
     if (opt_entries)
     {
@@ -182,10 +215,14 @@ CommandExport::populate_archive (const char *path, const char *dest_path,
     struct disir_archive *archive;
     int ret = 0;
 
-    auto status = disir_archive_export_begin (m_cli->disir (), path, &archive);
+    auto status = disir_archive_export_begin_codec (m_cli->disir (), path,
+                                                    m_codec, m_level, &archive);
     if (status != DISIR_STATUS_OK)
     {
         std::cout << "Unable to begin archive: " << disir_status_string (status) << std::endl;
+        auto error = disir_error (m_cli->disir ());
+        if (error)
+            std::cout << error << std::endl;
         return(1);
     }
 
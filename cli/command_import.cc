@@ -22,6 +22,7 @@ CommandImport::CommandImport(void)
 int
 CommandImport::handle_command (std::vector<std::string> &args)
 {
+    std::stringstream group_description;
     args::ArgumentParser parser ("Inspect or import entries from disir archive.");
     setup_parser (parser);
     parser.Prog ("disir import");
@@ -36,6 +37,15 @@ CommandImport::handle_command (std::vector<std::string> &args)
                                                    "Filepath to disir archive.",
                                                    args::Matcher{"archive"});
 
+    group_description << "Group of the entry selected by --entry. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+
+    args::ValueFlag<std::string> opt_entry_id (parser, "ENTRY",
+                                               "Inspect or import only this entry of the archive.",
+                                               args::Matcher{"entry"});
+
     args::Group import_opt_group (parser, "Import options:",
                                   args::Group::Validators::Xor);
 
@@ -89,19 +99,39 @@ CommandImport::handle_command (std::vector<std::string> &args)
         return (1);
     }
 
-    if (opt_archive_path)
+    if (opt_group_id && setup_group (args::get(opt_group_id)))
+    {
+        return (1);
+    }
+
+    if (opt_archive_path && opt_inspect)
+    {
+        return archive_inspect (args::get (opt_archive_path),
+                                opt_entry_id ? args::get (opt_entry_id).c_str() : NULL);
+    }
+    else if (opt_archive_path)
     {
         struct disir_import *import;
         enum disir_status status;
         struct import_report *report = NULL;
         enum disir_import_option option;
         std::string archive_path = args::get (opt_archive_path);
-        std::list<struct archive_entry_info> info;
-        struct archive_entry_info entry_info;
         int ret = 1;
         int entries;
 
-        status = disir_archive_import (m_cli->disir(), archive_path.c_str(), &import, &entries);
+        if (opt_entry_id)
+        {
+            // Only the selected entry is read from the archive.
+            status = disir_archive_import_entry (m_cli->disir(), archive_path.c_str(),
+                                                 m_cli->group_id().c_str(),
+                                                 args::get (opt_entry_id).c_str(), &import);
+            entries = 1;
+        }
+        else
+        {
+            status = disir_archive_import (m_cli->disir(), archive_path.c_str(),
+                                           &import, &entries);
+        }
         if (status != DISIR_STATUS_OK)
         {
             std::cerr << "Could not import archive (" << archive_path << "): "
@@ -109,17 +139,7 @@ CommandImport::handle_command (std::vector<std::string> &args)
             return (1);
         }
 
-        if (opt_inspect)
-        {
-            std::cout << "There are " << entries << " entries in the archive:\n" << std::endl;
-            for (auto i = 0; i < entries; i++)
-            {
-                read_archive_entry (import, i, entry_info);
-                info.push_back (entry_info);
-            }
-            print_archive_entries (info);
-        }
-        else if (opt_interactive)
+        if (opt_interactive)
         {
             ret = archive_import_interactive (import, entries);
         }
@@ -181,6 +201,51 @@ CommandImport::handle_command (std::vector<std::string> &args)
     return 0;
 }
 
+int
+CommandImport::archive_inspect (const std::string& archive_path, const char *entry_id)
+{
+    enum disir_status status;
+    struct disir_archive_listing *listing = NULL;
+    std::list<struct archive_entry_info> info;
+
+    status = disir_archive_list (m_cli->disir(), archive_path.c_str(), &listing);
+    if (status != DISIR_STATUS_OK)
+    {
+        std::cerr << "Could not list archive (" << archive_path << "): "
+                  << disir_error (m_cli->disir()) << std::endl;
+        return (1);
+    }
+
+    for (auto current = listing; current != NULL; current = current->next)
+    {
+        struct archive_entry_info entry_info;
+
+        if (entry_id != NULL && (m_cli->group_id() != current->al_group_id ||
+                                 strcmp (entry_id, current->al_entry_id) != 0))
+        {
+            continue;
+        }
+
+        entry_info.ai_entry_id = current->al_entry_id;
+        entry_info.ai_group_id = current->al_group_id;
+        entry_info.ai_version = current->al_version;
+        entry_info.ai_status = DISIR_STATUS_OK;
+        info.push_back (entry_info);
+    }
+    disir_archive_listing_finished (&listing);
+
+    if (info.empty())
+    {
+        std::cout << "There are no matching entries in the archive." << std::endl;
+        return (entry_id != NULL ? 1 : 0);
+    }
+
+    std::cout << "There are " << info.size() << " entries in the archive:\n" << std::endl;
+    print_archive_entries (info);
+
+    return (0);
+}
+
 enum disir_import_option
 CommandImport::prompt_finalize_yes_no_from_user ()
 {
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <set>
+
+#include <disir/disir.h>
+
+#include <disir/cli/command_mold.h>
+#include <disir/cli/args.hxx>
+
+using namespace disir;
+
+CommandMold::CommandMold(void)
+    : Command ("mold")
+{
+}
+
+int
+CommandMold::handle_command (std::vector<std::string> &args)
+{
+    std::stringstream group_description;
+    args::ArgumentParser parser ("Operate on mold entries.",
+                                 "Actions:\n"
+                                 "  compile  Compile mold entries into images that are"
+                                 " loaded in place of their entries, while newer than them.");
+
+    setup_parser (parser);
+    parser.Prog ("disir mold");
+
+    args::HelpFlag help (parser, "help", "Display the mold help menu and exit.",
+                         args::Matcher{'h', "help"});
+
+    group_description << "Specify the group to operate on. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+    args::Positional<std::string> opt_action (parser, "action",
+                                              "Action to perform on the mold entries.");
+    args::PositionalList<std::string> opt_entries (parser, "entry",
+                                                   "A list of entries to operate on."
+                                                   " All available entries if none are given.");
+
+    try
+    {
+        parser.ParseArgs (args);
+    }
+    catch (args::Help&)
+    {
+        std::cout << parser;
+        return (0);
+    }
+    catch (args::ParseError& e)
+    {
+        std::cerr << "ParseError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+    catch (args::ValidationError& e)
+    {
+        std::cerr << "ValidationError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (!opt_action)
+    {
+        std::cerr << "missing required argument [action]" << std::endl;
+        std::cout << parser;
+        return (1);
+    }
+
+    if (opt_group_id && setup_group (args::get(opt_group_id)))
+    {
+        return (1);
+    }
+
+    std::set<std::string> entries;
+    for (const auto& entry : args::get (opt_entries))
+    {
+        entries.insert (entry);
+    }
+
+    if (args::get (opt_action) == "compile")
+    {
+        return compile (entries);
+    }
+
+    std::cerr << "unknown action '" << args::get (opt_action) << "'" << std::endl;
+    std::cout << parser;
+    return (1);
+}
+
+int
+CommandMold::compile (std::set<std::string>& entries)
+{
+    enum disir_status status;
+    int failed = 0;
+
+    if (entries.empty())
+    {
+        struct disir_entry *queried;
+        struct disir_entry *next;
+        struct disir_entry *current;
+
+        status = disir_mold_entries (m_cli->disir(), m_cli->group_id().c_str(), &queried);
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "Failed to retrieve available entries: "
+                      << disir_error (m_cli->disir()) << std::endl;
+            return (-1);
+        }
+
+        current = queried;
+        while (current != NULL)
+        {
+            next = current->next;
+
+            entries.insert (std::string(current->de_entry_name));
+
+            disir_entry_finished (&current);
+            current = next;
+        }
+    }
+
+    std::cout << "In group " << m_cli->group_id() << std::endl;
+    if (entries.empty())
+    {
+        std::cout << "  There are no available entries." << std::endl;
+        return (0);
+    }
+
+    for (const auto& entry : entries)
+    {
+        status = disir_mold_compile_entry (m_cli->disir(), m_cli->group_id().c_str(),
+                                           entry.c_str());
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "  " << entry << ": " << disir_status_string (status);
+            if (disir_error (m_cli->disir()) != NULL)
+            {
+                std::cerr << " (" << disir_error (m_cli->disir()) << ")";
+            }
+            std::cerr << std::endl;
+            failed = 1;
+            continue;
+        }
+
+        std::cout << "  Compiled: " << entry << std::endl;
+    }
+
+    return (failed ? -1 : 0);
+}
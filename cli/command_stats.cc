@@ -0,0 +1,223 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+
+#include <disir/disir.h>
+
+#include <disir/cli/command_stats.h>
+#include <disir/cli/args.hxx>
+
+using namespace disir;
+
+//! Human readable representation of a duration in nanoseconds.
+static std::string
+format_duration (uint64_t ns)
+{
+    std::stringstream stream;
+
+    stream << std::fixed << std::setprecision (1);
+    if (ns < 1000)
+        stream << ns << " ns";
+    else if (ns < 1000000)
+        stream << ns / 1e3 << " us";
+    else if (ns < 1000000000)
+        stream << ns / 1e6 << " ms";
+    else
+        stream << ns / 1e9 << " s";
+
+    return stream.str();
+}
+
+CommandStats::CommandStats(void)
+    : Command ("stats")
+{
+}
+
+int
+CommandStats::handle_command (std::vector<std::string> &args)
+{
+    std::stringstream group_description;
+    args::ArgumentParser parser ("Read entries and report where time is spent within libdisir.");
+
+    setup_parser (parser);
+    parser.Prog ("disir stats");
+
+    args::HelpFlag help (parser, "help", "Display the stats help menu and exit.",
+                         args::Matcher{'h', "help"});
+
+    group_description << "Specify the group to operate on. The loaded default is: "
+                      << m_cli->group_id();
+    args::ValueFlag<std::string> opt_group_id (parser, "NAME", group_description.str(),
+                                               args::Matcher{"group"});
+
+    args::Flag opt_mold (parser, "mold",
+                         "Read molds instead of configs.",
+                         args::Matcher{"mold"});
+    args::ValueFlag<int> opt_iterations (parser, "N",
+                                         "Number of times to read each entry. The default is 1.",
+                                         args::Matcher{'n', "iterations"});
+    args::PositionalList<std::string> opt_entries (parser, "entry",
+                                                   "A list of entries to read."
+                                                   " The default is every available entry.");
+
+    try
+    {
+        parser.ParseArgs (args);
+    }
+    catch (args::Help&)
+    {
+        std::cout << parser;
+        return (0);
+    }
+    catch (args::ParseError& e)
+    {
+        std::cerr << "ParseError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+    catch (args::ValidationError& e)
+    {
+        std::cerr << "ValidationError: " << e.what() << std::endl;
+        std::cerr << "See '" << m_cli->m_program_name << " --help'" << std::endl;
+        return (1);
+    }
+
+    if (opt_group_id && setup_group (args::get(opt_group_id)))
+    {
+        return (1);
+    }
+
+    int iterations = (opt_iterations ? args::get (opt_iterations) : 1);
+    if (iterations < 1)
+    {
+        std::cerr << "iterations must be a positive number" << std::endl;
+        return (1);
+    }
+
+    enum disir_status status;
+    status = disir_stats_enable (m_cli->disir(), 1);
+    if (status != DISIR_STATUS_OK)
+    {
+        std::cerr << "Failed to enable stats: " << disir_status_string (status) << std::endl;
+        return (1);
+    }
+    disir_stats_reset (m_cli->disir());
+
+    // Get the set of entries to read
+    std::set<std::string> entries_to_read;
+    if (opt_entries)
+    {
+        for (const auto& entry : args::get (opt_entries))
+        {
+            entries_to_read.insert (entry);
+        }
+    }
+    else
+    {
+        struct disir_entry *entries;
+        struct disir_entry *next;
+        struct disir_entry *current;
+
+        if (opt_mold)
+        {
+            status = disir_mold_entries (m_cli->disir(), m_cli->group_id().c_str(), &entries);
+        }
+        else
+        {
+            status = disir_config_entries (m_cli->disir(), m_cli->group_id().c_str(), &entries);
+        }
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "Failed to retrieve available entries: "
+                      << disir_error (m_cli->disir()) << std::endl;
+            return (-1);
+        }
+
+        current = entries;
+        while (current != NULL)
+        {
+            next = current->next;
+
+            entries_to_read.insert (std::string(current->de_entry_name));
+
+            disir_entry_finished (&current);
+            current = next;
+        }
+    }
+
+    std::cout << "In group " << m_cli->group_id() << std::endl;
+    m_cli->verbose() << "Reading " << entries_to_read.size() << " entries "
+                     << iterations << " times." << std::endl;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        for (const auto& entry : entries_to_read)
+        {
+            if (opt_mold)
+            {
+                struct disir_mold *mold = NULL;
+
+                status = disir_mold_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                          entry.c_str(), &mold);
+                if (mold)
+                    disir_mold_finished (&mold);
+            }
+            else
+            {
+                struct disir_config *config = NULL;
+
+                status = disir_config_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                            entry.c_str(), NULL, &config);
+                if (config)
+                    disir_config_finished (&config);
+            }
+
+            if (status != DISIR_STATUS_OK && i == 0)
+            {
+                m_cli->verbose() << "  " << entry << ": " << disir_status_string (status)
+                                 << std::endl;
+            }
+        }
+    }
+
+    std::cout << std::endl;
+    print_stats ();
+    std::cout << std::endl;
+
+    return (0);
+}
+
+void
+CommandStats::print_stats (void)
+{
+    struct disir_stats stats;
+
+    disir_stats_get (m_cli->disir(), &stats);
+
+    std::cout << "  " << std::left << std::setw (16) << "operation" << std::right
+              << std::setw (8) << "calls" << std::setw (10) << "failures"
+              << std::setw (12) << "mean" << std::setw (12) << "p50"
+              << std::setw (12) << "p99" << std::setw (12) << "max"
+              << std::setw (12) << "contexts" << std::endl;
+
+    for (int i = 0; i < DISIR_STATS_OPERATION_COUNT; i++)
+    {
+        const struct disir_stats_counter& counter = stats.ds_counters[i];
+
+        if (counter.sc_calls == 0)
+            continue;
+
+        std::cout << "  " << std::left << std::setw (16)
+                  << disir_stats_operation_string ((enum disir_stats_operation) i)
+                  << std::right
+                  << std::setw (8) << counter.sc_calls
+                  << std::setw (10) << counter.sc_failures
+                  << std::setw (12) << format_duration (counter.sc_total_ns / counter.sc_calls)
+                  << std::setw (12) << format_duration (disir_stats_percentile (&counter, 50))
+                  << std::setw (12) << format_duration (disir_stats_percentile (&counter, 99))
+                  << std::setw (12) << format_duration (counter.sc_max_ns)
+                  << std::setw (12) << counter.sc_contexts / counter.sc_calls
+                  << std::endl;
+    }
+}
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <disir/disir.h>
 #include <disir/fslib/util.h>
@@ -41,6 +42,10 @@ CommandVerify::handle_command (std::vector<std::string> &args)
     args::ValueFlag<std::string> opt_text_mold (parser, "TEXT MOLD",
                                                 "Verify mold from disk.",
                                                 args::Matcher{"text-mold"});
+    args::ValueFlag<int> opt_jobs (parser, "N",
+                                   "Number of threads to read config entries with."
+                                   " The default is the number of online processors.",
+                                   args::Matcher{'j', "jobs"});
     args::PositionalList<std::string> opt_entries (parser, "entry",
                                                    "A list of entries to verify.");
 
@@ -171,29 +176,60 @@ CommandVerify::handle_command (std::vector<std::string> &args)
     m_cli->verbose() << "There are " << entries_to_verify.size()
                      << " entries to verify." << std::endl;
     std::cout << std::endl;
-    for (const auto& entry : entries_to_verify)
+    if (opt_mold)
     {
-        // We simply read the config entry - the return status shall indicate whether it is invalid or not
-        enum disir_status status;
-        struct disir_config *config = NULL;
-        struct disir_mold *mold = NULL;
-
-        if (opt_mold)
+        for (const auto& entry : entries_to_verify)
         {
+            // We simply read the mold entry - the return status shall indicate whether it is invalid or not
+            enum disir_status status;
+            struct disir_mold *mold = NULL;
+
             status = disir_mold_read (m_cli->disir(), m_cli->group_id().c_str(),
                                       entry.c_str(), &mold);
+
+            print_verify (status, entry.c_str(), NULL, mold);
+            if (mold)
+                disir_mold_finished (&mold);
         }
-        else
+    }
+    else
+    {
+        // Read every config entry in parallel - the status of each shall indicate
+        // whether it is invalid or not
+        enum disir_status status;
+        std::vector<const char *> names;
+        for (const auto& entry : entries_to_verify)
         {
-            status = disir_config_read (m_cli->disir(), m_cli->group_id().c_str(),
-                                        entry.c_str(), NULL, &config);
+            names.push_back (entry.c_str());
         }
+        std::vector<struct disir_config *> configs (names.size(), NULL);
+        std::vector<enum disir_status> statuses (names.size(), DISIR_STATUS_OK);
 
-        print_verify (status, entry.c_str(), config, mold);
-        if (config)
-            disir_config_finished (&config);
-        if (mold)
-            disir_mold_finished (&mold);
+        status = disir_config_read_many (m_cli->disir(), m_cli->group_id().c_str(),
+                                         names.data(), names.size(),
+                                         configs.data(), statuses.data(),
+                                         (opt_jobs ? args::get (opt_jobs) : 0));
+        if (status != DISIR_STATUS_OK)
+        {
+            std::cerr << "Failed to read entries: " << disir_status_string (status) << std::endl;
+            return (-1);
+        }
+
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (statuses[i] != DISIR_STATUS_OK && statuses[i] != DISIR_STATUS_INVALID_CONTEXT)
+            {
+                // Read it again to register the error message on our instance.
+                if (configs[i])
+                    disir_config_finished (&configs[i]);
+                statuses[i] = disir_config_read (m_cli->disir(), m_cli->group_id().c_str(),
+                                                 names[i], NULL, &configs[i]);
+            }
+
+            print_verify (statuses[i], names[i], configs[i], NULL);
+            if (configs[i])
+                disir_config_finished (&configs[i]);
+        }
     }
     std::cout << std::endl;
 
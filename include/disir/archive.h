@@ -21,6 +21,19 @@ struct import_report
     int ir_internal;
 };
 
+//! A config entry listed from a disir archive.
+struct disir_archive_listing
+{
+    //! Backend (plugin) the config was exported from.
+    char *al_backend_id;
+    char *al_group_id;
+    char *al_entry_id;
+    //! Version of the archived config.
+    char *al_version;
+
+    struct disir_archive_listing *next;
+};
+
 //! disir import options
 enum disir_import_option
 {
@@ -42,6 +55,23 @@ enum disir_import_option
     DISIR_IMPORT_UPDATE_WITH_DISCARD,
 };
 
+//! Compression of an exported archive.
+enum disir_archive_codec
+{
+    //! xz, compressed in blocks that can be read on their own - on several threads.
+    //! Only xz archives allow importing a single entry, and appending to the archive,
+    //! without decompressing it in its entirety.
+    DISIR_ARCHIVE_CODEC_XZ = 0,
+    //! zstd, on several threads where libarchive supports it.
+    DISIR_ARCHIVE_CODEC_ZSTD,
+    DISIR_ARCHIVE_CODEC_GZIP,
+    //! Uncompressed tar archive.
+    DISIR_ARCHIVE_CODEC_NONE,
+};
+
+//! Compression level of the codec's own choosing.
+#define DISIR_ARCHIVE_LEVEL_DEFAULT (-1)
+
 //! \brief Begin exporting a new or existing archive.
 //!
 //! Function initiates exporting a new or already existing archive
@@ -66,11 +96,37 @@ enum disir_status
 disir_archive_export_begin (struct disir_instance *instance,
                             const char *archive_path, struct disir_archive **archive);
 
+//! \brief Begin exporting a new or existing archive, compressed with 'codec'.
+//!
+//! As disir_archive_export_begin, which compresses with DISIR_ARCHIVE_CODEC_XZ
+//! at DISIR_ARCHIVE_LEVEL_DEFAULT. An existing archive is only appended to in place
+//! when both it and the exported archive are xz compressed. Otherwise, it is read in its
+//! entirety and written again with 'codec'.
+//!
+//! \param[in] instance The disir instance.
+//! \param[in] archive_path Filepath either path to an archive to which entries can be
+//!     appended, or NULL to start a new one.
+//! \param[in] codec Compression of the exported archive.
+//! \param[in] level Compression level of 'codec': 0-9 for xz and gzip, 1-22 for zstd,
+//!     or DISIR_ARCHIVE_LEVEL_DEFAULT. Only DISIR_ARCHIVE_LEVEL_DEFAULT applies to
+//!     DISIR_ARCHIVE_CODEC_NONE.
+//! \param[out] archive The disir archive structure containing archive state.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if codec or level is out of range.
+//! \return See disir_archive_export_begin for the remaining return values.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_archive_export_begin_codec (struct disir_instance *instance, const char *archive_path,
+                                  enum disir_archive_codec codec, int level,
+                                  struct disir_archive **archive);
+
 //! \brief Append configs within group to a disir archive.
 //!
 //! Function will append all configs within the given group to an archive created
 //! by a disir_archive_export_begin call. If the group already exist in
-//! the archive, an error is returned.
+//! the archive, an error is returned. The configs are read and serialized
+//! on multiple threads, while they are written to the archive in order.
 //!
 //! \param[in] instance The disir instance.
 //! \param[in] archive The open disir archive initiated by disir_archive_export_begin.
@@ -81,7 +137,7 @@ disir_archive_export_begin (struct disir_instance *instance,
 //!     invalid options.
 //! \return DISIR_STATUS_EXISTS if appending group already exist in archive.
 //! \return DISIR_STATUS_NOT_EXIST if no config entries exists for given group id.
-//! \return DISIR_STATUS_FS_ERROR if unable to write to disk or clean up temporary files.
+//! \return DISIR_STATUS_FS_ERROR if unable to write the entries to the archive.
 //! \return DISIR_STATUS_NO_CAN_DO if plugin does not support serializing configuration entries.
 //!
 DISIR_EXPORT
@@ -104,7 +160,7 @@ disir_archive_append_group (struct disir_instance *instance, struct disir_archiv
 //! \return DISIR_STATUS_INVALID_ARGUMENT if either of the inputs are NULL or
 //!     invalid options.
 //! \return DISIR_STATUS_EXISTS if appending entry id already exist in archive.
-//! \return DISIR_STATUS_FS_ERROR if unable to write to disk or clean up temporary files.
+//! \return DISIR_STATUS_FS_ERROR if unable to write the entry to the archive.
 //! \return DISIR_STATUS_NO_CAN_DO if plugin does not support serializing configuartion entries.
 //!
 DISIR_EXPORT
@@ -162,6 +218,65 @@ enum disir_status
 disir_archive_import (struct disir_instance *instance, const char *archive_path,
                       struct disir_import **import, int *entries);
 
+//! \brief Retrieve a single config entry from disir_archive.
+//!
+//! Function will return an import structure containing only the config
+//! identified by group_id and entry_id. It is resolved, and finalized, exactly
+//! as an entry retrieved by disir_archive_import, at index 0.
+//!
+//! The entry is located through the entry index of the archive, decompressing
+//! only the part of the archive that holds it. Archives without an index are
+//! read in their entirety.
+//!
+//! \param[in] instance The disir instance.
+//! \param[in] archive_path Filepath to the disir archive
+//! \param[in] group_id Name of group the entry belongs to.
+//! \param[in] entry_id The config's entry ID.
+//! \param[out] import The structure containing import state.
+//!
+//! \return DISIR_STATUS_OK on success.
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either of the inputs are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if no such entry exists in the archive,
+//!     or no archive on archive_path exist.
+//! \return DISIR_STATUS_FS_ERROR if archive is invalid, or the entry does not match its index.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_archive_import_entry (struct disir_instance *instance, const char *archive_path,
+                            const char *group_id, const char *entry_id,
+                            struct disir_import **import);
+
+//! \brief List the config entries in a disir archive.
+//!
+//! Function will populate listing with the config entries in the archive,
+//! as read from its entry index. No config is read. Archives without an
+//! index are read in their entirety.
+//! The listing must be freed with disir_archive_listing_finished.
+//!
+//! \param[in] instance The disir instance.
+//! \param[in] archive_path Filepath to the disir archive
+//! \param[out] listing Linked list of the entries in the archive.
+//!
+//! \return DISIR_STATUS_OK on success.
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either of the inputs are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if no archive on archive_path exist.
+//! \return DISIR_STATUS_FS_ERROR if archive is invalid.
+//! \return DISIR_STATUS_NO_MEMORY on allocation failure.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_archive_list (struct disir_instance *instance, const char *archive_path,
+                    struct disir_archive_listing **listing);
+
+//! \brief Free a listing retrieved by disir_archive_list, every entry included.
+//!
+//! \return DISIR_STATUS_OK, with listing set to NULL.
+//! \return DISIR_STATUS_INVALID_ARGUMENT if listing is NULL.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_archive_listing_finished (struct disir_archive_listing **listing);
+
 //! \brief Retrieve information about a single configuration entry.
 //!
 //! Function will return the information about a import configuration entry
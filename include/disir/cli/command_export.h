@@ -24,6 +24,10 @@ namespace disir
         std::string m_tempdir = "";
         // name of archive
         std::string m_archive_name = "";
+        // compression of the archive
+        enum disir_archive_codec m_codec = DISIR_ARCHIVE_CODEC_XZ;
+        // compression level of m_codec
+        int m_level = DISIR_ARCHIVE_LEVEL_DEFAULT;
 
         // Creates and export archive of config entries
         int populate_archive (const char *path, const char *dest_path,
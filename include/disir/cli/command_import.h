@@ -53,6 +53,10 @@ namespace disir
         //! Handle command implementation
         virtual int handle_command (std::vector<std::string> &args);
     private:
+        //! Print the entries in the archive, or only entry_id if not NULL,
+        //! without reading their configs.
+        int archive_inspect (const std::string& archive_path, const char *entry_id);
+
         //! Import all entries with one option
         int import_all_option (struct disir_import *import, int entries,
                                enum disir_import_option option);
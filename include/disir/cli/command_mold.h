@@ -0,0 +1,26 @@
+#ifndef _LIBDISIRCLI_COMMAND_MOLD_H
+#define _LIBDISIRCLI_COMMAND_MOLD_H
+
+#include <string>
+
+#include <disir/cli/cli.h>
+#include <disir/cli/command.h>
+
+namespace disir
+{
+    class CommandMold : public Command
+    {
+    public:
+        //! Basic constructor
+        CommandMold (void);
+
+        //! Handle command implementation
+        virtual int handle_command (std::vector<std::string> &args);
+
+        //! Compile each of the mold entries. All available entries if empty.
+        int compile (std::set<std::string>& entries);
+    };
+
+}
+
+#endif // _LIBDISIRCLI_COMMAND_MOLD_H
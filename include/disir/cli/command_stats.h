@@ -0,0 +1,27 @@
+#ifndef _LIBDISIRCLI_COMMAND_STATS_H
+#define _LIBDISIRCLI_COMMAND_STATS_H
+
+#include <string>
+
+#include <disir/cli/cli.h>
+#include <disir/cli/command.h>
+
+namespace disir
+{
+    class CommandStats : public Command
+    {
+    public:
+        //! Basic constructor
+        CommandStats (void);
+
+        //! Handle command implementation
+        virtual int handle_command (std::vector<std::string> &args);
+
+    private:
+        //! Print the counters collected by the instance of the cli.
+        void print_stats (void);
+    };
+
+}
+
+#endif // _LIBDISIRCLI_COMMAND_STATS_H
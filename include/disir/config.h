@@ -5,6 +5,8 @@
 extern "C"{
 #endif // __cplusplus
 
+#include <stddef.h>
+
 #include <disir/disir.h>
 
 //!
@@ -43,6 +45,41 @@ enum disir_status
 disir_config_read (struct disir_instance *instance, const char *group_id, const char *entry_id,
                    struct disir_mold *mold, struct disir_config **config);
 
+//! \brief Input many config entries from the same group in parallel.
+//!
+//! Equivalent to calling disir_config_read() with a NULL mold for each entry in `entries`,
+//! but the entries are read, parsed and validated by a pool of `nthreads` threads.
+//! Entries resolving to the same mold share a single, parsed mold, through the
+//! mold cache of `instance` (see disir_mold_cache_stats()).
+//!
+//! The instance must not be used by other threads while this function executes.
+//! Error messages of individual entries are not retained on `instance`; re-read
+//! a failed entry with disir_config_read() to retrieve its disir_error().
+//!
+//! \param[in] instance Library instance.
+//! \param[in] group_id String identifier for the which group to look for entries.
+//! \param[in] entries Array of `entries_count` config entry identifiers to read.
+//! \param[in] entries_count Number of elements in `entries`, `configs` and `statuses`.
+//! \param[out] configs Array populated with the config read for each entry,
+//!     or NULL if no config was read. Each config must be released with
+//!     disir_config_finished().
+//! \param[out] statuses Array populated with the status disir_config_read()
+//!     would return for each entry.
+//! \param[in] nthreads Number of threads to read entries with, including the calling thread.
+//!     If zero or negative, the number of online processors is used.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance, group_id, entries, configs
+//!     or statuses are NULL.
+//! \return DISIR_STATUS_OK when every entry has been attempted read.
+//!     The individual result is found in `statuses`.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_config_read_many (struct disir_instance *instance, const char *group_id,
+                        const char * const *entries, size_t entries_count,
+                        struct disir_config **configs, enum disir_status *statuses,
+                        int nthreads);
+
 //! \brief Output the config object to the disir instance.
 //!
 //! \param[in] instance Library instance.
@@ -138,6 +175,9 @@ disir_generate_config_from_mold (struct disir_mold *mold, struct disir_version *
 
 //! \brief Validate the config, checking for any contexts that are invalid.
 //!
+//! Contexts modified since the config was last validated are validated again.
+//! Unmodified contexts retain the validity determined when they were last validated.
+//!
 //! \param[in] config Input config to validate
 //! \param[out] collection Populated collection of invalid contexts, if any.
 //!     This parameter is optional. If NULL, no collection is returned.
@@ -165,6 +205,30 @@ DISIR_EXPORT
 enum disir_status
 disir_config_get_mold(struct disir_config *config, struct disir_mold **mold);
 
+//! \brief Create a read-only snapshot of a config, which may be shared between threads.
+//!
+//! The snapshot is a deep copy of config. It cannot be modified; every setter
+//! and context constructor returns DISIR_STATUS_CONTEXT_IN_WRONG_STATE.
+//! Reference counting is elided on the snapshot, so any number of threads may
+//! concurrently read it through the disir_config_get_keyval_* functions, or
+//! dc_config_getcontext() and the dc_* getters. The source config is not affected.
+//!
+//! A compiled query (struct disir_query) caches its resolution and must not be
+//! shared between threads - compile one per thread instead.
+//!
+//! Release the snapshot with disir_config_finished(), once no thread is reading it.
+//!
+//! \param[in] config Finalized config to take a snapshot of.
+//! \param[out] snapshot Allocated read-only copy of config on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if config or snapshot are NULL.
+//! \return DISIR_STATUS_NO_MEMORY on allocation failure.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_config_freeze (struct disir_config *config, struct disir_config **snapshot);
+
 //! \brief Mark yourself finished with the configuration object.
 //!
 //! NOTE: Destroys the config object outright - not usable anywhere after this operation
@@ -344,6 +408,210 @@ enum disir_status
 disir_config_set_keyval_integer (struct disir_config *config, int64_t value,
                                  const char *query, ...);
 
+//! Pre-parsed query, created by disir_query_compile().
+//! A compiled query may be used with any config. It remembers the keyval it last
+//! resolved to, and hands it out directly until any section or keyval is added to
+//! or removed from a config or mold.
+struct disir_query;
+
+//! \brief Parse a query once, for repeated use with the *_compiled getters and setters.
+//!
+//! For an exhaustive explaination of the query syntax, see XXX_QUERY_XXX
+//!
+//! \param[out] query Compiled query allocated on success.
+//! \param[in] format The varadic template and arguments to construct the query.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if query or format are NULL,
+//!     or the query is malformed.
+//! \return DISIR_STATUS_INSUFFICIENT_RESOURCES if the query exceeds 2048 bytes.
+//! \return DISIR_STATUS_NO_MEMORY on allocation failure.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_query_compile (struct disir_query **query, const char *format, ...);
+
+//! \brief Release a compiled query.
+//!
+//! \param[in,out] query Compiled query to release. Sat to NULL.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if query is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_query_finished (struct disir_query **query);
+
+//! \brief Retrieve the query string a compiled query was created from.
+DISIR_EXPORT
+const char *
+disir_query_string (struct disir_query *query);
+
+//! \see disir_config_get_keyval_string()
+//! Resolve a compiled query instead of formatting and parsing a query string.
+DISIR_EXPORT
+enum disir_status
+disir_config_get_keyval_string_compiled (struct disir_config *config, const char **value,
+                                         struct disir_query *query);
+
+//! \see disir_config_set_keyval_string()
+DISIR_EXPORT
+enum disir_status
+disir_config_set_keyval_string_compiled (struct disir_config *config, const char *value,
+                                         struct disir_query *query);
+
+//! \see disir_config_get_keyval_enum()
+DISIR_EXPORT
+enum disir_status
+disir_config_get_keyval_enum_compiled (struct disir_config *config, const char **value,
+                                       struct disir_query *query);
+
+//! \see disir_config_set_keyval_enum()
+DISIR_EXPORT
+enum disir_status
+disir_config_set_keyval_enum_compiled (struct disir_config *config, const char *value,
+                                       struct disir_query *query);
+
+//! \see disir_config_get_keyval_boolean()
+DISIR_EXPORT
+enum disir_status
+disir_config_get_keyval_boolean_compiled (struct disir_config *config, uint8_t *value,
+                                          struct disir_query *query);
+
+//! \see disir_config_set_keyval_boolean()
+DISIR_EXPORT
+enum disir_status
+disir_config_set_keyval_boolean_compiled (struct disir_config *config, uint8_t value,
+                                          struct disir_query *query);
+
+//! \see disir_config_get_keyval_float()
+DISIR_EXPORT
+enum disir_status
+disir_config_get_keyval_float_compiled (struct disir_config *config, double *value,
+                                        struct disir_query *query);
+
+//! \see disir_config_set_keyval_float()
+DISIR_EXPORT
+enum disir_status
+disir_config_set_keyval_float_compiled (struct disir_config *config, double value,
+                                        struct disir_query *query);
+
+//! \see disir_config_get_keyval_integer()
+DISIR_EXPORT
+enum disir_status
+disir_config_get_keyval_integer_compiled (struct disir_config *config, int64_t *value,
+                                          struct disir_query *query);
+
+//! \see disir_config_set_keyval_integer()
+DISIR_EXPORT
+enum disir_status
+disir_config_set_keyval_integer_compiled (struct disir_config *config, int64_t value,
+                                          struct disir_query *query);
+
+
+//! Live view of a config entry, reloaded whenever its backing file changes.
+//! Created by disir_config_watch().
+struct disir_watch;
+
+//! \brief Read a config entry and keep it up to date as its backing file changes.
+//!
+//! The entry is read with disir_config_read() and published as a frozen snapshot
+//! (see disir_config_freeze()). If the entry is stored in a file by a filesystem
+//! based plugin, a background thread watches the file with inotify. Whenever the file
+//! is written, the entry is read and validated anew. Only a config that reads and
+//! validates without error replaces the published snapshot.
+//! Otherwise, the previous snapshot stays in place.
+//!
+//! Readers access the published snapshot through disir_watch_acquire() and
+//! disir_watch_release(). They never block, and a snapshot is not released
+//! before every reader that acquired it has released it again.
+//!
+//! Reloads use instance from the watch thread. The caller must not use the same
+//! instance from other threads while the watch is active; create a dedicated
+//! instance for the watch if required.
+//!
+//! \param[in] instance Library instance to read the entry with. Must outlive the watch.
+//! \param[in] group_id Group to read the entry from.
+//! \param[in] entry_id Config entry to watch.
+//! \param[out] watch Allocated watch on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any argument is NULL.
+//! \return DISIR_STATUS_NO_MEMORY on allocation failure.
+//! \return status of disir_config_read() if the initial read does not return
+//!     DISIR_STATUS_OK.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_config_watch (struct disir_instance *instance, const char *group_id,
+                    const char *entry_id, struct disir_watch **watch);
+
+//! \brief Acquire the currently published snapshot of a watched config.
+//!
+//! The snapshot is read-only, and remains valid until the matching
+//! disir_watch_release() call. Release it as soon as possible, as a replaced
+//! snapshot is held back until every reader has released it.
+//!
+//! \param[in] watch Watch to acquire the snapshot from.
+//! \param[out] config Published snapshot.
+//! \param[out] ticket Opaque value to pass to disir_watch_release().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if any argument is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_watch_acquire (struct disir_watch *watch, struct disir_config **config,
+                     uint64_t *ticket);
+
+//! \brief Release a snapshot acquired with disir_watch_acquire().
+//!
+//! \param[in] watch Watch the snapshot was acquired from.
+//! \param[in] ticket Value populated by disir_watch_acquire().
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if watch is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_watch_release (struct disir_watch *watch, uint64_t ticket);
+
+//! \brief Read the watched config entry anew, and publish it if valid.
+//!
+//! Blocks until every reader of the replaced snapshot has released it.
+//!
+//! \param[in] watch Watch to reload.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if watch is NULL.
+//! \return status of disir_config_read() if it does not return DISIR_STATUS_OK.
+//!     The published snapshot is left unchanged.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_watch_reload (struct disir_watch *watch);
+
+//! \brief Number of snapshots published by the watch, starting at 1.
+//!
+//! \return 0 if watch is NULL.
+//!
+DISIR_EXPORT
+uint64_t
+disir_watch_generation (struct disir_watch *watch);
+
+//! \brief Stop watching and release the watch, including its published snapshot.
+//!
+//! No reader may hold a snapshot acquired from watch.
+//!
+//! \param[in,out] watch Watch to release. Sat to NULL on success.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if watch or *watch are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_watch_finished (struct disir_watch **watch);
+
 
 #ifdef __cplusplus
 }
@@ -181,6 +181,30 @@ DISIR_EXPORT
 enum disir_status
 dc_context_valid (struct disir_context *context);
 
+//! \brief Allocate every object in the tree of root context from a single arena.
+//!
+//! Sections, keyvals, defaults, documentation and restrictions, along with
+//! their names and string values, are carved out of large blocks owned by the root.
+//! The blocks are released in one sweep when the root context is released,
+//! instead of one free per object. Destroying the tree still visits every context
+//! to release its reference. Memory of individual objects destroyed before the root
+//! is not reclaimed until then; strings replaced by longer ones are only reused
+//! by strings of the same size.
+//!
+//! Must be invoked on a freshly begun root context, before any child is added.
+//!
+//! \param context Root context, either DISIR_CONTEXT_CONFIG or DISIR_CONTEXT_MOLD.
+//!
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is not a root context.
+//! \return DISIR_STATUS_CONTEXT_IN_WRONG_STATE if context already has children
+//!     or outstanding references.
+//! \return DISIR_STATUS_NO_MEMORY if the arena could not be allocated.
+//! \return DISIR_STATUS_OK on success, or if the arena is already enabled.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_enable_arena (struct disir_context *context);
+
 //! \brief Add a name to a context entry.
 //!
 //! This is required on supported contexts:
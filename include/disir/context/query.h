@@ -111,6 +111,60 @@ enum disir_status
 dc_find_elements (struct disir_context *context, const char *name,
                   struct disir_collection **collection);
 
+//! Private element container of CONFIG, MOLD and SECTION contexts.
+struct disir_element_storage;
+
+//! \brief Borrowed iterator over the direct child elements of a context.
+//!
+//! The iterator is meant to live on the stack. It allocates nothing,
+//! and requires no cleanup. Its members are private.
+//!
+struct disir_element_iter
+{
+    struct disir_element_storage    *ei_storage;
+    int32_t                         ei_index;
+    int32_t                         ei_by_name;
+};
+
+//! \brief Begin iterating the direct child elements of context.
+//!
+//! Unlike dc_get_elements() and dc_find_elements(), the contexts yielded by
+//! dc_element_iter_next() are borrowed: their reference count is not incremented,
+//! and the caller must not dc_putcontext() them. A borrowed context is only valid
+//! while no element is added to or removed from the parent context.
+//!
+//! \param[in] context Parent context to iterate child elements of.
+//!     Must be of context type:
+//!         * DISIR_CONTEXT_CONFIG
+//!         * DISIR_CONTEXT_MOLD
+//!         * DISIR_CONTEXT_SECTION
+//! \param[in] name Only iterate child elements matching name. NULL iterates every child.
+//! \param[out] iter Iterator to initialize.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if context or iter are NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if the input context is not of correct type.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_element_iter_begin (struct disir_context *context, const char *name,
+                       struct disir_element_iter *iter);
+
+//! \brief Retrieve the next borrowed child element from the iterator.
+//!
+//! Child elements are yielded in insertion order.
+//!
+//! \param[in] iter Iterator initialized by dc_element_iter_begin().
+//! \param[out] context Populated with the next child element. Not to be put.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if iter or context are NULL.
+//! \return DISIR_STATUS_EXHAUSTED when every child element has been yielded.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dc_element_iter_next (struct disir_element_iter *iter, struct disir_context **context);
+
 //! \brief Query for a context relative to parent.
 //!
 //! \param[in] parent The context to query from.
@@ -235,12 +235,217 @@ DISIR_EXPORT
 enum disir_status
 disir_instance_destroy (struct disir_instance **instance);
 
+//! Counters of the mold cache held by a libdisir instance.
+struct disir_mold_cache_stats
+{
+    //! Config reads that reused a cached mold.
+    uint64_t        mcs_hits;
+    //! Config reads that had to read the mold from its plugin.
+    uint64_t        mcs_misses;
+    //! Number of molds currently held by the cache.
+    uint64_t        mcs_entries;
+};
+
+//! \brief Retrieve the mold cache counters of a libdisir instance.
+//!
+//! When a config is read from a filesystem backed plugin without an explicit mold,
+//! the mold is cached in the instance. Subsequent reads of configs resolving to the
+//! same mold entry reuse it, as long as the mold (and override) files are unchanged
+//! on disk - i.e., same inode, modification time and size.
+//!
+//! \param[in] instance Library instance to query.
+//! \param[out] stats Populated with the cache counters.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance or stats are NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_cache_stats (struct disir_instance *instance, struct disir_mold_cache_stats *stats);
+
+//! \brief Release all molds held by the mold cache of a libdisir instance.
+//!
+//! Molds still referenced by configs are not destroyed until those configs are finished.
+//! The hit and miss counters are left untouched.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_cache_clear (struct disir_instance *instance);
+
+//! \brief Allocate each config and mold read through instance from an arena.
+//!
+//! The root context of configs and molds unserialized by the plugins of instance
+//! are then sat up with dc_enable_arena(). Off by default, as the memory of objects
+//! destroyed, and of strings replaced by longer ones, is only reused for objects
+//! of the same size until the entire tree is released. Best suited for configs
+//! that are read, queried and released - not edited at length.
+//! Worker instances, e.g., those of disir_config_read_many(), follow the
+//! instance they read on behalf of.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if instance is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_arena_enable (struct disir_instance *instance, int enable);
+
+//! \brief Query whether configs and molds read through instance are allocated from an arena.
+//!
+//! \return 1 if enabled by disir_arena_enable(), 0 otherwise - or if instance is NULL.
+//!
+DISIR_EXPORT
+int
+disir_arena_enabled (struct disir_instance *instance);
+
+//! Operations timed by the stats of a libdisir instance. See disir_stats_get().
+enum disir_stats_operation
+{
+    //! disir_config_read() - the dp_config_read call of the plugin holding the entry.
+    DISIR_STATS_CONFIG_READ = 0,
+    //! disir_config_write() - the dp_config_write call of the plugin.
+    DISIR_STATS_CONFIG_WRITE,
+    //! disir_config_entries() - the dp_config_entries call of every plugin in the group.
+    DISIR_STATS_CONFIG_ENTRIES,
+    //! disir_mold_read() - the dp_mold_read call of the plugin holding the entry.
+    DISIR_STATS_MOLD_READ,
+    //! disir_mold_write() - the dp_mold_write call of the plugin.
+    DISIR_STATS_MOLD_WRITE,
+    //! disir_mold_entries() - the dp_mold_entries call of every plugin in the group.
+    DISIR_STATS_MOLD_ENTRIES,
+    //! Unserializing a config or mold read from the filesystem.
+    DISIR_STATS_PARSE,
+    //! Validating a finalized config or mold, or a modified config.
+    DISIR_STATS_VALIDATE,
+    //! disir_update_config().
+    DISIR_STATS_UPDATE,
+    //! dc_compare().
+    DISIR_STATS_COMPARE,
+
+    //! Number of operations - not an operation.
+    DISIR_STATS_OPERATION_COUNT,
+};
+
+//! Number of latency histogram buckets. Bucket i counts calls that took
+//! [2^i, 2^(i+1)) nanoseconds. The last bucket also counts every slower call.
+#define DISIR_STATS_HISTOGRAM_BUCKETS 32
+
+//! Counters of a single operation.
+struct disir_stats_counter
+{
+    //! Number of calls.
+    uint64_t        sc_calls;
+    //! Number of calls that returned another status than DISIR_STATUS_OK.
+    uint64_t        sc_failures;
+    //! Accumulated time spent in calls, in nanoseconds.
+    uint64_t        sc_total_ns;
+    //! Slowest call, in nanoseconds.
+    uint64_t        sc_max_ns;
+    //! Contexts allocated by the calls. For reads, this is the size of the trees read.
+    uint64_t        sc_contexts;
+    //! Most contexts allocated by a single call, i.e., the largest tree read.
+    uint64_t        sc_contexts_max;
+    //! Latency histogram, see DISIR_STATS_HISTOGRAM_BUCKETS.
+    uint64_t        sc_histogram[DISIR_STATS_HISTOGRAM_BUCKETS];
+};
+
+//! Counters of every operation, indexed by enum disir_stats_operation.
+struct disir_stats
+{
+    struct disir_stats_counter ds_counters[DISIR_STATS_OPERATION_COUNT];
+};
+
+//! \brief Start or stop collecting stats for instance.
+//!
+//! Stats are not collected unless enabled; operations then only check a flag.
+//! Operations of a worker instance, e.g., those of disir_config_read_many(),
+//! count towards the instance it reads on behalf of.
+//!
+//! Passing a NULL instance enables the process wide stats, which count validate,
+//! update and compare operations performed outside the operations of an instance.
+//! The same operations performed by disir_config_read() and friends count towards
+//! the stats of that instance, if enabled.
+//!
+//! Counters are kept when stats are disabled. See disir_stats_reset().
+//!
+//! \return DISIR_STATUS_NO_MEMORY if the counters could not be allocated.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_stats_enable (struct disir_instance *instance, int enable);
+
+//! \brief Retrieve the stats collected for instance, or the process wide stats if NULL.
+//!
+//! \param[out] stats Populated with a snapshot of the counters. Counters of operations
+//!     running concurrently in other threads may be mid-update.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if stats is NULL.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_stats_get (struct disir_instance *instance, struct disir_stats *stats);
+
+//! \brief Zero the stats of instance, or the process wide stats if NULL.
+//!
+//! \return DISIR_STATUS_OK.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_stats_reset (struct disir_instance *instance);
+
+//! \brief Return a string representation of the stats operation.
+DISIR_EXPORT
+const char *
+disir_stats_operation_string (enum disir_stats_operation operation);
+
+//! \brief Estimate the latency below which percentile percent of the calls of counter completed.
+//!
+//! \return upper bound, in nanoseconds, of the histogram bucket holding the percentile,
+//!     at most the slowest call. 0 if counter holds no calls.
+//!
+DISIR_EXPORT
+uint64_t
+disir_stats_percentile (const struct disir_stats_counter *counter, double percentile);
+
 //! \brief Log a USER level log entry to the disir log.
 //!
 DISIR_EXPORT
 void
 disir_log_user (struct disir_instance *instance, const char *message, ...);
 
+//! \brief Destination of the disir log, see disir_log_set_sink().
+//!
+//! \param data Opaque pointer given to disir_log_set_sink().
+//! \param line One complete log entry, timestamp and level included.
+//!     Not null terminated, and without a trailing newline.
+//! \param size Number of bytes in line.
+//!
+typedef void (*disir_log_sink) (void *data, const char *line, size_t size);
+
+//! \brief Send the disir log to sink instead of /var/log/disir.log.
+//!
+//! Log entries are queued by the thread logging them, and written out in batches
+//! by a background thread. The sink is therefore invoked from that thread, never
+//! concurrently with itself. Entries queued before this call are written to the
+//! previous destination. Passing a NULL sink restores the default log file.
+//!
+DISIR_EXPORT
+void
+disir_log_set_sink (disir_log_sink sink, void *data);
+
+//! \brief Write every queued log entry to the sink before returning.
+//!
+//! Queued entries are otherwise written shortly after they are logged,
+//! and at process exit.
+//!
+DISIR_EXPORT
+void
+disir_log_flush (void);
+
 //! \brief Set an error message to the disir instance.
 //!
 //! This will also issue a ERROR level log event to the log stream.
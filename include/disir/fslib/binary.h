@@ -0,0 +1,111 @@
+#ifndef _LIBDISIR_FSLIB_BINARY_H
+#define _LIBDISIR_FSLIB_BINARY_H
+
+#ifdef __cplusplus
+extern "C"{
+#endif // _cplusplus
+
+
+#include <disir/disir.h>
+#include <disir/plugin.h>
+#include <stdio.h>
+
+//! PLEASE NOTE:
+//! This file contains public libdisir methods and structures
+//! that is only indended for use by plugins.
+//! Any usage of these methods outside plugins may cause inconsistencies
+//! in the deployed configurations in a filesystem.
+
+
+//! \brief Binary implementation of config_read
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_config_read (struct disir_instance *instance,
+                        struct disir_register_plugin *plugin, const char *entry_id,
+                        struct disir_mold *mold, struct disir_config **config);
+
+//! \brief Binary implementation of config_write
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_config_write (struct disir_instance *instance,
+                         struct disir_register_plugin *plugin, const char *entry_id,
+                         struct disir_config *config);
+
+//! \brief Binary implementation of config_remove
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_config_remove (struct disir_instance *instance,
+                          struct disir_register_plugin *plugin, const char *entry_id);
+
+//! \brief Binary imlementation of config_entries
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_config_entries (struct disir_instance *instance,
+                           struct disir_register_plugin *plugin,
+                           struct disir_entry **entries);
+
+//! \brief Binary imlementation of config_query
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_config_query (struct disir_instance *instance,
+                         struct disir_register_plugin *plugin,
+                         const char *entry_id,
+                         struct disir_entry **entry);
+
+//! \brief Serialize config as a checksummed binary image.
+//!
+//! The image records the version of the config, the version of its mold and
+//! whether the config was valid when it was written. Each element is prefixed
+//! by its size, such that a reader may skip sections it does not decode.
+//! The image is only intended to be read back on a host of the same byte order.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_serialize_config (struct disir_instance *instance,
+                             struct disir_config *config, FILE *output);
+
+//! \brief Unserialize config from the binary image read from input.
+//!
+//! See dio_binary_unserialize_config_span().
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_unserialize_config (struct disir_instance *instance, FILE *input,
+                               struct disir_mold *mold, struct disir_config **config);
+
+//! \brief Unserialize config from the binary image in [data, data + size).
+//!
+//! If the config was valid when written, with a mold of the same version as mold,
+//! the config is not validated again. Its elements are then decoded lazily:
+//! a section or keyval is only constructed when it is first looked up, or when
+//! the elements of its parent are iterated. Decoding an element modifies the
+//! config, so a config read this way shall not be accessed from several threads
+//! at once without synchronization.
+//!
+//! Otherwise, every element is decoded up front and the config is validated,
+//! as with the other config formats.
+//!
+//! \return DISIR_STATUS_NO_CAN_DO if the image is of another format version or byte order.
+//! \return DISIR_STATUS_FS_ERROR if the image is malformed or fails its checksum.
+//! \return DISIR_STATUS_CONFLICTING_SEMVER if the config version is greater than
+//!     the version of mold.
+//! \return DISIR_STATUS_INVALID_CONTEXT if the config is not valid.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_binary_unserialize_config_span (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config);
+
+
+#ifdef __cplusplus
+}
+#endif // _cplusplus
+
+#endif // _LIBDISIR_FSLIB_BINARY_H
@@ -42,6 +42,8 @@ dio_json_config_remove (struct disir_instance *instance,
 
 //! \brief JSON implementation of config_write to filedescriptor
 //!
+//! The config is written in the compact layout, see dio_json_serialize_config_compact.
+//!
 DISIR_EXPORT
 enum disir_status
 dio_json_config_fd_write (struct disir_instance *instance,
@@ -111,12 +113,33 @@ enum disir_status
 dio_json_serialize_config (struct disir_instance *instance,
                            struct disir_config *config, FILE *output);
 
+//! \brief Serialize config as json without any whitespace between tokens.
+//!
+//! Intended for machine consumption. The document is written to the file
+//! descriptor of output in a single pass over the config, without
+//! building it in memory first.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_json_serialize_config_compact (struct disir_instance *instance,
+                                   struct disir_config *config, FILE *output);
+
 //! TODO: docs
 DISIR_EXPORT
 enum disir_status
 dio_json_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config);
 
+//! \brief Unserialize config from the json document in [data, data + size).
+//!
+//! The document is parsed directly from the buffer, without any stream in between.
+//!
+DISIR_EXPORT
+enum disir_status
+dio_json_unserialize_config_span (struct disir_instance *instance,
+                                  const char *data, size_t size,
+                                  struct disir_mold *mold, struct disir_config **config);
+
 //! TODO: docs
 DISIR_EXPORT
 enum disir_status
@@ -129,6 +152,12 @@ enum disir_status
 dio_json_unserialize_mold (struct disir_instance *instance,
                            FILE *input, struct disir_mold **mold);
 
+//! \brief Unserialize mold from the json document in [data, data + size).
+DISIR_EXPORT
+enum disir_status
+dio_json_unserialize_mold_span (struct disir_instance *instance,
+                                const char *data, size_t size, struct disir_mold **mold);
+
 //! TODO: docs
 DISIR_EXPORT
 enum disir_status
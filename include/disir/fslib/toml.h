@@ -62,6 +62,13 @@ enum disir_status
 dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config);
 
+//! \brief Unserialize config from the TOML document in [data, data + size).
+DISIR_EXPORT
+enum disir_status
+dio_toml_unserialize_config_span (struct disir_instance *instance,
+                                  const char *data, size_t size,
+                                  struct disir_mold *mold, struct disir_config **config);
+
 
 #ifdef __cplusplus
 }
@@ -33,6 +33,17 @@ typedef enum disir_status (*dio_unserialize_mold) (struct disir_instance *,
                                                    FILE *,
                                                    struct disir_mold **);
 
+//! Function signature for unserializing a config from the contiguous bytes [data, data + size)
+typedef enum disir_status (*dio_unserialize_config_span) (struct disir_instance *,
+                                                          const char *, size_t,
+                                                          struct disir_mold *,
+                                                          struct disir_config **);
+
+//! Function signature for unserializing a mold from the contiguous bytes [data, data + size)
+typedef enum disir_status (*dio_unserialize_mold_span) (struct disir_instance *,
+                                                        const char *, size_t,
+                                                        struct disir_mold **);
+
 
 //! Create the input path recursively
 //! Similar to shall command mkdir -p
@@ -105,6 +116,40 @@ fslib_mold_resolve_entry_filepath (struct disir_instance *instance, const char *
                              char *filepath, char *override_filepath, struct stat *statbuf,
                              int *namespace_entry);
 
+//! \brief Resolve the filepath of the compiled image of a mold entry.
+//!
+//! The image is named after entry_id, and after whether it is read from a namespace
+//! mold and an override entry, as resolved by fslib_mold_resolve_entry_id().
+//!
+//! \param[out] filepath Populate the output buffer with the complete, resolved filepath.
+//!     Buffer is required to be PATH_MAX sized.
+//!
+//! \return DISIR_STATUS_INSUFFICIENT_RESOURCES if the resolved path is too large.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_mold_compiled_filepath (struct disir_instance *instance,
+                              struct disir_register_plugin *plugin, const char *entry_id,
+                              const char *mold_filepath, const char *override_filepath,
+                              char *filepath);
+
+//! \brief Load the compiled image of a mold entry, if it is newer than its sources.
+//!
+//! mold_filepath, mold_statbuf and override_filepath are as resolved by
+//! fslib_mold_resolve_entry_id(). An image that cannot be loaded is ignored with a warning.
+//!
+//! \return DISIR_STATUS_NOT_EXIST if there is no image, or if it is older than
+//!     the mold or the override entry.
+//! \return status of disir_mold_load_compiled() otherwise.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_mold_read_compiled (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                          const char *entry_id,
+                          const char *mold_filepath, const struct stat *mold_statbuf,
+                          const char *override_filepath, struct disir_mold **mold);
+
 //! \brief Stat the filepath and return appropriate error (with message set)
 //!
 //! \return DISIR_STATUS_FS_ERROR if filepath contains a non-directory in path.
@@ -117,6 +162,43 @@ enum disir_status
 fslib_stat_filepath (struct disir_instance *instance,
                      const char *filepath, struct stat *statbuf);
 
+//! \brief Read the complete contents of filepath into a single buffer.
+//!
+//! The file is read with as few read(2) calls as its size allows, without any
+//! stdio or iostream buffering in between. The buffer is not memory mapped,
+//! since entries are rewritten in place and a mapping would fault if the
+//! entry is truncated while it is being parsed.
+//!
+//! \param[out] data Allocated buffer holding the contents, null-terminated.
+//!     The caller must free it.
+//! \param[out] size Number of bytes read, excluding the null terminator.
+//!
+//! \return DISIR_STATUS_FS_ERROR if filepath cannot be opened or read.
+//! \return DISIR_STATUS_NO_MEMORY if the buffer cannot be allocated.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_read_filepath (struct disir_instance *instance, const char *filepath,
+                     char **data, size_t *size);
+
+//! \brief Read what remains of input into a single buffer.
+//!
+//! Meant for streams without a file descriptor, such as memory streams,
+//! that cannot be handed to fslib_read_filepath().
+//!
+//! \param[out] data Allocated buffer holding the contents, null-terminated.
+//!     The caller must free it.
+//! \param[out] size Number of bytes read, excluding the null terminator.
+//!
+//! \return DISIR_STATUS_FS_ERROR if input cannot be read.
+//! \return DISIR_STATUS_NO_MEMORY if the buffer cannot be allocated.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_read_stream (struct disir_instance *instance, FILE *input, char **data, size_t *size);
+
 //! \brief Recursively query basedir for matching plugin entries.
 //!
 //! \return DISIR_STATUS_OK regardless of query operation
@@ -148,6 +230,36 @@ fslib_plugin_mold_read (struct disir_instance *instance,
                         struct disir_mold **mold,
                         dio_unserialize_mold func_unserialize);
 
+//! \brief Compile the mold entry into its image, as located by fslib_mold_compiled_filepath()
+//!
+//! The mold entry is read with the mold_read operation of the plugin.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_plugin_mold_compile (struct disir_instance *instance,
+                           struct disir_register_plugin *plugin,
+                           const char *entry_id);
+
+//! \brief Generic filesystem based implementation of config_read, from a single buffer
+//!
+//! The entry file is read with fslib_read_filepath and handed to func_unserialize
+//! as one contiguous span.
+//!
+DISIR_EXPORT
+enum disir_status
+fslib_plugin_config_read_span (struct disir_instance *instance,
+                               struct disir_register_plugin *plugin, const char *entry_id,
+                               struct disir_mold *mold, struct disir_config **config,
+                               dio_unserialize_config_span func_unserialize);
+
+//! \brief Generic filesystem based implementation of mold_read, from a single buffer
+DISIR_EXPORT
+enum disir_status
+fslib_plugin_mold_read_span (struct disir_instance *instance,
+                             struct disir_register_plugin *plugin, const char *entry_id,
+                             struct disir_mold **mold,
+                             dio_unserialize_mold_span func_unserialize);
+
 //! \brief Generic filesystem based implementation of config_write
 DISIR_EXPORT
 enum disir_status
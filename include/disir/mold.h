@@ -108,6 +108,56 @@ DISIR_EXPORT
 enum disir_status
 disir_mold_valid (struct disir_mold *mold, struct disir_collection **collection);
 
+//! \brief Compile the mold into an image at filepath, for disir_mold_load_compiled().
+//!
+//! The image holds the finalized mold in a relocatable form, which is loaded by
+//! mapping it into memory, without parsing or validating its contents.
+//! It is written to a temporary file that is renamed to filepath - an image
+//! in use is never modified.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either of the input arguments are NULL.
+//! \return DISIR_STATUS_INVALID_CONTEXT if mold is not valid. Only valid molds are compiled.
+//! \return DISIR_STATUS_FS_ERROR if the image cannot be written to filepath.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_compile (struct disir_instance *instance, struct disir_mold *mold,
+                    const char *filepath);
+
+//! \brief Load a mold compiled with disir_mold_compile().
+//!
+//! The image is mapped into memory, and the strings of the mold are referenced in place.
+//! The mapping is released when the last context of the mold is.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either of the input arguments are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if filepath does not exist.
+//! \return DISIR_STATUS_FS_ERROR if filepath cannot be opened or mapped.
+//! \return DISIR_STATUS_NO_CAN_DO if the image is of another format version or byte order.
+//! \return DISIR_STATUS_BAD_CONTEXT_OBJECT if filepath is not a well-formed image.
+//! \return DISIR_STATUS_OK on success.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_load_compiled (struct disir_instance *instance, const char *filepath,
+                          struct disir_mold **mold);
+
+//! \brief Compile the mold entry, such that disir_mold_read() loads it from its image.
+//!
+//! The image is placed next to the mold entry of the filesystem plugin holding it,
+//! and is only used by disir_mold_read() while it is newer than the mold
+//! and its override entry.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either `instance`, `group_id` or `entry_id` are NULL.
+//! \return DISIR_STATUS_NOT_EXIST if no plugin in group_id holds the mold entry.
+//! \return DISIR_STATUS_NO_CAN_DO if the plugin holding the entry is not filesystem based.
+//! \return status of reading or compiling the mold entry.
+//!
+DISIR_EXPORT
+enum disir_status
+disir_mold_compile_entry (struct disir_instance *instance, const char *group_id,
+                          const char *entry_id);
+
 //! \brief Mark yourself finished with the mold object.
 //!
 //! \\param[in,out] mold Object to mark as finished. Turns the pointer to NULL
@@ -0,0 +1,282 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <disir/disir.h>
+
+#include "arena.h"
+#include "context_private.h"
+#include "log.h"
+
+//! Size of each regular block allocated by the arena.
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+//! Allocations larger than this gets a block of their own,
+//! such that they do not waste the remainder of the current block.
+#define ARENA_LARGE_ALLOCATION (ARENA_BLOCK_SIZE / 4)
+
+//! Alignment of every allocation handed out by the arena.
+#define ARENA_ALIGNMENT (sizeof (max_align_t))
+
+//! Allocations released with dx_arena_release() up to this size are kept
+//! for reuse by later allocations of the same size.
+#define ARENA_REUSE_LIMIT 512
+#define ARENA_REUSE_CLASSES (ARENA_REUSE_LIMIT / ARENA_ALIGNMENT)
+
+//! Released allocation, linked into the reuse list of its size.
+struct arena_chunk
+{
+    struct arena_chunk      *ac_next;
+};
+
+struct arena_block
+{
+    //! Next block in the chain. The current block is always at the head.
+    struct arena_block      *ab_next;
+
+    //! Bytes available in ab_data.
+    size_t                  ab_capacity;
+
+    //! Bytes handed out from ab_data.
+    size_t                  ab_used;
+
+    //! Block memory follows the header.
+    max_align_t             ab_data[];
+};
+
+struct disir_arena
+{
+    //! Chain of blocks owned by this arena, current block first.
+    struct arena_block      *ar_blocks;
+
+    //! Total bytes handed out.
+    size_t                  ar_bytes;
+
+    //! Number of blocks in ar_blocks.
+    size_t                  ar_numblocks;
+
+    //! Number of contexts referencing this arena. Accessed atomically - contexts
+    //! of a frozen tree may be released from several threads.
+    int64_t                 ar_refcount;
+
+    //! Released allocations available for reuse, indexed by their size
+    //! in units of ARENA_ALIGNMENT, less one.
+    struct arena_chunk      *ar_reuse[ARENA_REUSE_CLASSES];
+
+    //! Memory mapping adopted by this arena, unmapped along with its blocks.
+    void                    *ar_mapping;
+    size_t                  ar_mapping_size;
+};
+
+//! STATIC API
+static struct arena_block *
+arena_block_create (size_t capacity)
+{
+    struct arena_block *block;
+
+    block = malloc (sizeof (struct arena_block) + capacity);
+    if (block == NULL)
+        return NULL;
+
+    block->ab_next = NULL;
+    block->ab_capacity = capacity;
+    block->ab_used = 0;
+
+    return block;
+}
+
+//! INTERNAL API
+struct disir_arena *
+dx_arena_create (void)
+{
+    struct disir_arena *arena;
+
+    arena = calloc (1, sizeof (struct disir_arena));
+    if (arena == NULL)
+        return NULL;
+
+    arena->ar_refcount = 1;
+
+    return arena;
+}
+
+//! INTERNAL API
+struct disir_arena *
+dx_arena_incref (struct disir_arena *arena)
+{
+    if (arena)
+        __atomic_add_fetch (&arena->ar_refcount, 1, __ATOMIC_RELAXED);
+
+    return arena;
+}
+
+//! INTERNAL API
+void
+dx_arena_decref (struct disir_arena **arena)
+{
+    struct arena_block *block;
+    struct arena_block *next;
+
+    if (arena == NULL || *arena == NULL)
+        return;
+
+    if (__atomic_sub_fetch (&(*arena)->ar_refcount, 1, __ATOMIC_ACQ_REL) > 0)
+    {
+        *arena = NULL;
+        return;
+    }
+
+    log_debug (6, "destroying arena %p (%zu bytes in %zu blocks)",
+               *arena, (*arena)->ar_bytes, (*arena)->ar_numblocks);
+
+    for (block = (*arena)->ar_blocks; block != NULL; block = next)
+    {
+        next = block->ab_next;
+        free (block);
+    }
+
+    if ((*arena)->ar_mapping)
+    {
+        munmap ((*arena)->ar_mapping, (*arena)->ar_mapping_size);
+    }
+
+    free (*arena);
+    *arena = NULL;
+}
+
+//! INTERNAL API
+void *
+dx_arena_calloc (struct disir_arena *arena, size_t size)
+{
+    struct arena_block *block;
+    void *memory;
+
+    if (arena == NULL)
+        return calloc (1, size);
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+    if (size <= ARENA_REUSE_LIMIT && arena->ar_reuse[size / ARENA_ALIGNMENT - 1])
+    {
+        memory = arena->ar_reuse[size / ARENA_ALIGNMENT - 1];
+        arena->ar_reuse[size / ARENA_ALIGNMENT - 1] = ((struct arena_chunk *) memory)->ac_next;
+        memset (memory, 0, size);
+        return memory;
+    }
+
+    if (size > ARENA_LARGE_ALLOCATION)
+    {
+        // Dedicated block. Insert behind the current block so it remains in use.
+        block = arena_block_create (size);
+        if (block == NULL)
+            return NULL;
+        block->ab_used = size;
+        if (arena->ar_blocks)
+        {
+            block->ab_next = arena->ar_blocks->ab_next;
+            arena->ar_blocks->ab_next = block;
+        }
+        else
+        {
+            arena->ar_blocks = block;
+        }
+        memory = block->ab_data;
+    }
+    else
+    {
+        block = arena->ar_blocks;
+        if (block == NULL || block->ab_capacity - block->ab_used < size)
+        {
+            block = arena_block_create (ARENA_BLOCK_SIZE);
+            if (block == NULL)
+                return NULL;
+            block->ab_next = arena->ar_blocks;
+            arena->ar_blocks = block;
+        }
+        memory = (char *) block->ab_data + block->ab_used;
+        block->ab_used += size;
+    }
+
+    // Blocks are malloc'ed, not calloc'ed - only zero what we hand out.
+    memset (memory, 0, size);
+
+    arena->ar_bytes += size;
+    if (memory == (void *) block->ab_data)
+        arena->ar_numblocks++;
+
+    return memory;
+}
+
+//! INTERNAL API
+void
+dx_arena_free (struct disir_arena *arena, void *memory)
+{
+    if (arena == NULL)
+        free (memory);
+}
+
+//! INTERNAL API
+void
+dx_arena_release (struct disir_arena *arena, void *memory, size_t size)
+{
+    struct arena_chunk *chunk;
+
+    if (arena == NULL)
+    {
+        free (memory);
+        return;
+    }
+    if (memory == NULL || size == 0)
+        return;
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (size > ARENA_REUSE_LIMIT)
+        return;
+
+    chunk = memory;
+    chunk->ac_next = arena->ar_reuse[size / ARENA_ALIGNMENT - 1];
+    arena->ar_reuse[size / ARENA_ALIGNMENT - 1] = chunk;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_arena_adopt_mapping (struct disir_arena *arena, void *address, size_t size)
+{
+    if (arena == NULL || address == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). arena (%p), address (%p)", arena, address);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (arena->ar_mapping)
+    {
+        log_debug (0, "arena %p already holds a mapping.", arena);
+        return DISIR_STATUS_EXISTS;
+    }
+
+    arena->ar_mapping = address;
+    arena->ar_mapping_size = size;
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_arena_usage (struct disir_arena *arena, size_t *bytes, size_t *blocks)
+{
+    if (bytes)
+        *bytes = (arena ? arena->ar_bytes : 0);
+    if (blocks)
+        *blocks = (arena ? arena->ar_numblocks : 0);
+}
+
+//! INTERNAL API
+struct disir_arena *
+dx_context_arena (struct disir_context *context)
+{
+    if (context == NULL)
+        return NULL;
+
+    return context->cx_arena;
+}
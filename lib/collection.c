@@ -129,6 +129,7 @@ dx_collection_coalesce (struct disir_collection *collection)
     int32_t probe;
     int32_t invalid_entries_count;
     int32_t iterator_moveback;
+    uint64_t generation;
 
     if (collection == NULL)
     {
@@ -136,6 +137,13 @@ dx_collection_coalesce (struct disir_collection *collection)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    // No context destroyed since last time - every entry is still valid.
+    generation = dx_context_destroy_generation ();
+    if (collection->cc_generation == generation)
+    {
+        return DISIR_STATUS_OK;
+    }
+
     context = NULL;
     index = 0;
     probe = 1;
@@ -190,6 +198,8 @@ dx_collection_coalesce (struct disir_collection *collection)
     if (collection->cc_iterator_index < 0)
         collection->cc_iterator_index = 0;
 
+    collection->cc_generation = generation;
+
     return DISIR_STATUS_OK;
 }
 
@@ -204,6 +214,7 @@ dc_collection_create (void)
         return NULL;
 
     collection->cc_capacity = 10;
+    collection->cc_generation = dx_context_destroy_generation ();
 
     collection->cc_collection = calloc (collection->cc_capacity, sizeof (struct disir_context *));
     if (collection->cc_collection == NULL)
@@ -277,7 +288,7 @@ dc_collection_push_context (struct disir_collection *collection, struct disir_co
     // Expand capacity if needed
     if (collection->cc_numentries == collection->cc_capacity)
     {
-        reallocated_capacity = collection->cc_capacity + 10;
+        reallocated_capacity = collection->cc_capacity * 2;
         reallocated_size = reallocated_capacity * sizeof (struct disir_context*);
         log_debug (8, "Reallocating collection to new size( %d )", reallocated_size);
         reallocated_collection = realloc (collection->cc_collection, reallocated_size);
@@ -294,6 +305,12 @@ dc_collection_push_context (struct disir_collection *collection, struct disir_co
     collection->cc_collection[collection->cc_numentries] = context;
     collection->cc_numentries++;
 
+    // An already destroyed context must be coalesced away.
+    if (context->CONTEXT_STATE_DESTROYED)
+    {
+        collection->cc_generation = 0;
+    }
+
     return DISIR_STATUS_OK;
 }
 
@@ -14,6 +14,7 @@
 #include "multimap.h"
 #include "restriction.h"
 #include "section.h"
+#include "stats.h"
 
 //! Forward declare
 static enum disir_status
@@ -358,30 +359,34 @@ compare_all_in_name (struct disir_context *lhs, struct disir_context *rhs, const
                      struct disir_diff_report *report)
 {
     enum disir_status status;
-    struct disir_collection *lhs_collection = NULL;
-    struct disir_collection *rhs_collection = NULL;
+    struct disir_element_iter lhs_iter;
+    struct disir_element_iter rhs_iter;
 
     struct disir_context *lhs_entry = NULL;
     struct disir_context *rhs_entry = NULL;
 
     log_debug (1, "Comparing %s (%p vs %p)", name, lhs, rhs);
 
-    status = dc_find_elements (lhs, name, &lhs_collection);
+    status = dc_element_iter_begin (lhs, name, &lhs_iter);
     if (status != DISIR_STATUS_OK)
     {
         // Something has really gone awry, since we queried the lhs for this name just
         // before entering this function..
         goto out;
     }
-    status = dc_find_elements (rhs, name, &rhs_collection);
+    status = dc_element_iter_begin (rhs, name, &rhs_iter);
     if (status != DISIR_STATUS_OK)
     {
-        if (status == DISIR_STATUS_NOT_EXIST)
-        {
-            log_debug (3, "rhs does not contain name entry: %s", name);
-            dx_diff_report_add (report, "%s not found in rhs.", dx_context_name (lhs));
-            status = DISIR_STATUS_OK;
-        }
+        goto out;
+    }
+
+    // Peek the first rhs entry - if there is none, the name is missing from rhs entirely.
+    status = dc_element_iter_next (&rhs_iter, &rhs_entry);
+    if (status == DISIR_STATUS_EXHAUSTED)
+    {
+        log_debug (3, "rhs does not contain name entry: %s", name);
+        dx_diff_report_add (report, "%s not found in rhs.", dx_context_name (lhs));
+        status = DISIR_STATUS_OK;
         goto out;
     }
 
@@ -390,33 +395,23 @@ compare_all_in_name (struct disir_context *lhs, struct disir_context *rhs, const
     // if RHS contains more entries, report it out of loop.
     do
     {
-        status = dc_collection_next (lhs_collection, &lhs_entry);
+        status = dc_element_iter_next (&lhs_iter, &lhs_entry);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
             break;
         }
-        if (status != DISIR_STATUS_OK)
-        {
-            log_debug (1, "lhs failed to retrieve collection context: %s",
-                          disir_status_string (status));
-            goto out;
-        }
 
-        // Get rhs
-        status = dc_collection_next (rhs_collection, &rhs_entry);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            status = DISIR_STATUS_OK;
-            dx_diff_report_add (report, "%s contains extra entry.", dx_context_name (lhs));
-            dc_putcontext (&lhs_entry);
-            continue;
-        }
-        if (status != DISIR_STATUS_OK)
+        // Get rhs - the first entry was already retrieved above.
+        if (rhs_entry == NULL)
         {
-            log_debug (1, "rhs failed to retrieve collection context: %s",
-                          disir_status_string (status));
-            goto out;
+            status = dc_element_iter_next (&rhs_iter, &rhs_entry);
+            if (status == DISIR_STATUS_EXHAUSTED)
+            {
+                status = DISIR_STATUS_OK;
+                dx_diff_report_add (report, "%s contains extra entry.", dx_context_name (lhs));
+                continue;
+            }
         }
 
         // Compare entries.
@@ -426,51 +421,20 @@ compare_all_in_name (struct disir_context *lhs, struct disir_context *rhs, const
             goto out;
         }
 
-        dc_putcontext (&lhs_entry);
-        dc_putcontext (&rhs_entry);
+        rhs_entry = NULL;
     } while (1);
 
-    do
+    // An rhs entry retrieved but not compared is missing from lhs, as is every remaining one.
+    while (rhs_entry != NULL || dc_element_iter_next (&rhs_iter, &rhs_entry) == DISIR_STATUS_OK)
     {
-        status = dc_collection_next (rhs_collection, &rhs_entry);
-        if (status == DISIR_STATUS_EXHAUSTED)
-        {
-            break;
-        }
-        if (status == DISIR_STATUS_OK)
-        {
-            // TODO: Report value - stringify?
-            dx_diff_report_add (report, "%s missing entry.", dx_context_name (lhs));
-
-            dc_putcontext (&rhs_entry);
-            continue;
-        }
-
-        dc_putcontext (&rhs_entry);
-        log_debug (1, "rhs collection next returned: %s", disir_status_string (status));
-        break;
-    } while (1);
-
+        // TODO: Report value - stringify?
+        dx_diff_report_add (report, "%s missing entry.", dx_context_name (lhs));
+        rhs_entry = NULL;
+    }
 
     status = DISIR_STATUS_OK;
     // FALL-THROUGH
 out:
-    if (lhs_entry)
-    {
-        dc_putcontext (&lhs_entry);
-    }
-    if (rhs_entry)
-    {
-        dc_putcontext (&rhs_entry);
-    }
-    if (lhs_collection)
-    {
-        dc_collection_finished (&lhs_collection);
-    }
-    if (rhs_collection)
-    {
-        dc_collection_finished (&rhs_collection);
-    }
     return status;
 }
 
@@ -484,15 +448,12 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
     // Element names already handled is marked in a map,
     // and are thus skipped if encountered again (this to compare multiple entries in config)
     enum disir_status status;
-    struct disir_collection *lhs_elements;
-    struct disir_collection *rhs_elements;
+    struct disir_element_iter iter;
     struct disir_context *element;
     const char *name;
     struct multimap *map;
 
     element = NULL;
-    lhs_elements = NULL;
-    rhs_elements = NULL;
     name = NULL;
 
     // Create a multimap
@@ -505,7 +466,7 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
         goto out;
     }
 
-    status = dc_get_elements (lhs, &lhs_elements);
+    status = dc_element_iter_begin (lhs, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         log_debug (1, "failed to get elements from lhs: %s", disir_status_string (status));
@@ -514,17 +475,12 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
 
     do
     {
-        status = dc_collection_next (lhs_elements, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
             break;
         }
-        if (status != DISIR_STATUS_OK)
-        {
-            log_debug (1, "Failed to get collection item: %s", disir_status_string (status));
-            break;
-        }
 
         log_debug (5, "Getting name for element: %p", element);
         // Get name
@@ -535,8 +491,6 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
             break;
         }
 
-        dc_putcontext (&element);
-
         // Entry already handled. Skip it.
         if (multimap_contains_key (map, name))
         {
@@ -559,7 +513,7 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
     // We need to iterate rhs to check if there resides any entries there
     // that is not part of map, e.g., not part of lhs.
 
-    status = dc_get_elements (rhs, &rhs_elements);
+    status = dc_element_iter_begin (rhs, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         // QUESTION: Could there be a valid scenario where rhs is empty?
@@ -569,17 +523,12 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
 
     do
     {
-        status = dc_collection_next (rhs_elements, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
             break;
         }
-        if (status != DISIR_STATUS_OK)
-        {
-            log_debug (1, "Failed to get collection item: %s", disir_status_string (status));
-            break;
-        }
 
         log_debug (5, "Getting name for element: %p", element);
         // Get name
@@ -590,8 +539,6 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
             break;
         }
 
-        dc_putcontext (&element);
-
         // Entry exists in lhs - skip it
         if (multimap_contains_key (map, name))
         {
@@ -607,19 +554,6 @@ compare_all_elements (struct disir_context *lhs, struct disir_context *rhs,
     {
         multimap_destroy (map, NULL, NULL);
     }
-    if (lhs_elements)
-    {
-        dc_collection_finished (&lhs_elements);
-    }
-    if (rhs_elements)
-    {
-        dc_collection_finished (&rhs_elements);
-    }
-
-    if (element)
-    {
-        dc_putcontext (&element);
-    }
 
     // FALL-THROUGH
 out:
@@ -797,6 +731,7 @@ dc_compare (struct disir_context *lhs, struct disir_context *rhs,
 {
     enum disir_status status;
     struct disir_diff_report *internal_report;
+    struct dx_stats_timer timer;
 
     if (lhs == NULL || rhs == NULL)
     {
@@ -811,7 +746,9 @@ dc_compare (struct disir_context *lhs, struct disir_context *rhs,
         return DISIR_STATUS_NO_MEMORY;
     }
 
+    dx_stats_begin (NULL, &timer);
     status = diff_compare_contexts_with_report (lhs, rhs, internal_report);
+    dx_stats_end (&timer, DISIR_STATS_COMPARE, status);
     if (status == DISIR_STATUS_OK && internal_report->dr_entries > 0)
     {
         status = DISIR_STATUS_CONFLICT;
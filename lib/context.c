@@ -11,6 +11,7 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "config.h"
 #include "section.h"
 #include "keyval.h"
@@ -165,6 +166,8 @@ context_remove_from_parent (struct disir_context **context)
     {
         log_debug(8, "Removing '%s' from parent storage", name);
         dx_element_storage_remove (storage, name, *context);
+        // The entry counts of parent changed.
+        dx_context_mark_dirty ((*context)->cx_parent_context);
     }
 }
 
@@ -184,6 +187,13 @@ dc_destroy (struct disir_context **context)
         return status;
     }
 
+    // Frozen snapshots are only released through disir_config_finished
+    status = CONTEXT_FROZEN_CHECK (*context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged.
+        return status;
+    }
 
     TRACE_ENTER ("%p", *context);
 
@@ -232,7 +242,7 @@ dc_destroy (struct disir_context **context)
     }
 
     // Set the context to destroyed
-    (*context)->CONTEXT_STATE_DESTROYED = 1;
+    dx_context_mark_destroyed (*context);
 
     // Decref the parent ref count attained in dx_context_attach
     // Guard against decrefing ourselves (top-level contexts)
@@ -270,6 +280,12 @@ dc_begin (struct disir_context *parent, enum disir_context_type context_type,
         log_debug (0, "invoked with child NULL pointer");
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
+    status = CONTEXT_FROZEN_CHECK (parent);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged.
+        return status;
+    }
 
     // Disallow top-level contexts
     if (dx_context_type_is_toplevel (context_type))
@@ -462,7 +478,15 @@ dc_putcontext (struct disir_context **context)
 
     TRACE_ENTER ("*context: %p", *context);
 
-    if ((*context)->cx_refcount == 1)
+    // References to frozen contexts are not counted.
+    if ((*context)->CONTEXT_STATE_FROZEN)
+    {
+        *context = NULL;
+        TRACE_EXIT ("");
+        return DISIR_STATUS_OK;
+    }
+
+    if (__atomic_load_n (&(*context)->cx_refcount, __ATOMIC_ACQUIRE) == 1)
     {
         log_debug_context (4, *context, "Input context only at 1 reference."
                                         " Destroying instead of reducing refcount.");
@@ -500,6 +524,48 @@ dc_context_valid (struct disir_context *context)
     return status;
 }
 
+//! PUBLIC API
+enum disir_status
+dc_enable_arena (struct disir_context *context)
+{
+    enum disir_status status;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+
+    status = CONTEXT_TYPE_CHECK (context, DISIR_CONTEXT_CONFIG, DISIR_CONTEXT_MOLD);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+
+    if (context->cx_arena)
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    // Each child holds a reference on its parent. Children begun before
+    // the arena is enabled would not share it.
+    if (context->cx_refcount != 1)
+    {
+        dx_log_context (context, "cannot enable arena on context with children or references.");
+        return DISIR_STATUS_CONTEXT_IN_WRONG_STATE;
+    }
+
+    context->cx_arena = dx_arena_create ();
+    if (context->cx_arena == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! PUBLIC API
 enum disir_status
 dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
@@ -528,6 +594,12 @@ dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
         // Already logged
         return status;
     }
+    status = CONTEXT_FROZEN_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
 
     // Find the name in the mold
     if (dc_context_type (context->cx_root_context) == DISIR_CONTEXT_CONFIG)
@@ -566,11 +638,13 @@ dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
 
     if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
     {
-        status = dx_value_set_string (&context->cx_keyval->kv_name, name, name_size);
+        status = dx_value_set_string_arena (dx_context_arena (context),
+                                            &context->cx_keyval->kv_name, name, name_size);
     }
     else if (dc_context_type (context) == DISIR_CONTEXT_SECTION)
     {
-        status = dx_value_set_string (&context->cx_section->se_name, name, name_size);
+        status = dx_value_set_string_arena (dx_context_arena (context),
+                                            &context->cx_section->se_name, name, name_size);
     }
     else
     {
@@ -580,6 +654,9 @@ dc_set_name (struct disir_context *context, const char *name, int32_t name_size)
 
     status = (status == DISIR_STATUS_OK ? invalid : status);
 
+    // A finalized context may now refer to another mold equivalent.
+    dx_context_mark_dirty (context);
+
     // TODO:  if context is not in constructing mode (it has been finalized once)
     // remove old name from parent storage and add it under the new name.
 
@@ -987,6 +1064,14 @@ dc_add_introduced (struct disir_context *context, struct disir_version *version)
     {
         introduced->sv_major = version->sv_major;
         introduced->sv_minor = version->sv_minor;
+        if (dc_context_type (context) == DISIR_CONTEXT_RESTRICTION)
+        {
+            dx_restriction_evaluator_invalidate (context);
+        }
+        else if (dc_context_type (context) == DISIR_CONTEXT_DEFAULT)
+        {
+            dx_version_index_destroy (&context->cx_parent_context->cx_keyval->kv_default_index);
+        }
 
         log_debug_context (6, context, "adding introduced to root(%s): %s",
                                        dc_context_type_string (context->cx_root_context),
@@ -1045,6 +1130,10 @@ dc_add_deprecated (struct disir_context *context, struct disir_version *version)
     {
         deprecated->sv_major = version->sv_major;
         deprecated->sv_minor = version->sv_minor;
+        if (dc_context_type (context) == DISIR_CONTEXT_RESTRICTION)
+        {
+            dx_restriction_evaluator_invalidate (context);
+        }
 
         log_debug_context (6, context, "adding deprecated to root(%s): %s",
                                        dc_context_type_string (context->cx_root_context),
@@ -1134,6 +1223,12 @@ dc_set_version (struct disir_context *context, struct disir_version *version)
         // Already logged ?
         return status;
     }
+    status = CONTEXT_FROZEN_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
 
     if (dc_context_type (context) == DISIR_CONTEXT_CONFIG)
     {
@@ -1438,3 +1533,59 @@ dc_find_elements (struct disir_context *context,
     return status;
 }
 
+//! PUBLIC API
+enum disir_status
+dc_element_iter_begin (struct disir_context *context, const char *name,
+                       struct disir_element_iter *iter)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+    if (iter == NULL)
+    {
+        log_debug (0, "invoked with NULL iter pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_MOLD:
+        storage = context->cx_mold->mo_elements;
+        break;
+    case DISIR_CONTEXT_CONFIG:
+        storage = context->cx_config->cf_elements;
+        break;
+    case DISIR_CONTEXT_SECTION:
+        storage = context->cx_section->se_elements;
+        break;
+    default:
+    {
+        dx_log_context (context, "cannot iterate elements of %s.",
+                                 dc_context_type_string (context));
+        return DISIR_STATUS_WRONG_CONTEXT;
+    }
+    }
+
+    dx_element_storage_iter_begin (storage, name, iter);
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+dc_element_iter_next (struct disir_element_iter *iter, struct disir_context **context)
+{
+    if (iter == NULL || context == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (iter: %p, context: %p)", iter, context);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    return dx_element_storage_iter_next (iter, context);
+}
+
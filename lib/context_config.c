@@ -13,6 +13,7 @@
 #include "mqueue.h"
 #include "log.h"
 #include "element_storage.h"
+#include "stats.h"
 
 //! PUBLIC API
 struct disir_context *
@@ -67,7 +68,7 @@ dc_config_begin (struct disir_mold *mold, struct disir_context **config)
 
     // Set associated mold
     context->cx_config->cf_mold = mold;
-    mold->mo_reference_count++;
+    dx_mold_incref (mold);
 
     // Set root context to self (such that children can inherit)
     context->cx_root_context = context;
@@ -81,6 +82,7 @@ enum disir_status
 dc_config_finalize (struct disir_context **context, struct disir_config **config)
 {
     enum disir_status status;
+    struct dx_stats_timer timer;
 
     TRACE_ENTER ("context: %p, config: %p", context, config);
 
@@ -104,7 +106,9 @@ dc_config_finalize (struct disir_context **context, struct disir_config **config
     }
 
     // Perform full config validation.
+    dx_stats_begin (NULL, &timer);
     status = dx_validate_context (*context);
+    dx_stats_end (&timer, DISIR_STATS_VALIDATE, status);
     // Only set state if the validate operation went as planned
     if (status == DISIR_STATUS_OK || status == DISIR_STATUS_INVALID_CONTEXT)
     {
@@ -127,6 +131,28 @@ dc_config_finalize (struct disir_context **context, struct disir_config **config
     return status;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_config_finalize_trusted (struct disir_context **context, struct disir_config **config)
+{
+    if (context == NULL || *context == NULL || config == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). context (%p), config (%p)", context, config);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (dx_context_type_sanify ((*context)->cx_type) != DISIR_CONTEXT_CONFIG)
+    {
+        return DISIR_STATUS_WRONG_CONTEXT;
+    }
+
+    *config = (*context)->cx_config;
+    (*context)->CONTEXT_STATE_FINALIZED = 1;
+    (*context)->CONTEXT_STATE_CONSTRUCTING = 0;
+    *context = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 struct disir_config *
 dx_config_create (struct disir_context *context)
@@ -139,7 +165,7 @@ dx_config_create (struct disir_context *context)
         goto error;
     }
 
-    config->cf_elements = dx_element_storage_create ();
+    config->cf_elements = dx_element_storage_create (&context->cx_elements_generation);
     if (config->cf_elements == NULL)
     {
         goto error;
@@ -176,6 +202,9 @@ dx_config_destroy (struct disir_config **config)
     // Remove our reference to the mold
     disir_mold_finished (&(*config)->cf_mold);
 
+    // Deferred elements are not constructed only to be destroyed.
+    dx_element_storage_set_loader ((*config)->cf_elements, NULL, NULL);
+
     // Destroy all element_storage children
     status = dx_element_storage_get_all ((*config)->cf_elements, &collection);
     if (status == DISIR_STATUS_OK)
@@ -230,7 +259,7 @@ disir_config_get_mold (struct disir_config *config, struct disir_mold **mold)
     }
 
     *mold = config->cf_mold;
-    (*mold)->mo_reference_count++;
+    dx_mold_incref (*mold);
 
     return DISIR_STATUS_OK;
 }
@@ -14,6 +14,7 @@
 #include "keyval.h"
 #include "default.h"
 #include "context_private.h"
+#include "arena.h"
 #include "collection.h"
 
 
@@ -65,6 +66,8 @@ dx_default_begin (struct disir_context *parent, struct disir_context **def)
     }
     log_debug_context (8, parent, "created context: %p", context);
 
+    context->cx_arena = dx_arena_incref (dx_context_arena (parent));
+
     context->cx_default = dx_default_create (context);
     if (context->cx_default == NULL)
     {
@@ -108,6 +111,7 @@ dx_default_finalize (struct disir_context *default_context)
     default_context->CONTEXT_STATE_IN_PARENT = 1;
     MQ_ENQUEUE_CONDITIONAL (*queue, def,
         (dc_version_compare (&entry->de_introduced, &def->de_introduced) > 0));
+    dx_version_index_destroy (&default_context->cx_parent_context->cx_keyval->kv_default_index);
 
     return dx_validate_context (default_context);
 }
@@ -118,7 +122,7 @@ dx_default_create (struct disir_context *context)
 {
     struct disir_default *def;
 
-    def = calloc ( 1, sizeof (struct disir_default));
+    def = dx_arena_calloc (dx_context_arena (context), sizeof (struct disir_default));
     if (def == NULL)
     {
         return NULL;
@@ -148,10 +152,16 @@ dx_default_destroy (struct disir_default **def)
     if (tmp->de_value.dv_type == DISIR_VALUE_TYPE_STRING ||
         tmp->de_value.dv_size > 0)
     {
-        free (tmp->de_value.dv_string);
+        dx_value_free_string (&tmp->de_value);
     }
 
     context = tmp->de_context;
+    if (context && context->cx_parent_context
+        && context->cx_parent_context->CONTEXT_STATE_DESTROYED == 0
+        && dc_context_type (context->cx_parent_context) == DISIR_CONTEXT_KEYVAL)
+    {
+        dx_version_index_destroy (&context->cx_parent_context->cx_keyval->kv_default_index);
+    }
     if (context && context->cx_parent_context)
     {
         // Don't access parent context type if context is destoyed
@@ -171,7 +181,7 @@ dx_default_destroy (struct disir_default **def)
         }
     }
 
-    free (tmp);
+    dx_arena_free (dx_context_arena (tmp->de_context), tmp);
     *def = NULL;
 
     return DISIR_STATUS_OK;;
@@ -620,6 +630,10 @@ dx_default_get_active (struct disir_context *keyval, struct disir_version *versi
         // We cant really do anything - everything is empty.
         current = NULL;
     }
+    else if (keyval->cx_keyval->kv_default_index)
+    {
+        current = dx_version_index_lookup (keyval->cx_keyval->kv_default_index, version);
+    }
     else if (version)
     {
         current = MQ_FIND (keyval->cx_keyval->kv_default_queue,
@@ -641,3 +655,37 @@ dx_default_get_active (struct disir_context *keyval, struct disir_version *versi
     *def = current;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_default_index_build (struct disir_context *keyval)
+{
+    struct disir_version_index *index;
+    struct disir_default *def;
+    int32_t i;
+
+    dx_version_index_destroy (&keyval->cx_keyval->kv_default_index);
+
+    def = keyval->cx_keyval->kv_default_queue;
+    if (def == NULL)
+        return DISIR_STATUS_OK;
+
+    // Introduced versions modified after enqueue may leave the queue unsorted.
+    for (; def->next != NULL; def = def->next)
+    {
+        if (dc_version_compare (&def->de_introduced, &def->next->de_introduced) > 0)
+            return DISIR_STATUS_OK;
+    }
+
+    index = dx_version_index_create (MQ_SIZE (keyval->cx_keyval->kv_default_queue));
+    if (index == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+
+    i = 0;
+    for (def = keyval->cx_keyval->kv_default_queue; def != NULL; def = def->next)
+    {
+        dx_version_index_set (index, i++, &def->de_introduced, def);
+    }
+
+    keyval->cx_keyval->kv_default_index = index;
+    return DISIR_STATUS_OK;
+}
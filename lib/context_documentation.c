@@ -12,6 +12,7 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "config.h"
 #include "mold.h"
 #include "keyval.h"
@@ -330,6 +331,8 @@ dx_documentation_begin (struct disir_context *parent, struct disir_context **doc
 
     log_debug_context (8, parent, "created context: %p", context);
 
+    context->cx_arena = dx_arena_incref (dx_context_arena (parent));
+
     context->cx_documentation = dx_documentation_create(context);
     if (context->cx_documentation == NULL)
     {
@@ -368,7 +371,7 @@ dx_documentation_create (struct disir_context *context)
 {
     struct disir_documentation *doc;
 
-    doc = calloc(1, sizeof (struct disir_documentation));
+    doc = dx_arena_calloc (dx_context_arena (context), sizeof (struct disir_documentation));
     if (doc == NULL)
         return NULL;
 
@@ -392,8 +395,7 @@ dx_documentation_destroy (struct disir_documentation **documentation)
     tmp = *documentation;
     queue = NULL;
 
-    if (tmp->dd_value.dv_size > 0)
-        free(tmp->dd_value.dv_string);
+    dx_value_free_string (&tmp->dd_value);
 
     context = (*documentation)->dd_context;
     if (context && context->cx_parent_context)
@@ -438,7 +440,7 @@ dx_documentation_destroy (struct disir_documentation **documentation)
         }
     }
 
-    free(tmp);
+    dx_arena_free (dx_context_arena (tmp->dd_context), tmp);
     *documentation = NULL;
     return DISIR_STATUS_OK;
 }
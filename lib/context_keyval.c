@@ -9,6 +9,7 @@
 
 // private
 #include "context_private.h"
+#include "arena.h"
 #include "keyval.h"
 #include "config.h"
 #include "mold.h"
@@ -55,6 +56,8 @@ dx_keyval_begin (struct disir_context *parent, struct disir_context **keyval)
         return DISIR_STATUS_NO_MEMORY;
     }
 
+    context->cx_arena = dx_arena_incref (dx_context_arena (parent));
+
     context->cx_keyval = dx_keyval_create (context);
     if (context->cx_keyval == NULL)
     {
@@ -136,6 +139,7 @@ dx_keyval_finalize (struct disir_context *keyval)
         else
         {
             keyval->CONTEXT_STATE_IN_PARENT = 1;
+            dx_context_mark_dirty (keyval->cx_parent_context);
         }
     }
 
@@ -360,7 +364,7 @@ dx_keyval_create (struct disir_context *parent)
 {
     struct disir_keyval *keyval;
 
-    keyval = calloc(1, sizeof (struct disir_keyval));
+    keyval = dx_arena_calloc (dx_context_arena (parent), sizeof (struct disir_keyval));
     if (keyval == NULL)
         return NULL;
 
@@ -386,17 +390,14 @@ dx_keyval_destroy (struct disir_keyval **keyval)
     }
 
     // Free allocated name
-    if ((*keyval)->kv_name.dv_size != 0)
-    {
-        free ((*keyval)->kv_name.dv_string);
-    }
+    dx_value_free_string (&(*keyval)->kv_name);
 
     // Free allocated value, if string or enum
     if (((*keyval)->kv_value.dv_type == DISIR_VALUE_TYPE_STRING
         || (*keyval)->kv_value.dv_type == DISIR_VALUE_TYPE_ENUM)
            && (*keyval)->kv_value.dv_size != 0)
     {
-        free ((*keyval)->kv_value.dv_string);
+        dx_value_free_string (&(*keyval)->kv_value);
     }
 
     // Decref mold_equiv if set
@@ -415,12 +416,15 @@ dx_keyval_destroy (struct disir_keyval **keyval)
     }
 
     // Destroy all default entries on the keyval.
+    dx_version_index_destroy (&(*keyval)->kv_default_index);
     while ((def = MQ_POP((*keyval)->kv_default_queue)))
     {
         context = def->de_context;
         dc_destroy (&context);
     }
 
+    dx_restriction_evaluator_destroy (&(*keyval)->kv_restriction_evaluator);
+
     // Destroy all restrictions
     while ((restriction = MQ_POP ((*keyval)->kv_restrictions_queue)))
     {
@@ -428,7 +432,7 @@ dx_keyval_destroy (struct disir_keyval **keyval)
         dc_destroy (&context);
     }
 
-    free (*keyval);
+    dx_arena_free (dx_context_arena ((*keyval)->kv_context), *keyval);
     *keyval = NULL;
     return DISIR_STATUS_OK;
 }
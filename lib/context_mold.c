@@ -8,12 +8,59 @@
 
 // private
 #include "context_private.h"
+#include "collection.h"
+#include "element_storage.h"
 #include "mold.h"
 #include "documentation.h"
+#include "keyval.h"
 #include "mqueue.h"
 #include "log.h"
+#include "restriction.h"
+#include "section.h"
+#include "stats.h"
 
 
+//! STATIC API
+//! Compile the restriction evaluators and default indexes of every keyval in the
+//! mold tree rooted at context, such that lookups by version need not walk their queues.
+static enum disir_status
+mold_compile_lookups (struct disir_context *context)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct disir_element_iter iter;
+    struct disir_context *element;
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_MOLD:
+        storage = context->cx_mold->mo_elements;
+        break;
+    case DISIR_CONTEXT_SECTION:
+        storage = context->cx_section->se_elements;
+        break;
+    case DISIR_CONTEXT_KEYVAL:
+        status = dx_default_index_build (context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        dx_restriction_evaluator_destroy (&context->cx_keyval->kv_restriction_evaluator);
+        return dx_restriction_evaluator_compile (context,
+                                                 &context->cx_keyval->kv_restriction_evaluator);
+    default:
+        return DISIR_STATUS_OK;
+    }
+
+    status = DISIR_STATUS_OK;
+    dx_element_storage_iter_begin (storage, NULL, &iter);
+    while (status == DISIR_STATUS_OK
+           && dx_element_storage_iter_next (&iter, &element) == DISIR_STATUS_OK)
+    {
+        status = mold_compile_lookups (element);
+    }
+
+    return status;
+}
+
 //! PUBLIC API
 struct disir_context *
 dc_mold_getcontext (struct disir_mold *mold)
@@ -68,6 +115,7 @@ enum disir_status
 dc_mold_finalize (struct disir_context **context, struct disir_mold **mold)
 {
     enum disir_status status;
+    struct dx_stats_timer timer;
 
     TRACE_ENTER ("context: %p, mold: %p", context, mold);
 
@@ -91,10 +139,18 @@ dc_mold_finalize (struct disir_context **context, struct disir_mold **mold)
     }
 
     // Perform full mold validation.
+    dx_stats_begin (NULL, &timer);
     status = dx_validate_context (*context);
+    dx_stats_end (&timer, DISIR_STATS_VALIDATE, status);
     // Only set state if the validate operation went as planned
     if (status == DISIR_STATUS_OK || status == DISIR_STATUS_INVALID_CONTEXT)
     {
+        // Not fatal - lookups fall back to the queues of contexts missing an index.
+        if (mold_compile_lookups (*context) != DISIR_STATUS_OK)
+        {
+            log_warn ("failed to compile lookup indexes for mold.");
+        }
+
         *mold = (*context)->cx_mold;
         (*context)->CONTEXT_STATE_FINALIZED = 1;
         (*context)->CONTEXT_STATE_CONSTRUCTING = 0;
@@ -114,6 +170,40 @@ dc_mold_finalize (struct disir_context **context, struct disir_mold **mold)
     return status;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_mold_finalize_trusted (struct disir_context **context, struct disir_mold **mold)
+{
+    if (context == NULL || *context == NULL || mold == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). context (%p), mold (%p)", context, mold);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (dx_context_type_sanify ((*context)->cx_type) != DISIR_CONTEXT_MOLD)
+    {
+        return DISIR_STATUS_WRONG_CONTEXT;
+    }
+
+    if (mold_compile_lookups (*context) != DISIR_STATUS_OK)
+    {
+        log_warn ("failed to compile lookup indexes for mold.");
+    }
+
+    *mold = (*context)->cx_mold;
+    (*context)->CONTEXT_STATE_FINALIZED = 1;
+    (*context)->CONTEXT_STATE_CONSTRUCTING = 0;
+    *context = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
+
+//! INTERNAL API
+void
+dx_mold_incref (struct disir_mold *mold)
+{
+    __atomic_add_fetch (&mold->mo_reference_count, 1, __ATOMIC_RELAXED);
+}
 
 //! INTERNAL API
 struct disir_mold *
@@ -129,7 +219,7 @@ dx_mold_create (struct disir_context *context)
 
     mold->mo_reference_count = 1;
     mold->mo_context = context;
-    mold->mo_elements = dx_element_storage_create ();
+    mold->mo_elements = dx_element_storage_create (&context->cx_elements_generation);
     if (mold->mo_elements == NULL)
     {
         goto error;
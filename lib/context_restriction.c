@@ -10,6 +10,7 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "restriction.h"
 #include "log.h"
 #include "mqueue.h"
@@ -144,6 +145,8 @@ dx_restriction_begin (struct disir_context *parent, struct disir_context **restr
     }
     log_debug_context (8, parent, "created context: %p", context);
 
+    context->cx_arena = dx_arena_incref (dx_context_arena (parent));
+
     context->cx_restriction = dx_restriction_create (context);
     if (context->cx_restriction == NULL)
     {
@@ -189,6 +192,7 @@ dx_restriction_finalize (struct disir_context *context)
         // Enqueue
         MQ_ENQUEUE (*queue, context->cx_restriction);
         context->CONTEXT_STATE_IN_PARENT = 1;
+        dx_restriction_evaluator_invalidate (context);
     }
     else
     {
@@ -211,7 +215,8 @@ dx_restriction_create (struct disir_context *context)
 {
     struct disir_restriction *restriction;
 
-    restriction = calloc ( 1, sizeof (struct disir_restriction));
+    restriction = dx_arena_calloc (dx_context_arena (context),
+                                   sizeof (struct disir_restriction));
     if (restriction == NULL)
     {
         return NULL;
@@ -237,6 +242,14 @@ dx_restriction_destroy (struct disir_restriction **restriction)
     queue = NULL;
 
     tmp = *restriction;
+
+    // The evaluator of a keyval refers to the enum values of its restrictions.
+    if (tmp->re_context && tmp->re_context->cx_parent_context
+        && tmp->re_context->cx_parent_context->CONTEXT_STATE_DESTROYED == 0)
+    {
+        dx_restriction_evaluator_invalidate (tmp->re_context);
+    }
+
     if (tmp->re_value_string)
     {
         free (tmp->re_value_string);
@@ -276,7 +289,7 @@ dx_restriction_destroy (struct disir_restriction **restriction)
         dc_destroy (&context);
     }
 
-    free (tmp);
+    dx_arena_free (dx_context_arena (tmp->re_context), tmp);
     *restriction = NULL;
 
     return DISIR_STATUS_OK;
@@ -411,6 +424,7 @@ dc_set_restriction_type (struct disir_context *context, enum disir_restriction_t
     }
 
     // Parent is valid entry to set type to.
+    dx_restriction_evaluator_invalidate (context);
     context->cx_restriction->re_type = type;
 
     return DISIR_STATUS_OK;
@@ -486,6 +500,7 @@ dc_restriction_set_string (struct disir_context *context, const char *value)
     {
     case DISIR_RESTRICTION_EXC_VALUE_ENUM:
     {
+        dx_restriction_evaluator_invalidate (context);
         if (context->cx_restriction->re_value_string)
         {
             free (context->cx_restriction->re_value_string);
@@ -526,6 +541,7 @@ dc_restriction_set_range (struct disir_context *context, double min, double max)
     {
     case DISIR_RESTRICTION_EXC_VALUE_RANGE:
     {
+        dx_restriction_evaluator_invalidate (context);
         // Store restriction value based on keyval type (integer vs float)
         if (dc_value_type (context->cx_parent_context) == DISIR_VALUE_TYPE_INTEGER)
         {
@@ -625,6 +641,7 @@ dc_restriction_set_numeric (struct disir_context *context, double value)
     {
     case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
     {
+        dx_restriction_evaluator_invalidate (context);
         context->cx_restriction->re_value_numeric = value;
         break;
     }
@@ -1025,7 +1042,9 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
 {
     enum disir_status status;
     struct disir_restriction **queue;
+    struct disir_restriction_evaluator *evaluator;
     struct disir_version *config_version;
+    int fulfilled;
     int exclusive_fulfilled = 0;
     int restriction_entries_inactive = 0;
     double value;
@@ -1070,6 +1089,29 @@ dx_restriction_exclusive_value_check (struct disir_context *context, int64_t int
     queue = &context->cx_keyval->kv_mold_equiv->cx_keyval->kv_restrictions_queue;
     config_version = &context->cx_root_context->cx_config->cf_version;
 
+    // Look up the value in the evaluator compiled for the mold keyval, if any.
+    // Only a violation walks the restriction queue, to report the allowed values.
+    evaluator = context->cx_keyval->kv_mold_equiv->cx_keyval->kv_restriction_evaluator;
+    if (evaluator && dc_value_type (context) == DISIR_VALUE_TYPE_ENUM)
+    {
+        // An enum without any active restriction has no legal value.
+        fulfilled = dx_restriction_evaluator_check (evaluator, config_version, 0, string_value);
+        if (fulfilled == 1)
+        {
+            TRACE_EXIT ("status (%s", disir_status_string (status));
+            return status;
+        }
+    }
+    else if (evaluator)
+    {
+        fulfilled = dx_restriction_evaluator_check (evaluator, config_version, value, NULL);
+        if (fulfilled != -1)
+        {
+            TRACE_EXIT ("status (%s", disir_status_string (status));
+            return status;
+        }
+    }
+
     MQ_FOREACH (*queue,
     {
         if (entry->re_type == DISIR_RESTRICTION_INC_ENTRY_MIN ||
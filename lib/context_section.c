@@ -9,6 +9,7 @@
 
 // private
 #include "context_private.h"
+#include "arena.h"
 #include "section.h"
 #include "config.h"
 #include "mold.h"
@@ -51,6 +52,9 @@ dx_section_begin (struct disir_context *parent, struct disir_context **section)
         return DISIR_STATUS_NO_MEMORY;
     }
 
+    context->cx_arena = dx_arena_incref (dx_context_arena (parent));
+    context->cx_root_context = parent->cx_root_context;
+
     context->cx_section = dx_section_create (context);
     if (context->cx_section == NULL)
     {
@@ -135,6 +139,7 @@ dx_section_finalize (struct disir_context *section)
         else
         {
             section->CONTEXT_STATE_IN_PARENT = 1;
+            dx_context_mark_dirty (section->cx_parent_context);
         }
     }
 
@@ -147,14 +152,15 @@ dx_section_create (struct disir_context *self)
 {
     struct disir_section *section;
 
-    section = calloc(1, sizeof (struct disir_section));
+    section = dx_arena_calloc (dx_context_arena (self), sizeof (struct disir_section));
     if (section == NULL)
         return NULL;
 
     section->se_introduced.sv_major = 1;
     section->se_name.dv_type = DISIR_VALUE_TYPE_STRING;
     section->se_context = self;
-    section->se_elements = dx_element_storage_create ();
+    section->se_elements =
+        dx_element_storage_create (&self->cx_root_context->cx_elements_generation);
     if (section->se_elements == NULL)
     {
         goto error;
@@ -168,7 +174,7 @@ error:
     }
     if (section)
     {
-        free (section);
+        dx_arena_free (dx_context_arena (self), section);
     }
     return NULL;
 }
@@ -189,10 +195,7 @@ dx_section_destroy (struct disir_section **section)
     }
 
     // Free allocated name
-    if ((*section)->se_name.dv_size != 0)
-    {
-        free ((*section)->se_name.dv_string);
-    }
+    dx_value_free_string (&(*section)->se_name);
 
     // Decref mold_equiv if set
     if ((*section)->se_mold_equiv)
@@ -208,6 +211,9 @@ dx_section_destroy (struct disir_section **section)
         dc_destroy (&context);
     }
 
+    // Deferred elements are not constructed only to be destroyed.
+    dx_element_storage_set_loader ((*section)->se_elements, NULL, NULL);
+
     // Destroy all element_storage children
     status = dx_element_storage_get_all ((*section)->se_elements, &collection);
     if (status == DISIR_STATUS_OK)
@@ -234,7 +240,7 @@ dx_section_destroy (struct disir_section **section)
         dc_destroy (&context);
     }
 
-    free (*section);
+    dx_arena_free (dx_context_arena ((*section)->se_context), *section);
     *section = NULL;
 
     return DISIR_STATUS_OK;
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 
 // Public disir interface
 #include <disir/disir.h>
@@ -9,8 +10,10 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "log.h"
 #include "keyval.h"
+#include "stats.h"
 
 //! Array  of string representations corresponding to the
 //! disir_context_type enumeration value.
@@ -149,19 +152,87 @@ dx_context_attach (struct disir_context *parent, struct disir_context *context)
     dx_context_incref (parent);
 }
 
+//! INTERNAL API
+void
+dx_context_mark_dirty (struct disir_context *context)
+{
+    struct disir_context *parent;
+
+    if (context->CONTEXT_STATE_FINALIZED == 0)
+        return;
+
+    context->CONTEXT_STATE_DIRTY = 1;
+
+    // Ancestors of a context with dirty elements are already marked.
+    for (parent = context->cx_parent_context;
+         parent != NULL && parent != context && parent->CONTEXT_STATE_DIRTY_ELEMENTS == 0;
+         parent = parent->cx_parent_context)
+    {
+        parent->CONTEXT_STATE_DIRTY_ELEMENTS = 1;
+    }
+}
+
+//! Source of the generations of every tree. See dx_context_generation_bump().
+static _Atomic uint64_t context_generation_sequence = 1;
+
+//! INTERNAL API
+void
+dx_context_generation_bump (uint64_t *generation)
+{
+    uint64_t next;
+
+    next = atomic_fetch_add_explicit (&context_generation_sequence, 1, memory_order_relaxed) + 1;
+    __atomic_store_n (generation, next, __ATOMIC_RELEASE);
+}
+
+//! INTERNAL API
+uint64_t
+dx_context_elements_generation (struct disir_context *context)
+{
+    return __atomic_load_n (&context->cx_root_context->cx_elements_generation,
+                            __ATOMIC_ACQUIRE);
+}
+
+//! Bumped every time a context is marked destroyed.
+//! Atomic, since contexts may be destroyed in other threads, e.g., by disir_config_watch().
+static _Atomic uint64_t context_destroy_generation = 1;
+
+//! INTERNAL API
+void
+dx_context_mark_destroyed (struct disir_context *context)
+{
+    context->CONTEXT_STATE_DESTROYED = 1;
+    atomic_fetch_add_explicit (&context_destroy_generation, 1, memory_order_release);
+}
+
+//! INTERNAL API
+uint64_t
+dx_context_destroy_generation (void)
+{
+    return atomic_load_explicit (&context_destroy_generation, memory_order_acquire);
+}
+
 //! INTERNAL API
 void
 dx_context_incref (struct disir_context *context)
 {
-    context->cx_refcount++;
-    log_debug_context (9, context,
-                       "(%p) increased refcount to: %d", context, context->cx_refcount);
+    int64_t refcount;
+
+    // Frozen contexts are shared read-only between threads - refcounting is elided.
+    if (context->CONTEXT_STATE_FROZEN)
+        return;
+
+    // Log arguments are not evaluated for disabled entries - never increment within them.
+    refcount = __atomic_add_fetch (&context->cx_refcount, 1, __ATOMIC_RELAXED);
+    log_debug_context (9, context, "(%p) increased refcount to: %ld", context, refcount);
 }
 
 //! INTERNAL API
 void
 dx_context_decref (struct disir_context **context)
 {
+    int64_t refcount;
+
     if (context == NULL)
         return;
     if (*context == NULL)
@@ -170,16 +241,17 @@ dx_context_decref (struct disir_context **context)
         return;
     }
 
-    (*context)->cx_refcount--;
+    if ((*context)->CONTEXT_STATE_FROZEN)
+        return;
 
-    if ((*context)->cx_refcount == 0)
+    refcount = __atomic_sub_fetch (&(*context)->cx_refcount, 1, __ATOMIC_ACQ_REL);
+    if (refcount == 0)
     {
         dx_context_destroy (context);
     }
     else
     {
-        log_debug_context (9, *context, "(%p) reduced refcount to: %d",
-                           *context, (*context)->cx_refcount);
+        log_debug_context (9, *context, "(%p) reduced refcount to: %ld", *context, refcount);
     }
 }
 
@@ -204,6 +276,7 @@ dx_context_create (enum disir_context_type type)
         return NULL;
 
     context->cx_type = type;
+    dx_stats_contexts_allocated++;
 
     // Set default context state to CONSTRUCTING
     context->CONTEXT_STATE_CONSTRUCTING = 1;
@@ -229,6 +302,8 @@ dx_context_destroy  (struct disir_context **context)
 
     log_debug_context (9, *context, " (%p) reached refcount zero. Freeing.", *context);
 
+    dx_arena_decref (&(*context)->cx_arena);
+
     free(*context);
     *context = NULL;
 }
@@ -255,6 +330,10 @@ dx_context_transfer_logwarn (struct disir_context *destination, struct disir_con
     if (source == destination)
         return;
 
+    // Frozen contexts are never modified
+    if (destination->CONTEXT_STATE_FROZEN || source->CONTEXT_STATE_FROZEN)
+        return;
+
     // Remove existing error message at destination
     if (destination->cx_error_message)
     {
@@ -310,6 +389,20 @@ dx_context_dp_full_check_log_error (struct disir_context **context, const char *
     return dx_context_sp_full_check_log_error (*context, function_name);
 }
 
+//! INTERNAL API
+enum disir_status
+dx_context_frozen_check_log_error (struct disir_context *context, const char *function_name)
+{
+    if (context->CONTEXT_STATE_FROZEN)
+    {
+        log_debug (0, "%s() invoked on frozen context %s",
+                   function_name, dc_context_type_string (context));
+        return DISIR_STATUS_CONTEXT_IN_WRONG_STATE;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 
 
 //! INTERNAL API
@@ -11,6 +11,7 @@
 
 // Private
 #include "context_private.h"
+#include "arena.h"
 #include "config.h"
 #include "section.h"
 #include "keyval.h"
@@ -94,6 +95,12 @@ set_value_input_check (struct disir_context *context, enum disir_value_type type
         // Already logged ?
         return status;
     }
+    status = CONTEXT_FROZEN_CHECK (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
 
     if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
     {
@@ -107,6 +114,9 @@ set_value_input_check (struct disir_context *context, enum disir_value_type type
 
         *storage = &context->cx_keyval->kv_value;
 
+        // The value and validity of a finalized keyval is about to change.
+        dx_context_mark_dirty (context);
+
         // Assign keyval to its mold equiv type
         // (Makes a correction in the type previously sat wrongfully (on purpose) below.)
         if (context->cx_keyval->kv_mold_equiv)
@@ -408,7 +418,8 @@ dc_set_value_string (struct disir_context *context, const char *value, int32_t v
         goto error;
     }
 
-    status = dx_value_set_string (value_storage, value, value_size);
+    status = dx_value_set_string_arena (dx_context_arena (context),
+                                        value_storage, value, value_size);
     if (status != DISIR_STATUS_OK)
     {
         dx_context_error_set (context,
@@ -835,7 +846,8 @@ dc_set_value_enum (struct disir_context *context, const char *value, int32_t val
         invalid = DISIR_STATUS_INVALID_CONTEXT;
     }
 
-    status = dx_value_set_string (value_storage, value, value_size);
+    status = dx_value_set_string_arena (dx_context_arena (context),
+                                        value_storage, value, value_size);
     if (status != DISIR_STATUS_OK)
     {
         dx_context_error_set (context,
@@ -19,6 +19,7 @@
 #include "log.h"
 #include "mqueue.h"
 #include "restriction.h"
+#include "stats.h"
 
 //! INTERNAL STATIC
 static enum disir_status
@@ -227,6 +228,7 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
     {
         return DISIR_STATUS_NO_MEMORY;
     }
+    pthread_mutex_init (&dis->mold_cache_lock, NULL);
 
     // No user provided config - generate the internal mold since user cannot provide one.
     if (config == NULL)
@@ -298,6 +300,7 @@ disir_instance_create (const char *config_filepath, struct disir_config *config,
 error:
     if (dis)
     {
+        pthread_mutex_destroy (&dis->mold_cache_lock);
         free (dis);
     }
     if (libmold)
@@ -318,6 +321,9 @@ disir_instance_destroy (struct disir_instance **instance)
     if (instance == NULL || *instance == NULL)
         return DISIR_STATUS_INVALID_ARGUMENT;
 
+    // Release cached molds before the plugins which read them are unloaded
+    disir_mold_cache_clear (*instance);
+
     // Free loaded plugins
     while (1)
     {
@@ -363,9 +369,75 @@ disir_instance_destroy (struct disir_instance **instance)
         free ((*instance)->disir_error_message);
     }
 
+    dx_stats_destroy (*instance);
+    pthread_mutex_destroy (&(*instance)->mold_cache_lock);
     free (*instance);
 
     *instance = NULL;
     return DISIR_STATUS_OK;
 }
 
+//! PUBLIC API
+enum disir_status
+disir_arena_enable (struct disir_instance *instance, int enable)
+{
+    if (instance == NULL)
+    {
+        log_debug (0, "invoked with NULL instance pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (instance->dio_parent)
+        instance = instance->dio_parent;
+
+    instance->dio_arena = (enable ? 1 : 0);
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+int
+disir_arena_enabled (struct disir_instance *instance)
+{
+    if (instance == NULL)
+        return 0;
+
+    if (instance->dio_parent)
+        instance = instance->dio_parent;
+
+    return instance->dio_arena;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_instance_worker_create (struct disir_instance *parent, struct disir_instance **worker)
+{
+    struct disir_instance *instance;
+
+    instance = calloc (1, sizeof (struct disir_instance));
+    if (instance == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    // Borrowed from the parent - never released by the worker.
+    instance->dio_plugin_queue = parent->dio_plugin_queue;
+    instance->libdisir_config = parent->libdisir_config;
+    instance->dio_parent = parent;
+
+    *worker = instance;
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_instance_worker_destroy (struct disir_instance **worker)
+{
+    if ((*worker)->disir_error_message)
+    {
+        free ((*worker)->disir_error_message);
+    }
+
+    free (*worker);
+    *worker = NULL;
+}
+
@@ -19,14 +19,27 @@ extern "C" {
 #include <archive_entry.h>
 #include <cstdio>
 #include <iostream>
+#include <vector>
 
 
 //! PUBLIC API
 enum disir_status
 disir_archive_export_begin (struct disir_instance *instance,
                             const char *archive_path, struct disir_archive **archive)
+{
+    return disir_archive_export_begin_codec (instance, archive_path, DISIR_ARCHIVE_CODEC_XZ,
+                                             DISIR_ARCHIVE_LEVEL_DEFAULT, archive);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_archive_export_begin_codec (struct disir_instance *instance, const char *archive_path,
+                                  enum disir_archive_codec codec, int level,
+                                  struct disir_archive **archive)
 {
     enum disir_status status;
+    int level_min = 0;
+    int level_max = 9;
 
     if (instance == NULL || archive == NULL)
     {
@@ -35,13 +48,40 @@ disir_archive_export_begin (struct disir_instance *instance,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
+    switch (codec)
+    {
+    case DISIR_ARCHIVE_CODEC_XZ:
+    case DISIR_ARCHIVE_CODEC_GZIP:
+        break;
+    case DISIR_ARCHIVE_CODEC_ZSTD:
+        level_min = 1;
+        level_max = 22;
+        break;
+    case DISIR_ARCHIVE_CODEC_NONE:
+        level_max = -1;
+        break;
+    default:
+        disir_error_set (instance, "unknown archive codec: %d", (int) codec);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (level != DISIR_ARCHIVE_LEVEL_DEFAULT && (level < level_min || level > level_max))
+    {
+        if (codec == DISIR_ARCHIVE_CODEC_NONE)
+            disir_error_set (instance, "uncompressed archives take no compression level");
+        else
+            disir_error_set (instance, "compression level %d out of range [%d, %d]",
+                                       level, level_min, level_max);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
     if (archive_path == NULL)
     {
-        status = dx_archive_begin_new (archive);
+        status = dx_archive_begin_new (codec, level, NULL, archive);
     }
     else
     {
-        status = dx_archive_begin_existing (instance, archive_path, archive);
+        status = dx_archive_begin_existing (instance, archive_path, codec, level, archive);
     }
 
     return status;
@@ -50,7 +90,8 @@ disir_archive_export_begin (struct disir_instance *instance,
 //! STATIC FUNCTION
 static enum disir_status
 archive_import_config_entries (struct disir_instance *instance,
-                               struct disir_archive *archive,
+                               const std::vector<struct disir_archive_entry>& archive_entries,
+                               std::map<std::string, std::string>& archive_content,
                                struct disir_import **import)
 {
     enum disir_status status;
@@ -64,7 +105,7 @@ archive_import_config_entries (struct disir_instance *instance,
         return DISIR_STATUS_NO_MEMORY;
     }
 
-    im->di_num_entries = archive->da_config_entries->size();
+    im->di_num_entries = archive_entries.size();
 
     im->di_entries = (struct disir_import_entry**)calloc (1, sizeof (struct disir_import_entry*)
                                                                      *im->di_num_entries);
@@ -75,7 +116,7 @@ archive_import_config_entries (struct disir_instance *instance,
     }
 
     current = im->di_entries;
-    for (const auto& e : *archive->da_config_entries)
+    for (const auto& e : archive_entries)
     {
         entry = (struct disir_import_entry*)calloc (1, sizeof (struct disir_import_entry));
         if (entry == NULL)
@@ -89,7 +130,11 @@ archive_import_config_entries (struct disir_instance *instance,
         entry->ie_backend_id = strdup (e.de_backend_id.c_str());
         entry->ie_version = strdup (e.de_version.c_str());
 
-        status = dx_resolve_config_import_status (instance, e.de_filepath.c_str(), entry);
+        // Present, as validated by dx_archive_validate or read through the index.
+        const std::string& content = archive_content[e.de_archive_path];
+
+        status = dx_resolve_config_import_status (instance, content.data(), content.size(),
+                                                  entry);
         if (status != DISIR_STATUS_OK &&
             status != DISIR_STATUS_CONFLICT &&
             status != DISIR_STATUS_NO_CAN_DO &&
@@ -120,8 +165,8 @@ disir_archive_import (struct disir_instance *instance, const char *archive_path,
 {
     enum disir_status status;
     struct disir_archive *archive = NULL;
+    std::vector<struct disir_archive_entry> archive_entries;
     std::map<std::string, std::string> archive_content;
-    char *tmp_dir_name = NULL;
 
     if (instance == NULL || archive_path == NULL || import == NULL || entries == NULL)
     {
@@ -143,17 +188,80 @@ disir_archive_import (struct disir_instance *instance, const char *archive_path,
         return status;
     }
 
-    // Create temp path for extraction
-    tmp_dir_name = dx_archive_create_temp_folder();
-    if (tmp_dir_name == NULL)
+    status = dx_archive_read (archive_path, archive_content);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    status = dx_archive_validate (archive, archive_content);
+    if (status != DISIR_STATUS_OK)
     {
-        dx_archive_destroy (archive);
-        return DISIR_STATUS_FS_ERROR;
+        disir_error_set (instance, "archive on path '%s' is invalid", archive_path);
+        goto out;
     }
 
-    archive->da_extract_folder_path = tmp_dir_name;
+    archive_entries.assign (archive->da_config_entries->begin(),
+                            archive->da_config_entries->end());
+    status = archive_import_config_entries (instance, archive_entries, archive_content, import);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    *entries = (*import)->di_num_entries;
+    // FALL-THROUGH
+out:
+    // At this point, archive does exist.
+    disir_archive_finalize (instance, NULL, &archive);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Read the config entries of the archive on archive_path from its entry index,
+//! leaving the archive open in reader. Archives without an index are read in their
+//! entirety, with the content of every member in archive_content, and reader NULL.
+static enum disir_status
+archive_entries_read (struct disir_instance *instance, const char *archive_path,
+                      std::vector<struct disir_archive_entry>& entries,
+                      std::map<std::string, std::string>& archive_content,
+                      struct disir_archive_reader **reader)
+{
+    enum disir_status status;
+    struct disir_archive *archive = NULL;
+
+    *reader = NULL;
 
-    status = dx_archive_extract (archive_path, archive_content, tmp_dir_name);
+    status = dx_assert_read_permission (archive_path);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "unable to read archive: '%s'", archive_path);
+        return status;
+    }
+
+    status = dx_archive_reader_open (archive_path, reader);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = dx_archive_index_read (*reader, entries);
+        if (status == DISIR_STATUS_OK)
+            return status;
+
+        dx_archive_reader_close (reader);
+    }
+
+    if (status != DISIR_STATUS_NOT_EXIST)
+    {
+        disir_error_set (instance, "archive on path '%s' is invalid", archive_path);
+        return status;
+    }
+
+    // No index - read it all.
+    entries.clear();
+
+    status = dx_archive_create (&archive);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = dx_archive_read (archive_path, archive_content);
     if (status != DISIR_STATUS_OK)
         goto out;
 
@@ -164,19 +272,156 @@ disir_archive_import (struct disir_instance *instance, const char *archive_path,
         goto out;
     }
 
-    status = archive_import_config_entries (instance, archive, import);
+    entries.assign (archive->da_config_entries->begin(), archive->da_config_entries->end());
+    // FALL-THROUGH
+out:
+    dx_archive_destroy (archive);
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_archive_import_entry (struct disir_instance *instance, const char *archive_path,
+                            const char *group_id, const char *entry_id,
+                            struct disir_import **import)
+{
+    enum disir_status status;
+    struct disir_archive_reader *reader = NULL;
+    std::vector<struct disir_archive_entry> entries;
+    std::vector<struct disir_archive_entry> selected;
+    std::map<std::string, std::string> archive_content;
+
+    if (instance == NULL || archive_path == NULL || group_id == NULL ||
+        entry_id == NULL || import == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance(%p), archive_path (%p)," \
+                      " group_id (%p), entry_id (%p), import (%p)",
+                      instance, archive_path, group_id, entry_id, import);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = archive_entries_read (instance, archive_path, entries, archive_content, &reader);
     if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (const auto& entry : entries)
+    {
+        if (entry.de_group_id == group_id && entry.de_entry_id == entry_id)
+        {
+            selected.push_back (entry);
+            break;
+        }
+    }
+
+    if (selected.empty())
+    {
+        disir_error_set (instance, "entry '%s' in group '%s' does not exist in archive",
+                         entry_id, group_id);
+        status = DISIR_STATUS_NOT_EXIST;
         goto out;
+    }
 
-    *entries = (*import)->di_num_entries;
+    if (reader)
+    {
+        status = dx_archive_index_member_read (reader, selected[0],
+                                               archive_content[selected[0].de_archive_path]);
+        if (status != DISIR_STATUS_OK)
+        {
+            disir_error_set (instance, "unable to read entry '%s' from archive", entry_id);
+            goto out;
+        }
+    }
+
+    status = archive_import_config_entries (instance, selected, archive_content, import);
     // FALL-THROUGH
 out:
-    // At this point, archive does exist.
-    disir_archive_finalize (instance, NULL, &archive);
+    dx_archive_reader_close (&reader);
 
     return status;
 }
 
+//! PUBLIC API
+enum disir_status
+disir_archive_list (struct disir_instance *instance, const char *archive_path,
+                    struct disir_archive_listing **listing)
+{
+    enum disir_status status;
+    struct disir_archive_reader *reader = NULL;
+    struct disir_archive_listing *head = NULL;
+    struct disir_archive_listing **tail = &head;
+    struct disir_archive_listing *current;
+    std::vector<struct disir_archive_entry> entries;
+    std::map<std::string, std::string> archive_content;
+
+    if (instance == NULL || archive_path == NULL || listing == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance(%p), archive_path (%p)," \
+                      " listing (%p)", instance, archive_path, listing);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = archive_entries_read (instance, archive_path, entries, archive_content, &reader);
+    dx_archive_reader_close (&reader);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    for (const auto& entry : entries)
+    {
+        current = (struct disir_archive_listing *) calloc (1, sizeof (*current));
+        if (current == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto error;
+        }
+        *tail = current;
+        tail = &current->next;
+
+        current->al_backend_id = strdup (entry.de_backend_id.c_str());
+        current->al_group_id = strdup (entry.de_group_id.c_str());
+        current->al_entry_id = strdup (entry.de_entry_id.c_str());
+        current->al_version = strdup (entry.de_version.c_str());
+        if (current->al_backend_id == NULL || current->al_group_id == NULL ||
+            current->al_entry_id == NULL || current->al_version == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto error;
+        }
+    }
+
+    *listing = head;
+    return DISIR_STATUS_OK;
+error:
+    disir_archive_listing_finished (&head);
+
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_archive_listing_finished (struct disir_archive_listing **listing)
+{
+    struct disir_archive_listing *next;
+
+    if (listing == NULL)
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    while (*listing != NULL)
+    {
+        next = (*listing)->next;
+        free ((*listing)->al_backend_id);
+        free ((*listing)->al_group_id);
+        free ((*listing)->al_entry_id);
+        free ((*listing)->al_version);
+        free (*listing);
+        *listing = next;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! PUBLIC API
 enum disir_status
 disir_archive_append_entry (struct disir_instance *instance, struct disir_archive *archive,
@@ -406,7 +651,16 @@ disir_archive_finalize (struct disir_instance *instance, const char *archive_pat
         }
     }
 
-    if (archive_path)
+    if (archive_path && ar->da_append_offset)
+    {
+        status = dx_archive_disk_splice (archive_path, ar->da_existing_path,
+                                         ar->da_temp_archive_path, ar->da_append_offset);
+        if (status != DISIR_STATUS_OK)
+        {
+            disir_error_set (instance, "failed to write archive to disk");
+        }
+    }
+    else if (archive_path)
     {
         status = dx_archive_disk_append (archive_path, ar->da_existing_path,
                                          ar->da_temp_archive_path);
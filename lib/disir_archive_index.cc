@@ -0,0 +1,1036 @@
+// disir public
+#include <disir/disir.h>
+
+// disir private
+#include "archive_private.h"
+extern "C" {
+#include "disir_private.h"
+#include "binary/binary_format.h"
+#include "log.h"
+}
+
+// external libs
+#include <archive.h>
+#include <archive_entry.h>
+#include <lzma.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unistd.h>
+
+// cpp
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+//!
+//! A disir archive is a tar stream compressed as a single xz stream.
+//! The writer ends the current xz block between members once it exceeds
+//! ARCHIVE_BLOCK_SIZE, and ends it before the trailer - the metadata members
+//! and the entry index - such that the trailer is the last block on its own.
+//!
+//! The xz index, at the end of the stream, maps an uncompressed offset to
+//! the block holding it. Together with the member offsets of the entry index,
+//! a single member is read by decompressing only the block holding it.
+//!
+//! Appending to an archive replaces its trailer: the new members, a new trailer
+//! and xz index are written where the trailer began, leaving every other block as is.
+//!
+
+//! A block of the tar stream, compressed on its own.
+struct writer_block
+{
+    //! Uncompressed content, released once compressed.
+    std::string             wb_data;
+    uint64_t                wb_uncompressed_size;
+    std::vector<uint8_t>    wb_out;
+    size_t                  wb_out_size;
+    lzma_vli                wb_unpadded_size;
+    lzma_ret                wb_ret;
+    //! Set once a thread has taken on compressing the block.
+    bool                    wb_claimed;
+    bool                    wb_done;
+};
+
+//! Compressed stream of the tar stream written by libarchive.
+//! Each block is compressed on its own, on a pool of threads, and written to the file in order.
+struct disir_archive_writer
+{
+    FILE                                *dw_file;
+    //! LZMA2 options of every block. Read-only once the writer is created.
+    lzma_options_lzma                   dw_options;
+    lzma_check                          dw_check;
+    //! Records of every block in the stream, those of an appended archive included.
+    lzma_index                          *dw_index;
+    //! Uncompressed size of the tar stream written so far.
+    uint64_t                            dw_offset;
+    //! Offset in the uncompressed tar stream where the current block began.
+    uint64_t                            dw_block_offset;
+    //! Block currently written to by libarchive.
+    struct writer_block                 *dw_current;
+    //! Blocks ended, in order, waiting to be compressed and written to the file.
+    std::deque<struct writer_block *>   dw_pending;
+    //! Number of blocks that may be pending before waiting for the oldest of them.
+    size_t                              dw_window;
+    bool                                dw_stop;
+    std::vector<std::thread>            dw_threads;
+    std::mutex                          dw_mutex;
+    std::condition_variable             dw_cond;
+};
+
+//! Archive opened for reading individual blocks.
+struct disir_archive_reader
+{
+    FILE                *dr_file;
+    //! Size of the archive file.
+    uint64_t            dr_size;
+    lzma_index          *dr_index;
+    lzma_stream_flags   dr_flags;
+};
+
+//! STATIC FUNCTION
+static enum disir_status
+writer_output (struct disir_archive_writer *writer, const uint8_t *buffer, size_t size)
+{
+    if (fwrite (buffer, 1, size, writer->dw_file) != size)
+    {
+        log_error ("failed to write archive: %s", strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+//! Compress the content of block into a complete xz block, its header included.
+static void
+block_encode (const struct disir_archive_writer *writer, struct writer_block *block)
+{
+    lzma_options_lzma options = writer->dw_options;
+    lzma_filter filters[2];
+    lzma_block block_options;
+
+    filters[0].id = LZMA_FILTER_LZMA2;
+    filters[0].options = &options;
+    filters[1].id = LZMA_VLI_UNKNOWN;
+    filters[1].options = NULL;
+
+    memset (&block_options, 0, sizeof (block_options));
+    block_options.version = 0;
+    block_options.check = writer->dw_check;
+    block_options.filters = filters;
+
+    block->wb_uncompressed_size = block->wb_data.size();
+    block->wb_out_size = 0;
+    try
+    {
+        block->wb_out.resize (lzma_block_buffer_bound (block->wb_data.size()));
+    }
+    catch (std::bad_alloc& e)
+    {
+        block->wb_ret = LZMA_MEM_ERROR;
+        return;
+    }
+
+    block->wb_ret = lzma_block_buffer_encode (&block_options, NULL,
+                                              (const uint8_t *) block->wb_data.data(),
+                                              block->wb_data.size(), block->wb_out.data(),
+                                              &block->wb_out_size, block->wb_out.size());
+    if (block->wb_ret == LZMA_OK)
+    {
+        block->wb_unpadded_size = lzma_block_unpadded_size (&block_options);
+    }
+
+    std::string().swap (block->wb_data);
+}
+
+//! STATIC FUNCTION
+//! Compress pending blocks until the writer stops.
+static void
+writer_worker (struct disir_archive_writer *writer)
+{
+    std::unique_lock<std::mutex> lock (writer->dw_mutex);
+
+    while (1)
+    {
+        struct writer_block *block = NULL;
+
+        writer->dw_cond.wait (lock, [writer, &block] {
+            for (auto pending : writer->dw_pending)
+            {
+                if (pending->wb_claimed == false)
+                {
+                    block = pending;
+                    return true;
+                }
+            }
+            return writer->dw_stop;
+        });
+
+        if (block == NULL)
+            return;
+
+        block->wb_claimed = true;
+        lock.unlock();
+        block_encode (writer, block);
+        lock.lock();
+        block->wb_done = true;
+        writer->dw_cond.notify_all();
+    }
+}
+
+//! STATIC FUNCTION
+//! Write pending blocks to the file, in order, until at most 'keep' of them remain.
+//! A block no thread has taken on yet is compressed by the caller.
+static enum disir_status
+writer_flush (struct disir_archive_writer *writer, size_t keep)
+{
+    struct writer_block *block;
+
+    while (writer->dw_pending.size() > keep)
+    {
+        block = writer->dw_pending.front();
+        {
+            std::unique_lock<std::mutex> lock (writer->dw_mutex);
+
+            if (block->wb_claimed == false)
+            {
+                block->wb_claimed = true;
+                lock.unlock();
+                block_encode (writer, block);
+                lock.lock();
+                block->wb_done = true;
+            }
+
+            writer->dw_cond.wait (lock, [block] { return block->wb_done; });
+            writer->dw_pending.pop_front();
+        }
+
+        std::unique_ptr<struct writer_block> written (block);
+        if (block->wb_ret != LZMA_OK)
+        {
+            log_error ("failed to compress archive (lzma error %d)", block->wb_ret);
+            return DISIR_STATUS_INTERNAL_ERROR;
+        }
+
+        enum disir_status status = writer_output (writer, block->wb_out.data(), block->wb_out_size);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        if (lzma_index_append (writer->dw_index, NULL, block->wb_unpadded_size,
+                               block->wb_uncompressed_size) != LZMA_OK)
+        {
+            log_error ("failed to record archive block");
+            return DISIR_STATUS_INTERNAL_ERROR;
+        }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+//! Stop the threads of the writer.
+static void
+writer_stop (struct disir_archive_writer *writer)
+{
+    {
+        std::lock_guard<std::mutex> lock (writer->dw_mutex);
+        writer->dw_stop = true;
+    }
+    writer->dw_cond.notify_all();
+
+    for (auto& thread : writer->dw_threads)
+    {
+        thread.join();
+    }
+    writer->dw_threads.clear();
+}
+
+//! STATIC FUNCTION
+static la_ssize_t
+writer_write (struct archive *archive, void *client_data, const void *buffer, size_t length)
+{
+    struct disir_archive_writer *writer = (struct disir_archive_writer *) client_data;
+
+    (void) archive;
+
+    if (length == 0)
+        return 0;
+
+    if (writer->dw_current == NULL)
+    {
+        writer->dw_current = new (std::nothrow) writer_block();
+        if (writer->dw_current == NULL)
+            return -1;
+    }
+
+    try
+    {
+        writer->dw_current->wb_data.append ((const char *) buffer, length);
+    }
+    catch (std::bad_alloc& e)
+    {
+        log_error ("unable to allocate archive block");
+        return -1;
+    }
+
+    writer->dw_offset += length;
+    return length;
+}
+
+//! STATIC FUNCTION
+//! Write the remaining blocks, followed by the xz index and stream footer.
+static int
+writer_close (struct archive *archive, void *client_data)
+{
+    enum disir_status status;
+    struct disir_archive_writer *writer = (struct disir_archive_writer *) client_data;
+    lzma_stream_flags flags;
+    std::vector<uint8_t> index;
+    uint8_t footer[LZMA_STREAM_HEADER_SIZE];
+    size_t out_pos = 0;
+
+    (void) archive;
+
+    if (writer->dw_file == NULL)
+        return ARCHIVE_OK;
+
+    status = dx_archive_writer_block_end (writer);
+    if (status == DISIR_STATUS_OK)
+        status = writer_flush (writer, 0);
+    writer_stop (writer);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    memset (&flags, 0, sizeof (flags));
+    flags.version = 0;
+    flags.check = writer->dw_check;
+    flags.backward_size = lzma_index_size (writer->dw_index);
+
+    index.resize (flags.backward_size);
+    if (lzma_index_buffer_encode (writer->dw_index, index.data(),
+                                  &out_pos, index.size()) != LZMA_OK ||
+        lzma_stream_footer_encode (&flags, footer) != LZMA_OK)
+    {
+        log_error ("failed to encode archive index");
+        status = DISIR_STATUS_INTERNAL_ERROR;
+        goto out;
+    }
+
+    status = writer_output (writer, index.data(), index.size());
+    if (status == DISIR_STATUS_OK)
+        status = writer_output (writer, footer, sizeof (footer));
+    // FALL-THROUGH
+out:
+    if (fclose (writer->dw_file) != 0)
+    {
+        log_error ("failed to close archive: %s", strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+    }
+    writer->dw_file = NULL;
+
+    return (status == DISIR_STATUS_OK ? ARCHIVE_OK : ARCHIVE_FATAL);
+}
+
+//! STATIC FUNCTION
+//! Allocate a writer of blocks with 'check', compressed at 'level',
+//! to a new file at 'filepath'.
+static enum disir_status
+writer_create (const char *filepath, lzma_check check, int level,
+               struct disir_archive_writer **writer)
+{
+    enum disir_status status;
+    struct disir_archive_writer *w;
+    size_t nthreads;
+    long online;
+    size_t index;
+
+    w = new (std::nothrow) disir_archive_writer();
+    if (w == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    if (lzma_lzma_preset (&w->dw_options, (level == DISIR_ARCHIVE_LEVEL_DEFAULT ?
+                                           LZMA_PRESET_DEFAULT : (uint32_t) level)))
+    {
+        log_error ("unable to initialize archive compression at level %d", level);
+        status = DISIR_STATUS_INVALID_ARGUMENT;
+        goto error;
+    }
+
+    // A block is compressed on its own - a dictionary beyond its size only costs memory.
+    if (w->dw_options.dict_size > 2 * ARCHIVE_BLOCK_SIZE)
+        w->dw_options.dict_size = 2 * ARCHIVE_BLOCK_SIZE;
+
+    w->dw_check = check;
+
+    w->dw_index = lzma_index_init (NULL);
+    if (w->dw_index == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
+    w->dw_file = fopen (filepath, "wb");
+    if (w->dw_file == NULL)
+    {
+        log_error ("unable to open archive on path '%s': %s", filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    // The thread writing the archive is one of them, compressing the oldest block
+    // if no other thread has taken it on.
+    online = sysconf (_SC_NPROCESSORS_ONLN);
+    nthreads = online > 1 ? (size_t) online : 1;
+
+    for (index = 1; index < nthreads; index++)
+    {
+        try
+        {
+            w->dw_threads.emplace_back (writer_worker, w);
+        }
+        catch (std::system_error& e)
+        {
+            log_warn ("failed to start compression thread %zu - continuing with fewer threads.",
+                      index);
+            break;
+        }
+    }
+    w->dw_window = 2 * w->dw_threads.size();
+
+    *writer = w;
+    return DISIR_STATUS_OK;
+error:
+    dx_archive_writer_destroy (&w);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Direct the tar stream of 'archive' to writer.
+static enum disir_status
+writer_attach (struct archive *archive, const char *filepath,
+               struct disir_archive_writer *writer)
+{
+    // Pass every write straight through, such that the offset where
+    // each member begins is known to the writer.
+    if (archive_write_set_bytes_per_block (archive, 0) != ARCHIVE_OK)
+    {
+        log_error ("unable to set archive block size: %s", archive_error_string (archive));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    if (archive_write_open (archive, writer, NULL, writer_write, writer_close) != ARCHIVE_OK)
+    {
+        log_error ("unable to open archive on path '%s': %s",
+                   filepath, archive_error_string (archive));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_writer_open (struct archive *archive, const char *filepath, int level,
+                        struct disir_archive_writer **writer)
+{
+    enum disir_status status;
+    struct disir_archive_writer *w = NULL;
+    lzma_stream_flags flags;
+    uint8_t header[LZMA_STREAM_HEADER_SIZE];
+
+    status = writer_create (filepath, LZMA_CHECK_CRC64, level, &w);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    memset (&flags, 0, sizeof (flags));
+    flags.version = 0;
+    flags.check = w->dw_check;
+    if (lzma_stream_header_encode (&flags, header) != LZMA_OK)
+    {
+        log_error ("failed to encode archive header");
+        status = DISIR_STATUS_INTERNAL_ERROR;
+        goto error;
+    }
+
+    status = writer_output (w, header, sizeof (header));
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    status = writer_attach (archive, filepath, w);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    *writer = w;
+    return DISIR_STATUS_OK;
+error:
+    dx_archive_writer_destroy (&w);
+
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_writer_open_append (struct archive *archive, const char *filepath, int level,
+                               struct disir_archive_reader *existing, uint64_t *append_offset,
+                               struct disir_archive_writer **writer)
+{
+    enum disir_status status;
+    struct disir_archive_writer *w = NULL;
+    lzma_index_iter iter;
+    lzma_vli blocks;
+
+    status = writer_create (filepath, existing->dr_flags.check, level, &w);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    // Keep the records of every block but the trailer.
+    blocks = lzma_index_block_count (existing->dr_index);
+    lzma_index_iter_init (&iter, existing->dr_index);
+    while (lzma_index_iter_next (&iter, LZMA_INDEX_ITER_BLOCK) == 0)
+    {
+        if (iter.block.number_in_file == blocks)
+            break;
+
+        if (lzma_index_append (w->dw_index, NULL, iter.block.unpadded_size,
+                               iter.block.uncompressed_size) != LZMA_OK)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto error;
+        }
+    }
+
+    // The tar stream continues where the trailer began.
+    w->dw_offset = iter.block.uncompressed_file_offset;
+    w->dw_block_offset = w->dw_offset;
+
+    status = writer_attach (archive, filepath, w);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    *append_offset = iter.block.compressed_file_offset;
+    *writer = w;
+    return DISIR_STATUS_OK;
+error:
+    dx_archive_writer_destroy (&w);
+
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_writer_member_begin (struct disir_archive_writer *writer, uint64_t *offset)
+{
+    enum disir_status status;
+
+    status = DISIR_STATUS_OK;
+    if (writer->dw_offset - writer->dw_block_offset >= ARCHIVE_BLOCK_SIZE)
+    {
+        status = dx_archive_writer_block_end (writer);
+    }
+
+    *offset = writer->dw_offset;
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_writer_block_end (struct disir_archive_writer *writer)
+{
+    if (writer->dw_current == NULL)
+        return DISIR_STATUS_OK;
+
+    {
+        std::lock_guard<std::mutex> lock (writer->dw_mutex);
+        writer->dw_pending.push_back (writer->dw_current);
+    }
+    writer->dw_cond.notify_one();
+
+    writer->dw_current = NULL;
+    writer->dw_block_offset = writer->dw_offset;
+
+    return writer_flush (writer, writer->dw_window);
+}
+
+//! INTERNAL API
+void
+dx_archive_writer_destroy (struct disir_archive_writer **writer)
+{
+    if (writer == NULL || *writer == NULL)
+        return;
+
+    writer_stop (*writer);
+    for (auto block : (*writer)->dw_pending)
+    {
+        delete block;
+    }
+    delete (*writer)->dw_current;
+
+    if ((*writer)->dw_file)
+        fclose ((*writer)->dw_file);
+    if ((*writer)->dw_index)
+        lzma_index_end ((*writer)->dw_index, NULL);
+    delete *writer;
+    *writer = NULL;
+}
+
+//! STATIC FUNCTION
+static enum disir_status
+reader_read (struct disir_archive_reader *reader, uint64_t offset, uint8_t *buffer, size_t size)
+{
+    if (fseeko (reader->dr_file, (off_t) offset, SEEK_SET) != 0 ||
+        fread (buffer, 1, size, reader->dr_file) != size)
+    {
+        log_error ("failed to read archive: %s", strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_reader_open (const char *archive_path, struct disir_archive_reader **reader)
+{
+    enum disir_status status;
+    struct disir_archive_reader *r;
+    lzma_stream_flags header_flags;
+    uint8_t header[LZMA_STREAM_HEADER_SIZE];
+    uint8_t footer[LZMA_STREAM_HEADER_SIZE];
+    std::vector<uint8_t> index;
+    uint64_t memlimit = UINT64_MAX;
+    uint64_t size;
+    size_t in_pos = 0;
+    off_t end;
+
+    status = dx_archive_journal_recover (archive_path);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    r = (struct disir_archive_reader *) calloc (1, sizeof (struct disir_archive_reader));
+    if (r == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    r->dr_file = fopen (archive_path, "rb");
+    if (r->dr_file == NULL)
+    {
+        log_error ("could not open archive '%s': %s", archive_path, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    if (fseeko (r->dr_file, 0, SEEK_END) != 0 || (end = ftello (r->dr_file)) < 0)
+    {
+        log_error ("could not seek archive '%s': %s", archive_path, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+    size = (uint64_t) end;
+    r->dr_size = size;
+
+    // Anything but a single xz stream is left to the sequential reader.
+    status = DISIR_STATUS_NOT_EXIST;
+    if (size < 2 * LZMA_STREAM_HEADER_SIZE)
+        goto error;
+
+    if (reader_read (r, 0, header, sizeof (header)) != DISIR_STATUS_OK ||
+        reader_read (r, size - sizeof (footer), footer, sizeof (footer)) != DISIR_STATUS_OK)
+    {
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    if (lzma_stream_header_decode (&header_flags, header) != LZMA_OK ||
+        lzma_stream_footer_decode (&r->dr_flags, footer) != LZMA_OK ||
+        lzma_stream_flags_compare (&header_flags, &r->dr_flags) != LZMA_OK ||
+        r->dr_flags.backward_size > size - 2 * LZMA_STREAM_HEADER_SIZE)
+    {
+        log_debug (3, "archive '%s' is not a single xz stream", archive_path);
+        goto error;
+    }
+
+    index.resize (r->dr_flags.backward_size);
+    if (reader_read (r, size - sizeof (footer) - index.size(),
+                     index.data(), index.size()) != DISIR_STATUS_OK)
+    {
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    if (lzma_index_buffer_decode (&r->dr_index, &memlimit, NULL,
+                                  index.data(), &in_pos, index.size()) != LZMA_OK ||
+        lzma_index_file_size (r->dr_index) != size)
+    {
+        log_debug (3, "archive '%s' is not a single xz stream", archive_path);
+        goto error;
+    }
+
+    // The entry index is written in a block of its own.
+    if (lzma_index_block_count (r->dr_index) < 2)
+    {
+        log_debug (3, "archive '%s' is compressed in a single block", archive_path);
+        goto error;
+    }
+
+    *reader = r;
+    return DISIR_STATUS_OK;
+error:
+    dx_archive_reader_close (&r);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Decompress the block holding the uncompressed 'offset' into 'block'.
+//! 'block_offset' is populated with the uncompressed offset where the block begins.
+static enum disir_status
+reader_block_decode (struct disir_archive_reader *reader, uint64_t offset,
+                     std::string& block, uint64_t *block_offset)
+{
+    enum disir_status status;
+    lzma_index_iter iter;
+    lzma_block block_options;
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    std::vector<uint8_t> compressed;
+    size_t in_pos;
+    size_t out_pos;
+    lzma_ret ret;
+    int i;
+
+    lzma_index_iter_init (&iter, reader->dr_index);
+    if (lzma_index_iter_locate (&iter, offset))
+    {
+        log_error ("archive offset %" PRIu64 " is beyond the end of the archive", offset);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    // The index is only checked for consistency with itself and the file size.
+    if (iter.block.compressed_file_offset + iter.block.total_size > reader->dr_size ||
+        iter.block.uncompressed_size > ARCHIVE_MEMBER_SIZE_MAX)
+    {
+        log_error ("archive block at offset %" PRIu64 " is out of bounds",
+                   (uint64_t) iter.block.compressed_file_offset);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    try
+    {
+        compressed.resize (iter.block.total_size);
+        block.resize (iter.block.uncompressed_size);
+    }
+    catch (std::bad_alloc& e)
+    {
+        log_error ("unable to allocate archive block");
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    status = reader_read (reader, iter.block.compressed_file_offset,
+                          compressed.data(), compressed.size());
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    memset (&block_options, 0, sizeof (block_options));
+    block_options.version = 1;
+    block_options.check = reader->dr_flags.check;
+    block_options.filters = filters;
+    block_options.header_size = lzma_block_header_size_decode (compressed[0]);
+    if (block_options.header_size > compressed.size() ||
+        lzma_block_header_decode (&block_options, NULL, compressed.data()) != LZMA_OK)
+    {
+        log_error ("invalid block header in archive at offset %" PRIu64,
+                   (uint64_t) iter.block.compressed_file_offset);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    in_pos = block_options.header_size;
+    out_pos = 0;
+
+    ret = lzma_block_compressed_size (&block_options, iter.block.unpadded_size);
+    if (ret == LZMA_OK)
+    {
+        ret = lzma_block_buffer_decode (&block_options, NULL,
+                                        compressed.data(), &in_pos, compressed.size(),
+                                        (uint8_t *) &block[0], &out_pos, block.size());
+    }
+
+    // Allocated by lzma_block_header_decode
+    for (i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+    {
+        free (filters[i].options);
+    }
+
+    if (ret != LZMA_OK || out_pos != block.size())
+    {
+        log_error ("failed to decompress archive block at offset %" PRIu64 " (lzma error %d)",
+                   (uint64_t) iter.block.compressed_file_offset, ret);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    *block_offset = iter.block.uncompressed_file_offset;
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+//! Read the tar members beginning at 'offset' in 'block' into 'members', keyed by name.
+//! At most 'count' members are read, or every member in the block if 0.
+static enum disir_status
+block_members_read (const std::string& block, uint64_t offset, size_t count,
+                    std::map<std::string, std::string>& members)
+{
+    enum disir_status status;
+    struct archive *read_archive;
+    struct archive_entry *entry;
+    const char *pathname;
+    int ret;
+
+    if (offset >= block.size())
+    {
+        log_error ("archive member offset is beyond its block");
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    read_archive = archive_read_new();
+    if (read_archive == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    status = DISIR_STATUS_FS_ERROR;
+    if (archive_read_support_format_tar (read_archive) != ARCHIVE_OK ||
+        archive_read_open_memory (read_archive, block.data() + offset,
+                                  block.size() - offset) != ARCHIVE_OK)
+    {
+        log_error ("could not open archive block: %s", archive_error_string (read_archive));
+        goto out;
+    }
+
+    while ((ret = archive_read_next_header (read_archive, &entry)) == ARCHIVE_OK)
+    {
+        pathname = archive_entry_pathname (entry);
+        if (pathname == NULL)
+        {
+            log_error ("archive member without a pathname");
+            status = DISIR_STATUS_FS_ERROR;
+            goto out;
+        }
+
+        try
+        {
+            status = dx_archive_read_data (read_archive, entry, members[pathname]);
+        }
+        catch (std::bad_alloc& e)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+        }
+        if (status != DISIR_STATUS_OK || members.size() == count)
+            goto out;
+    }
+
+    if (ret != ARCHIVE_EOF || members.empty())
+    {
+        log_error ("could not read archive member: %s", archive_error_string (read_archive));
+        status = DISIR_STATUS_FS_ERROR;
+    }
+    // FALL-THROUGH
+out:
+    archive_read_free (read_archive);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Split the line of the entry index beginning at 'pos' into its tab separated fields.
+//! The last field extends to the end of the line. Returns the position past the line,
+//! or std::string::npos if the line does not hold exactly 'count' fields.
+static size_t
+index_line_split (const std::string& index, size_t pos, std::string *fields, size_t count)
+{
+    size_t end = index.find ('\n', pos);
+    if (end == std::string::npos)
+        return std::string::npos;
+
+    for (size_t i = 0; i < count - 1; i++)
+    {
+        size_t tab = index.find ('\t', pos);
+        if (tab == std::string::npos || tab > end)
+            return std::string::npos;
+
+        fields[i].assign (index, pos, tab - pos);
+        pos = tab + 1;
+    }
+    fields[count - 1].assign (index, pos, end - pos);
+
+    return end + 1;
+}
+
+//! STATIC FUNCTION
+//! Parse the unsigned integer field of the entry index, in 'base'.
+static enum disir_status
+index_number (const std::string& field, int base, uint64_t *value)
+{
+    char *end = NULL;
+
+    errno = 0;
+    *value = strtoull (field.c_str(), &end, base);
+    if (field.empty() || field[0] == '-' || *end != '\0' || errno != 0)
+    {
+        log_error ("invalid number '%s' in %s", field.c_str(), INDEX_FILENAME);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_trailer_read (struct disir_archive_reader *reader,
+                         std::map<std::string, std::string>& trailer)
+{
+    enum disir_status status;
+    std::string block;
+    uint64_t block_offset;
+    uint64_t size;
+
+    size = lzma_index_uncompressed_size (reader->dr_index);
+    if (size == 0)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    status = reader_block_decode (reader, size - 1, block, &block_offset);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = block_members_read (block, 0, 0, trailer);
+    if (status != DISIR_STATUS_OK || trailer.count (INDEX_FILENAME) == 0)
+    {
+        log_debug (3, "archive carries no entry index");
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_index_parse (const std::string& index,
+                        std::vector<struct disir_archive_entry>& entries)
+{
+    enum disir_status status;
+    std::string header[3];
+    std::string fields[7];
+    size_t pos;
+
+    pos = index_line_split (index, 0, header, 3);
+    if (pos == std::string::npos || header[0] != INDEX_MAGIC)
+    {
+        log_error ("invalid header in %s", INDEX_FILENAME);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = dx_archive_validate_implementation (header[1], header[2]);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    while (pos < index.size())
+    {
+        struct disir_archive_entry entry;
+
+        pos = index_line_split (index, pos, fields, 7);
+        if (pos == std::string::npos)
+        {
+            log_error ("malformed entry in %s", INDEX_FILENAME);
+            return DISIR_STATUS_FS_ERROR;
+        }
+
+        if ((status = index_number (fields[0], 10, &entry.de_offset)) != DISIR_STATUS_OK ||
+            (status = index_number (fields[1], 10, &entry.de_size)) != DISIR_STATUS_OK ||
+            (status = index_number (fields[2], 16, &entry.de_hash)) != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+
+        entry.de_backend_id = fields[3];
+        entry.de_group_id = fields[4];
+        entry.de_version = fields[5];
+        entry.de_entry_id = fields[6];
+        entry.de_archive_path = entry.de_backend_id + "/" + entry.de_group_id +
+                                "/" + entry.de_entry_id;
+        entries.push_back (entry);
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_index_read (struct disir_archive_reader *reader,
+                       std::vector<struct disir_archive_entry>& entries)
+{
+    enum disir_status status;
+    std::map<std::string, std::string> trailer;
+
+    status = dx_archive_trailer_read (reader, trailer);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    return dx_archive_index_parse (trailer[INDEX_FILENAME], entries);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_index_member_read (struct disir_archive_reader *reader,
+                              const struct disir_archive_entry& entry, std::string& content)
+{
+    enum disir_status status;
+    std::string block;
+    std::map<std::string, std::string> members;
+    uint64_t block_offset;
+
+    status = reader_block_decode (reader, entry.de_offset, block, &block_offset);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = block_members_read (block, entry.de_offset - block_offset, 1, members);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    content.swap (members.begin()->second);
+    if (members.begin()->first != entry.de_archive_path || content.size() != entry.de_size ||
+        binary_checksum (content.data(), content.size()) != entry.de_hash)
+    {
+        log_error ("archive member '%s' does not match the entry index",
+                   entry.de_archive_path.c_str());
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_archive_reader_close (struct disir_archive_reader **reader)
+{
+    if (reader == NULL || *reader == NULL)
+        return;
+
+    if ((*reader)->dr_index)
+        lzma_index_end ((*reader)->dr_index, NULL);
+    if ((*reader)->dr_file)
+        fclose ((*reader)->dr_file);
+    free (*reader);
+    *reader = NULL;
+}
@@ -13,29 +13,17 @@ extern "C" {
 // external libs
 #include <archive.h>
 #include <archive_entry.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <unistd.h>
 #include <fstream>
 #include <iostream>
-#include <ftw.h>
+#include <sstream>
+#include <stdexcept>
 #include <ctime>
 
-//! INTERNAL API
-char *dx_archive_create_temp_folder (void)
-{
-    char  basename[] = "/tmp/disir.XXXXXX";
-    char *tmp_dir_name = mkdtemp (basename);
-
-    if (tmp_dir_name != NULL)
-    {
-        return strdup(tmp_dir_name);
-    }
-    else
-    {
-        log_error ("unable to create temporary folder: %s", strerror (errno));
-        return NULL;
-    }
-}
-
 //! INTERNAL API
 enum disir_status
 dx_archive_create (struct disir_archive **archive)
@@ -50,9 +38,11 @@ dx_archive_create (struct disir_archive **archive)
 
     ar->da_archive = NULL;
     ar->da_entries = NULL;
-    ar->da_extract_folder_path = NULL;
     ar->da_existing_path = NULL;
     ar->da_temp_archive_path = NULL;
+    ar->da_append_offset = 0;
+    ar->da_codec = DISIR_ARCHIVE_CODEC_XZ;
+    ar->da_level = DISIR_ARCHIVE_LEVEL_DEFAULT;
 
     ar->da_metadata = new (std::nothrow) toml::Value (toml::Table());
     if (ar->da_metadata == nullptr)
@@ -70,6 +60,14 @@ dx_archive_create (struct disir_archive **archive)
         goto error;
     }
 
+    ar->da_members = new (std::nothrow) std::map<std::string, struct disir_archive_entry>;
+    if (ar->da_members == nullptr)
+    {
+        log_debug (3, "failed to allocate archive members map");
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
     *archive = ar;
     return DISIR_STATUS_OK;
 error:
@@ -77,6 +75,8 @@ error:
         delete ar->da_metadata;
     if (ar && ar->da_config_entries)
         delete ar->da_config_entries;
+    if (ar && ar->da_members)
+        delete ar->da_members;
     if (ar)
         free (ar);
 
@@ -85,131 +85,114 @@ error:
 
 //! INTERNAL API
 enum disir_status
-dx_archive_extract (const char *archive_path, std::map<std::string, std::string>& extract_content,
-                    const char *extract_path)
+dx_archive_read_data (struct archive *read_archive, struct archive_entry *entry,
+                      std::string& content)
 {
-    enum disir_status status;
-    struct archive *write_archive = NULL;
-    struct archive *read_archive = NULL;
-    struct archive_entry *entry;
-    int flags;
     int ret;
     int64_t offset;
     size_t size;
     const void *buff;
-    char path[PATH_MAX];
 
-    // Check for write permission
-    status = dx_assert_write_permission (extract_path);
-    if (status != DISIR_STATUS_OK)
+    content.clear();
+    if (archive_entry_size (entry) > ARCHIVE_MEMBER_SIZE_MAX)
     {
-        return status;
+        log_error ("archive member is too large: %" PRId64 " bytes",
+                   (int64_t) archive_entry_size (entry));
+        return DISIR_STATUS_FS_ERROR;
     }
 
-    flags = ARCHIVE_EXTRACT_TIME;
-    flags |= ARCHIVE_EXTRACT_PERM;
-    flags |= ARCHIVE_EXTRACT_ACL;
-    flags |= ARCHIVE_EXTRACT_FFLAGS;
+    try
+    {
+        if (archive_entry_size (entry) > 0)
+        {
+            content.reserve (archive_entry_size (entry));
+        }
 
-    write_archive = archive_write_disk_new();
-    if (write_archive == NULL)
+        while (1)
+        {
+            ret = archive_read_data_block (read_archive, &buff, &size, &offset);
+            if (ret == ARCHIVE_EOF)
+                break;
+
+            if (ret != ARCHIVE_OK)
+            {
+                log_error ("could not read archive data: %s",
+                            archive_error_string (read_archive));
+                return DISIR_STATUS_FS_ERROR;
+            }
+
+            if (offset < 0 || (uint64_t) offset + size > ARCHIVE_MEMBER_SIZE_MAX)
+            {
+                log_error ("archive member data is out of bounds at offset %" PRId64,
+                           (int64_t) offset);
+                return DISIR_STATUS_FS_ERROR;
+            }
+
+            // Holes in sparse members read back as zeroes.
+            if ((size_t) offset > content.size())
+            {
+                content.resize (offset, '\0');
+            }
+            content.replace (offset, size, (const char *) buff, size);
+        }
+    }
+    catch (std::bad_alloc& e)
     {
-        log_debug (3, "unable to open new disk write archive");
+        log_error ("unable to allocate archive member");
         return DISIR_STATUS_NO_MEMORY;
     }
-
-    if (archive_write_disk_set_options (write_archive, flags) != ARCHIVE_OK)
+    catch (std::length_error& e)
     {
-        log_error ("could not set permission flags: %s", archive_error_string (write_archive));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
+        log_error ("archive member is too large");
+        return DISIR_STATUS_FS_ERROR;
     }
 
-    if (archive_write_disk_set_standard_lookup (write_archive))
-    {
-        log_error ("could not set convenience functions %s", archive_error_string (write_archive));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
-    }
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_read (const char *archive_path, std::map<std::string, std::string>& archive_content)
+{
+    enum disir_status status;
+    struct archive *read_archive = NULL;
+    struct archive_entry *entry;
+    const char *pathname;
 
     status = dx_archive_open_read (archive_path, &read_archive);
     if (status != DISIR_STATUS_OK)
     {
         // Already logged
-        goto out;
+        return status;
     }
 
-    status = DISIR_STATUS_OK;
-
     while (archive_read_next_header (read_archive, &entry) == ARCHIVE_OK)
     {
-        snprintf(path, PATH_MAX, "%s/%s", extract_path, archive_entry_pathname (entry));
-        extract_content.insert (std::make_pair (archive_entry_pathname (entry), path));
-        archive_entry_set_pathname (entry, path);
-
-        if (archive_write_header (write_archive, entry) == ARCHIVE_OK &&
-                                  archive_entry_size (entry) > 0)
+        pathname = archive_entry_pathname (entry);
+        if (pathname == NULL)
         {
-            while (1)
-            {
-                ret = archive_read_data_block (read_archive, &buff, &size, &offset);
-                if (ret == ARCHIVE_EOF)
-                    break;
-
-                if (ret != ARCHIVE_OK)
-                {
-                    log_error ("could not read archive data: %s",
-                                archive_error_string (read_archive));
-                    status = DISIR_STATUS_FS_ERROR;
-                    goto out;
-                }
-
-                ret = archive_write_data_block (write_archive, buff, size, offset);
-                if (ret != ARCHIVE_OK)
-                {
-                    log_error ("could not write archive to disk: %s",
-                                archive_error_string (write_archive));
-                    status = DISIR_STATUS_FS_ERROR;
-                    goto out;
-                }
-            }
-        }
-
-        if (archive_write_finish_entry (write_archive) != ARCHIVE_OK)
-        {
-            log_error ("could not finish archive write entry: %s",
-                        archive_error_string (read_archive));
+            log_error ("archive member without a pathname in '%s'", archive_path);
             status = DISIR_STATUS_FS_ERROR;
             break;
         }
-    }
-    // FALL-THROUGH
-out:
-    if (write_archive)
-    {
-        if (archive_write_close (write_archive) != ARCHIVE_OK)
+
+        try
         {
-            log_error ("unable to close write archive during extraction: %s",
-                        archive_error_string (write_archive));
-            status = DISIR_STATUS_FS_ERROR;
+            status = dx_archive_read_data (read_archive, entry, archive_content[pathname]);
         }
-
-        if (archive_write_free (write_archive) != ARCHIVE_OK)
+        catch (std::bad_alloc& e)
         {
-            log_error ("unable to free archive during extraction: %s",
-                        archive_error_string (write_archive));
-            status = DISIR_STATUS_FS_ERROR;
+            status = DISIR_STATUS_NO_MEMORY;
         }
+        if (status != DISIR_STATUS_OK)
+            break;
     }
 
-    if (read_archive)
+    if (archive_read_free (read_archive) != ARCHIVE_OK)
     {
-        if (archive_read_free (read_archive) != ARCHIVE_OK)
-        {
-            log_error ("unable to free read archive during extraction: %s",
-                        archive_error_string (read_archive));
-            status = DISIR_STATUS_FS_ERROR;
-        }
+        log_error ("unable to free read archive: %s",
+                    archive_error_string (read_archive));
+        status = DISIR_STATUS_FS_ERROR;
     }
 
     return status;
@@ -229,9 +212,72 @@ dx_random_string (unsigned int length, unsigned int seed, char *dest)
     *dest = '\0';
 }
 
+//! STATIC FUNCTION
+//! Open 'ar' for writing to 'filepath', compressed by the libarchive filter of 'codec'.
+static enum disir_status
+open_write_filter (struct archive *ar, const char *filepath,
+                   enum disir_archive_codec codec, int level)
+{
+    const char *filter = NULL;
+    char option[32];
+    int ret;
+
+    switch (codec)
+    {
+    case DISIR_ARCHIVE_CODEC_ZSTD:
+        filter = "zstd";
+        ret = archive_write_add_filter_zstd (ar);
+        break;
+    case DISIR_ARCHIVE_CODEC_GZIP:
+        filter = "gzip";
+        ret = archive_write_add_filter_gzip (ar);
+        break;
+    default:
+        ret = archive_write_add_filter_none (ar);
+        break;
+    }
+
+    if (ret != ARCHIVE_OK)
+    {
+        log_error ("unable to set archive compression: %s", archive_error_string (ar));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    if (filter && level != DISIR_ARCHIVE_LEVEL_DEFAULT)
+    {
+        snprintf (option, sizeof (option), "%d", level);
+        if (archive_write_set_filter_option (ar, filter, "compression-level",
+                                             option) != ARCHIVE_OK)
+        {
+            log_error ("unable to set archive compression level %d: %s",
+                       level, archive_error_string (ar));
+            return DISIR_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    // Older versions of libarchive compress zstd on a single thread.
+    if (codec == DISIR_ARCHIVE_CODEC_ZSTD)
+    {
+        snprintf (option, sizeof (option), "%ld", sysconf (_SC_NPROCESSORS_ONLN));
+        if (archive_write_set_filter_option (ar, filter, "threads", option) != ARCHIVE_OK)
+        {
+            log_debug (3, "compressing archive on a single thread: %s",
+                       archive_error_string (ar));
+        }
+    }
+
+    if (archive_write_open_filename (ar, filepath) != ARCHIVE_OK)
+    {
+        log_error ("unable open archive on path '%s': %s", filepath, archive_error_string (ar));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 enum disir_status
-dx_archive_open_write (struct disir_archive *archive)
+dx_archive_open_write (struct disir_archive *archive, struct disir_archive_reader *existing)
 {
     enum disir_status status;
     char temp_archive_path[PATH_MAX];
@@ -263,13 +309,6 @@ dx_archive_open_write (struct disir_archive *archive)
         goto out;
     }
 
-    if (archive_write_add_filter_xz (ar) != ARCHIVE_OK)
-    {
-        log_error ("unable to set archive compression: %s", archive_error_string (ar));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
-    }
-
     // Seed until temp file path is unique
     while (retry_count <= 100)
     {
@@ -304,13 +343,24 @@ dx_archive_open_write (struct disir_archive *archive)
         goto out;
     }
 
-    if (archive_write_open_filename (ar, temp_archive_path) != ARCHIVE_OK)
+    // xz is compressed by the writer, in blocks that can be read on their own.
+    if (archive->da_codec != DISIR_ARCHIVE_CODEC_XZ)
     {
-        log_error ("unable open archive on path '%s': %s",
-                   temp_archive_path, archive_error_string (ar));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
+        status = open_write_filter (ar, temp_archive_path, archive->da_codec, archive->da_level);
+    }
+    else if (existing)
+    {
+        status = dx_archive_writer_open_append (ar, temp_archive_path, archive->da_level,
+                                                existing, &archive->da_append_offset,
+                                                &archive->da_writer);
     }
+    else
+    {
+        status = dx_archive_writer_open (ar, temp_archive_path, archive->da_level,
+                                         &archive->da_writer);
+    }
+    if (status != DISIR_STATUS_OK)
+        goto out;
 
     archive->da_archive = ar;
     // FALL-THROUGH
@@ -338,6 +388,10 @@ dx_archive_open_read (const char *archive_path, struct archive **archive)
     int err;
     struct archive *ar;
 
+    status = dx_archive_journal_recover (archive_path);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
     ar = archive_read_new();
     if (ar == NULL)
     {
@@ -354,7 +408,8 @@ dx_archive_open_read (const char *archive_path, struct archive **archive)
         goto out;
     }
 
-    err = archive_read_support_filter_xz (ar);
+    // Any codec the archive may have been exported with
+    err = archive_read_support_filter_all (ar);
     if (err != ARCHIVE_OK)
     {
         if (err != ARCHIVE_WARN)
@@ -392,26 +447,23 @@ out:
 //! STATIC FUNCTION
 static enum disir_status
 validate_archive_backend_entries (struct disir_archive *archive,
-                                  std::map<std::string, std::string>& extract_content,
+                                  std::map<std::string, std::string>& archive_content,
                                   const std::string backend,
                                   const toml::Value& groups)
 {
-    struct stat file_exist;
     struct disir_archive_entry archive_entry;
     toml::Value *entries_group_table;
     std::string config_entry;
 
     // Locate entries.toml within backend
-    auto iter = extract_content.find (backend + "/entries.toml");
-    if (iter == extract_content.end())
+    auto iter = archive_content.find (backend + "/entries.toml");
+    if (iter == archive_content.end())
     {
         log_error ("cannot find entries.toml for backend '%s' in map", backend);
         return DISIR_STATUS_NOT_EXIST;
     }
 
-    auto toml_filepath = iter->second;
-
-    std::ifstream entries_toml (toml_filepath.c_str());
+    std::istringstream entries_toml (iter->second);
     toml::ParseResult pr = toml::parse (entries_toml);
 
     if (!pr.valid())
@@ -442,28 +494,21 @@ validate_archive_backend_entries (struct disir_archive *archive,
             return DISIR_STATUS_WRONG_VALUE_TYPE;
         }
 
-        // Locate config on disk
+        // Locate config in archive
         for (const auto& entry : entries_group_table->as<toml::Table>())
         {
             config_entry = backend + "/" + group.as<std::string>() + "/" + entry.first;
-            iter = extract_content.find (config_entry);
-            if (iter == extract_content.end ())
+            iter = archive_content.find (config_entry);
+            if (iter == archive_content.end ())
             {
                 log_error ("cannot find config in map: %s", config_entry.c_str());
                 return DISIR_STATUS_NOT_EXIST;
             }
 
-            // Validate existence of file on disk. Necessary?
-            if (stat (iter->second.c_str(), &file_exist) != 0)
-            {
-                log_error ("file does not exist on disk: %s", config_entry.c_str());
-                return DISIR_STATUS_NOT_EXIST;
-            }
-
             archive_entry.de_backend_id = backend;
             archive_entry.de_group_id = group.as<std::string>();
             archive_entry.de_entry_id = entry.first;
-            archive_entry.de_filepath = iter->second;
+            archive_entry.de_archive_path = config_entry;
             archive_entry.de_version  = entry.second.as<std::string>();
             archive->da_config_entries->insert (archive_entry);
         }
@@ -472,24 +517,43 @@ validate_archive_backend_entries (struct disir_archive *archive,
     return DISIR_STATUS_OK;
 }
 
+//! INTERNAL API
+enum disir_status
+dx_archive_validate_implementation (const std::string& org_version,
+                                    const std::string& implementation)
+{
+    // TODO: Fix hardcoded org_version when available.
+    if (org_version != ARCHIVE_ORG_VERSION)
+    {
+        log_error ("'disir_org_version' in existing archive differs from current system");
+        return DISIR_STATUS_NO_CAN_DO;
+    }
+
+    if (implementation != libdisir_version_string)
+    {
+        log_error ("'implementation' version in existing archive differs from current system");
+        return DISIR_STATUS_NO_CAN_DO;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 enum disir_status
 dx_archive_validate (struct disir_archive *archive,
-                     std::map<std::string, std::string>& extract_content)
+                     std::map<std::string, std::string>& archive_content)
 {
     enum disir_status status;
 
     // Parse metadata.toml
-    auto it = extract_content.find (METADATA_FILENAME);
-    if (it == extract_content.end())
+    auto it = archive_content.find (METADATA_FILENAME);
+    if (it == archive_content.end())
     {
         log_error ("no metadata.toml in disir archive");
         return DISIR_STATUS_NOT_EXIST;
     }
 
-    std::string toml_filepath = it->second;
-
-    std::ifstream metadata (toml_filepath.c_str());
+    std::istringstream metadata (it->second);
     toml::ParseResult pr = toml::parse (metadata);
 
     if (!pr.valid())
@@ -514,13 +578,6 @@ dx_archive_validate (struct disir_archive *archive,
         return DISIR_STATUS_WRONG_VALUE_TYPE;
     }
 
-    // TODO: Fix hardcoded org_version when available.
-    if (strcmp (org_version->as<std::string>().c_str(), "0/1-draft"))
-    {
-        log_error ("'disir_org_version' in existing archive differs from current system");
-        return DISIR_STATUS_NO_CAN_DO;
-    }
-
     const toml::Value* implementation = root.find ("implementation");
     if (implementation == nullptr)
     {
@@ -534,10 +591,12 @@ dx_archive_validate (struct disir_archive *archive,
         return DISIR_STATUS_WRONG_VALUE_TYPE;
     }
 
-    if (strcmp (implementation->as<std::string>().c_str(), libdisir_version_string))
+    status = dx_archive_validate_implementation (org_version->as<std::string>(),
+                                                 implementation->as<std::string>());
+    if (status != DISIR_STATUS_OK)
     {
-        log_error ("'implementation' version in existing archive differs from current system");
-        return DISIR_STATUS_NO_CAN_DO;
+        // Already logged
+        return status;
     }
 
     const toml::Value* backends = root.find (ATTRIBUTE_KEY_BACKEND);
@@ -589,7 +648,7 @@ dx_archive_validate (struct disir_archive *archive,
         }
 
         // Validate entries.toml
-        status = validate_archive_backend_entries (archive, extract_content,
+        status = validate_archive_backend_entries (archive, archive_content,
                                                    id->as<std::string>(), *groups);
         if (status != DISIR_STATUS_OK)
         {
@@ -601,54 +660,10 @@ dx_archive_validate (struct disir_archive *archive,
     return DISIR_STATUS_OK;
 }
 
-//! STATIC FUNCTION
-static int
-remove_folder_and_content (const char *fpath, const struct stat *sb,
-                           int typeflag, struct FTW *ftwbuf)
-{
-    (void) sb;
-    (void) ftwbuf;
-    (void) typeflag;
-    std::string path_formatted = fpath;
-    std::string tmp_folder = path_formatted.substr(0, path_formatted.find("/", 1));
-
-    // Safeguard: Make sure path resides in tmp folder.
-    if (tmp_folder != "/tmp")
-    {
-        log_error ("tried to remove folder '%s' which is outside /tmp", fpath);
-        return DISIR_STATUS_FS_ERROR;
-    }
-
-    int ret = remove (fpath);
-
-    if (ret)
-    {
-        log_debug (5, "could not remove '%s'", fpath);
-    }
-
-    return ret;
-}
-
 //! INTERNAL API
 enum disir_status
 dx_archive_destroy (struct disir_archive *ar)
 {
-    struct stat st;
-    int ret;
-
-    // Remove temp files
-    if (ar && ar->da_extract_folder_path && stat (ar->da_extract_folder_path, &st) == 0)
-    {
-        // Use 'remove_path' duplicate as remove function may modify arguments.
-        const char *remove_path = ar->da_extract_folder_path;
-        ret = nftw (remove_path, remove_folder_and_content, 64, FTW_DEPTH | FTW_PHYS);
-        if (ret != 0)
-        {
-            // Already logged
-            return DISIR_STATUS_FS_ERROR;
-        }
-    }
-
     if (ar && ar->da_entries)
     {
         for (auto& entry : *ar->da_entries)
@@ -664,10 +679,12 @@ dx_archive_destroy (struct disir_archive *ar)
         free (ar->da_existing_path);
     if (ar && ar->da_metadata != nullptr)
         delete ar->da_metadata;
-    if (ar && ar->da_extract_folder_path)
-        free (ar->da_extract_folder_path);
     if (ar && ar->da_config_entries != nullptr)
         delete ar->da_config_entries;
+    if (ar && ar->da_members != nullptr)
+        delete ar->da_members;
+    if (ar)
+        dx_archive_writer_destroy (&ar->da_writer);
     if (ar)
         free (ar);
 
@@ -745,6 +762,439 @@ copy_file (const char *from, const char *to)
     return DISIR_STATUS_OK;
 }
 
+//! STATIC FUNCTION
+//! Populate 'dest' with 'archive_path', with the .disir extension appended
+//! if it doesn't already exist.
+static void
+append_extension (const char *archive_path, char *dest)
+{
+    const char *ext = NULL;
+
+    strcpy (dest, archive_path);
+
+    ext = strrchr (archive_path, '.');
+    if (ext == NULL || strcmp (ext, ".disir") != 0)
+    {
+        strcat (dest, ".disir");
+    }
+}
+
+//! STATIC FUNCTION
+//! Flush the directory entries of the directory holding 'path' to disk.
+static enum disir_status
+sync_directory (const char *path)
+{
+    std::string directory (path);
+    size_t slash;
+    int fd;
+    int ret;
+
+    slash = directory.find_last_of ('/');
+    if (slash == std::string::npos)
+        directory = ".";
+    else if (slash == 0)
+        directory = "/";
+    else
+        directory.resize (slash);
+
+    fd = open (directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        log_error ("unable to open directory '%s': %s", directory.c_str(), strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    ret = fsync (fd);
+    close (fd);
+    if (ret != 0)
+    {
+        log_error ("unable to sync directory '%s': %s", directory.c_str(), strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+//! Write the content of the archive at 'offset', about to be replaced, to 'journal_path'.
+//! The journal is on disk once this returns successfully.
+static enum disir_status
+journal_write (const char *journal_path, uint64_t offset, const std::string& replaced)
+{
+    FILE *journal;
+    int ret;
+
+    journal = fopen (journal_path, "wb");
+    if (journal == NULL)
+    {
+        log_error ("unable to create journal '%s': %s", journal_path, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    ret = fprintf (journal, SPLICE_JOURNAL_MAGIC " %" PRIu64 " %zu\n", offset, replaced.size());
+    if (ret < 0 ||
+        fwrite (replaced.data(), 1, replaced.size(), journal) != replaced.size() ||
+        fflush (journal) != 0 || fsync (fileno (journal)) != 0)
+    {
+        log_error ("failed to write journal '%s': %s", journal_path, strerror (errno));
+        fclose (journal);
+        remove (journal_path);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    if (fclose (journal) != 0 || sync_directory (journal_path) != DISIR_STATUS_OK)
+    {
+        log_error ("failed to write journal '%s': %s", journal_path, strerror (errno));
+        remove (journal_path);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+//! Lock 'archive_path' against splices and journal recovery in other processes.
+//! 'operation' is LOCK_SH or LOCK_EX. Returns the locked file descriptor, or -1.
+static int
+archive_lock (const char *archive_path, int operation)
+{
+    int fd;
+
+    fd = open (archive_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+
+    while (flock (fd, operation) != 0)
+    {
+        if (errno == EINTR)
+            continue;
+
+        log_error ("unable to lock archive '%s': %s", archive_path, strerror (errno));
+        close (fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+//! STATIC FUNCTION
+//! Restore 'archive' from the journal at 'journal_path', and remove the journal.
+//! The caller holds the exclusive archive lock.
+static enum disir_status
+journal_restore (FILE *archive, const char *archive_path, const char *journal_path)
+{
+    enum disir_status status;
+    FILE *journal;
+    char magic[sizeof (SPLICE_JOURNAL_MAGIC)];
+    char buffer[65536];
+    uint64_t offset;
+    uint64_t size;
+    uint64_t remaining;
+    size_t chunk;
+    off_t begin;
+    off_t end;
+
+    journal = fopen (journal_path, "rb");
+    if (journal == NULL)
+    {
+        if (errno == ENOENT)
+            return DISIR_STATUS_OK;
+
+        log_error ("unable to open journal '%s': %s", journal_path, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = DISIR_STATUS_FS_ERROR;
+
+    // The archive is not written to before the journal is complete.
+    if (fscanf (journal, "%12s %" SCNu64 " %" SCNu64, magic, &offset, &size) != 3 ||
+        strcmp (magic, SPLICE_JOURNAL_MAGIC) != 0 || fgetc (journal) != '\n' ||
+        (begin = ftello (journal)) < 0 || fseeko (journal, 0, SEEK_END) != 0 ||
+        (end = ftello (journal)) < 0 || (uint64_t) (end - begin) != size)
+    {
+        log_warn ("discarding incomplete journal '%s'", journal_path);
+        status = DISIR_STATUS_OK;
+        goto out;
+    }
+
+    log_warn ("restoring archive '%s' from an interrupted append", archive_path);
+
+    clearerr (archive);
+    if (fseeko (journal, begin, SEEK_SET) != 0 ||
+        fseeko (archive, (off_t) offset, SEEK_SET) != 0)
+    {
+        log_error ("failed to seek archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+
+    for (remaining = size; remaining > 0; remaining -= chunk)
+    {
+        chunk = remaining < sizeof (buffer) ? remaining : sizeof (buffer);
+        if (fread (buffer, 1, chunk, journal) != chunk ||
+            fwrite (buffer, 1, chunk, archive) != chunk)
+        {
+            log_error ("failed to restore archive '%s': %s", archive_path, strerror (errno));
+            goto out;
+        }
+    }
+
+    if (fflush (archive) != 0 ||
+        ftruncate (fileno (archive), (off_t) (offset + size)) != 0 ||
+        fsync (fileno (archive)) != 0)
+    {
+        log_error ("failed to restore archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+
+    status = DISIR_STATUS_OK;
+    // FALL-THROUGH
+out:
+    fclose (journal);
+
+    // Kept for the next attempt, unless the archive is restored.
+    if (status == DISIR_STATUS_OK)
+    {
+        if (remove (journal_path) != 0)
+        {
+            log_error ("unable to remove journal '%s': %s", journal_path, strerror (errno));
+            return DISIR_STATUS_FS_ERROR;
+        }
+        sync_directory (journal_path);
+    }
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Open 'archive_path' and restore it from the journal at 'journal_path', if there is one.
+//! The caller holds the exclusive archive lock.
+static enum disir_status
+journal_restore_path (const char *archive_path, const char *journal_path)
+{
+    enum disir_status status;
+    FILE *archive;
+
+    if (access (journal_path, F_OK) != 0)
+        return DISIR_STATUS_OK;
+
+    archive = fopen (archive_path, "r+b");
+    if (archive == NULL)
+    {
+        log_error ("unable to open archive '%s' to restore it: %s",
+                   archive_path, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = journal_restore (archive, archive_path, journal_path);
+    if (fclose (archive) != 0)
+    {
+        log_error ("failed to close archive '%s': %s", archive_path, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+    }
+
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_journal_recover (const char *archive_path)
+{
+    enum disir_status status;
+    std::string journal_path (archive_path);
+    int lock;
+
+    journal_path += SPLICE_JOURNAL_SUFFIX;
+
+    // A missing or unreadable archive is left to the caller to report.
+    lock = archive_lock (archive_path, LOCK_SH);
+    if (lock == -1)
+        return DISIR_STATUS_OK;
+
+    // The journal of a splice in progress is gone by the time its lock is released.
+    if (access (journal_path.c_str(), F_OK) != 0)
+    {
+        close (lock);
+        return DISIR_STATUS_OK;
+    }
+
+    if (flock (lock, LOCK_EX) != 0)
+    {
+        log_error ("unable to lock archive '%s': %s", archive_path, strerror (errno));
+        close (lock);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = journal_restore_path (archive_path, journal_path.c_str());
+    close (lock);
+
+    return status;
+}
+
+//! STATIC FUNCTION
+//! Overwrite 'archive_path' from 'offset' with the content of 'temp_archive_path'.
+//! The content replaced is journaled beforehand, and restored should the splice fail.
+static enum disir_status
+splice_file (const char *temp_archive_path, const char *archive_path, uint64_t offset)
+{
+    enum disir_status status;
+    std::string journal_path (archive_path);
+    FILE *archive = NULL;
+    FILE *temp = NULL;
+    std::string replaced;
+    char buffer[65536];
+    uint64_t written;
+    size_t size;
+    off_t end;
+    int lock;
+    bool journaled = false;
+
+    journal_path += SPLICE_JOURNAL_SUFFIX;
+    status = DISIR_STATUS_FS_ERROR;
+
+    // Held until the journal is removed, such that it is never mistaken for an interrupted one.
+    lock = archive_lock (archive_path, LOCK_EX);
+    if (lock == -1)
+    {
+        log_error ("unable to open archive '%s': %s", archive_path, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    // Left behind by an earlier splice that could not be restored.
+    status = journal_restore_path (archive_path, journal_path.c_str());
+    if (status != DISIR_STATUS_OK)
+        goto out;
+    status = DISIR_STATUS_FS_ERROR;
+
+    archive = fopen (archive_path, "r+b");
+    if (archive == NULL)
+    {
+        log_error ("unable to open archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+
+    temp = fopen (temp_archive_path, "rb");
+    if (temp == NULL)
+    {
+        log_error ("unable to open archive '%s': %s", temp_archive_path, strerror (errno));
+        goto out;
+    }
+
+    if (fseeko (archive, 0, SEEK_END) != 0 || (end = ftello (archive)) < 0 ||
+        (uint64_t) end < offset)
+    {
+        log_error ("archive '%s' has been truncated", archive_path);
+        goto out;
+    }
+
+    replaced.resize ((uint64_t) end - offset);
+    if (fseeko (archive, (off_t) offset, SEEK_SET) != 0 ||
+        fread (&replaced[0], 1, replaced.size(), archive) != replaced.size() ||
+        fseeko (archive, (off_t) offset, SEEK_SET) != 0)
+    {
+        log_error ("failed to read archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+
+    status = journal_write (journal_path.c_str(), offset, replaced);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+    journaled = true;
+    status = DISIR_STATUS_FS_ERROR;
+
+    written = 0;
+    while ((size = fread (buffer, 1, sizeof (buffer), temp)) > 0)
+    {
+        if (fwrite (buffer, 1, size, archive) != size)
+            break;
+        written += size;
+    }
+
+    if (ferror (temp) || ferror (archive) || fflush (archive) != 0 ||
+        ftruncate (fileno (archive), (off_t) (offset + written)) != 0 ||
+        fsync (fileno (archive)) != 0)
+    {
+        log_error ("failed to write archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+
+    if (fclose (archive) != 0)
+    {
+        archive = NULL;
+        log_error ("failed to close archive '%s': %s", archive_path, strerror (errno));
+        goto out;
+    }
+    archive = NULL;
+
+    // The append is complete once the journal is gone.
+    if (remove (journal_path.c_str()) != 0)
+    {
+        log_error ("unable to remove journal '%s': %s", journal_path.c_str(), strerror (errno));
+        goto out;
+    }
+    journaled = false;
+    sync_directory (journal_path.c_str());
+
+    status = DISIR_STATUS_OK;
+    // FALL-THROUGH
+out:
+    if (temp)
+        fclose (temp);
+    if (archive)
+        fclose (archive);
+
+    // Put back what was there. Left to the next open of the archive if this fails.
+    if (journaled && journal_restore_path (archive_path, journal_path.c_str()) != DISIR_STATUS_OK)
+    {
+        log_error ("failed to restore archive '%s' from journal '%s'",
+                   archive_path, journal_path.c_str());
+    }
+    close (lock);
+
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_archive_disk_splice (const char *new_archive_path, const char *existing_archive_path,
+                        const char *temp_archive_path, uint64_t offset)
+{
+    enum disir_status status;
+    char archive_path_with_extension[4096];
+
+    append_extension (new_archive_path, archive_path_with_extension);
+
+    // Appending in place - only the trailer onwards is written.
+    if (strcmp (existing_archive_path, archive_path_with_extension) == 0)
+    {
+        return splice_file (temp_archive_path, existing_archive_path, offset);
+    }
+
+    // Exporting the result to a new location
+    status = copy_file (existing_archive_path, archive_path_with_extension);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_error ("failed to copy archive to '%s': %s", archive_path_with_extension,
+                                                         strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = splice_file (temp_archive_path, archive_path_with_extension, offset);
+    if (status != DISIR_STATUS_OK)
+    {
+        remove (archive_path_with_extension);
+        return status;
+    }
+
+    if (remove (existing_archive_path) != 0)
+    {
+        log_error ("failed to remove existing archive in '%s': %s", existing_archive_path,
+                                                                    strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! INTERNAL API
 enum disir_status
 dx_archive_disk_append (const char *new_archive_path, const char *existing_archive_path,
@@ -754,18 +1204,10 @@ dx_archive_disk_append (const char *new_archive_path, const char *existing_archi
     int ret;
     char backup_path[PATH_MAX];
     char archive_path_with_extension[4096];
-    const char *ext = NULL;
 
-    strcpy (archive_path_with_extension, new_archive_path);
+    append_extension (new_archive_path, archive_path_with_extension);
     backup_path[0] = '\0';
 
-    // Append extension if it doesn't already exists
-    ext = strrchr (new_archive_path, '.');
-    if (ext == NULL || strcmp (ext, ".disir") != 0)
-    {
-        strcat (archive_path_with_extension, ".disir");
-    }
-
     // CASE 1: Finalizing a new archive to given location
     if (existing_archive_path == NULL)
     {
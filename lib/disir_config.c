@@ -3,11 +3,16 @@
 
 #include <disir/disir.h>
 
+#include "arena.h"
 #include "config.h"
+#include "collection.h"
 #include "disir_private.h"
+#include "keyval.h"
 #include "log.h"
 #include "mqueue.h"
 #include "multimap.h"
+#include "section.h"
+#include "stats.h"
 
 
 // STATIC INTERNAL
@@ -30,6 +35,7 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_timer timer;
 
     plugin = NULL;
 
@@ -68,7 +74,7 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
         {
             log_warn ("Plugin '%s' (id %s) failed to query for entry '%s': %s",
                       entry->pi_io_id, entry->pi_plugin.dp_name,
-                      entry_id), disir_status_string (status);
+                      entry_id, disir_status_string (status));
             entry = entry->next;
             continue;
         }
@@ -82,8 +88,10 @@ disir_config_read (struct disir_instance *instance, const char *group_id, const
         if (plugin->pi_plugin.dp_config_read)
         {
             *config = NULL;
+            dx_stats_begin (instance, &timer);
             status = plugin->pi_plugin.dp_config_read (instance, &plugin->pi_plugin,
                                                        entry_id, mold, config);
+            dx_stats_end (&timer, DISIR_STATS_CONFIG_READ, status);
         }
         else
         {
@@ -110,6 +118,7 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
     int entry_id_length;
+    struct dx_stats_timer timer;
 
     plugin = NULL;
 
@@ -150,8 +159,10 @@ disir_config_write (struct disir_instance *instance, const char *group_id, const
     {
         if (plugin->pi_plugin.dp_config_write)
         {
+            dx_stats_begin (instance, &timer);
             status = plugin->pi_plugin.dp_config_write (instance, &plugin->pi_plugin,
                                                         entry_id, config);
+            dx_stats_end (&timer, DISIR_STATS_CONFIG_WRITE, status);
         }
         else
         {
@@ -252,6 +263,7 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
     struct disir_entry *queue;
     struct disir_entry *query;
     struct disir_entry *current;
+    struct dx_stats_timer timer;
 
     queue = NULL;
     query = NULL;
@@ -291,8 +303,10 @@ disir_config_entries (struct disir_instance *instance, const char *group_id,
             continue;
         }
 
+        dx_stats_begin (instance, &timer);
         status = entry->pi_plugin.dp_config_entries (instance,
                                                      &entry->pi_plugin, &query);
+        dx_stats_end (&timer, DISIR_STATS_CONFIG_ENTRIES, status);
         if (status != DISIR_STATUS_OK)
         {
             log_warn ("Plugin '%s' queried for config entries failed with status: %s",
@@ -404,6 +418,228 @@ disir_config_query (struct disir_instance *instance, const char *group_id,
     return status;
 }
 
+//! STATIC API
+//! Return the element storage of a CONFIG or SECTION context, NULL otherwise.
+static struct disir_element_storage *
+config_element_storage (struct disir_context *context)
+{
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_CONFIG:
+        return context->cx_config->cf_elements;
+    case DISIR_CONTEXT_SECTION:
+        return context->cx_section->se_elements;
+    default:
+        return NULL;
+    }
+}
+
+//! STATIC API
+//! Copy every element stored in source into the constructing destination context.
+static enum disir_status
+config_freeze_copy (struct disir_context *destination, struct disir_context *source)
+{
+    enum disir_status status;
+    struct disir_collection *collection;
+    struct disir_context *element;
+    struct disir_context *copy;
+    struct disir_value *value;
+    const char *name;
+    int32_t name_size;
+
+    collection = NULL;
+    element = NULL;
+    copy = NULL;
+
+    status = dx_element_storage_get_all (config_element_storage (source), &collection);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    while (dc_collection_next (collection, &element) == DISIR_STATUS_OK)
+    {
+        status = dc_begin (destination, dc_context_type (element), &copy);
+        if (status != DISIR_STATUS_OK)
+        {
+            goto error;
+        }
+
+        dc_get_name (element, &name, &name_size);
+        status = dc_set_name (copy, name, name_size);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
+        {
+            goto error;
+        }
+
+        if (dc_context_type (element) == DISIR_CONTEXT_KEYVAL)
+        {
+            // A keyval without mold equivalent has no type until its value is set.
+            value = &element->cx_keyval->kv_value;
+            copy->cx_keyval->kv_value.dv_type = value->dv_type;
+            if (value->dv_type == DISIR_VALUE_TYPE_STRING ||
+                value->dv_type == DISIR_VALUE_TYPE_ENUM)
+            {
+                status = dx_value_set_string_arena (dx_context_arena (copy),
+                                                    &copy->cx_keyval->kv_value,
+                                                    value->dv_string, value->dv_size);
+            }
+            else if (value->dv_type != DISIR_VALUE_TYPE_UNKNOWN)
+            {
+                status = dx_value_copy (&copy->cx_keyval->kv_value, value);
+            }
+        }
+        else
+        {
+            status = config_freeze_copy (copy, element);
+        }
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
+        {
+            goto error;
+        }
+
+        status = dc_finalize (&copy);
+        if (status == DISIR_STATUS_INVALID_CONTEXT)
+        {
+            // The source element is invalid as well - keep it, as the source does.
+            dc_putcontext (&copy);
+        }
+        else if (status != DISIR_STATUS_OK)
+        {
+            goto error;
+        }
+
+        dc_putcontext (&element);
+    }
+
+    status = DISIR_STATUS_OK;
+    // FALL-THROUGH
+error:
+    if (copy)
+    {
+        dc_destroy (&copy);
+    }
+    if (element)
+    {
+        dc_putcontext (&element);
+    }
+    if (collection)
+    {
+        dc_collection_finished (&collection);
+    }
+
+    return status;
+}
+
+//! STATIC API
+//! Set or clear the FROZEN state on every element below context, but not on context itself.
+//!
+//! References held by collections are not counted on frozen contexts. The reference
+//! acquired by the element storage collection is handed over accordingly, such that
+//! refcounts are balanced once dc_collection_finished() is called.
+static void
+config_set_frozen (struct disir_context *context, unsigned int frozen)
+{
+    struct disir_collection *collection;
+    struct disir_context *element;
+    int32_t i;
+
+    collection = NULL;
+
+    if (dx_element_storage_get_all (config_element_storage (context),
+                                    &collection) != DISIR_STATUS_OK)
+    {
+        return;
+    }
+
+    for (i = 0; i < collection->cc_numentries; i++)
+    {
+        element = collection->cc_collection[i];
+
+        config_set_frozen (element, frozen);
+
+        if (frozen)
+        {
+            // The element storage still holds a reference.
+            dx_context_decref (&element);
+            element->CONTEXT_STATE_FROZEN = 1;
+        }
+        else
+        {
+            element->CONTEXT_STATE_FROZEN = 0;
+            dx_context_incref (element);
+        }
+    }
+
+    dc_collection_finished (&collection);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_config_freeze (struct disir_config *config, struct disir_config **snapshot)
+{
+    enum disir_status status;
+    struct disir_context *context;
+    struct disir_version version;
+
+    context = NULL;
+
+    if (config == NULL || snapshot == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). config (%p), snapshot (%p)",
+                      config, snapshot);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("config (%p) snapshot (%p)", config, snapshot);
+
+    status = dc_config_begin (config->cf_mold, &context);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    // The snapshot is never modified - allocate the entire tree in one go.
+    status = dc_enable_arena (context);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    dc_config_get_version (config, &version);
+    status = dc_set_version (context, &version);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    status = config_freeze_copy (context, config->cf_context);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    status = dc_config_finalize (&context, snapshot);
+    if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+    {
+        goto error;
+    }
+
+    config_set_frozen ((*snapshot)->cf_context, 1);
+    (*snapshot)->cf_context->CONTEXT_STATE_FROZEN = 1;
+
+    status = DISIR_STATUS_OK;
+    // FALL-THROUGH
+error:
+    if (context)
+    {
+        dc_destroy (&context);
+    }
+
+    TRACE_EXIT ("%s", disir_status_string (status));
+    return status;
+}
+
 //! PUBLIC API
 enum disir_status
 disir_config_finished (struct disir_config **config)
@@ -417,6 +653,11 @@ disir_config_finished (struct disir_config **config)
     TRACE_ENTER ("config (%p)", *config);
 
     context = (*config)->cf_context;
+    if (context->CONTEXT_STATE_FROZEN)
+    {
+        context->CONTEXT_STATE_FROZEN = 0;
+        config_set_frozen (context, 0);
+    }
     status = dc_destroy (&context);
     if (status == DISIR_STATUS_OK)
         *config = NULL;
@@ -431,6 +672,7 @@ disir_config_valid (struct disir_config *config, struct disir_collection **colle
 {
     enum disir_status status;
     struct disir_collection *col;
+    struct dx_stats_timer timer;
 
     TRACE_ENTER ("config (%p) collection (%p)", config, collection);
 
@@ -441,23 +683,36 @@ disir_config_valid (struct disir_config *config, struct disir_collection **colle
         goto error;
     }
 
-    if (collection)
+    // Only contexts modified since the config was last validated are validated again.
+    if (config->cf_context->CONTEXT_STATE_DIRTY || config->cf_context->CONTEXT_STATE_DIRTY_ELEMENTS)
     {
-        col = dc_collection_create ();
+        dx_stats_begin (NULL, &timer);
+        status = dx_validate_dirty (config->cf_context);
+        dx_stats_end (&timer, DISIR_STATS_VALIDATE, status);
     }
 
-    status = dx_invalid_elements (config->cf_context, col);
-
-    if (collection)
+    if (collection == NULL)
     {
-        if (dc_collection_size (col))
+        // Every context has its validity summarized in the state of the config.
+        status = DISIR_STATUS_OK;
+        if (config->cf_context->CONTEXT_STATE_INVALID
+            || config->cf_context->CONTEXT_STATE_ELEMENTS_INVALID)
         {
-            *collection = col;
-        }
-        else
-        {
-            dc_collection_finished (&col);
+            status = DISIR_STATUS_INVALID_CONTEXT;
         }
+        goto error;
+    }
+
+    col = dc_collection_create ();
+    status = dx_invalid_elements (config->cf_context, col);
+
+    if (dc_collection_size (col))
+    {
+        *collection = col;
+    }
+    else
+    {
+        dc_collection_finished (&col);
     }
 
     // FALL-THROUGH
@@ -0,0 +1,175 @@
+// external public includes
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// public disir interface
+#include <disir/disir.h>
+
+// private
+#include "disir_private.h"
+#include "log.h"
+
+
+//! State shared by every thread participating in a disir_config_read_many() call.
+struct read_many
+{
+    const char                      *rm_group_id;
+    const char * const              *rm_entries;
+    size_t                          rm_entries_count;
+    struct disir_config             **rm_configs;
+    enum disir_status               *rm_statuses;
+
+    //! Index of the next entry to be read. Idle threads claim entries from it,
+    //! such that the threads stay busy until every entry is read.
+    atomic_size_t                   rm_next;
+};
+
+//! A single thread reading entries, with its own worker instance.
+struct read_many_worker
+{
+    struct read_many                *rw_shared;
+    struct disir_instance           *rw_instance;
+    pthread_t                       rw_thread;
+};
+
+//! STATIC API
+static void *
+read_many_worker (void *arg)
+{
+    struct read_many_worker *worker;
+    struct read_many *shared;
+    size_t index;
+
+    worker = arg;
+    shared = worker->rw_shared;
+
+    while (1)
+    {
+        index = atomic_fetch_add_explicit (&shared->rm_next, 1, memory_order_relaxed);
+        if (index >= shared->rm_entries_count)
+            break;
+
+        shared->rm_configs[index] = NULL;
+        shared->rm_statuses[index] = disir_config_read (worker->rw_instance,
+                                                        shared->rm_group_id,
+                                                        shared->rm_entries[index],
+                                                        NULL, &shared->rm_configs[index]);
+    }
+
+    return NULL;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_config_read_many (struct disir_instance *instance, const char *group_id,
+                        const char * const *entries, size_t entries_count,
+                        struct disir_config **configs, enum disir_status *statuses,
+                        int nthreads)
+{
+    enum disir_status status;
+    struct read_many shared;
+    struct read_many_worker *workers;
+    int started;
+    int failed;
+    size_t i;
+
+    if (instance == NULL || group_id == NULL || entries == NULL
+        || configs == NULL || statuses == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p) group_id (%p) entries (%p)"
+                      " configs (%p) statuses (%p)",
+                      instance, group_id, entries, configs, statuses);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) group_id (%s) entries_count (%zu) nthreads (%d)",
+                 instance, group_id, entries_count, nthreads);
+
+    if (nthreads <= 0)
+    {
+        nthreads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+    }
+    if ((size_t) nthreads > entries_count)
+    {
+        nthreads = (int) entries_count;
+    }
+    if (nthreads < 1)
+    {
+        nthreads = 1;
+    }
+
+    shared.rm_group_id = group_id;
+    shared.rm_entries = entries;
+    shared.rm_entries_count = entries_count;
+    shared.rm_configs = configs;
+    shared.rm_statuses = statuses;
+    atomic_init (&shared.rm_next, 0);
+
+    workers = calloc (nthreads, sizeof (struct read_many_worker));
+    if (workers == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    // The calling thread is worker 0. Read with fewer threads if we cannot get them all.
+    for (started = 0; started < nthreads; started++)
+    {
+        workers[started].rw_shared = &shared;
+        status = dx_instance_worker_create (instance, &workers[started].rw_instance);
+        if (status != DISIR_STATUS_OK)
+            break;
+
+        if (started == 0)
+            continue;
+
+        if (pthread_create (&workers[started].rw_thread, NULL,
+                            read_many_worker, &workers[started]) != 0)
+        {
+            log_warn ("failed to start read thread %d - continuing with fewer threads.", started);
+            dx_instance_worker_destroy (&workers[started].rw_instance);
+            break;
+        }
+    }
+
+    if (started == 0)
+    {
+        // Not even the calling thread got a worker instance.
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    read_many_worker (&workers[0]);
+
+    for (i = 0; i < (size_t) started; i++)
+    {
+        if (i != 0)
+        {
+            pthread_join (workers[i].rw_thread, NULL);
+        }
+        dx_instance_worker_destroy (&workers[i].rw_instance);
+    }
+
+    disir_error_clear (instance);
+    failed = 0;
+    for (i = 0; i < entries_count; i++)
+    {
+        if (statuses[i] != DISIR_STATUS_OK)
+            failed++;
+    }
+    if (failed)
+    {
+        disir_error_set (instance,
+                         "%d of %zu entries in group '%s' were invalid or failed to read",
+                         failed, entries_count, group_id);
+    }
+
+    status = DISIR_STATUS_OK;
+out:
+    free (workers);
+
+    TRACE_EXIT ("%s", disir_status_string (status));
+    return status;
+}
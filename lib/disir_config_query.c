@@ -909,3 +909,263 @@ dc_config_set_keyval_integer (struct disir_context *context, int64_t value,
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
+
+//! STATIC API
+//! Invoke config_set_keyval_generic with a preformatted query string.
+static enum disir_status
+config_set_keyval_query (struct disir_context *parent, enum disir_value_type type,
+                         const char *value_string, uint8_t value_boolean, int64_t value_integer,
+                         double value_float, const char *query, ...)
+{
+    enum disir_status status;
+    va_list args;
+
+    va_start (args, query);
+    status = config_set_keyval_generic (parent, type, query, args, value_string,
+                                        value_boolean, value_integer, value_float);
+    va_end (args);
+
+    return status;
+}
+
+//! STATIC API
+static enum disir_status
+config_get_keyval_compiled (struct disir_config *config, enum disir_value_type type,
+                            struct disir_query *query,
+                            const char **value_string, uint8_t *value_boolean,
+                            int64_t *value_integer, double *value_float)
+{
+    enum disir_status status;
+    struct disir_context *context_config;
+    struct disir_context *context;
+
+    if (config == NULL || query == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (config (%p), query (%p))", config, query);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (value_string == NULL && value_boolean == NULL &&
+        value_integer == NULL && value_float == NULL)
+    {
+        log_debug (0, "%s invoked with NULL value pointer", dx_value_type_string (type));
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    context_config = dc_config_getcontext (config);
+    if (context_config == NULL)
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dx_query_compiled_resolve (context_config, query, &context);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = get_value_generic (context, type, value_string,
+                                    value_boolean, value_integer, value_float);
+        dc_putcontext (&context);
+    }
+
+    dc_putcontext (&context_config);
+    return status;
+}
+
+//! STATIC API
+static enum disir_status
+config_set_keyval_compiled (struct disir_config *config, enum disir_value_type type,
+                            struct disir_query *query,
+                            const char *value_string, uint8_t value_boolean,
+                            int64_t value_integer, double value_float)
+{
+    enum disir_status status;
+    struct disir_context *context_config;
+    struct disir_context *context;
+
+    if (config == NULL || query == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (config (%p), query (%p))", config, query);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (value_string == NULL &&
+         (type == DISIR_VALUE_TYPE_STRING || type == DISIR_VALUE_TYPE_ENUM))
+    {
+        log_debug (0, "value_string invoked with NULL pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    context_config = dc_config_getcontext (config);
+    if (context_config == NULL)
+    {
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dx_query_compiled_resolve (context_config, query, &context);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = set_value_generic (context, type, value_string, value_boolean,
+                                    value_integer, value_float);
+        if (status != DISIR_STATUS_OK)
+        {
+            dx_context_transfer_logwarn (context_config, context);
+        }
+        dc_putcontext (&context);
+    }
+    else if (status == DISIR_STATUS_NOT_EXIST)
+    {
+        // Creating the keyval (and its ancestors) is rare. Take the regular path.
+        status = config_set_keyval_query (context_config, type, value_string, value_boolean,
+                                          value_integer, value_float, "%s", query->dq_string);
+    }
+
+    dc_putcontext (&context_config);
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_get_keyval_string_compiled (struct disir_config *config, const char **value,
+                                         struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_get_keyval_compiled (config, DISIR_VALUE_TYPE_STRING, query,
+                                         value, NULL, NULL, NULL);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_set_keyval_string_compiled (struct disir_config *config, const char *value,
+                                         struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_set_keyval_compiled (config, DISIR_VALUE_TYPE_STRING, query,
+                                         value, 0, 0, 0);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_get_keyval_enum_compiled (struct disir_config *config, const char **value,
+                                       struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_get_keyval_compiled (config, DISIR_VALUE_TYPE_ENUM, query,
+                                         value, NULL, NULL, NULL);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_set_keyval_enum_compiled (struct disir_config *config, const char *value,
+                                       struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_set_keyval_compiled (config, DISIR_VALUE_TYPE_ENUM, query,
+                                         value, 0, 0, 0);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_get_keyval_boolean_compiled (struct disir_config *config, uint8_t *value,
+                                          struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_get_keyval_compiled (config, DISIR_VALUE_TYPE_BOOLEAN, query,
+                                         NULL, value, NULL, NULL);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_set_keyval_boolean_compiled (struct disir_config *config, uint8_t value,
+                                          struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_set_keyval_compiled (config, DISIR_VALUE_TYPE_BOOLEAN, query,
+                                         NULL, value, 0, 0);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_get_keyval_float_compiled (struct disir_config *config, double *value,
+                                        struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_get_keyval_compiled (config, DISIR_VALUE_TYPE_FLOAT, query,
+                                         NULL, NULL, NULL, value);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_set_keyval_float_compiled (struct disir_config *config, double value,
+                                        struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_set_keyval_compiled (config, DISIR_VALUE_TYPE_FLOAT, query,
+                                         NULL, 0, 0, value);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_get_keyval_integer_compiled (struct disir_config *config, int64_t *value,
+                                          struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_get_keyval_compiled (config, DISIR_VALUE_TYPE_INTEGER, query,
+                                         NULL, NULL, value, NULL);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
+
+//! PUBLIC API: high-level
+enum disir_status
+disir_config_set_keyval_integer_compiled (struct disir_config *config, int64_t value,
+                                          struct disir_query *query)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("");
+    status = config_set_keyval_compiled (config, DISIR_VALUE_TYPE_INTEGER, query,
+                                         NULL, 0, value, 0);
+    TRACE_EXIT ("%s", disir_status_string (status));
+
+    return status;
+}
@@ -7,9 +7,12 @@
 #include "archive_private.h"
 extern "C" {
 #include "disir_private.h"
+#include "binary/binary_format.h"
 #include "log.h"
 }
 #include <limits.h>
+#include <unistd.h>
+#include <inttypes.h>
 
 // external libs
 #include <archive.h>
@@ -17,24 +20,27 @@ extern "C" {
 
 // cpp
 #include <map>
-#include <fstream>
+#include <sstream>
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
 
 
 // STATIC FUNCTION
 static enum disir_status
-copy_metadata (struct disir_archive *archive, std::map<std::string, std::string>& extract_content)
+copy_metadata (struct disir_archive *archive, std::map<std::string, std::string>& archive_content)
 {
-    auto it = extract_content.find (METADATA_FILENAME);
-    if (it == extract_content.end())
+    auto it = archive_content.find (METADATA_FILENAME);
+    if (it == archive_content.end())
     {
         log_error ("no metadata.toml in disir archive");
         return DISIR_STATUS_NOT_EXIST;
     }
 
-    std::string toml_filepath = it->second;
-
-    std::ifstream metadata (toml_filepath.c_str());
+    std::istringstream metadata (it->second);
     toml::ParseResult pr = toml::parse (metadata);
 
     if (!pr.valid())
@@ -51,16 +57,14 @@ copy_metadata (struct disir_archive *archive, std::map<std::string, std::string>
     {
         auto id = entry.find (ATTRIBUTE_KEY_ID);
 
-        auto iter = extract_content.find (id->as<std::string>() + "/entries.toml");
-        if (iter == extract_content.end())
+        auto iter = archive_content.find (id->as<std::string>() + "/entries.toml");
+        if (iter == archive_content.end())
         {
             log_error ("cannot find entries.toml for backend '%s' in map", id->as<std::string>());
             return DISIR_STATUS_NOT_EXIST;
         }
 
-        auto entries_toml_filepath = iter->second;
-
-        std::ifstream entries_toml (entries_toml_filepath.c_str());
+        std::istringstream entries_toml (iter->second);
         toml::ParseResult pr = toml::parse (entries_toml);
 
         if (!pr.valid())
@@ -83,16 +87,11 @@ copy_metadata (struct disir_archive *archive, std::map<std::string, std::string>
 
 //! STATIC FUNCTION
 static enum disir_status
-serialize_entry_index (struct disir_archive *archive, struct disir_config *config,
+serialize_entry_index (struct disir_archive *archive, const char *version_string,
                        const char *group_id, const char *entry_id, const char *plugin_name)
 {
-    enum disir_status status;
-    struct disir_version config_version;
-    struct disir_context *context_config = NULL;
     toml::Value *plugin_entries;
     toml::Value *group_entries;
-    char buf[500];
-    char *version_string;
 
     auto it = archive->da_entries->find (plugin_name);
     if (it == archive->da_entries->end())
@@ -112,28 +111,37 @@ serialize_entry_index (struct disir_archive *archive, struct disir_config *confi
         group_entries = plugin_entries->setChild (group_id, toml::Table());
     }
 
+    group_entries->setChild (entry_id, version_string);
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC FUNCTION
+static enum disir_status
+config_version_string (struct disir_config *config, char *buf, size_t size)
+{
+    enum disir_status status;
+    struct disir_version config_version;
+    struct disir_context *context_config = NULL;
+
     context_config = dc_config_getcontext (config);
     if (context_config == NULL)
     {
-        status = DISIR_STATUS_INTERNAL_ERROR;
-        goto out;
+        return DISIR_STATUS_INTERNAL_ERROR;
     }
 
     status = dc_get_version (context_config, &config_version);
     if (status != DISIR_STATUS_OK)
         goto out;
 
-    version_string = dc_version_string (buf, 500, &config_version);
-    if (version_string == NULL)
+    if (dc_version_string (buf, size, &config_version) == NULL)
     {
         status = DISIR_STATUS_INVALID_CONTEXT;
         goto out;
     }
-    group_entries->setChild (entry_id, version_string);
     // FALL-THROUGH
 out:
-    if (context_config)
-        dc_putcontext (&context_config);
+    dc_putcontext (&context_config);
 
     return status;
 }
@@ -174,71 +182,170 @@ populate_archive_entry (struct archive *archive, struct archive_entry *entry,
 }
 
 //! STATIC FUNCTION
+//! Write buffer as the member archive_entry_name, recording where it is located.
 static enum disir_status
-append_config (struct disir_instance *instance, struct archive *archive,
-               const char *filepath, const char *archive_entry_name)
+append_buffer (struct disir_archive *archive, const char *buffer, size_t size,
+               const char *archive_entry_name)
 {
     enum disir_status status;
     struct archive_entry *entry = NULL;
-    struct stat st;
-    FILE *infile = NULL;
-    char buf[8192];
-    int read;
-
-    status = fslib_stat_filepath (instance, filepath, &st);
-    if (status != DISIR_STATUS_OK)
-    {
-        return status;
-    }
+    struct disir_archive_entry member;
 
     entry = archive_entry_new();
     if (entry == NULL)
     {
         log_debug (3, "error creating new archive entry: %s",
-                       archive_errno (archive));
+                       archive_error_string (archive->da_archive));
         return DISIR_STATUS_NO_MEMORY;
     }
 
-    status = populate_archive_entry (archive, entry, archive_entry_name, st.st_size);
+    // Members are only located by offset in archives compressed by the writer (xz).
+    member.de_offset = 0;
+    if (archive->da_writer)
+    {
+        status = dx_archive_writer_member_begin (archive->da_writer, &member.de_offset);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+    }
+
+    status = populate_archive_entry (archive->da_archive, entry, archive_entry_name, size);
     if (status != DISIR_STATUS_OK)
         goto out;
 
-    infile = fopen (filepath, "r");
-    if (infile == NULL)
+    if (size > 0 && archive_write_data (archive->da_archive, buffer, size) < 0)
     {
-        log_error ("unable to open %s (%s)", filepath, strerror (errno));
+        log_error ("error writing to archive: %s", archive_error_string (archive->da_archive));
         status = DISIR_STATUS_FS_ERROR;
         goto out;
     }
 
-    do
+    if (archive_write_finish_entry (archive->da_archive) != ARCHIVE_OK)
     {
-        read = fread (buf, 1, sizeof (buf), infile);
-        if (read == 0)
-            break;
+        log_error ("could not finish archive write entry: %s",
+                   archive_error_string (archive->da_archive));
+        status = DISIR_STATUS_FS_ERROR;
+        goto out;
+    }
 
-        if (archive_write_data (archive, buf, read) < 0)
-        {
-            log_error ("error writing to archive %s", archive_errno (archive));
-            status = DISIR_STATUS_FS_ERROR;
-            goto out;
-        }
-    } while (1);
+    member.de_archive_path = archive_entry_name;
+    member.de_size = size;
+    member.de_hash = binary_checksum (buffer, size);
+    (*archive->da_members)[archive_entry_name] = member;
+    // FALL-THROUGH
+out:
+    archive_entry_free (entry);
+
+    return status;
+}
+
+//! A config entry serialized into memory, waiting for its turn to be written to the archive.
+struct export_slot
+{
+    const char          *es_entry_id;
+    //! Set once the entry is serialized, successfully or not.
+    bool                es_done;
+    enum disir_status   es_status;
+    char                *es_buffer;
+    size_t              es_size;
+    char                es_version[500];
+    //! Error message of the instance that failed to serialize the entry.
+    std::string         es_error;
+};
+
+//! State shared by the threads serializing entries for dx_archive_config_entries_write().
+//! The calling thread writes the serialized entries to the archive, in order.
+struct export_pipeline
+{
+    struct disir_register_plugin    *ep_plugin;
+    const char                      *ep_group_id;
+    std::vector<struct export_slot> ep_slots;
+    //! Index of the next entry to be serialized.
+    size_t                          ep_next;
+    //! Index of the next entry to be written to the archive.
+    size_t                          ep_written;
+    //! Number of entries that may be serialized ahead of the archive writer.
+    size_t                          ep_window;
+    //! Set when the archive writer stops. The remaining entries are left alone.
+    bool                            ep_abort;
+    std::mutex                      ep_mutex;
+    std::condition_variable         ep_cond;
+};
+
+//! STATIC FUNCTION
+//! Read the config of slot and serialize it into an in-memory buffer.
+static void
+serialize_config_entry (struct disir_instance *instance, struct export_pipeline *pipeline,
+                        struct export_slot *slot)
+{
+    enum disir_status status;
+    struct disir_config *config = NULL;
+    FILE *stream = NULL;
+
+    status = disir_config_read (instance, pipeline->ep_group_id, slot->es_entry_id,
+                                NULL, &config);
+    if (status != DISIR_STATUS_OK)
+        goto out;
 
-    if (archive_write_finish_entry (archive) != ARCHIVE_OK)
+    status = config_version_string (config, slot->es_version, sizeof (slot->es_version));
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    stream = open_memstream (&slot->es_buffer, &slot->es_size);
+    if (stream == NULL)
     {
-        log_error ("could not finish archive write entry %s", archive_errno (archive));
-        status = DISIR_STATUS_FS_ERROR;
+        log_error ("unable to open memory stream for config entry %s", slot->es_entry_id);
+        status = DISIR_STATUS_NO_MEMORY;
         goto out;
     }
+
+    status = pipeline->ep_plugin->dp_config_fd_write (instance, config, stream);
     // FALL-THROUGH
 out:
-    if (entry)
-        archive_entry_free (entry);
-    if (infile)
-        fclose (infile);
+    // The buffer is only complete once the stream is closed.
+    if (stream)
+        fclose (stream);
 
-    return status;
+    if (status != DISIR_STATUS_OK)
+    {
+        free (slot->es_buffer);
+        slot->es_buffer = NULL;
+        if (disir_error (instance))
+            slot->es_error = disir_error (instance);
+    }
+
+    if (config)
+        disir_config_finished (&config);
+
+    slot->es_status = status;
+}
+
+//! STATIC FUNCTION
+//! Serialize entries until there are none left, staying within the window
+//! of entries ahead of the archive writer.
+static void
+export_worker (struct disir_instance *instance, struct export_pipeline *pipeline)
+{
+    std::unique_lock<std::mutex> lock (pipeline->ep_mutex);
+
+    while (1)
+    {
+        pipeline->ep_cond.wait (lock, [pipeline] {
+            return pipeline->ep_abort
+                   || pipeline->ep_next >= pipeline->ep_slots.size()
+                   || pipeline->ep_next < pipeline->ep_written + pipeline->ep_window;
+        });
+        if (pipeline->ep_abort || pipeline->ep_next >= pipeline->ep_slots.size())
+            break;
+
+        auto& slot = pipeline->ep_slots[pipeline->ep_next++];
+
+        lock.unlock();
+        serialize_config_entry (instance, pipeline, &slot);
+        lock.lock();
+
+        slot.es_done = true;
+        pipeline->ep_cond.notify_all();
+    }
 }
 
 //! INTERNAL API
@@ -249,19 +356,16 @@ dx_archive_config_entries_write (struct disir_instance *instance, struct disir_a
                                  const char *group_id)
 {
     enum disir_status status;
-    struct disir_config *config = NULL;
     struct disir_entry *current = NULL;
     struct disir_archive_entry archive_entry;
-    FILE *entry_file = NULL;
-    char filepath[PATH_MAX];
+    struct export_pipeline pipeline;
+    std::vector<std::thread> threads;
+    std::vector<struct disir_instance *> workers;
     char archive_entry_name[PATH_MAX];
-    char *tmp_dir_name = NULL;
-    int ret;
+    size_t nthreads;
+    size_t index;
 
-    // setting it now such that
-    // it can be deallocated on label out
-    current = config_entry;
-    filepath[0] = '\0';
+    status = DISIR_STATUS_OK;
 
     if (plugin->dp_config_fd_write == NULL)
     {
@@ -270,100 +374,133 @@ dx_archive_config_entries_write (struct disir_instance *instance, struct disir_a
         goto out;
     }
 
-    tmp_dir_name = dx_archive_create_temp_folder();
-    if (tmp_dir_name == NULL)
+    pipeline.ep_plugin = plugin;
+    pipeline.ep_group_id = group_id;
+    pipeline.ep_next = 0;
+    pipeline.ep_written = 0;
+    pipeline.ep_abort = false;
+    for (current = config_entry; current != NULL; current = current->next)
     {
-        log_error ("unable to create temp folder for config files");
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
+        struct export_slot slot;
+
+        slot.es_entry_id = current->de_entry_name;
+        slot.es_done = false;
+        slot.es_status = DISIR_STATUS_OK;
+        slot.es_buffer = NULL;
+        slot.es_size = 0;
+        pipeline.ep_slots.push_back (slot);
     }
 
-    do
+    // The calling thread is one of them, writing the archive.
+    nthreads = (size_t) sysconf (_SC_NPROCESSORS_ONLN);
+    if (nthreads > pipeline.ep_slots.size())
+        nthreads = pipeline.ep_slots.size();
+    if (nthreads < 1)
+        nthreads = 1;
+    pipeline.ep_window = 2 * nthreads;
+
+    for (index = 1; index < nthreads; index++)
     {
-        config_entry = current->next;
+        struct disir_instance *worker;
 
-        snprintf(filepath, PATH_MAX, "%s/%s", tmp_dir_name, "temp_entry");
+        if (dx_instance_worker_create (instance, &worker) != DISIR_STATUS_OK)
+            break;
 
-        entry_file = fopen (filepath, "w");
-        if (entry_file == NULL)
+        try
         {
-            log_error ("unable to open temp config file: %s", filepath);
-            status = DISIR_STATUS_FS_ERROR;
-            goto out;
+            threads.emplace_back (export_worker, worker, &pipeline);
         }
+        catch (std::system_error& e)
+        {
+            log_warn ("failed to start export thread %zu - continuing with fewer threads.",
+                      index);
+            dx_instance_worker_destroy (&worker);
+            break;
+        }
+        workers.push_back (worker);
+    }
 
-        status = disir_config_read (instance, group_id, current->de_entry_name, NULL, &config);
-        if (status != DISIR_STATUS_OK)
-            goto out;
+    for (index = 0; index < pipeline.ep_slots.size(); index++)
+    {
+        auto& slot = pipeline.ep_slots[index];
 
-        status = plugin->dp_config_fd_write (instance, config, entry_file);
+        {
+            std::unique_lock<std::mutex> lock (pipeline.ep_mutex);
+
+            // Serialize the entry ourselves rather than wait for a busy worker to claim it.
+            if (pipeline.ep_next == index)
+            {
+                pipeline.ep_next++;
+                lock.unlock();
+                serialize_config_entry (instance, &pipeline, &slot);
+                lock.lock();
+                slot.es_done = true;
+            }
+
+            pipeline.ep_cond.wait (lock, [&slot] { return slot.es_done; });
+        }
+
+        status = slot.es_status;
         if (status != DISIR_STATUS_OK)
-            goto out;
+        {
+            if (slot.es_error.empty() == false)
+                disir_error_set (instance, "%s", slot.es_error.c_str());
+            break;
+        }
 
-        status = serialize_entry_index (archive, config, group_id,
-                                        current->de_entry_name, plugin->dp_name);
+        status = serialize_entry_index (archive, slot.es_version, group_id,
+                                        slot.es_entry_id, plugin->dp_name);
         if (status != DISIR_STATUS_OK)
-            goto out;
+            break;
 
         snprintf (archive_entry_name, PATH_MAX, "%s/%s/%s",
-                  plugin->dp_name, group_id, current->de_entry_name);
+                  plugin->dp_name, group_id, slot.es_entry_id);
 
-        status = append_config (instance, archive->da_archive, filepath, archive_entry_name);
+        status = append_buffer (archive, slot.es_buffer, slot.es_size, archive_entry_name);
         if (status != DISIR_STATUS_OK)
-            goto out;
+            break;
 
         archive_entry.de_backend_id = plugin->dp_name;
         archive_entry.de_group_id = group_id;
-        archive_entry.de_entry_id = current->de_entry_name;
-        archive_entry.de_filepath = "";
+        archive_entry.de_entry_id = slot.es_entry_id;
+        archive_entry.de_archive_path = archive_entry_name;
         archive->da_config_entries->insert (archive_entry);
 
-        disir_entry_finished (&current);
-        disir_config_finished (&config);
-
-        current = config_entry;
+        free (slot.es_buffer);
+        slot.es_buffer = NULL;
 
-        // Clean-up
-        ret = remove (filepath);
-        if (ret != 0)
-        {
-            log_debug (5, "unable to remove temp config file");
-            status = DISIR_STATUS_FS_ERROR;
-            goto out;
-        }
+        std::lock_guard<std::mutex> lock (pipeline.ep_mutex);
+        pipeline.ep_written = index + 1;
+        pipeline.ep_cond.notify_all();
     }
-    while (current != NULL);
-    // FALL-THROUGH
-out:
-    if (entry_file)
-        fclose (entry_file);
 
-    if (filepath[0] != '\0')
     {
-        // Ignore failure condition
-        (void)remove (filepath);
+        std::lock_guard<std::mutex> lock (pipeline.ep_mutex);
+        pipeline.ep_abort = true;
+        pipeline.ep_cond.notify_all();
     }
 
-    if (current)
+    for (auto& thread : threads)
     {
-        do
-        {
-            config_entry = current->next;
-            disir_entry_finished (&current);
-            current = config_entry;
-        }
-        while (current != NULL);
+        thread.join();
+    }
+    for (auto& worker : workers)
+    {
+        dx_instance_worker_destroy (&worker);
     }
 
-    if (tmp_dir_name)
+    // Entries serialized ahead of a failure are never written.
+    for (auto& slot : pipeline.ep_slots)
     {
-        ret = rmdir (tmp_dir_name);
-        if (ret != 0)
-        {
-            log_debug (5, "unable to remove temp folder");
-            status = DISIR_STATUS_FS_ERROR;
-        }
-        free (tmp_dir_name);
+        free (slot.es_buffer);
+    }
+    // FALL-THROUGH
+out:
+    while (config_entry != NULL)
+    {
+        current = config_entry->next;
+        disir_entry_finished (&config_entry);
+        config_entry = current;
     }
 
     return status;
@@ -373,14 +510,10 @@ out:
 static enum disir_status
 write_archive_metadata_toml (struct disir_archive *archive)
 {
-    enum disir_status status;
     std::ostringstream entry_formatted;
-    struct archive_entry *entry = NULL;
-    const char *archive_entry_name = METADATA_FILENAME;
-    const char *disir_org_version = "0/1-draft";
 
     archive->da_metadata->setChild ("implementation", libdisir_version_string);
-    archive->da_metadata->setChild ("disir_org_version", disir_org_version);
+    archive->da_metadata->setChild ("disir_org_version", ARCHIVE_ORG_VERSION);
     auto toml_arr = archive->da_metadata->setChild (ATTRIBUTE_KEY_BACKEND, toml::Array());
 
     for (const auto& kv : *archive->da_entries)
@@ -398,40 +531,56 @@ write_archive_metadata_toml (struct disir_archive *archive)
     archive->da_metadata->write (&entry_formatted);
     auto str = entry_formatted.str();
 
-    entry = archive_entry_new();
-    if (entry == NULL)
-    {
-        log_debug (5, "error creating new archive entry: %s",
-                       archive_errno (archive->da_archive));
-        return DISIR_STATUS_NO_MEMORY;
-    }
+    return append_buffer (archive, str.c_str(), str.size(), METADATA_FILENAME);
+}
 
-    status = populate_archive_entry (archive->da_archive, entry, archive_entry_name, str.size());
-    if (status != DISIR_STATUS_OK)
-        goto out;
+//! STATIC FUNCTION
+//! Write the entry index, locating the member of every config entry in the archive.
+//! It is the last member of the trailer.
+static enum disir_status
+write_archive_index (struct disir_archive *archive)
+{
+    std::string index;
+    char archive_entry_name[PATH_MAX];
+    char record[128];
 
-    if (archive_write_data (archive->da_archive, str.c_str(), str.size()) < 0)
-    {
-        log_error ("error writing archive entries.toml %s",
-                    archive_error_string (archive->da_archive));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
-    }
+    index.append (INDEX_MAGIC "\t" ARCHIVE_ORG_VERSION "\t");
+    index.append (libdisir_version_string);
+    index.push_back ('\n');
 
-    if (archive_write_finish_entry (archive->da_archive) != ARCHIVE_OK)
+    for (const auto& backend : *archive->da_entries)
     {
-        log_error ("could not finish archive write entry in entries.toml: %s",
-                    archive_error_string (archive->da_archive));
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
+        for (const auto& group : backend.second->as<toml::Table>())
+        {
+            for (const auto& entry : group.second.as<toml::Table>())
+            {
+                snprintf (archive_entry_name, PATH_MAX, "%s/%s/%s", backend.first.c_str(),
+                          group.first.c_str(), entry.first.c_str());
+
+                auto member = archive->da_members->find (archive_entry_name);
+                if (member == archive->da_members->end())
+                {
+                    log_error ("no member '%s' written to archive", archive_entry_name);
+                    return DISIR_STATUS_INTERNAL_ERROR;
+                }
+
+                snprintf (record, sizeof (record), "%" PRIu64 "\t%" PRIu64 "\t%016" PRIx64 "\t",
+                          member->second.de_offset, member->second.de_size,
+                          member->second.de_hash);
+                index.append (record);
+                index.append (backend.first);
+                index.push_back ('\t');
+                index.append (group.first);
+                index.push_back ('\t');
+                index.append (entry.second.as<std::string>());
+                index.push_back ('\t');
+                index.append (entry.first);
+                index.push_back ('\n');
+            }
+        }
     }
 
-    // FALL-THROUGH
-out:
-    if (entry)
-        archive_entry_free (entry);
-
-    return status;
+    return append_buffer (archive, index.c_str(), index.size(), INDEX_FILENAME);
 }
 
 //! INTERNAL API
@@ -439,9 +588,17 @@ enum disir_status
 dx_archive_metadata_write (struct disir_archive *archive)
 {
     enum disir_status status;
-    struct archive_entry *entry = NULL;
     char archive_entry_name[PATH_MAX];
 
+    // The trailer is written in an xz block of its own,
+    // such that appending to the archive only replaces this block.
+    if (archive->da_writer)
+    {
+        status = dx_archive_writer_block_end (archive->da_writer);
+        if (status != DISIR_STATUS_OK)
+            return status;
+    }
+
     // Create metadata.toml
     status = write_archive_metadata_toml (archive);
     if (status != DISIR_STATUS_OK) {
@@ -456,44 +613,93 @@ dx_archive_metadata_write (struct disir_archive *archive)
         kv.second->write (&entry_formatted);
         auto str = entry_formatted.str();
 
-        entry = archive_entry_new();
-        if (entry == NULL)
-        {
-            log_error ("error creating new archive entry: %s",
-                        archive_errno (archive->da_archive));
-            return DISIR_STATUS_NO_MEMORY;
-        }
-
         snprintf (archive_entry_name, PATH_MAX, "%s/entries.toml", kv.first.c_str());
 
-        status = populate_archive_entry (archive->da_archive, entry,
-                                         archive_entry_name, str.size());
+        status = append_buffer (archive, str.c_str(), str.size(), archive_entry_name);
         if (status != DISIR_STATUS_OK)
-            goto error;
+            return status;
+    }
 
-        if (archive_write_data (archive->da_archive, str.c_str(), str.size()) < 0)
-        {
-            log_error ("error writing archive metadata.toml: %s",
-                        archive_errno (archive->da_archive));
-            status = DISIR_STATUS_FS_ERROR;
-            goto error;
-        }
+    // Other codecs than xz are only read in their entirety - without the index.
+    if (archive->da_writer == NULL)
+        return DISIR_STATUS_OK;
+
+    // Create the entry index
+    return write_archive_index (archive);
+}
+
+//! STATIC FUNCTION
+//! Begin appending to the existing archive in place, continuing it from its trailer.
+//! Returns DISIR_STATUS_NOT_EXIST if the archive does not keep its metadata and entry
+//! index in a trailer of their own, and must be copied in its entirety.
+static enum disir_status
+begin_existing_append (struct disir_instance *instance, const char *archive_path, int level,
+                       struct disir_archive **archive)
+{
+    enum disir_status status;
+    struct disir_archive_reader *reader = NULL;
+    struct disir_archive *write_archive = NULL;
+    std::map<std::string, std::string> trailer;
+    std::vector<struct disir_archive_entry> entries;
+
+    status = dx_archive_reader_open (archive_path, &reader);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    status = dx_archive_trailer_read (reader, trailer);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    status = dx_archive_index_parse (trailer[INDEX_FILENAME], entries);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "invalid archive");
+        goto out;
+    }
+
+    status = dx_archive_begin_new (DISIR_ARCHIVE_CODEC_XZ, level, reader, &write_archive);
+    if (status != DISIR_STATUS_OK)
+        goto out;
+
+    // Missing metadata is left behind in a block preceding the trailer.
+    status = copy_metadata (write_archive, trailer);
+    if (status != DISIR_STATUS_OK)
+        goto out;
 
-        if (archive_write_finish_entry (archive->da_archive) != ARCHIVE_OK)
+    for (const auto& entry : entries)
+    {
+        write_archive->da_config_entries->insert (entry);
+        (*write_archive->da_members)[entry.de_archive_path] = entry;
+    }
+
+    // Anything but an index of every entry in entries.toml is left to the full copy.
+    for (const auto& backend : *write_archive->da_entries)
+    {
+        for (const auto& group : backend.second->as<toml::Table>())
         {
-            log_error ("could not finish archive write entry in metadata.toml: %s",
-                        archive_error_string (archive->da_archive));
-            status = DISIR_STATUS_FS_ERROR;
-            goto error;
+            for (const auto& entry : group.second.as<toml::Table>())
+            {
+                auto path = backend.first + "/" + group.first + "/" + entry.first;
+                if (write_archive->da_members->count (path) == 0)
+                {
+                    log_debug (3, "entry '%s' is not indexed in archive", path.c_str());
+                    status = DISIR_STATUS_NOT_EXIST;
+                    goto out;
+                }
+            }
         }
-
-        archive_entry_free (entry);
     }
 
-    return DISIR_STATUS_OK;
-error:
-    if (entry)
-        archive_entry_free (entry);
+    write_archive->da_existing_path = strdup (archive_path);
+    *archive = write_archive;
+
+    //FALL-THROUGH
+out:
+    dx_archive_reader_close (&reader);
+    if (status != DISIR_STATUS_OK && write_archive)
+    {
+        disir_archive_finalize (instance, NULL, &write_archive);
+    }
 
     return status;
 }
@@ -501,12 +707,12 @@ error:
 //! INTERNAL API
 enum disir_status
 dx_archive_begin_existing (struct disir_instance *instance, const char *archive_path,
+                           enum disir_archive_codec codec, int level,
                            struct disir_archive **archive)
 {
     enum disir_status status;
-    std::map<std::string, std::string> extract_content;
+    std::map<std::string, std::string> archive_content;
     struct disir_archive *write_archive = NULL;
-    char *tmp_dir_name = NULL;
     const char *ext = NULL;
 
     // Make sure archive path is not a directory
@@ -532,38 +738,36 @@ dx_archive_begin_existing (struct disir_instance *instance, const char *archive_
         return status;
     }
 
-    status = dx_archive_begin_new (&write_archive);
-    if (status != DISIR_STATUS_OK)
-        goto out;
-
-    // Create temporary extract folder
-    tmp_dir_name = dx_archive_create_temp_folder();
-    if (tmp_dir_name == NULL)
+    // Only xz archives are appended to in place.
+    if (codec == DISIR_ARCHIVE_CODEC_XZ)
     {
-        status = DISIR_STATUS_FS_ERROR;
-        goto out;
+        status = begin_existing_append (instance, archive_path, level, archive);
+        if (status != DISIR_STATUS_NOT_EXIST)
+            return status;
     }
 
-    // Store temp path for clean up later
-    write_archive->da_extract_folder_path = tmp_dir_name;
+    // Copy the entire archive
+    status = dx_archive_begin_new (codec, level, NULL, &write_archive);
+    if (status != DISIR_STATUS_OK)
+        goto out;
 
-    status = dx_archive_extract (archive_path, extract_content, tmp_dir_name);
+    status = dx_archive_read (archive_path, archive_content);
     if (status != DISIR_STATUS_OK)
         goto out;
 
-    status = dx_archive_validate (write_archive, extract_content);
+    status = dx_archive_validate (write_archive, archive_content);
     if (status != DISIR_STATUS_OK)
     {
         disir_error_set (instance, "invalid archive");
         goto out;
     }
 
-    status = copy_metadata (write_archive, extract_content);
+    status = copy_metadata (write_archive, archive_content);
     if (status != DISIR_STATUS_OK)
         goto out;
 
     // Copy content
-    for (const auto& entry : extract_content)
+    for (const auto& entry : archive_content)
     {
         // Ignore metadata files, they will be re-written in finalize.
         if (entry.first.find ("entries.toml") != std::string::npos)
@@ -572,8 +776,11 @@ dx_archive_begin_existing (struct disir_instance *instance, const char *archive_
         if (entry.first.find ("metadata.toml") != std::string::npos)
             continue;
 
-        status = append_config (instance, write_archive->da_archive, entry.second.c_str(),
-                                                                     entry.first.c_str());
+        if (entry.first == INDEX_FILENAME)
+            continue;
+
+        status = append_buffer (write_archive, entry.second.data(),
+                                entry.second.size(), entry.first.c_str());
         if (status != DISIR_STATUS_OK)
             goto out;
     }
@@ -596,7 +803,8 @@ out:
 
 //! INTERNAL API
 enum disir_status
-dx_archive_begin_new (struct disir_archive **archive)
+dx_archive_begin_new (enum disir_archive_codec codec, int level,
+                      struct disir_archive_reader *existing, struct disir_archive **archive)
 {
     enum disir_status status;
     struct disir_archive *ar;
@@ -612,7 +820,10 @@ dx_archive_begin_new (struct disir_archive **archive)
         return status;
     }
 
-    status = dx_archive_open_write (ar);
+    ar->da_codec = codec;
+    ar->da_level = level;
+
+    status = dx_archive_open_write (ar, existing);
     if (status != DISIR_STATUS_OK)
         goto error;
 
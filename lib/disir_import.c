@@ -17,6 +17,8 @@
 // external libs
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
+#include <errno.h>
 
 //! STATIC FUNCTION
 static void
@@ -193,12 +195,13 @@ out:
 
 //! STATIC FUNCTION
 static enum disir_status
-read_config_imported (struct disir_instance *instance, const char *filepath, const char *group_id,
-                      struct disir_mold *mold, struct disir_config **config)
+read_config_imported (struct disir_instance *instance, const char *data, size_t size,
+                      const char *group_id, struct disir_mold *mold,
+                      struct disir_config **config)
 {
     enum disir_status status;
     struct disir_register_plugin *plugin;
-    FILE *file = NULL;
+    FILE *stream = NULL;
 
     dx_retrieve_plugin_by_group (instance, group_id, &plugin);
     if (plugin == NULL)
@@ -206,31 +209,37 @@ read_config_imported (struct disir_instance *instance, const char *filepath, con
         return DISIR_STATUS_NO_CAN_DO;
     }
 
-    file = fopen (filepath, "r");
-    if (file == NULL)
+    if (plugin->dp_config_fd_read == NULL)
     {
-        log_debug (10, "unable to read imported config on filepath '%s'", filepath);
-        return DISIR_STATUS_FS_ERROR;
+        return DISIR_STATUS_NO_CAN_DO;
     }
 
-    if (plugin->dp_config_fd_read != NULL)
+    // An empty memory stream cannot be opened - nor is it a valid config.
+    if (size == 0)
     {
-        status = plugin->dp_config_fd_read (instance, file, mold, config);
+        log_debug (10, "imported config is empty");
+        return DISIR_STATUS_FS_ERROR;
     }
-    else
+
+    // Opened read-only - the data is never written through the stream.
+    stream = fmemopen ((void *) (uintptr_t) data, size, "r");
+    if (stream == NULL)
     {
-        status = DISIR_STATUS_NO_CAN_DO;
+        log_debug (10, "unable to open memory stream for imported config: %s", strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
     }
 
-    if (file)
-        fclose (file);
+    status = plugin->dp_config_fd_read (instance, stream, mold, config);
+
+    fclose (stream);
 
     return status;
 }
 
 // INTERNAL API
 enum disir_status
-dx_resolve_config_import_status (struct disir_instance *instance, const char *config_path,
+dx_resolve_config_import_status (struct disir_instance *instance,
+                                 const char *data, size_t size,
                                  struct disir_import_entry *import)
 {
     enum disir_status status;
@@ -245,7 +254,7 @@ dx_resolve_config_import_status (struct disir_instance *instance, const char *co
         return DISIR_STATUS_NO_CAN_DO;
     }
 
-    status = read_config_imported (instance, config_path, import->ie_group_id,
+    status = read_config_imported (instance, data, size, import->ie_group_id,
                                    mold, &config_imported);
 
     import->ie_config = config_imported;
@@ -2,12 +2,14 @@
 #include <string.h>
 
 #include <disir/disir.h>
+#include <disir/fslib/util.h>
 
 #include "disir_private.h"
 #include "log.h"
 #include "mold.h"
 #include "mqueue.h"
 #include "multimap.h"
+#include "stats.h"
 
 
 // String hashing function for the multimap
@@ -22,29 +24,16 @@ static unsigned long djb2 (char *str)
     return hash;
 }
 
-//! PUBLIC API
-enum disir_status
-disir_mold_read (struct disir_instance *instance, const char *group_id,
-                 const char *entry_id, struct disir_mold **mold)
+//! STATIC API
+//! Find the first plugin in group_id that holds the mold entry_id.
+static struct disir_register_plugin_internal *
+mold_plugin_find (struct disir_instance *instance, const char *group_id, const char *entry_id)
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
 
     plugin = NULL;
 
-    if (instance == NULL || entry_id == NULL || mold == NULL)
-    {
-        log_debug (0, "invoked with NULL argument(s)." \
-                      " instance (%p), group_id (%p), entry_id (%p), mold (%p)",
-                      instance, group_id, entry_id, mold);
-        return DISIR_STATUS_INVALID_ARGUMENT;
-    }
-
-    TRACE_ENTER ("instance (%p) group_id (%s) entry_id (%s) mold (%p)",
-                 instance, group_id, entry_id, mold, mold);
-
-    disir_error_clear (instance);
-
     MQ_FOREACH (instance->dio_plugin_queue,
     ({
         if (strcmp (entry->pi_group_id, group_id) != 0)
@@ -69,7 +58,7 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
         {
             log_warn ("Plugin '%s' (id %s) failed to query for entry '%s': %s",
                       entry->pi_io_id, entry->pi_plugin.dp_name,
-                      entry_id), disir_status_string (status);
+                      entry_id, disir_status_string (status));
             entry = entry->next;
             continue;
         }
@@ -78,13 +67,42 @@ disir_mold_read (struct disir_instance *instance, const char *group_id,
         break;
     }));
 
+    return plugin;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_read (struct disir_instance *instance, const char *group_id,
+                 const char *entry_id, struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct disir_register_plugin_internal *plugin;
+    struct dx_stats_timer timer;
+
+    if (instance == NULL || entry_id == NULL || mold == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s)." \
+                      " instance (%p), group_id (%p), entry_id (%p), mold (%p)",
+                      instance, group_id, entry_id, mold);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) group_id (%s) entry_id (%s) mold (%p)",
+                 instance, group_id, entry_id, mold, mold);
+
+    disir_error_clear (instance);
+
+    plugin = mold_plugin_find (instance, group_id, entry_id);
+
     if (plugin)
     {
         if (plugin->pi_plugin.dp_mold_read)
         {
             *mold = NULL;
+            dx_stats_begin (instance, &timer);
             status = plugin->pi_plugin.dp_mold_read (instance, &plugin->pi_plugin,
                                                      entry_id, mold);
+            dx_stats_end (&timer, DISIR_STATS_MOLD_READ, status);
         }
         else
         {
@@ -110,6 +128,7 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
 {
     enum disir_status status;
     struct disir_register_plugin_internal *plugin;
+    struct dx_stats_timer timer;
 
     plugin = NULL;
 
@@ -141,8 +160,10 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
     {
         if (plugin->pi_plugin.dp_mold_write)
         {
+            dx_stats_begin (instance, &timer);
             status = plugin->pi_plugin.dp_mold_write (instance, &plugin->pi_plugin,
                                                       entry_id, mold);
+            dx_stats_end (&timer, DISIR_STATS_MOLD_WRITE, status);
         }
         else
         {
@@ -163,6 +184,57 @@ disir_mold_write (struct disir_instance *instance, const char *group_id,
     return DISIR_STATUS_INTERNAL_ERROR;
 }
 
+//! PUBLIC API
+enum disir_status
+disir_mold_compile_entry (struct disir_instance *instance, const char *group_id,
+                          const char *entry_id)
+{
+    enum disir_status status;
+    struct disir_register_plugin_internal *plugin;
+
+    if (instance == NULL || group_id == NULL || entry_id == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), group_id (%p), entry_id (%p)",
+                      instance, group_id, entry_id);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) group_id (%s) entry_id (%s)", instance, group_id, entry_id);
+
+    disir_error_clear (instance);
+
+    plugin = mold_plugin_find (instance, group_id, entry_id);
+    if (plugin == NULL)
+    {
+        disir_error_set (instance, "No plugin in group '%s' contains mold entry '%s'",
+                         group_id, entry_id);
+        status = DISIR_STATUS_NOT_EXIST;
+    }
+    else if (plugin->pi_plugin.dp_mold_read == NULL
+             || plugin->pi_plugin.dp_mold_base_id == NULL
+             || plugin->pi_plugin.dp_mold_entry_type == NULL)
+    {
+        disir_error_set (instance, "Plugin '%s' does not hold its molds on the filesystem",
+                         plugin->pi_io_id);
+        status = DISIR_STATUS_NO_CAN_DO;
+    }
+    else
+    {
+        status = fslib_plugin_mold_compile (instance, &plugin->pi_plugin, entry_id);
+        if (status == DISIR_STATUS_NOT_EXIST)
+        {
+            // The plugin reported the entry, yet it resolves to no file.
+            disir_error_set (instance,
+                             "Plugin '%s' does not hold mold entry '%s' on the filesystem",
+                             plugin->pi_io_id, entry_id);
+            status = DISIR_STATUS_NO_CAN_DO;
+        }
+    }
+
+    TRACE_EXIT ("status: %s", disir_status_string (status));
+    return status;
+}
+
 //! PUBLIC API
 enum disir_status
 disir_mold_entries (struct disir_instance *instance,
@@ -173,6 +245,7 @@ disir_mold_entries (struct disir_instance *instance,
     struct disir_entry *queue;
     struct disir_entry *query;
     struct disir_entry *current;
+    struct dx_stats_timer timer;
 
     queue = NULL;
     query = NULL;
@@ -211,7 +284,9 @@ disir_mold_entries (struct disir_instance *instance,
             continue;
         }
 
+        dx_stats_begin (instance, &timer);
         status = entry->pi_plugin.dp_mold_entries (instance, &entry->pi_plugin, &query);
+        dx_stats_end (&timer, DISIR_STATS_MOLD_ENTRIES, status);
         if (status != DISIR_STATUS_OK)
         {
             log_debug (1, "Plugin '%s' queried for mold entries failed with status: %s",
@@ -337,8 +412,7 @@ disir_mold_finished (struct disir_mold **mold)
 
     TRACE_ENTER ("mold: %p", *mold);
 
-    (*mold)->mo_reference_count--;
-    if ((*mold)->mo_reference_count == 0)
+    if (__atomic_sub_fetch (&(*mold)->mo_reference_count, 1, __ATOMIC_ACQ_REL) == 0)
     {
         log_debug (6, "Mold reached reference count 0 - destroying context.");
         context = (*mold)->mo_context;
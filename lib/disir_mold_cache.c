@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <disir/disir.h>
+
+#include "disir_private.h"
+#include "log.h"
+#include "mold.h"
+#include "mqueue.h"
+
+
+//! Identity of a file on disk. A changed identity means the file must be re-read.
+struct mold_cache_identity
+{
+    dev_t               mi_device;
+    ino_t               mi_inode;
+    struct timespec     mi_mtime;
+    off_t               mi_size;
+};
+
+//! A mold held by the instance mold cache, keyed by plugin and the files it was read from.
+struct dx_mold_cache_entry
+{
+    //! Plugin which read the mold.
+    struct disir_register_plugin    *mc_plugin;
+    //! Allocated filepath of the mold entry.
+    char                            *mc_mold_filepath;
+    //! Allocated filepath of the override entry. NULL if no override entry was applied.
+    char                            *mc_override_filepath;
+
+    struct mold_cache_identity      mc_mold_identity;
+    struct mold_cache_identity      mc_override_identity;
+
+    //! Reference held by the cache.
+    struct disir_mold               *mc_mold;
+
+    struct dx_mold_cache_entry      *next, *prev;
+};
+
+//! STATIC API
+static void
+mold_cache_identity (const struct stat *statbuf, struct mold_cache_identity *identity)
+{
+    memset (identity, 0, sizeof (*identity));
+    if (statbuf == NULL)
+        return;
+
+    identity->mi_device = statbuf->st_dev;
+    identity->mi_inode = statbuf->st_ino;
+    identity->mi_mtime = statbuf->st_mtim;
+    identity->mi_size = statbuf->st_size;
+}
+
+//! STATIC API
+static int
+mold_cache_identity_equal (const struct mold_cache_identity *a,
+                           const struct mold_cache_identity *b)
+{
+    return (a->mi_device == b->mi_device && a->mi_inode == b->mi_inode
+            && a->mi_mtime.tv_sec == b->mi_mtime.tv_sec
+            && a->mi_mtime.tv_nsec == b->mi_mtime.tv_nsec
+            && a->mi_size == b->mi_size);
+}
+
+//! STATIC API
+static int
+mold_cache_filepath_equal (const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return (a == b);
+
+    return (strcmp (a, b) == 0);
+}
+
+//! STATIC API
+//! Return the instance holding the mold cache used by instance, with its cache locked.
+static struct disir_instance *
+mold_cache_lock (struct disir_instance *instance)
+{
+    if (instance->dio_parent)
+    {
+        instance = instance->dio_parent;
+    }
+
+    pthread_mutex_lock (&instance->mold_cache_lock);
+    return instance;
+}
+
+//! STATIC API
+static struct dx_mold_cache_entry *
+mold_cache_find (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                 const char *mold_filepath, const char *override_filepath)
+{
+    struct dx_mold_cache_entry *entry;
+
+    for (entry = instance->mold_cache; entry != NULL; entry = entry->next)
+    {
+        if (entry->mc_plugin == plugin
+            && mold_cache_filepath_equal (entry->mc_mold_filepath, mold_filepath)
+            && mold_cache_filepath_equal (entry->mc_override_filepath, override_filepath))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+//! STATIC API
+//! Return non-zero if the files of entry still match mold_stat and override_stat.
+static int
+mold_cache_entry_current (struct dx_mold_cache_entry *entry,
+                          const struct stat *mold_stat, const struct stat *override_stat)
+{
+    struct mold_cache_identity identity;
+
+    mold_cache_identity (mold_stat, &identity);
+    if (mold_cache_identity_equal (&entry->mc_mold_identity, &identity) == 0)
+        return 0;
+
+    mold_cache_identity (override_stat, &identity);
+    return mold_cache_identity_equal (&entry->mc_override_identity, &identity);
+}
+
+//! STATIC API
+static void
+mold_cache_entry_remove (struct disir_instance *instance, struct dx_mold_cache_entry *entry)
+{
+    MQ_REMOVE (instance->mold_cache, entry);
+
+    disir_mold_finished (&entry->mc_mold);
+    free (entry->mc_mold_filepath);
+    free (entry->mc_override_filepath);
+    free (entry);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_mold_cache_lookup (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                      const char *mold_filepath, const struct stat *mold_stat,
+                      const char *override_filepath, const struct stat *override_stat,
+                      struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct dx_mold_cache_entry *entry;
+
+    instance = mold_cache_lock (instance);
+
+    status = DISIR_STATUS_NOT_EXIST;
+    entry = mold_cache_find (instance, plugin, mold_filepath, override_filepath);
+    if (entry && mold_cache_entry_current (entry, mold_stat, override_stat) == 0)
+    {
+        log_debug (4, "cached mold for '%s' is stale - releasing it.", mold_filepath);
+        mold_cache_entry_remove (instance, entry);
+    }
+    else if (entry)
+    {
+        dx_mold_incref (entry->mc_mold);
+        *mold = entry->mc_mold;
+        status = DISIR_STATUS_OK;
+    }
+
+    if (status == DISIR_STATUS_OK)
+        instance->mold_cache_hits++;
+    else
+        instance->mold_cache_misses++;
+
+    pthread_mutex_unlock (&instance->mold_cache_lock);
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_mold_cache_store (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                     const char *mold_filepath, const struct stat *mold_stat,
+                     const char *override_filepath, const struct stat *override_stat,
+                     struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct dx_mold_cache_entry *entry;
+
+    instance = mold_cache_lock (instance);
+
+    entry = mold_cache_find (instance, plugin, mold_filepath, override_filepath);
+    if (entry && mold_cache_entry_current (entry, mold_stat, override_stat))
+    {
+        // Another reader got here first - share its mold.
+        disir_mold_finished (mold);
+        dx_mold_incref (entry->mc_mold);
+        *mold = entry->mc_mold;
+        status = DISIR_STATUS_OK;
+        goto out;
+    }
+    if (entry)
+    {
+        mold_cache_entry_remove (instance, entry);
+    }
+
+    status = DISIR_STATUS_NO_MEMORY;
+    entry = calloc (1, sizeof (*entry));
+    if (entry == NULL)
+        goto out;
+
+    entry->mc_mold_filepath = strdup (mold_filepath);
+    if (entry->mc_mold_filepath == NULL)
+        goto error;
+    if (override_filepath)
+    {
+        entry->mc_override_filepath = strdup (override_filepath);
+        if (entry->mc_override_filepath == NULL)
+            goto error;
+    }
+
+    entry->mc_plugin = plugin;
+    mold_cache_identity (mold_stat, &entry->mc_mold_identity);
+    mold_cache_identity (override_stat, &entry->mc_override_identity);
+
+    dx_mold_incref (*mold);
+    entry->mc_mold = *mold;
+
+    MQ_ENQUEUE (instance->mold_cache, entry);
+    status = DISIR_STATUS_OK;
+    goto out;
+error:
+    free (entry->mc_mold_filepath);
+    free (entry);
+out:
+    pthread_mutex_unlock (&instance->mold_cache_lock);
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_cache_stats (struct disir_instance *instance, struct disir_mold_cache_stats *stats)
+{
+    struct dx_mold_cache_entry *entry;
+
+    if (instance == NULL || stats == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (instance: %p, stats: %p)", instance, stats);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    instance = mold_cache_lock (instance);
+
+    stats->mcs_hits = instance->mold_cache_hits;
+    stats->mcs_misses = instance->mold_cache_misses;
+    stats->mcs_entries = 0;
+    for (entry = instance->mold_cache; entry != NULL; entry = entry->next)
+    {
+        stats->mcs_entries++;
+    }
+
+    pthread_mutex_unlock (&instance->mold_cache_lock);
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_cache_clear (struct disir_instance *instance)
+{
+    if (instance == NULL)
+    {
+        log_debug (0, "invoked with NULL instance pointer");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    instance = mold_cache_lock (instance);
+
+    while (instance->mold_cache)
+    {
+        mold_cache_entry_remove (instance, instance->mold_cache);
+    }
+
+    pthread_mutex_unlock (&instance->mold_cache_lock);
+    return DISIR_STATUS_OK;
+}
@@ -0,0 +1,490 @@
+// external public includes
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+
+// private
+#include "disir_private.h"
+#include "log.h"
+#include "mqueue.h"
+
+
+//! Events that signal a complete write of the watched file.
+#define WATCH_INOTIFY_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+struct disir_watch
+{
+    //! Instance the entry is read with.
+    struct disir_instance           *dw_instance;
+
+    //! Group and entry identifying the watched config.
+    char                            *dw_group_id;
+    char                            *dw_entry_id;
+
+    //! Published snapshot. Swapped atomically on reload.
+    _Atomic (struct disir_config *) dw_config;
+
+    //! Number of snapshots published.
+    _Atomic uint64_t                dw_generation;
+
+    //! Reader epoch. Readers register in dw_readers[epoch & 1].
+    _Atomic uint64_t                dw_epoch;
+    _Atomic int64_t                 dw_readers[2];
+
+    //! Serialize reloads from the watch thread and disir_watch_reload().
+    pthread_mutex_t                 dw_reload_lock;
+
+    //! File backing the entry, and the name of it within its directory.
+    char                            dw_filepath[PATH_MAX];
+    const char                      *dw_filename;
+
+    //! inotify descriptor watching the directory of dw_filepath. -1 if not watching.
+    int                             dw_inotify;
+    //! Pipe used to wake the watch thread on shutdown.
+    int                             dw_wakeup[2];
+    pthread_t                       dw_thread;
+    int                             dw_thread_running;
+};
+
+//! STATIC API
+//! Locate the file backing the watched entry, if read by a filesystem based plugin.
+//! Uses the same plugin resolution as disir_config_read().
+static enum disir_status
+watch_resolve_filepath (struct disir_watch *watch)
+{
+    enum disir_status status;
+    struct disir_register_plugin_internal *plugin;
+
+    plugin = NULL;
+
+    MQ_FOREACH (watch->dw_instance->dio_plugin_queue,
+    ({
+        if (strcmp (entry->pi_group_id, watch->dw_group_id) != 0 ||
+            entry->pi_plugin.dp_config_query == NULL)
+        {
+            entry = entry->next;
+            continue;
+        }
+        status = entry->pi_plugin.dp_config_query (watch->dw_instance, &entry->pi_plugin,
+                                                   watch->dw_entry_id, NULL);
+        if (status != DISIR_STATUS_EXISTS)
+        {
+            entry = entry->next;
+            continue;
+        }
+
+        plugin = entry;
+        break;
+    }));
+
+    if (plugin == NULL || plugin->pi_plugin.dp_config_base_id == NULL ||
+        plugin->pi_plugin.dp_config_entry_type == NULL)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    status = fslib_config_resolve_filepath (watch->dw_instance, &plugin->pi_plugin,
+                                            watch->dw_entry_id, watch->dw_filepath);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    watch->dw_filename = strrchr (watch->dw_filepath, '/');
+    if (watch->dw_filename == NULL)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+    watch->dw_filename++;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Wait until every reader that may have acquired the snapshot replaced
+//! before this call has released it.
+static void
+watch_synchronize (struct disir_watch *watch)
+{
+    uint64_t epoch;
+
+    // Readers that register from now on use the other slot, and see the new snapshot.
+    epoch = atomic_fetch_add (&watch->dw_epoch, 1);
+
+    while (atomic_load (&watch->dw_readers[epoch & 1]) != 0)
+    {
+        sched_yield ();
+    }
+}
+
+//! STATIC API
+//! Read and validate the entry, then publish a frozen snapshot of it.
+//! Caller holds dw_reload_lock.
+static enum disir_status
+watch_publish (struct disir_watch *watch)
+{
+    enum disir_status status;
+    struct disir_config *config;
+    struct disir_config *snapshot;
+    struct disir_config *previous;
+
+    config = NULL;
+    snapshot = NULL;
+
+    status = disir_config_read (watch->dw_instance, watch->dw_group_id,
+                                watch->dw_entry_id, NULL, &config);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_warn ("watch: failed to read config %s/%s: %s", watch->dw_group_id,
+                  watch->dw_entry_id, disir_status_string (status));
+        goto error;
+    }
+
+    status = disir_config_freeze (config, &snapshot);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    previous = atomic_exchange (&watch->dw_config, snapshot);
+    atomic_fetch_add (&watch->dw_generation, 1);
+    if (previous)
+    {
+        watch_synchronize (watch);
+        disir_config_finished (&previous);
+    }
+
+    log_debug (2, "watch: published generation %lu of config %s/%s",
+               (unsigned long) atomic_load (&watch->dw_generation),
+               watch->dw_group_id, watch->dw_entry_id);
+
+    status = DISIR_STATUS_OK;
+    // FALL-THROUGH
+error:
+    if (config)
+    {
+        disir_config_finished (&config);
+    }
+
+    return status;
+}
+
+//! STATIC API
+//! Return non-zero if the inotify event buffer holds a write to the watched file.
+static int
+watch_events_match (struct disir_watch *watch, const char *buffer, ssize_t length)
+{
+    const struct inotify_event *event;
+    ssize_t offset;
+    int match;
+
+    match = 0;
+    for (offset = 0; offset < length; offset += sizeof (struct inotify_event) + event->len)
+    {
+        event = (const struct inotify_event *) (buffer + offset);
+        if (event->len > 0 && (event->mask & WATCH_INOTIFY_MASK) &&
+            strcmp (event->name, watch->dw_filename) == 0)
+        {
+            match = 1;
+        }
+    }
+
+    return match;
+}
+
+//! STATIC API
+static void *
+watch_thread (void *arg)
+{
+    struct disir_watch *watch;
+    struct pollfd fds[2];
+    char buffer[4096]
+        __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+    ssize_t length;
+
+    watch = arg;
+
+    fds[0].fd = watch->dw_inotify;
+    fds[0].events = POLLIN;
+    fds[1].fd = watch->dw_wakeup[0];
+    fds[1].events = POLLIN;
+
+    while (1)
+    {
+        if (poll (fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            log_error ("watch: poll failed: %s", strerror (errno));
+            break;
+        }
+
+        if (fds[1].revents)
+        {
+            break;
+        }
+
+        length = read (watch->dw_inotify, buffer, sizeof (buffer));
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        if (watch_events_match (watch, buffer, length))
+        {
+            pthread_mutex_lock (&watch->dw_reload_lock);
+            watch_publish (watch);
+            pthread_mutex_unlock (&watch->dw_reload_lock);
+        }
+    }
+
+    return NULL;
+}
+
+//! STATIC API
+//! Start watching the directory holding the backing file, if there is one.
+static void
+watch_start_thread (struct disir_watch *watch)
+{
+    char directory[PATH_MAX];
+    size_t directory_length;
+
+    if (watch_resolve_filepath (watch) != DISIR_STATUS_OK)
+    {
+        log_debug (2, "watch: config %s/%s is not file backed - not watching.",
+                   watch->dw_group_id, watch->dw_entry_id);
+        return;
+    }
+
+    // Watch the directory, such that files replaced by rename are detected.
+    directory_length = watch->dw_filename - watch->dw_filepath;
+    memcpy (directory, watch->dw_filepath, directory_length);
+    directory[directory_length] = '\0';
+
+    watch->dw_inotify = inotify_init1 (IN_CLOEXEC);
+    if (watch->dw_inotify < 0)
+    {
+        log_warn ("watch: inotify_init1 failed: %s", strerror (errno));
+        return;
+    }
+    if (inotify_add_watch (watch->dw_inotify, directory, WATCH_INOTIFY_MASK) < 0)
+    {
+        log_warn ("watch: cannot watch %s: %s", directory, strerror (errno));
+        goto error;
+    }
+    if (pipe (watch->dw_wakeup) != 0)
+    {
+        log_warn ("watch: pipe failed: %s", strerror (errno));
+        watch->dw_wakeup[0] = watch->dw_wakeup[1] = -1;
+        goto error;
+    }
+    if (pthread_create (&watch->dw_thread, NULL, watch_thread, watch) != 0)
+    {
+        log_warn ("watch: failed to create watch thread.");
+        goto error;
+    }
+
+    watch->dw_thread_running = 1;
+    return;
+error:
+    if (watch->dw_wakeup[0] >= 0)
+    {
+        close (watch->dw_wakeup[0]);
+        close (watch->dw_wakeup[1]);
+        watch->dw_wakeup[0] = watch->dw_wakeup[1] = -1;
+    }
+    close (watch->dw_inotify);
+    watch->dw_inotify = -1;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_config_watch (struct disir_instance *instance, const char *group_id,
+                    const char *entry_id, struct disir_watch **watch)
+{
+    enum disir_status status;
+    struct disir_watch *w;
+
+    if (instance == NULL || group_id == NULL || entry_id == NULL || watch == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), group_id (%p),"
+                      " entry_id (%p), watch (%p)", instance, group_id, entry_id, watch);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) group_id (%s) entry_id (%s)", instance, group_id, entry_id);
+
+    w = calloc (1, sizeof (struct disir_watch));
+    if (w == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+
+    w->dw_instance = instance;
+    w->dw_inotify = -1;
+    w->dw_wakeup[0] = w->dw_wakeup[1] = -1;
+    atomic_init (&w->dw_config, NULL);
+    atomic_init (&w->dw_generation, 0);
+    atomic_init (&w->dw_epoch, 0);
+    atomic_init (&w->dw_readers[0], 0);
+    atomic_init (&w->dw_readers[1], 0);
+    pthread_mutex_init (&w->dw_reload_lock, NULL);
+
+    w->dw_group_id = strdup (group_id);
+    w->dw_entry_id = strdup (entry_id);
+    if (w->dw_group_id == NULL || w->dw_entry_id == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
+    status = watch_publish (w);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    watch_start_thread (w);
+
+    *watch = w;
+    status = DISIR_STATUS_OK;
+    goto out;
+error:
+    disir_watch_finished (&w);
+out:
+    TRACE_EXIT ("%s", disir_status_string (status));
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_watch_acquire (struct disir_watch *watch, struct disir_config **config,
+                     uint64_t *ticket)
+{
+    uint64_t epoch;
+
+    if (watch == NULL || config == NULL || ticket == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). watch (%p), config (%p), ticket (%p)",
+                      watch, config, ticket);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Register as reader in the current epoch. Only retried if a reload
+    // advanced the epoch in between - never waits on the writer.
+    while (1)
+    {
+        epoch = atomic_load (&watch->dw_epoch);
+        atomic_fetch_add (&watch->dw_readers[epoch & 1], 1);
+        if (atomic_load (&watch->dw_epoch) == epoch)
+            break;
+        atomic_fetch_sub (&watch->dw_readers[epoch & 1], 1);
+    }
+
+    *config = atomic_load (&watch->dw_config);
+    *ticket = epoch;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_watch_release (struct disir_watch *watch, uint64_t ticket)
+{
+    if (watch == NULL)
+    {
+        log_debug (0, "invoked with watch NULL pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    atomic_fetch_sub (&watch->dw_readers[ticket & 1], 1);
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_watch_reload (struct disir_watch *watch)
+{
+    enum disir_status status;
+
+    if (watch == NULL)
+    {
+        log_debug (0, "invoked with watch NULL pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    pthread_mutex_lock (&watch->dw_reload_lock);
+    status = watch_publish (watch);
+    pthread_mutex_unlock (&watch->dw_reload_lock);
+
+    return status;
+}
+
+//! PUBLIC API
+uint64_t
+disir_watch_generation (struct disir_watch *watch)
+{
+    if (watch == NULL)
+        return 0;
+
+    return atomic_load (&watch->dw_generation);
+}
+
+//! PUBLIC API
+enum disir_status
+disir_watch_finished (struct disir_watch **watch)
+{
+    struct disir_config *config;
+
+    if (watch == NULL || *watch == NULL)
+    {
+        log_debug (0, "invoked with NULL watch pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    if ((*watch)->dw_thread_running)
+    {
+        if (write ((*watch)->dw_wakeup[1], "", 1) != 1)
+        {
+            log_warn ("watch: failed to wake watch thread: %s", strerror (errno));
+        }
+        pthread_join ((*watch)->dw_thread, NULL);
+    }
+    if ((*watch)->dw_wakeup[0] >= 0)
+    {
+        close ((*watch)->dw_wakeup[0]);
+        close ((*watch)->dw_wakeup[1]);
+    }
+    if ((*watch)->dw_inotify >= 0)
+    {
+        close ((*watch)->dw_inotify);
+    }
+
+    config = atomic_load (&(*watch)->dw_config);
+    if (config)
+    {
+        disir_config_finished (&config);
+    }
+
+    pthread_mutex_destroy (&(*watch)->dw_reload_lock);
+    free ((*watch)->dw_group_id);
+    free ((*watch)->dw_entry_id);
+    free (*watch);
+    *watch = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
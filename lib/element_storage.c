@@ -1,9 +1,7 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include <disir/disir.h>
-#include <multimap.h>
-#include <list.h>
-#include <errno.h>
 
 #include "context_private.h"
 #include "collection.h"
@@ -22,75 +20,501 @@
 //!
 //!
 
+//! Sentinel index used to terminate the per-name entry chains.
+#define ELEMENT_STORAGE_NO_ENTRY (-1)
+
+//! Initial capacity of the entry array and name table when first populated.
+#define ELEMENT_STORAGE_INITIAL_CAPACITY 8
+
+//! Token held by a deferred slot while its element is being loaded.
+#define ELEMENT_STORAGE_TOKEN_LOADING UINT64_MAX
+
+//! One interned name in the element storage.
+//! Every distinct name added to the storage is given a name id (its index in es_names)
+//! that is never reused for the lifetime of the storage.
+struct element_storage_name
+{
+    //! Full hash of the name. Compared before the string itself when probing.
+    uint64_t        en_hash;
+
+    //! Offset of the NULL terminated name in es_name_pool.
+    uint32_t        en_offset;
+
+    //! Length of the name, excluding the NULL terminator.
+    uint32_t        en_length;
+
+    //! Index into es_entries of the first entry stored with this name.
+    int32_t         en_first;
+
+    //! Index into es_entries of the last entry stored with this name.
+    int32_t         en_last;
+
+    //! Number of live entries stored with this name.
+    int32_t         en_count;
+};
+
+//! One slot in the insertion ordered entry array.
+struct element_storage_entry
+{
+    //! Context stored in this slot. NULL if the context has been removed.
+    struct disir_context    *ee_context;
+
+    //! Interned name id this entry is stored by.
+    uint32_t                ee_name_id;
+
+    //! Index of the next entry stored by the same name, or ELEMENT_STORAGE_NO_ENTRY.
+    int32_t                 ee_next;
+
+    //! Token of the deferred element held by this slot, handed to the loader of the
+    //! storage when the slot is first accessed. Zero unless the slot is deferred.
+    uint64_t                ee_token;
+};
+
 //! Make the element storage a complete ADT to the entire library
 //! This way, we can really modify the internals without too much fuzz
 //! around the codebase on this rather important interface
 struct disir_element_storage
 {
-    // A multimap that holds all elements inserted by key.
-    // Multiple values may be associated with a key, of which are stored
-    // in insertion order.
-    // Key is a string name of the element to store. We make a copy of the key
-    // upon insertion, since foul things may happend if we reference the name
-    // stored inside a context object that has been freed.
-    // The map allows us to quickly retrieve named entries.
-    struct multimap *es_map;
-
-    // List to simply keep a insertion order of all keyval and section contexts
-    // The list lets us iterate all child context in order of insertion - important
+    // Flat array of every context stored, in insertion order.
+    // The array lets us iterate all child context in order of insertion - important
     // for the sake of consistency when exposing the raw dump of all children.
-    struct list     *es_list;
+    // Removed contexts leave a NULL slot behind, which are compacted away
+    // once they outnumber the live entries.
+    struct element_storage_entry    *es_entries;
+    int32_t                         es_entries_size;
+    uint32_t                        es_entries_capacity;
+
+    // Number of live (non-removed) entries in es_entries.
+    int32_t                         es_numentries;
+
+    // Table of interned names. Each entry in es_entries refer to its name by index
+    // into this table, and each name keep a chain through es_entries of all entries
+    // stored by that name, in insertion order.
+    struct element_storage_name     *es_names;
+    uint32_t                        es_names_size;
+    uint32_t                        es_names_capacity;
+
+    // Open-addressed (linear probing) hash index from name to name id.
+    // A slot hold name id + 1, where zero marks an empty slot.
+    // The capacity is always a power of two.
+    uint32_t                        *es_index;
+    uint32_t                        es_index_capacity;
+
+    // Pool holding a copy of every interned name, NULL terminated.
+    // We make a copy of the name, since foul things may happend if we reference the name
+    // stored inside a context object that has been freed.
+    char                            *es_name_pool;
+    uint32_t                        es_name_pool_size;
+    uint32_t                        es_name_pool_capacity;
+
+    // Set while the storage is being destroyed. Removal does not compact while set.
+    int                             es_destroying;
+
+    // Constructs the elements of deferred slots. See dx_element_storage_add_deferred().
+    dx_element_loader               es_loader;
+    void                            *es_loader_data;
+
+    // Index + 1 of the deferred slot being loaded, zero if none.
+    // The element added by the loader takes the place of this slot.
+    int32_t                         es_loading;
+    // Generation of the tree, bumped on every insertion and removal.
+    // Lets cached query resolutions detect that the tree they resolved may have changed.
+    uint64_t                        *es_generation;
 };
 
-// String hashing function for the multimap
-// http://www.cse.yorku.ca/~oz/hash.html
-static unsigned long djb2 (char *str)
+//! STATIC API
+//! Assign a new generation to the tree of storage, if any.
+static inline void
+element_storage_bump (struct disir_element_storage *storage)
 {
-    unsigned long hash = 5381;
-    char c;
-    while( (c = *str++) ) {
-        hash = ((hash << 5) + hash) + c;
+    if (storage->es_generation)
+        dx_context_generation_bump (storage->es_generation);
+}
+
+//! STATIC API
+//! 64-bit FNV-1a string hash. Outputs the length of the hashed string.
+static uint64_t
+element_storage_hash (const char *name, uint32_t *length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    const unsigned char *c = (const unsigned char *) name;
+
+    while (*c)
+    {
+        hash ^= *c++;
+        hash *= 1099511628211ULL;
     }
+
+    *length = (uint32_t) (c - (const unsigned char *) name);
     return hash;
 }
 
-//! INTERNAL API
-struct disir_element_storage *
-dx_element_storage_create (void)
+//! STATIC API
+//! Grow the array pointed to by array to hold at least 'required' elements of size 'size'.
+static enum disir_status
+element_storage_reserve (void **array, uint32_t *capacity, uint32_t required, size_t size)
 {
-    struct disir_element_storage *storage;
+    void *reallocated;
+    uint32_t new_capacity;
 
-    storage = calloc(1, sizeof (struct disir_element_storage));
-    if (storage == NULL)
+    if (required <= *capacity)
+        return DISIR_STATUS_OK;
+
+    new_capacity = (*capacity == 0 ? ELEMENT_STORAGE_INITIAL_CAPACITY : *capacity);
+    while (new_capacity < required)
+    {
+        new_capacity *= 2;
+    }
+
+    reallocated = realloc (*array, new_capacity * size);
+    if (reallocated == NULL)
     {
-        goto error;
+        log_warn ("element storage failed to grow to capacity %u", new_capacity);
+        return DISIR_STATUS_NO_MEMORY;
     }
 
-    storage->es_map = multimap_create ((int (*)(const void *, const void*)) strcmp,
-                                       (unsigned long (*)(const void*)) djb2);
-    if (storage->es_map == NULL)
+    *array = reallocated;
+    *capacity = new_capacity;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Locate the name id of name in storage.
+//! \return name id if found, -1 otherwise.
+static int64_t
+element_storage_name_lookup (struct disir_element_storage *storage, const char *name,
+                             uint64_t hash, uint32_t length)
+{
+    uint32_t mask;
+    uint32_t slot;
+    struct element_storage_name *candidate;
+
+    if (storage->es_index_capacity == 0)
+        return (-1);
+
+    mask = storage->es_index_capacity - 1;
+    slot = (uint32_t) hash & mask;
+    while (storage->es_index[slot] != 0)
     {
-        goto error;
+        candidate = &storage->es_names[storage->es_index[slot] - 1];
+        if (candidate->en_hash == hash && candidate->en_length == length &&
+            memcmp (storage->es_name_pool + candidate->en_offset, name, length) == 0)
+        {
+            return storage->es_index[slot] - 1;
+        }
+        slot = (slot + 1) & mask;
     }
 
-    storage->es_list = list_create ();
-    if (storage->es_list == NULL)
+    return (-1);
+}
+
+//! STATIC API
+//! Insert name id into a hash index. The index must have room for it.
+static void
+element_storage_index_insert (uint32_t *index, uint32_t capacity, uint64_t hash, uint32_t id)
+{
+    uint32_t mask;
+    uint32_t slot;
+
+    mask = capacity - 1;
+    slot = (uint32_t) hash & mask;
+    while (index[slot] != 0)
     {
-        goto error;
+        slot = (slot + 1) & mask;
     }
 
-    return storage;
-error:
-    if (storage && storage->es_map)
-        multimap_destroy (storage->es_map, NULL, NULL);
+    index[slot] = id + 1;
+}
+
+//! STATIC API
+//! Double the capacity of the hash index, re-inserting every interned name.
+static enum disir_status
+element_storage_index_grow (struct disir_element_storage *storage)
+{
+    uint32_t *index;
+    uint32_t capacity;
+    uint32_t i;
+
+    capacity = (storage->es_index_capacity == 0 ? 2 * ELEMENT_STORAGE_INITIAL_CAPACITY
+                                                : 2 * storage->es_index_capacity);
+
+    index = calloc (capacity, sizeof (uint32_t));
+    if (index == NULL)
+    {
+        log_warn ("element storage failed to allocate hash index of capacity %u", capacity);
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    for (i = 0; i < storage->es_names_size; i++)
+    {
+        element_storage_index_insert (index, capacity, storage->es_names[i].en_hash, i);
+    }
+
+    free (storage->es_index);
+    storage->es_index = index;
+    storage->es_index_capacity = capacity;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Intern name in storage, outputting its name id. Existing names are not duplicated.
+static enum disir_status
+element_storage_name_intern (struct disir_element_storage *storage, const char *name,
+                             uint32_t *name_id)
+{
+    enum disir_status status;
+    struct element_storage_name *entry;
+    uint64_t hash;
+    uint32_t length;
+    int64_t id;
+
+    hash = element_storage_hash (name, &length);
+    id = element_storage_name_lookup (storage, name, hash, length);
+    if (id >= 0)
+    {
+        *name_id = (uint32_t) id;
+        return DISIR_STATUS_OK;
+    }
+
+    // Keep the index load factor at or below one half.
+    if ((storage->es_names_size + 1) * 2 > storage->es_index_capacity)
+    {
+        status = element_storage_index_grow (storage);
+        if (status != DISIR_STATUS_OK)
+            return status;
+    }
+
+    status = element_storage_reserve ((void **) &storage->es_names, &storage->es_names_capacity,
+                                      storage->es_names_size + 1,
+                                      sizeof (struct element_storage_name));
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = element_storage_reserve ((void **) &storage->es_name_pool,
+                                      &storage->es_name_pool_capacity,
+                                      storage->es_name_pool_size + length + 1, sizeof (char));
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    entry = &storage->es_names[storage->es_names_size];
+    entry->en_hash = hash;
+    entry->en_offset = storage->es_name_pool_size;
+    entry->en_length = length;
+    entry->en_first = ELEMENT_STORAGE_NO_ENTRY;
+    entry->en_last = ELEMENT_STORAGE_NO_ENTRY;
+    entry->en_count = 0;
+
+    memcpy (storage->es_name_pool + storage->es_name_pool_size, name, length + 1);
+    storage->es_name_pool_size += length + 1;
+
+    element_storage_index_insert (storage->es_index, storage->es_index_capacity,
+                                  hash, storage->es_names_size);
+
+    *name_id = storage->es_names_size;
+    storage->es_names_size++;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Locate the interned name entry matching name. NULL if no such name is stored.
+static struct element_storage_name *
+element_storage_name_find (struct disir_element_storage *storage, const char *name)
+{
+    uint64_t hash;
+    uint32_t length;
+    int64_t id;
+
+    hash = element_storage_hash (name, &length);
+    id = element_storage_name_lookup (storage, name, hash, length);
+    if (id < 0)
+        return NULL;
+
+    return &storage->es_names[id];
+}
+
+//! STATIC API
+//! Append a slot holding either context or the deferred element token to storage.
+static enum disir_status
+element_storage_append (struct disir_element_storage *storage, const char *name,
+                        struct disir_context *context, uint64_t token)
+{
+    enum disir_status status;
+    struct element_storage_entry *entry;
+    struct element_storage_name *entry_name;
+    uint32_t name_id;
+    int32_t index;
+
+    // Reserve the entry slot first - interning the name cannot be rolled back.
+    status = element_storage_reserve ((void **) &storage->es_entries,
+                                      &storage->es_entries_capacity,
+                                      storage->es_entries_size + 1,
+                                      sizeof (struct element_storage_entry));
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = element_storage_name_intern (storage, name, &name_id);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    index = storage->es_entries_size;
+    entry = &storage->es_entries[index];
+    entry->ee_context = context;
+    entry->ee_name_id = name_id;
+    entry->ee_next = ELEMENT_STORAGE_NO_ENTRY;
+    entry->ee_token = token;
+
+    // Append to the chain of entries with this name, for chronological ordering.
+    entry_name = &storage->es_names[name_id];
+    if (entry_name->en_last == ELEMENT_STORAGE_NO_ENTRY)
+        entry_name->en_first = index;
+    else
+        storage->es_entries[entry_name->en_last].ee_next = index;
+    entry_name->en_last = index;
+    entry_name->en_count++;
+
+    storage->es_entries_size++;
+    storage->es_numentries++;
+    element_storage_bump (storage);
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Return non-zero if the slot neither holds a context nor a deferred element.
+static int
+element_storage_slot_removed (const struct element_storage_entry *entry)
+{
+    return (entry->ee_context == NULL && entry->ee_token == 0);
+}
+
+//! STATIC API
+//! Skip leading removed entries of the name chain, so that lookups by name stay cheap
+//! when elements are removed in insertion order.
+static void
+element_storage_name_skip_removed (struct disir_element_storage *storage,
+                                   struct element_storage_name *entry_name)
+{
+    while (entry_name->en_first != ELEMENT_STORAGE_NO_ENTRY &&
+           element_storage_slot_removed (&storage->es_entries[entry_name->en_first]))
+    {
+        entry_name->en_first = storage->es_entries[entry_name->en_first].ee_next;
+    }
+    if (entry_name->en_first == ELEMENT_STORAGE_NO_ENTRY)
+    {
+        entry_name->en_last = ELEMENT_STORAGE_NO_ENTRY;
+    }
+}
+
+//! STATIC API
+//! Construct the element of the deferred slot at index through the loader of storage.
+//! The slot does not count as an entry while it is loaded, such that the loader
+//! adds its element as any other. A slot the loader does not fill is left removed.
+//! No-op unless the slot is deferred.
+static void
+element_storage_load (struct disir_element_storage *storage, int32_t index)
+{
+    enum disir_status status;
+    struct element_storage_entry *entry;
+    uint32_t name_id;
+    int32_t loading;
+    uint64_t token;
+
+    entry = &storage->es_entries[index];
+    if (storage->es_loader == NULL || entry->ee_context != NULL || entry->ee_token == 0 ||
+        entry->ee_token == ELEMENT_STORAGE_TOKEN_LOADING)
+    {
+        return;
+    }
+
+    token = entry->ee_token;
+    name_id = entry->ee_name_id;
+    entry->ee_token = ELEMENT_STORAGE_TOKEN_LOADING;
+    storage->es_names[name_id].en_count--;
+    storage->es_numentries--;
+
+    loading = storage->es_loading;
+    storage->es_loading = index + 1;
+    status = storage->es_loader (storage->es_loader_data, token);
+    storage->es_loading = loading;
+
+    // The loader may have grown the entry array.
+    entry = &storage->es_entries[index];
+    if (entry->ee_context == NULL)
+    {
+        log_warn ("element storage %p failed to load deferred element '%s': %s",
+                  storage, storage->es_name_pool + storage->es_names[name_id].en_offset,
+                  disir_status_string (status));
+        entry->ee_token = 0;
+        element_storage_name_skip_removed (storage, &storage->es_names[name_id]);
+    }
+}
+
+//! STATIC API
+//! Remove every removed (NULL) slot from the entry array and rebuild the name chains.
+static void
+element_storage_compact (struct disir_element_storage *storage)
+{
+    struct element_storage_entry *entry;
+    struct element_storage_name *name;
+    int32_t read;
+    int32_t write;
+    uint32_t i;
+
+    log_debug (8, "compacting element storage %p (%d slots, %d live)",
+               storage, storage->es_entries_size, storage->es_numentries);
+
+    for (i = 0; i < storage->es_names_size; i++)
+    {
+        storage->es_names[i].en_first = ELEMENT_STORAGE_NO_ENTRY;
+        storage->es_names[i].en_last = ELEMENT_STORAGE_NO_ENTRY;
+    }
+
+    write = 0;
+    for (read = 0; read < storage->es_entries_size; read++)
+    {
+        if (element_storage_slot_removed (&storage->es_entries[read]))
+            continue;
+
+        entry = &storage->es_entries[write];
+        *entry = storage->es_entries[read];
+        entry->ee_next = ELEMENT_STORAGE_NO_ENTRY;
+
+        name = &storage->es_names[entry->ee_name_id];
+        if (name->en_last == ELEMENT_STORAGE_NO_ENTRY)
+            name->en_first = write;
+        else
+            storage->es_entries[name->en_last].ee_next = write;
+        name->en_last = write;
+
+        write++;
+    }
+
+    storage->es_entries_size = write;
+}
 
-    if (storage && storage->es_list)
-        list_destroy (&storage->es_list);
+//! INTERNAL API
+struct disir_element_storage *
+dx_element_storage_create (uint64_t *generation)
+{
+    struct disir_element_storage *storage;
 
-    if (storage)
-        free (storage);
+    // The internal arrays are allocated upon first insertion.
+    // A great deal of sections never hold any elements.
+    storage = calloc (1, sizeof (struct disir_element_storage));
+    if (storage == NULL)
+        return NULL;
 
-    return NULL;
+    storage->es_generation = generation;
+    element_storage_bump (storage);
+
+    return storage;
 }
 
 //! INTERNAL API
@@ -99,8 +523,8 @@ error:
 enum disir_status
 dx_element_storage_destroy (struct disir_element_storage **storage)
 {
-    list_iterator_t *iter;
     struct disir_context *context;
+    int32_t i;
 
     TRACE_ENTER ("stroage: %p", storage);
 
@@ -110,21 +534,18 @@ dx_element_storage_destroy (struct disir_element_storage **storage)
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    iter = list_iterator_create ((*storage)->es_list, LIST_HEAD);
-    if (iter == NULL)
-    {
-        log_warn ("list_iterator_create allocation failed.");
-        return DISIR_STATUS_NO_MEMORY;
-    }
+    (*storage)->es_destroying = 1;
+    element_storage_bump (*storage);
 
-    // Destroy each context stored in the element storage (through the list)
-    while ((context = list_iterator_next (iter)))
+    // Destroy each context stored in the element storage (in insertion order)
+    for (i = 0; i < (*storage)->es_entries_size; i++)
     {
-        log_debug(9, "destroying context %p in list belonging to storage", context);
+        context = (*storage)->es_entries[i].ee_context;
         // Ignore return code - we just want to destroy and get out of town.
         // Destroying the context will decref our reference on it.
         if (context)
         {
+            log_debug(9, "destroying context %p in list belonging to storage", context);
             // We are destroying a child of us - this dc_destroy call will
             // remove our reference which we keep in the element storage.
             // However, the dc_destroy call will reach back into this storage,
@@ -137,11 +558,10 @@ dx_element_storage_destroy (struct disir_element_storage **storage)
         }
     }
 
-    // Destroy iterator and element_storage data structures
-    // multimap key is heap allocated upon insertion - free it upon deletion.
-    list_iterator_destroy (&iter);
-    list_destroy (&(*storage)->es_list);
-    multimap_destroy ((*storage)->es_map, free, NULL);
+    free ((*storage)->es_entries);
+    free ((*storage)->es_names);
+    free ((*storage)->es_index);
+    free ((*storage)->es_name_pool);
 
     free (*storage);
     *storage = NULL;
@@ -157,13 +577,24 @@ dx_element_storage_numentries (struct disir_element_storage *storage)
     if (storage == NULL)
         return (-1);
 
-    // Get the number of entries from the multimap
-    return multimap_size (storage->es_map);
+    return storage->es_numentries;
+}
+
+//! INTERNAL API
+int32_t
+dx_element_storage_count (struct disir_element_storage *storage, const char *name)
+{
+    struct element_storage_name *entry_name;
+
+    entry_name = element_storage_name_find (storage, name);
+    if (entry_name == NULL)
+        return 0;
+
+    return entry_name->en_count;
 }
 
 //! INTERNAL API
-//! Make a copy of the input name to use as key for multimap. Only allocate if no such
-//! key exist in the map.
+//! Intern a copy of the input name, if no such name exist in storage.
 //! Will increment context refcount.
 enum disir_status
 dx_element_storage_add (struct disir_element_storage *storage,
@@ -171,9 +602,9 @@ dx_element_storage_add (struct disir_element_storage *storage,
                         struct disir_context *context)
 {
     enum disir_status status;
-    int res;
-    int keys_in_map;
-    char *key;
+    struct element_storage_entry *entry;
+    struct element_storage_name *entry_name;
+    int32_t index;
 
     if (storage == NULL || name == NULL || context == NULL)
     {
@@ -182,58 +613,43 @@ dx_element_storage_add (struct disir_element_storage *storage,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    keys_in_map = multimap_contains_key (storage->es_map, name);
-    if (keys_in_map == 0)
+    if (context->CONTEXT_STATE_IN_PARENT)
     {
-        // Map does not contain a key with this name. Allocate space to store
-        // key in, so we can safely access the key memory even if the appointed context
-        // is destroyed whilst in our storage.
-        key = malloc (strlen (name) + 1); // XXX: Is there a more safe way to allocate this memory?
-        memcpy(key, name, strlen (name) + 1);
+        log_warn ("attempted to add context (%p) to element storage which already exists",
+                context);
+        return DISIR_STATUS_EXISTS;
     }
 
-    // Add to map - will check if it already exists or not.
-    res = multimap_push_value (storage->es_map,
-            (keys_in_map ? name : key),
-            context);
-    if (res == (-ENOMEM))
+    // The element constructed for a deferred slot takes the place of that slot.
+    if (storage->es_loading != 0)
     {
-        log_warn ("multimap_push_value failed to allocate sufficient memory.");
-        status = DISIR_STATUS_NO_MEMORY;
-        goto map_error;
-    }
-    else if (res != 0)
-    {
-        log_warn ("attempted to add context (%p) to element storage which already exists",
-                context);
-        status = DISIR_STATUS_EXISTS;
-        goto map_error;
+        index = storage->es_loading - 1;
+        entry = &storage->es_entries[index];
+        entry_name = element_storage_name_find (storage, name);
+        if (entry->ee_token == ELEMENT_STORAGE_TOKEN_LOADING &&
+            entry_name == &storage->es_names[entry->ee_name_id])
+        {
+            storage->es_loading = 0;
+            entry->ee_context = context;
+            entry->ee_token = 0;
+            entry_name->en_count++;
+            storage->es_numentries++;
+            element_storage_bump (storage);
+
+            dx_context_incref (context);
+            return DISIR_STATUS_OK;
+        }
     }
 
-    // Add to list for chronological ordering.
-    if (list_rpush (storage->es_list, context))
+    status = element_storage_append (storage, name, context, 0);
+    if (status != DISIR_STATUS_OK)
     {
-        status = DISIR_STATUS_INTERNAL_ERROR;
-        goto list_error;
+        return status;
     }
 
     dx_context_incref (context);
 
     return DISIR_STATUS_OK;;
-list_error:
-    multimap_remove_value (storage->es_map,
-        (keys_in_map ? name : key),
-        free, // Free's the allocated memory above, if removing last element with this key name.
-        NULL);
-
-map_error:
-    if (keys_in_map == 0)
-    {
-        // Allocated on heap - free it.
-        free (key);
-    }
-
-    return status;
 }
 
 enum disir_status
@@ -241,13 +657,61 @@ dx_element_storage_remove (struct disir_element_storage *storage,
                            const char * const name,
                            struct disir_context *context)
 {
-    multimap_remove_value (storage->es_map, name, free, context);
-    if (!list_remove (storage->es_list, context))
+    struct element_storage_name *entry_name;
+    int32_t index;
+
+    if (storage == NULL || context == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (storage %p, context %p)", storage, context);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    entry_name = (name != NULL ? element_storage_name_find (storage, name) : NULL);
+
+    index = ELEMENT_STORAGE_NO_ENTRY;
+    if (entry_name)
+    {
+        index = entry_name->en_first;
+        while (index != ELEMENT_STORAGE_NO_ENTRY &&
+               storage->es_entries[index].ee_context != context)
+        {
+            index = storage->es_entries[index].ee_next;
+        }
+    }
+
+    // Not stored by the input name - fall back to searching every slot.
+    if (index == ELEMENT_STORAGE_NO_ENTRY)
+    {
+        for (index = storage->es_entries_size - 1; index >= 0; index--)
+        {
+            if (storage->es_entries[index].ee_context == context)
+                break;
+        }
+        if (index < 0)
+        {
+            return DISIR_STATUS_OK;
+        }
+        entry_name = &storage->es_names[storage->es_entries[index].ee_name_id];
+    }
+
+    log_debug(8, "removing context %p from storage", context);
+
+    storage->es_entries[index].ee_context = NULL;
+    storage->es_numentries--;
+    entry_name->en_count--;
+    element_storage_bump (storage);
+
+    element_storage_name_skip_removed (storage, entry_name);
+
+    // Slot indices must stay put while a deferred slot is loaded.
+    if (storage->es_destroying == 0 && storage->es_loading == 0 &&
+        storage->es_entries_size - storage->es_numentries > storage->es_numentries)
     {
-        log_debug(8, "removing context %p from storage", context);
-        dx_context_decref (&context);
+        element_storage_compact (storage);
     }
 
+    dx_context_decref (&context);
+
     return DISIR_STATUS_OK;
 }
 
@@ -257,47 +721,38 @@ dx_element_storage_get (struct disir_element_storage *storage,
                         struct disir_collection **collection)
 {
     enum disir_status status;
-    struct disir_context *context;
     struct disir_collection *col;
-    struct multimap_value_iterator *iter;
+    struct element_storage_name *entry_name;
+    int32_t index;
 
-    iter = multimap_fetch (storage->es_map, name);
-    if (iter == NULL)
+    entry_name = element_storage_name_find (storage, name);
+    if (entry_name == NULL || entry_name->en_count == 0)
     {
         return DISIR_STATUS_NOT_EXIST;
     }
     col = dc_collection_create ();
-    if (collection == NULL)
+    if (col == NULL)
     {
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
+        return DISIR_STATUS_NO_MEMORY;
     }
 
-    while ((context = multimap_iterator_next (iter)))
+    for (index = entry_name->en_first; index != ELEMENT_STORAGE_NO_ENTRY;
+         index = storage->es_entries[index].ee_next)
     {
-        status = dc_collection_push_context (col, context);
+        element_storage_load (storage, index);
+        if (storage->es_entries[index].ee_context == NULL)
+            continue;
+
+        status = dc_collection_push_context (col, storage->es_entries[index].ee_context);
         if (status != DISIR_STATUS_OK)
         {
-            goto error;
+            dc_collection_finished (&col);
+            return status;
         }
     }
 
-    multimap_iterator_destroy (iter);
-
     *collection = col;
     return DISIR_STATUS_OK;
-error:
-
-    if (col)
-    {
-        dc_collection_finished (&col);
-    }
-    if (iter)
-    {
-        multimap_iterator_destroy (iter);
-    }
-
-    return status;
 }
 
 // INTERNAL API
@@ -306,12 +761,8 @@ dx_element_storage_get_all (struct disir_element_storage *storage,
                             struct disir_collection **collection)
 {
     enum disir_status status;
-    struct disir_context *context;
     struct disir_collection *coll;
-    struct list_iterator *iter;
-
-    coll = NULL;
-    iter = NULL;
+    int32_t index;
 
     if (storage == NULL)
     {
@@ -324,45 +775,32 @@ dx_element_storage_get_all (struct disir_element_storage *storage,
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    iter = list_iterator_create (storage->es_list, LIST_HEAD);
-    if (iter == NULL)
-    {
-        log_warn ("in element_storage (%p) - list_iterator_create failed", storage);
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
-    }
-
     coll = dc_collection_create ();
     if (coll == NULL)
     {
         log_warn (
             "in element_storage (%p) - dc_collection_create failed to allocate sufficient memory",
             storage);
-        status = DISIR_STATUS_NO_MEMORY;
-        goto error;
+        return DISIR_STATUS_NO_MEMORY;
     }
 
-    while ((context = list_iterator_next (iter)))
+    for (index = 0; index < storage->es_entries_size; index++)
     {
-        status = dc_collection_push_context (coll, context);
+        element_storage_load (storage, index);
+        if (storage->es_entries[index].ee_context == NULL)
+            continue;
+
+        status = dc_collection_push_context (coll, storage->es_entries[index].ee_context);
         if (status != DISIR_STATUS_OK)
-            goto error;
+        {
+            dc_collection_finished (&coll);
+            return status;
+        }
     }
 
-    list_iterator_destroy (&iter);
-
     *collection = coll;
 
     return DISIR_STATUS_OK;
-error:
-    if (iter)
-        list_iterator_destroy (&iter);
-    if (coll)
-    {
-        dc_collection_finished (&coll);
-    }
-
-    return status;
 }
 
 //! INTERNAL API
@@ -371,16 +809,135 @@ dx_element_storage_get_first(struct disir_element_storage *storage,
                              const char *name,
                              struct disir_context **context)
 {
-    struct disir_context *keyval;
+    struct element_storage_name *entry_name;
+    int32_t index;
 
-    keyval = multimap_get_first (storage->es_map, name);
-    if (keyval == NULL)
+    entry_name = element_storage_name_find (storage, name);
+    if (entry_name == NULL)
     {
         return DISIR_STATUS_NOT_EXIST;
     }
 
-    *context = keyval;
-    return DISIR_STATUS_OK;
+    // The first entry is live, unless it is a deferred slot that fails to load.
+    for (index = entry_name->en_first; index != ELEMENT_STORAGE_NO_ENTRY;
+         index = storage->es_entries[index].ee_next)
+    {
+        element_storage_load (storage, index);
+        if (storage->es_entries[index].ee_context != NULL)
+        {
+            *context = storage->es_entries[index].ee_context;
+            return DISIR_STATUS_OK;
+        }
+    }
+
+    return DISIR_STATUS_NOT_EXIST;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_element_storage_get_index (struct disir_element_storage *storage,
+                              const char *name, int32_t index,
+                              struct disir_context **context)
+{
+    struct element_storage_name *entry_name;
+    int32_t entry;
+
+    entry_name = element_storage_name_find (storage, name);
+    if (entry_name == NULL || index < 0 || index >= entry_name->en_count)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    for (entry = entry_name->en_first; entry != ELEMENT_STORAGE_NO_ENTRY;
+         entry = storage->es_entries[entry].ee_next)
+    {
+        element_storage_load (storage, entry);
+        if (storage->es_entries[entry].ee_context == NULL)
+            continue;
+
+        if (index-- == 0)
+        {
+            *context = storage->es_entries[entry].ee_context;
+            return DISIR_STATUS_OK;
+        }
+    }
+
+    return DISIR_STATUS_NOT_EXIST;
 }
 
+//! INTERNAL API
+void
+dx_element_storage_iter_begin (struct disir_element_storage *storage, const char *name,
+                               struct disir_element_iter *iter)
+{
+    struct element_storage_name *entry_name;
+
+    iter->ei_storage = storage;
+    iter->ei_by_name = (name != NULL);
+    iter->ei_index = 0;
+
+    if (name)
+    {
+        entry_name = element_storage_name_find (storage, name);
+        iter->ei_index = (entry_name ? entry_name->en_first : ELEMENT_STORAGE_NO_ENTRY);
+    }
+}
+
+//! INTERNAL API
+enum disir_status
+dx_element_storage_iter_next (struct disir_element_iter *iter, struct disir_context **context)
+{
+    struct disir_element_storage *storage;
+    int32_t index;
+
+    storage = iter->ei_storage;
+    index = iter->ei_index;
+
+    // Removed contexts leave a NULL slot behind - skip them.
+    // The bounds check keeps an iterator over a mutated storage from reading out of bounds.
+    while (index != ELEMENT_STORAGE_NO_ENTRY && index < storage->es_entries_size)
+    {
+        element_storage_load (storage, index);
+        *context = storage->es_entries[index].ee_context;
+        index = (iter->ei_by_name ? storage->es_entries[index].ee_next : index + 1);
+        if (*context != NULL)
+        {
+            iter->ei_index = index;
+            return DISIR_STATUS_OK;
+        }
+    }
+
+    iter->ei_index = ELEMENT_STORAGE_NO_ENTRY;
+    *context = NULL;
+    return DISIR_STATUS_EXHAUSTED;
+}
+
+//! INTERNAL API
+void
+dx_element_storage_set_loader (struct disir_element_storage *storage,
+                               dx_element_loader loader, void *data)
+{
+    storage->es_loader = loader;
+    storage->es_loader_data = data;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_element_storage_add_deferred (struct disir_element_storage *storage,
+                                 const char *name, uint64_t token)
+{
+    if (storage == NULL || name == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (storage %p, name %p)", storage, name);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+    if (storage->es_loader == NULL || token == 0 || token == ELEMENT_STORAGE_TOKEN_LOADING)
+    {
+        log_debug (0, "invoked without loader (%p) or with reserved token (%llu)",
+                   storage->es_loader, (unsigned long long) token);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    return element_storage_append (storage, name, NULL, token);
+}
 
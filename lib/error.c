@@ -29,6 +29,20 @@ disir_log_user (struct disir_instance *instance, const char *message, ...)
     va_end (args);
 }
 
+//! PUBLIC API
+void
+disir_log_set_sink (disir_log_sink sink, void *data)
+{
+    dx_log_set_sink (sink, data);
+}
+
+//! PUBLIC API
+void
+disir_log_flush (void)
+{
+    dx_log_flush ();
+}
+
 //! PUBLIC API
 void
 disir_error_set (struct disir_instance *instance, const char *message, ...)
@@ -0,0 +1,52 @@
+// public
+#include <disir/disir.h>
+#include <disir/fslib/util.h>
+#include <disir/fslib/binary.h>
+
+
+//! PLUGIN API
+enum disir_status
+dio_binary_config_read (struct disir_instance *instance,
+                        struct disir_register_plugin *plugin, const char *entry_id,
+                        struct disir_mold *mold, struct disir_config **config)
+{
+    return fslib_plugin_config_read_span (instance, plugin, entry_id, mold,
+                                          config, dio_binary_unserialize_config_span);
+}
+
+//! PLUGIN API
+enum disir_status
+dio_binary_config_write (struct disir_instance *instance,
+                         struct disir_register_plugin *plugin, const char *entry_id,
+                         struct disir_config *config)
+{
+    return fslib_plugin_config_write (instance, plugin, entry_id,
+                                      config, dio_binary_serialize_config);
+}
+
+//! PLUGIN API
+enum disir_status
+dio_binary_config_remove (struct disir_instance *instance,
+                          struct disir_register_plugin *plugin, const char *entry_id)
+{
+    return fslib_plugin_config_remove (instance, plugin, entry_id);
+}
+
+//! PLUGIN API
+enum disir_status
+dio_binary_config_entries (struct disir_instance *instance,
+                           struct disir_register_plugin *plugin,
+                           struct disir_entry **entries)
+{
+    return fslib_config_query_entries (instance, plugin, NULL, entries);
+}
+
+//! PLUGIN API
+enum disir_status
+dio_binary_config_query (struct disir_instance *instance,
+                         struct disir_register_plugin *plugin,
+                         const char *entry_id,
+                         struct disir_entry **entry)
+{
+    return fslib_plugin_config_query (instance, plugin, entry_id, entry);
+}
@@ -0,0 +1,283 @@
+// public
+#include <disir/disir.h>
+#include <disir/fslib/binary.h>
+
+// standard
+#include <stdlib.h>
+#include <string.h>
+
+// private
+#include "config.h"
+#include "mold.h"
+#include "log.h"
+#include "binary/binary_format.h"
+
+
+//! Growing buffer the image is assembled in before it is written.
+struct binary_writer
+{
+    char        *bw_data;
+    size_t      bw_size;
+    size_t      bw_capacity;
+    //! Set once an allocation has failed. Further writes are ignored.
+    int         bw_failed;
+};
+
+//! STATIC API
+//! Reserve size bytes at the end of the buffer. NULL if the buffer could not grow.
+static char *
+binary_reserve (struct binary_writer *writer, size_t size)
+{
+    char *data;
+    size_t capacity;
+
+    if (writer->bw_failed)
+        return NULL;
+
+    if (writer->bw_size + size > writer->bw_capacity)
+    {
+        capacity = (writer->bw_capacity ? writer->bw_capacity : 4096);
+        while (capacity < writer->bw_size + size)
+        {
+            capacity *= 2;
+        }
+
+        data = realloc (writer->bw_data, capacity);
+        if (data == NULL)
+        {
+            writer->bw_failed = 1;
+            return NULL;
+        }
+        writer->bw_data = data;
+        writer->bw_capacity = capacity;
+    }
+
+    data = writer->bw_data + writer->bw_size;
+    writer->bw_size += size;
+    return data;
+}
+
+//! STATIC API
+static void
+binary_put (struct binary_writer *writer, const void *value, size_t size)
+{
+    char *data;
+
+    data = binary_reserve (writer, size);
+    if (data)
+        memcpy (data, value, size);
+}
+
+//! STATIC API
+static void
+binary_put_u32 (struct binary_writer *writer, uint32_t value)
+{
+    binary_put (writer, &value, sizeof (value));
+}
+
+//! STATIC API
+//! Put the size of string, followed by string and its null terminator.
+static void
+binary_put_string (struct binary_writer *writer, const char *string, size_t size)
+{
+    binary_put_u32 (writer, (uint32_t) size);
+    binary_put (writer, string, size);
+    binary_put (writer, "", 1);
+}
+
+//! STATIC API
+static enum disir_status
+binary_put_value (struct binary_writer *writer, struct disir_context *context,
+                  enum disir_value_type type)
+{
+    enum disir_status status;
+    const char *string;
+    int32_t size;
+    int64_t integer;
+    double floating;
+    uint8_t boolean;
+
+    string = NULL;
+    size = 0;
+
+    switch (type)
+    {
+    case DISIR_VALUE_TYPE_STRING:
+        status = dc_get_value_string (context, &string, &size);
+        if (status == DISIR_STATUS_OK)
+            binary_put_string (writer, (string ? string : ""), (string ? size : 0));
+        break;
+    case DISIR_VALUE_TYPE_ENUM:
+        status = dc_get_value_enum (context, &string, &size);
+        if (status == DISIR_STATUS_OK)
+            binary_put_string (writer, (string ? string : ""), (string ? size : 0));
+        break;
+    case DISIR_VALUE_TYPE_INTEGER:
+        status = dc_get_value_integer (context, &integer);
+        if (status == DISIR_STATUS_OK)
+            binary_put (writer, &integer, sizeof (integer));
+        break;
+    case DISIR_VALUE_TYPE_FLOAT:
+        status = dc_get_value_float (context, &floating);
+        if (status == DISIR_STATUS_OK)
+            binary_put (writer, &floating, sizeof (floating));
+        break;
+    case DISIR_VALUE_TYPE_BOOLEAN:
+        status = dc_get_value_boolean (context, &boolean);
+        if (status == DISIR_STATUS_OK)
+            binary_put (writer, &boolean, sizeof (boolean));
+        break;
+    default:
+        // Keyvals without a mold equivalent hold no value to write.
+        status = DISIR_STATUS_OK;
+        break;
+    }
+
+    return status;
+}
+
+//! STATIC API
+//! Put the element block of the config or section context.
+static enum disir_status
+binary_put_elements (struct disir_instance *instance, struct binary_writer *writer,
+                     struct disir_context *context)
+{
+    enum disir_status status;
+    struct disir_element_iter iter;
+    struct disir_context *element;
+    enum disir_context_type type;
+    enum disir_value_type value_type;
+    const char *name;
+    int32_t name_size;
+    size_t count_offset;
+    size_t record_offset;
+    uint32_t count;
+    uint32_t record_size;
+    uint8_t header[4];
+
+    status = dc_element_iter_begin (context, NULL, &iter);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    count = 0;
+    count_offset = writer->bw_size;
+    binary_put_u32 (writer, 0);
+
+    while ((status = dc_element_iter_next (&iter, &element)) == DISIR_STATUS_OK)
+    {
+        type = dc_context_type (element);
+        value_type = DISIR_VALUE_TYPE_UNKNOWN;
+        if (type == DISIR_CONTEXT_KEYVAL)
+        {
+            dc_get_value_type (element, &value_type);
+        }
+
+        status = dc_get_name (element, &name, &name_size);
+        if (status != DISIR_STATUS_OK)
+        {
+            disir_error_set (instance, "could not retrieve name of %s: %s",
+                             dc_context_type_string (element), disir_status_string (status));
+            return status;
+        }
+
+        record_offset = writer->bw_size;
+        header[0] = (uint8_t) type;
+        header[1] = (uint8_t) (type == DISIR_CONTEXT_KEYVAL ? value_type : 0);
+        header[2] = 0;
+        header[3] = 0;
+        binary_put_u32 (writer, 0);
+        binary_put (writer, header, sizeof (header));
+        binary_put_string (writer, name, name_size);
+
+        if (type == DISIR_CONTEXT_SECTION)
+        {
+            status = binary_put_elements (instance, writer, element);
+        }
+        else
+        {
+            status = binary_put_value (writer, element, value_type);
+        }
+        if (status != DISIR_STATUS_OK)
+        {
+            disir_error_set (instance, "could not write %s '%s': %s",
+                             dc_context_type_string (element), name,
+                             disir_status_string (status));
+            return status;
+        }
+
+        if (writer->bw_failed)
+            return DISIR_STATUS_NO_MEMORY;
+
+        record_size = (uint32_t) (writer->bw_size - record_offset);
+        memcpy (writer->bw_data + record_offset, &record_size, sizeof (record_size));
+        count++;
+    }
+    if (status != DISIR_STATUS_EXHAUSTED)
+        return status;
+
+    if (writer->bw_failed)
+        return DISIR_STATUS_NO_MEMORY;
+
+    memcpy (writer->bw_data + count_offset, &count, sizeof (count));
+    return DISIR_STATUS_OK;
+}
+
+//! FSLIB API
+enum disir_status
+dio_binary_serialize_config (struct disir_instance *instance,
+                             struct disir_config *config, FILE *output)
+{
+    enum disir_status status;
+    struct binary_writer writer;
+    struct binary_config_header header;
+    struct disir_version mold_version;
+
+    if (instance == NULL || config == NULL || output == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), config (%p), output (%p)",
+                   instance, config, output);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset (&writer, 0, sizeof (writer));
+    memset (&header, 0, sizeof (header));
+
+    status = dc_mold_get_version (config->cf_mold, &mold_version);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    memcpy (header.bh_magic, BINARY_CONFIG_MAGIC, sizeof (header.bh_magic));
+    header.bh_format = BINARY_CONFIG_FORMAT;
+    header.bh_byte_order = BINARY_CONFIG_BYTE_ORDER;
+    header.bh_config_version_major = config->cf_version.sv_major;
+    header.bh_config_version_minor = config->cf_version.sv_minor;
+    header.bh_mold_version_major = mold_version.sv_major;
+    header.bh_mold_version_minor = mold_version.sv_minor;
+    if (disir_config_valid (config, NULL) == DISIR_STATUS_OK)
+    {
+        header.bh_flags |= BINARY_CONFIG_FLAG_VALID;
+    }
+
+    status = binary_put_elements (instance, &writer, config->cf_context);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto out;
+    }
+
+    header.bh_size = sizeof (header) + writer.bw_size;
+    header.bh_checksum = binary_checksum (writer.bw_data, writer.bw_size);
+
+    if (fwrite (&header, sizeof (header), 1, output) != 1
+        || fwrite (writer.bw_data, 1, writer.bw_size, output) != writer.bw_size
+        || fflush (output) != 0)
+    {
+        disir_error_set (instance, "could not write binary config");
+        status = DISIR_STATUS_FS_ERROR;
+    }
+
+out:
+    free (writer.bw_data);
+    return status;
+}
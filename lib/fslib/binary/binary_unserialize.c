@@ -0,0 +1,573 @@
+// public
+#include <disir/disir.h>
+#include <disir/fslib/binary.h>
+
+// standard
+#include <stdlib.h>
+#include <string.h>
+
+// private
+#include "context_private.h"
+#include "config.h"
+#include "section.h"
+#include "keyval.h"
+#include "element_storage.h"
+#include "arena.h"
+#include "log.h"
+#include "binary/binary_format.h"
+
+
+//! Image elements are decoded from.
+struct binary_reader
+{
+    const char      *br_data;
+    uint64_t        br_size;
+};
+
+//! Decoded fixed part of a record.
+struct binary_record
+{
+    uint8_t         rc_type;
+    uint8_t         rc_value_type;
+    const char      *rc_name;
+    uint32_t        rc_name_size;
+    //! Offset of the value of a keyval, or the element block of a section.
+    uint64_t        rc_payload;
+    //! Offset following the record.
+    uint64_t        rc_end;
+};
+
+//! Loader data of an element storage holding deferred elements of the image.
+struct binary_scope
+{
+    const struct binary_reader  *bs_reader;
+    //! Context owning the element storage.
+    struct disir_context        *bs_parent;
+};
+
+static enum disir_status
+binary_load (void *data, uint64_t token);
+
+//! STATIC API
+//! Copy size bytes at offset into value, unless they extend beyond end.
+static int
+binary_get (const struct binary_reader *reader, uint64_t offset, uint64_t end,
+            void *value, size_t size)
+{
+    if (offset > end || end - offset < size)
+        return -1;
+
+    memcpy (value, reader->br_data + offset, size);
+    return 0;
+}
+
+//! STATIC API
+//! Read a size prefixed, null terminated string at offset, ending before end.
+static int
+binary_get_string (const struct binary_reader *reader, uint64_t offset, uint64_t end,
+                   const char **string, uint32_t *size)
+{
+    if (binary_get (reader, offset, end, size, sizeof (*size)))
+        return -1;
+
+    offset += sizeof (*size);
+    if (end - offset <= *size || reader->br_data[offset + *size] != '\0')
+        return -1;
+
+    *string = reader->br_data + offset;
+    return 0;
+}
+
+//! STATIC API
+//! Decode the record at offset, which must end before end.
+static enum disir_status
+binary_read_record (const struct binary_reader *reader, uint64_t offset, uint64_t end,
+                    struct binary_record *record)
+{
+    uint32_t size;
+    uint8_t header[4];
+
+    if (binary_get (reader, offset, end, &size, sizeof (size)) ||
+        size < BINARY_CONFIG_RECORD_HEADER_SIZE || size > end - offset)
+    {
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    record->rc_end = offset + size;
+    binary_get (reader, offset + 4, record->rc_end, header, sizeof (header));
+    if (binary_get_string (reader, offset + 8, record->rc_end,
+                           &record->rc_name, &record->rc_name_size))
+    {
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    record->rc_type = header[0];
+    record->rc_value_type = header[1];
+    record->rc_payload = offset + BINARY_CONFIG_RECORD_HEADER_SIZE + record->rc_name_size + 1;
+
+    if (record->rc_type != DISIR_CONTEXT_KEYVAL && record->rc_type != DISIR_CONTEXT_SECTION)
+    {
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Set the value of the keyval record on context.
+static enum disir_status
+binary_set_value (const struct binary_reader *reader, struct binary_record *record,
+                  struct disir_context *context)
+{
+    const char *string;
+    uint32_t size;
+    int64_t integer;
+    double floating;
+    uint8_t boolean;
+
+    switch (record->rc_value_type)
+    {
+    case DISIR_VALUE_TYPE_STRING:
+    case DISIR_VALUE_TYPE_ENUM:
+        if (binary_get_string (reader, record->rc_payload, record->rc_end, &string, &size))
+            return DISIR_STATUS_FS_ERROR;
+        if (record->rc_value_type == DISIR_VALUE_TYPE_ENUM)
+            return dc_set_value_enum (context, string, size);
+        return dc_set_value_string (context, string, size);
+    case DISIR_VALUE_TYPE_INTEGER:
+        if (binary_get (reader, record->rc_payload, record->rc_end, &integer, sizeof (integer)))
+            return DISIR_STATUS_FS_ERROR;
+        return dc_set_value_integer (context, integer);
+    case DISIR_VALUE_TYPE_FLOAT:
+        if (binary_get (reader, record->rc_payload, record->rc_end, &floating, sizeof (floating)))
+            return DISIR_STATUS_FS_ERROR;
+        return dc_set_value_float (context, floating);
+    case DISIR_VALUE_TYPE_BOOLEAN:
+        if (binary_get (reader, record->rc_payload, record->rc_end, &boolean, sizeof (boolean)))
+            return DISIR_STATUS_FS_ERROR;
+        return dc_set_value_boolean (context, boolean);
+    case DISIR_VALUE_TYPE_UNKNOWN:
+        // Written for keyvals without a mold equivalent.
+        return DISIR_STATUS_OK;
+    default:
+        return DISIR_STATUS_FS_ERROR;
+    }
+}
+
+//! STATIC API
+//! Element storage of the config or section context.
+static struct disir_element_storage *
+binary_storage (struct disir_context *context)
+{
+    if (dc_context_type (context) == DISIR_CONTEXT_CONFIG)
+        return context->cx_config->cf_elements;
+
+    return context->cx_section->se_elements;
+}
+
+//! STATIC API
+//! Defer every record of the element block at [offset, end) onto the storage of parent.
+static enum disir_status
+binary_defer_elements (const struct binary_reader *reader, struct disir_context *parent,
+                       uint64_t offset, uint64_t end)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct binary_scope *scope;
+    struct binary_record record;
+    uint32_t count;
+
+    if (binary_get (reader, offset, end, &count, sizeof (count)))
+        return DISIR_STATUS_FS_ERROR;
+    offset += sizeof (count);
+
+    if (count == 0)
+        return (offset == end ? DISIR_STATUS_OK : DISIR_STATUS_FS_ERROR);
+
+    scope = dx_arena_calloc (dx_context_arena (parent), sizeof (*scope));
+    if (scope == NULL)
+        return DISIR_STATUS_NO_MEMORY;
+    scope->bs_reader = reader;
+    scope->bs_parent = parent;
+
+    storage = binary_storage (parent);
+    dx_element_storage_set_loader (storage, binary_load, scope);
+
+    for (; count > 0; count--)
+    {
+        status = binary_read_record (reader, offset, end, &record);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        // The record offset is the token - it is never zero, since it follows the header.
+        status = dx_element_storage_add_deferred (storage, record.rc_name, offset);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        offset = record.rc_end;
+    }
+
+    return (offset == end ? DISIR_STATUS_OK : DISIR_STATUS_FS_ERROR);
+}
+
+//! STATIC API
+//! Attach the constructed context to its parent without validating it,
+//! taking the place of the deferred slot it was constructed for.
+static enum disir_status
+binary_attach (struct disir_context *context, int mismatch)
+{
+    enum disir_status status;
+    const char *name;
+
+    if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
+        name = context->cx_keyval->kv_name.dv_string;
+    else
+        name = context->cx_section->se_name.dv_string;
+
+    status = dx_element_storage_add (binary_storage (context->cx_parent_context), name, context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    // As dc_finalize - the reference of the constructor is handed over to the parent.
+    context->CONTEXT_STATE_IN_PARENT = 1;
+    context->CONTEXT_STATE_FINALIZED = 1;
+    context->CONTEXT_STATE_CONSTRUCTING = 0;
+
+    // The mold no longer agrees with the image - have it validated on next request.
+    if (mismatch)
+    {
+        dx_context_mark_dirty (context);
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Construct the element of the deferred slot at token.
+static enum disir_status
+binary_load (void *data, uint64_t token)
+{
+    enum disir_status status;
+    struct binary_scope *scope;
+    struct binary_record record;
+    struct disir_context *context;
+    int mismatch;
+
+    scope = data;
+    context = NULL;
+    mismatch = 0;
+
+    status = binary_read_record (scope->bs_reader, token, scope->bs_reader->br_size, &record);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_begin (scope->bs_parent, record.rc_type, &context);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_set_name (context, record.rc_name, record.rc_name_size);
+    if (status == DISIR_STATUS_NOT_EXIST)
+    {
+        mismatch = 1;
+    }
+    else if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    if (record.rc_type == DISIR_CONTEXT_SECTION)
+    {
+        status = binary_defer_elements (scope->bs_reader, context,
+                                        record.rc_payload, record.rc_end);
+        if (status != DISIR_STATUS_OK)
+            goto error;
+    }
+    else
+    {
+        status = binary_set_value (scope->bs_reader, &record, context);
+        if (status == DISIR_STATUS_FS_ERROR || status == DISIR_STATUS_NO_MEMORY)
+            goto error;
+        if (status != DISIR_STATUS_OK)
+            mismatch = 1;
+    }
+
+    status = binary_attach (context, mismatch);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    return DISIR_STATUS_OK;
+error:
+    dc_destroy (&context);
+    return status;
+}
+
+//! STATIC API
+//! Construct and finalize every record of the element block at [offset, end)
+//! as children of parent, validating each.
+static enum disir_status
+binary_read_elements (const struct binary_reader *reader, struct disir_context *parent,
+                      uint64_t offset, uint64_t end, int depth)
+{
+    enum disir_status status;
+    struct binary_record record;
+    struct disir_context *context;
+    uint32_t count;
+
+    if (depth > BINARY_CONFIG_MAX_DEPTH)
+        return DISIR_STATUS_FS_ERROR;
+
+    if (binary_get (reader, offset, end, &count, sizeof (count)))
+        return DISIR_STATUS_FS_ERROR;
+    offset += sizeof (count);
+
+    for (; count > 0; count--)
+    {
+        context = NULL;
+
+        status = binary_read_record (reader, offset, end, &record);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        offset = record.rc_end;
+
+        status = dc_begin (parent, record.rc_type, &context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        // If the name does not have a mold equivalent, we can continue.
+        status = dc_set_name (context, record.rc_name, record.rc_name_size);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
+            goto error;
+
+        if (record.rc_type == DISIR_CONTEXT_SECTION)
+        {
+            status = binary_read_elements (reader, context, record.rc_payload,
+                                           record.rc_end, depth + 1);
+            if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+                goto error;
+        }
+        else
+        {
+            // A value of the wrong type leaves the keyval invalid, but we can continue.
+            status = binary_set_value (reader, &record, context);
+            if (status != DISIR_STATUS_OK &&
+                status != DISIR_STATUS_INVALID_CONTEXT &&
+                status != DISIR_STATUS_WRONG_VALUE_TYPE)
+            {
+                goto error;
+            }
+        }
+
+        status = dc_finalize (&context);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+            goto error;
+
+        // If context is invalid we need to explicitly
+        // signal that we are done with it.
+        if (status == DISIR_STATUS_INVALID_CONTEXT)
+        {
+            dc_putcontext (&context);
+        }
+    }
+
+    return (offset == end ? DISIR_STATUS_OK : DISIR_STATUS_FS_ERROR);
+error:
+    dc_destroy (&context);
+    return status;
+}
+
+//! STATIC API
+//! Verify the header of the image in [data, data + size).
+static enum disir_status
+binary_read_header (struct disir_instance *instance, const char *data, size_t size,
+                    struct binary_config_header *header)
+{
+    if (size < sizeof (*header))
+    {
+        disir_error_set (instance, "binary config is truncated (%zu bytes)", size);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    memcpy (header, data, sizeof (*header));
+    if (memcmp (header->bh_magic, BINARY_CONFIG_MAGIC, sizeof (header->bh_magic)) != 0)
+    {
+        disir_error_set (instance, "not a binary config");
+        return DISIR_STATUS_FS_ERROR;
+    }
+    if (header->bh_format != BINARY_CONFIG_FORMAT ||
+        header->bh_byte_order != BINARY_CONFIG_BYTE_ORDER)
+    {
+        disir_error_set (instance, "binary config of format %u (byte order 0x%08x) is not supported",
+                         header->bh_format, header->bh_byte_order);
+        return DISIR_STATUS_NO_CAN_DO;
+    }
+    if (header->bh_size != size)
+    {
+        disir_error_set (instance, "binary config is %zu bytes, header states %llu",
+                         size, (unsigned long long) header->bh_size);
+        return DISIR_STATUS_FS_ERROR;
+    }
+    if (header->bh_checksum != binary_checksum (data + sizeof (*header), size - sizeof (*header)))
+    {
+        disir_error_set (instance, "binary config failed its checksum");
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! FSLIB API
+enum disir_status
+dio_binary_unserialize_config_span (struct disir_instance *instance,
+                                    const char *data, size_t size,
+                                    struct disir_mold *mold, struct disir_config **config)
+{
+    enum disir_status status;
+    struct binary_config_header header;
+    struct binary_reader *reader;
+    struct binary_reader eager;
+    struct disir_context *context_config;
+    struct disir_arena *arena;
+    struct disir_version version;
+    struct disir_version mold_version;
+    char *image;
+
+    if (instance == NULL || data == NULL || mold == NULL || config == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), data (%p), mold (%p), config (%p)",
+                   instance, data, mold, config);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    *config = NULL;
+    context_config = NULL;
+
+    status = binary_read_header (instance, data, size, &header);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_mold_get_version (mold, &mold_version);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    version.sv_major = header.bh_config_version_major;
+    version.sv_minor = header.bh_config_version_minor;
+    // Mold version is lower than config version
+    if (dc_version_compare (&version, &mold_version) > 0)
+        return DISIR_STATUS_CONFLICTING_SEMVER;
+
+    status = dc_config_begin (mold, &context_config);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    status = dc_enable_arena (context_config);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    status = dc_set_version (context_config, &version);
+    if (status != DISIR_STATUS_OK)
+        goto error;
+
+    if ((header.bh_flags & BINARY_CONFIG_FLAG_VALID) &&
+        header.bh_mold_version_major == mold_version.sv_major &&
+        header.bh_mold_version_minor == mold_version.sv_minor)
+    {
+        // Valid with this very mold - decode on demand from a copy owned by the config.
+        arena = dx_context_arena (context_config);
+        image = dx_arena_calloc (arena, size);
+        reader = dx_arena_calloc (arena, sizeof (*reader));
+        if (image == NULL || reader == NULL)
+        {
+            status = DISIR_STATUS_NO_MEMORY;
+            goto error;
+        }
+        memcpy (image, data, size);
+        reader->br_data = image;
+        reader->br_size = size;
+
+        status = binary_defer_elements (reader, context_config, sizeof (header), size);
+        if (status != DISIR_STATUS_OK)
+            goto malformed;
+
+        status = dx_config_finalize_trusted (&context_config, config);
+        if (status != DISIR_STATUS_OK)
+            goto error;
+
+        return DISIR_STATUS_OK;
+    }
+
+    log_debug (4, "decoding binary config eagerly (flags 0x%x, mold version %u.%u)",
+               header.bh_flags, header.bh_mold_version_major, header.bh_mold_version_minor);
+
+    eager.br_data = data;
+    eager.br_size = size;
+    status = binary_read_elements (&eager, context_config, sizeof (header), size, 0);
+    if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+        goto malformed;
+
+    status = dc_config_finalize (&context_config, config);
+    if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+        goto error;
+
+    return status;
+malformed:
+    if (status == DISIR_STATUS_FS_ERROR)
+        disir_error_set (instance, "binary config is malformed");
+error:
+    if (context_config)
+    {
+        dc_destroy (&context_config);
+    }
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+dio_binary_unserialize_config (struct disir_instance *instance, FILE *input,
+                               struct disir_mold *mold, struct disir_config **config)
+{
+    enum disir_status status;
+    char *data;
+    char *grown;
+    size_t size;
+    size_t capacity;
+    size_t read;
+
+    if (instance == NULL || input == NULL || mold == NULL || config == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), input (%p), mold (%p), config (%p)",
+                   instance, input, mold, config);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    data = NULL;
+    size = 0;
+    capacity = 0;
+    do
+    {
+        if (size == capacity)
+        {
+            capacity = (capacity ? capacity * 2 : 64 * 1024);
+            grown = realloc (data, capacity);
+            if (grown == NULL)
+            {
+                free (data);
+                return DISIR_STATUS_NO_MEMORY;
+            }
+            data = grown;
+        }
+
+        read = fread (data + size, 1, capacity - size, input);
+        size += read;
+    } while (read > 0);
+
+    if (ferror (input))
+    {
+        disir_error_set (instance, "could not read binary config");
+        free (data);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = dio_binary_unserialize_config_span (instance, data, size, mold, config);
+    free (data);
+    return status;
+}
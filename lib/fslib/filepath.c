@@ -2,6 +2,7 @@
 
 #include <limits.h>
 #include <errno.h>
+#include <string.h>
 
 //! FSLIB API
 enum disir_status
@@ -47,6 +48,42 @@ fslib_mold_resolve_filepath (struct disir_instance *instance, struct disir_regis
     return DISIR_STATUS_OK;
 }
 
+//! FSLIB API
+enum disir_status
+fslib_mold_compiled_filepath (struct disir_instance *instance,
+                              struct disir_register_plugin *plugin, const char *entry_id,
+                              const char *mold_filepath, const char *override_filepath,
+                              char *filepath)
+{
+    enum disir_status status;
+    char nominal_filepath[PATH_MAX];
+    int namespace_entry;
+    int res;
+
+    status = fslib_mold_resolve_filepath (instance, plugin, entry_id, nominal_filepath);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    // Each combination of entries the mold may be read from has an image of its own,
+    // such that removing an entry never leaves an image of the old combination in use.
+    namespace_entry = (strcmp (mold_filepath, nominal_filepath) != 0);
+
+    res = snprintf (filepath, PATH_MAX, "%s/%s%s%s.%s.compiled",
+                    plugin->dp_mold_base_id, entry_id,
+                    (namespace_entry ? ".namespace" : ""),
+                    (override_filepath && *override_filepath != '\0' ? ".o" : ""),
+                    plugin->dp_mold_entry_type);
+
+    if (res >= PATH_MAX)
+    {
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! FSLIB API
 enum disir_status
 fslib_stat_filepath (struct disir_instance *instance,
@@ -10,8 +10,8 @@ dio_json_config_read (struct disir_instance *instance,
                       struct disir_register_plugin *plugin, const char *entry_id,
                       struct disir_mold *mold, struct disir_config **config)
 {
-    return fslib_plugin_config_read (instance, plugin, entry_id, mold,
-                                     config, dio_json_unserialize_config);
+    return fslib_plugin_config_read_span (instance, plugin, entry_id, mold,
+                                          config, dio_json_unserialize_config_span);
 }
 
 //! PLUGIN API
@@ -37,7 +37,7 @@ enum disir_status
 dio_json_config_fd_write (struct disir_instance *instance,
                           struct disir_config *config, FILE *out)
 {
-    return dio_json_serialize_config (instance, config, out);
+    return dio_json_serialize_config_compact (instance, config, out);
 }
 
 //! PLUGIN API
@@ -93,6 +93,13 @@ dio_json_mold_read (struct disir_instance *instance,
         override_ref = NULL;
     }
 
+    status = fslib_mold_read_compiled (instance, plugin, entry_id, mold_filepath, &statbuf,
+                                       override_ref, mold);
+    if (status == DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
     status = dio_json_unserialize_mold_filepath (instance, mold_filepath, override_ref, mold);
 
     return status;
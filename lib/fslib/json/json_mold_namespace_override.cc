@@ -9,6 +9,7 @@
 #include <iostream>
 #include <stdarg.h>
 #include <cstring>
+#include <iterator>
 #include <set>
 
 using namespace dio;
@@ -21,19 +22,39 @@ MoldOverride::MoldOverride ()
 enum disir_status
 MoldOverride::parse_mold_override_entry (struct disir_instance *instance, std::istream& entry)
 {
-    enum disir_status status;
+    // Parse error messages refer to the document - it must outlive the reader.
+    std::string document ((std::istreambuf_iterator<char> (entry)),
+                          std::istreambuf_iterator<char> ());
+
+    return parse_mold_override_entry (instance, document.data (),
+                                      document.data () + document.size ());
+}
+
+//! PUBLIC
+enum disir_status
+MoldOverride::parse_mold_override_entry (struct disir_instance *instance,
+                                         const char *begin, const char *end)
+{
     Json::Reader reader;
     Json::Value root;
 
-    bool success = reader.parse (entry, root);
+    bool success = reader.parse (begin, end, root);
     if (!success)
     {
-        std::cout << reader.getFormattedErrorMessages() << std::endl;
         disir_error_set (instance, "mold override parse error: %s",
                                    reader.getFormattedErrorMessages().c_str());
         return DISIR_STATUS_FS_ERROR;
     }
 
+    return read_mold_override_entry (instance, root);
+}
+
+//! PRIVATE
+enum disir_status
+MoldOverride::read_mold_override_entry (struct disir_instance *instance, Json::Value& root)
+{
+    enum disir_status status;
+
     status = validate_override_entry (instance, root);
     if (status != DISIR_STATUS_OK)
     {
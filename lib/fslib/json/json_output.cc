@@ -0,0 +1,400 @@
+// JSON private
+#include "json/json_serialize.h"
+
+// standard
+#include <algorithm>
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace dio;
+
+//! Indentation width and line width of Json::StyledWriter.
+#define STYLED_INDENT_SIZE 3
+#define STYLED_RIGHT_MARGIN 74
+
+static const char spaces[] = "                                                                ";
+
+//! Escaped form of control character c, as written by jsoncpp.
+static size_t
+escape_character (char *buffer, char c)
+{
+    switch (c)
+    {
+    case '\"':
+        memcpy (buffer, "\\\"", 2);
+        return 2;
+    case '\\':
+        memcpy (buffer, "\\\\", 2);
+        return 2;
+    case '\b':
+        memcpy (buffer, "\\b", 2);
+        return 2;
+    case '\f':
+        memcpy (buffer, "\\f", 2);
+        return 2;
+    case '\n':
+        memcpy (buffer, "\\n", 2);
+        return 2;
+    case '\r':
+        memcpy (buffer, "\\r", 2);
+        return 2;
+    case '\t':
+        memcpy (buffer, "\\t", 2);
+        return 2;
+    default:
+        if (c > 0 && c <= 0x1F)
+        {
+            return snprintf (buffer, 8, "\\u%04X", (int) c);
+        }
+        return 0;
+    }
+}
+
+JsonOutput::JsonOutput (int fd, bool compact)
+    : m_fd (fd), m_compact (compact)
+{
+}
+
+JsonOutput::JsonOutput (std::ostream& stream, bool compact)
+    : m_stream (&stream), m_compact (compact)
+{
+}
+
+JsonOutput::JsonOutput (std::string& output, bool compact)
+    : m_string (&output), m_compact (compact)
+{
+    m_string->clear ();
+}
+
+bool
+JsonOutput::flush ()
+{
+    size_t written = 0;
+    ssize_t res;
+
+    if (m_failed)
+    {
+        m_used = 0;
+        return false;
+    }
+
+    if (m_string)
+    {
+        m_string->append (m_buffer, m_used);
+    }
+    else if (m_stream)
+    {
+        m_stream->write (m_buffer, m_used);
+        m_failed = m_stream->fail ();
+    }
+    else
+    {
+        while (written < m_used)
+        {
+            res = ::write (m_fd, m_buffer + written, m_used - written);
+            if (res < 0 && errno == EINTR)
+                continue;
+            if (res < 0)
+            {
+                m_failed = true;
+                break;
+            }
+            written += res;
+        }
+    }
+
+    m_used = 0;
+    return (m_failed == false);
+}
+
+void
+JsonOutput::write (const char *data, size_t size)
+{
+    size_t chunk;
+
+    while (size > 0)
+    {
+        if (m_used == sizeof (m_buffer))
+        {
+            flush ();
+        }
+        chunk = std::min (size, sizeof (m_buffer) - m_used);
+        memcpy (m_buffer + m_used, data, chunk);
+        m_used += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void
+JsonOutput::put (char c)
+{
+    if (m_used == sizeof (m_buffer))
+    {
+        flush ();
+    }
+    m_buffer[m_used++] = c;
+}
+
+void
+JsonOutput::indent (size_t depth)
+{
+    size_t size = depth * STYLED_INDENT_SIZE;
+
+    put ('\n');
+    while (size > 0)
+    {
+        size_t chunk = std::min (size, sizeof (spaces) - 1);
+        write (spaces, chunk);
+        size -= chunk;
+    }
+}
+
+void
+JsonOutput::begin_value ()
+{
+    if (m_after_key || m_frames.empty ())
+    {
+        m_after_key = false;
+        return;
+    }
+
+    // Only arrays take values without a key.
+    Frame& frame = m_frames.back ();
+    if (frame.f_count > 0)
+    {
+        put (',');
+    }
+    if (m_compact == false)
+    {
+        if (frame.f_multiline)
+        {
+            indent (m_frames.size ());
+        }
+        else
+        {
+            put (' ');
+        }
+    }
+    frame.f_count++;
+}
+
+void
+JsonOutput::begin_object ()
+{
+    begin_value ();
+    put ('{');
+    m_frames.push_back (Frame { true, 0 });
+}
+
+void
+JsonOutput::end_object ()
+{
+    size_t count = m_frames.back ().f_count;
+
+    m_frames.pop_back ();
+    if (count > 0 && m_compact == false)
+    {
+        indent (m_frames.size ());
+    }
+    put ('}');
+}
+
+void
+JsonOutput::begin_array (bool multiline)
+{
+    begin_value ();
+    put ('[');
+    m_frames.push_back (Frame { multiline, 0 });
+}
+
+void
+JsonOutput::end_array ()
+{
+    Frame frame = m_frames.back ();
+
+    m_frames.pop_back ();
+    if (frame.f_count > 0 && m_compact == false)
+    {
+        if (frame.f_multiline)
+        {
+            indent (m_frames.size ());
+        }
+        else
+        {
+            put (' ');
+        }
+    }
+    put (']');
+}
+
+void
+JsonOutput::key (const char *name)
+{
+    Frame& frame = m_frames.back ();
+
+    if (frame.f_count > 0)
+    {
+        put (',');
+    }
+    if (m_compact == false)
+    {
+        indent (m_frames.size ());
+    }
+    frame.f_count++;
+
+    write_string (name);
+    if (m_compact)
+    {
+        put (':');
+    }
+    else
+    {
+        write (" : ", 3);
+    }
+    m_after_key = true;
+}
+
+void
+JsonOutput::write_string (const char *value)
+{
+    const char *start;
+    char escaped[8];
+    size_t size;
+
+    put ('"');
+
+    // Write the runs between characters that need escaping in one go.
+    for (start = value; *value; value++)
+    {
+        size = escape_character (escaped, *value);
+        if (size > 0)
+        {
+            write (start, value - start);
+            write (escaped, size);
+            start = value + 1;
+        }
+    }
+    write (start, value - start);
+    put ('"');
+}
+
+void
+JsonOutput::value_string (const char *value)
+{
+    begin_value ();
+    write_string (value);
+}
+
+void
+JsonOutput::value_integer (int64_t value)
+{
+    char buffer[32];
+
+    begin_value ();
+    write (buffer, format_integer (buffer, value));
+}
+
+void
+JsonOutput::value_float (double value)
+{
+    char buffer[32];
+
+    begin_value ();
+    write (buffer, format_float (buffer, value));
+}
+
+void
+JsonOutput::value_boolean (bool value)
+{
+    begin_value ();
+    if (value)
+    {
+        write ("true", 4);
+    }
+    else
+    {
+        write ("false", 5);
+    }
+}
+
+void
+JsonOutput::value_null ()
+{
+    begin_value ();
+    write ("null", 4);
+}
+
+bool
+JsonOutput::finish ()
+{
+    put ('\n');
+    return flush ();
+}
+
+bool
+JsonOutput::multiline_array (size_t count, size_t line_size)
+{
+    if (count * 3 >= STYLED_RIGHT_MARGIN)
+    {
+        return true;
+    }
+
+    // '[ ' + ', ' between each entry + ' ]'
+    return (4 + (count - 1) * 2 + line_size >= STYLED_RIGHT_MARGIN);
+}
+
+size_t
+JsonOutput::string_size (const char *value)
+{
+    char escaped[8];
+    size_t size = 2;
+
+    for (; *value; value++)
+    {
+        size += std::max (escape_character (escaped, *value), (size_t) 1);
+    }
+
+    return size;
+}
+
+size_t
+JsonOutput::format_integer (char *buffer, int64_t value)
+{
+    return snprintf (buffer, 32, "%" PRId64, value);
+}
+
+size_t
+JsonOutput::format_float (char *buffer, double value)
+{
+    int size;
+    int i;
+
+    if (isfinite (value))
+    {
+        size = snprintf (buffer, 32, "%.16g", value);
+    }
+    else if (value != value)
+    {
+        size = snprintf (buffer, 32, "null");
+    }
+    else
+    {
+        size = snprintf (buffer, 32, value < 0 ? "-1e+9999" : "1e+9999");
+    }
+
+    // The decimal point must not depend on the locale.
+    for (i = 0; i < size; i++)
+    {
+        if (buffer[i] == ',')
+        {
+            buffer[i] = '.';
+        }
+    }
+
+    return size;
+}
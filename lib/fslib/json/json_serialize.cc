@@ -1,27 +1,47 @@
 // JSON private
 #include "json/json_serialize.h"
 
-// 3party
-#include "fdstream.hpp"
-
 // public
 #include <disir/disir.h>
 #include <disir/fslib/json.h>
 
 
-//! FSLIB API
-enum disir_status
-dio_json_serialize_config (struct disir_instance *instance,
-                           struct disir_config *config, FILE* output)
+//! STATIC API
+//! Serialize object through an intermediate string, for FILE streams without a descriptor.
+template<typename Writer, typename Object>
+static enum disir_status
+serialize_to_stream (Writer& writer, Object *object, FILE *output)
 {
-    disir_log_user (instance, "TRACE ENTER dio_json_serialize_config");
+    enum disir_status status;
+    std::string document;
+
+    status = writer.serialize (object, document);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    if (fwrite (document.data (), 1, document.size (), output) != document.size ())
+        return DISIR_STATUS_FS_ERROR;
 
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static enum disir_status
+serialize_config (struct disir_config *config, FILE *output, bool compact)
+{
     try
     {
-        boost::fdostream file(fileno(output));
         dio::ConfigWriter writer (NULL);
+        writer.m_compact = compact;
 
-         return writer.serialize (config, file);
+        // A memory stream has no file descriptor to write to.
+        if (fileno (output) < 0)
+            return serialize_to_stream (writer, config, output);
+
+        // The document is written to the file descriptor directly,
+        // behind anything still buffered in output.
+        fflush (output);
+        return writer.serialize (config, fileno (output));
     }
     catch (std::exception& e)
     {
@@ -29,6 +49,26 @@ dio_json_serialize_config (struct disir_instance *instance,
     }
 }
 
+//! FSLIB API
+enum disir_status
+dio_json_serialize_config (struct disir_instance *instance,
+                           struct disir_config *config, FILE* output)
+{
+    disir_log_user (instance, "TRACE ENTER dio_json_serialize_config");
+
+    return serialize_config (config, output, false);
+}
+
+//! FSLIB API
+enum disir_status
+dio_json_serialize_config_compact (struct disir_instance *instance,
+                                   struct disir_config *config, FILE* output)
+{
+    disir_log_user (instance, "TRACE ENTER dio_json_serialize_config_compact");
+
+    return serialize_config (config, output, true);
+}
+
 // FSLIB API
 enum disir_status
 dio_json_serialize_mold (struct disir_instance *instance,
@@ -38,10 +78,13 @@ dio_json_serialize_mold (struct disir_instance *instance,
 
     try
     {
-        boost::fdostream file(fileno(output));
         dio::MoldWriter writer (instance);
 
-        return writer.serialize (mold, file);
+        if (fileno (output) < 0)
+            return serialize_to_stream (writer, mold, output);
+
+        fflush (output);
+        return writer.serialize (mold, fileno (output));
     }
     catch (std::exception& e)
     {
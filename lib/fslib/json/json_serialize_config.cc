@@ -5,10 +5,14 @@
 #include <disir/disir.h>
 
 // standard
+#include <algorithm>
+#include <errno.h>
 #include <iostream>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
 
 using namespace dio;
 
@@ -29,50 +33,38 @@ ConfigWriter::~ConfigWriter ()
 enum disir_status
 ConfigWriter::serialize (struct disir_config *config, std::ostream& stream)
 {
-    enum disir_status status;
-    Json::StyledWriter writer;
-    std::string outputJson;
-
-    status = DISIR_STATUS_OK;
+    JsonOutput output (stream, m_compact);
 
-    // Retrieving the config's context object
-    m_contextConfig = dc_config_getcontext (config);
-    if (m_contextConfig == NULL )
-    {
-        disir_error_set (m_disir, "could not retrieve cconfig context object");
-        return DISIR_STATUS_INTERNAL_ERROR;
-    }
+    return write_config (config, output);
+}
 
-    status = set_config_version (m_contextConfig, m_configRoot);
-    if (status != DISIR_STATUS_OK)
-    {
-        goto end;
-    }
+enum disir_status
+ConfigWriter::serialize (struct disir_config *config, std::string& output)
+{
+    enum disir_status status;
+    JsonOutput json_output (output, m_compact);
 
-    status = _serialize_context (m_contextConfig, m_configRoot[ATTRIBUTE_KEY_CONFIG]);
+    status = write_config (config, json_output);
     if (status != DISIR_STATUS_OK)
     {
-        goto end;
+        output.clear ();
     }
 
-    if (m_configRoot[ATTRIBUTE_KEY_CONFIG].empty())
-    {
-        m_configRoot[ATTRIBUTE_KEY_CONFIG] = Json::objectValue;
-    }
+    return status;
+}
 
-    stream << writer.writeOrdered (m_configRoot);
+enum disir_status
+ConfigWriter::serialize (struct disir_config *config, int fd)
+{
+    JsonOutput output (fd, m_compact);
 
-end:
-    dc_putcontext (&m_contextConfig);
-    return status;
+    return write_config (config, output);
 }
 
 enum disir_status
-ConfigWriter::serialize (struct disir_config *config, std::string& output)
+ConfigWriter::write_config (struct disir_config *config, JsonOutput& output)
 {
     enum disir_status status;
-    Json::StyledWriter writer;
-    std::string outputJson;
 
     // Retrieving the config's context object
     m_contextConfig = dc_config_getcontext (config);
@@ -82,33 +74,37 @@ ConfigWriter::serialize (struct disir_config *config, std::string& output)
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    status = set_config_version (m_contextConfig, m_configRoot);
+    output.begin_object ();
+
+    status = write_config_version (m_contextConfig, output);
     if (status != DISIR_STATUS_OK)
     {
         goto end;
     }
 
-    status = _serialize_context (m_contextConfig, m_configRoot[ATTRIBUTE_KEY_CONFIG]);
+    output.key (ATTRIBUTE_KEY_CONFIG);
+    output.begin_object ();
+    status = write_elements (m_contextConfig, output, false);
     if (status != DISIR_STATUS_OK)
     {
         goto end;
     }
+    output.end_object ();
 
-    if (m_configRoot[ATTRIBUTE_KEY_CONFIG].empty())
+    output.end_object ();
+    if (output.finish () == false)
     {
-	    m_configRoot[ATTRIBUTE_KEY_CONFIG] = Json::objectValue;
+        disir_error_set (m_disir, "could not write serialized config: %s", strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
     }
 
-    output = writer.writeOrdered (m_configRoot);
-
-
 end:
     dc_putcontext (&m_contextConfig);
     return status;
 }
 
 enum disir_status
-ConfigWriter::set_config_version (struct disir_context *context_config, Json::Value& root)
+ConfigWriter::write_config_version (struct disir_context *context_config, JsonOutput& output)
 {
     struct disir_version version;
     enum disir_status status;
@@ -130,78 +126,237 @@ ConfigWriter::set_config_version (struct disir_context *context_config, Json::Va
         return DISIR_STATUS_INTERNAL_ERROR;
     }
 
-    root[ATTRIBUTE_KEY_VERSION] = buf;
+    output.key (ATTRIBUTE_KEY_VERSION);
+    output.value_string (buf);
 
     return status;
 }
 
-// Mapping child node (section) to key (section name)
 enum disir_status
-ConfigWriter::set_section_keyname (struct disir_context *context, Json::Value& parent,
-                                   Json::Value& sectionVal)
+ConfigWriter::write_elements (struct disir_context *parent_context, JsonOutput& output,
+                              bool sorted)
 {
-    std::string name;
+    struct disir_element_iter iter;
+    struct disir_context *context;
+    struct disir_context *first;
     enum disir_status status;
+    std::vector<std::pair<const char *, struct disir_context *>> members;
+    const char *name;
+    int32_t size;
 
-    status = get_context_key (context, name);
+    status = dc_element_iter_begin (parent_context, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
-        // logged
         return status;
     }
 
-    serialize_duplicate_entries (parent, sectionVal, name);
+    while (dc_element_iter_next (&iter, &context) != DISIR_STATUS_EXHAUSTED)
+    {
+        if (dc_context_type (context) != DISIR_CONTEXT_SECTION &&
+            dc_context_type (context) != DISIR_CONTEXT_KEYVAL)
+        {
+            continue;
+        }
 
-    return status;
+        status = dc_get_name (context, &name, &size);
+        if (status != DISIR_STATUS_OK)
+        {
+            // Should not happen
+            disir_error_set (m_disir, "Disir returned an error from dc_get_name: %s",
+                                       disir_status_string (status));
+            return status;
+        }
+
+        // Elements sharing a name are written together with the first of them.
+        struct disir_element_iter named;
+        status = dc_element_iter_begin (parent_context, name, &named);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+        if (dc_element_iter_next (&named, &first) != DISIR_STATUS_OK || first != context)
+        {
+            continue;
+        }
+
+        if (sorted)
+        {
+            members.push_back (std::make_pair (name, context));
+            continue;
+        }
+
+        status = write_member (parent_context, context, name, output, sorted);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+    }
+
+    if (sorted == false)
+    {
+        return DISIR_STATUS_OK;
+    }
+
+    std::sort (members.begin (), members.end (),
+               [] (const std::pair<const char *, struct disir_context *>& a,
+                   const std::pair<const char *, struct disir_context *>& b)
+               {
+                   return strcmp (a.first, b.first) < 0;
+               });
+
+    for (auto& member : members)
+    {
+        status = write_member (parent_context, member.second, member.first, output, sorted);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+    }
+
+    return DISIR_STATUS_OK;
 }
 
 enum disir_status
-ConfigWriter::get_context_key (struct disir_context *context, std::string& key)
+ConfigWriter::write_member (struct disir_context *parent_context, struct disir_context *context,
+                            const char *name, JsonOutput& output, bool sorted)
 {
-    const char *name;
-    int32_t size;
+    struct disir_element_iter iter;
+    struct disir_context *entry;
     enum disir_status status;
+    size_t line_size = 0;
+    size_t entry_size;
+    size_t count = 0;
+    bool multiline = false;
 
-    status = dc_get_name (context, &name, &size);
-    if (status != DISIR_STATUS_OK) {
-        // Should not happen
-        disir_error_set (m_disir, "Disir returned an error from dc_get_name: %s",
-                                   disir_status_string (status));
+    status = dc_element_iter_begin (parent_context, name, &iter);
+    if (status != DISIR_STATUS_OK)
+    {
         return status;
     }
+    while (dc_element_iter_next (&iter, &entry) != DISIR_STATUS_EXHAUSTED)
+    {
+        count++;
+    }
 
-    key = std::string (name, size);
+    output.key (name);
+    if (count == 1)
+    {
+        return write_element (context, output, sorted);
+    }
 
-    return status;
+    // Entries of an array are written in name order by the styled layout.
+    if (output.compact () == false)
+    {
+        sorted = true;
+        multiline = JsonOutput::multiline_array (count, 0);
+
+        dc_element_iter_begin (parent_context, name, &iter);
+        while (multiline == false &&
+               dc_element_iter_next (&iter, &entry) != DISIR_STATUS_EXHAUSTED)
+        {
+            entry_size = element_size (entry);
+            multiline = (entry_size == 0);
+            line_size += entry_size;
+        }
+        multiline = multiline || JsonOutput::multiline_array (count, line_size);
+    }
+
+    output.begin_array (multiline);
+    dc_element_iter_begin (parent_context, name, &iter);
+    while (dc_element_iter_next (&iter, &entry) != DISIR_STATUS_EXHAUSTED)
+    {
+        status = write_element (entry, output, sorted);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+    }
+    output.end_array ();
+
+    return DISIR_STATUS_OK;
 }
 
-void
-ConfigWriter::serialize_duplicate_entries (Json::Value& parent,
-                                           Json::Value& child, const std::string name)
+enum disir_status
+ConfigWriter::write_element (struct disir_context *context, JsonOutput& output, bool sorted)
 {
-    Json::Value entries;
+    enum disir_status status;
 
-    if (parent[name].isArray())
+    if (dc_context_type (context) == DISIR_CONTEXT_KEYVAL)
     {
-        parent[name].append (child);
+        return write_keyval (context, output);
     }
-    else if (parent[name].isNull() == false)
+
+    // A section without children is still written, as an empty object.
+    output.begin_object ();
+    status = write_elements (context, output, sorted);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+    output.end_object ();
+
+    return DISIR_STATUS_OK;
+}
+
+size_t
+ConfigWriter::element_size (struct disir_context *context)
+{
+    struct disir_element_iter iter;
+    struct disir_context *child;
+    enum disir_value_type type;
+    char buffer[32];
+    double floatval;
+    int64_t intval;
+    const char *stringval;
+    uint8_t boolval;
+
+    if (dc_context_type (context) == DISIR_CONTEXT_SECTION)
     {
-        entries = Json::arrayValue;
-        entries.append (parent[name]);
-        entries.append (child);
-        child = entries;
-        parent[name] = child;
+        // Only an empty object fits on a single line.
+        if (dc_element_iter_begin (context, NULL, &iter) != DISIR_STATUS_OK ||
+            dc_element_iter_next (&iter, &child) != DISIR_STATUS_EXHAUSTED)
+        {
+            return 0;
+        }
+        return 2;
     }
-    else
+
+    if (dc_get_value_type (context, &type) != DISIR_STATUS_OK)
     {
-        parent[name] = child;
+        return 0;
+    }
+
+    switch (type) {
+        case DISIR_VALUE_TYPE_STRING:
+            if (dc_get_value_string (context, &stringval, NULL) != DISIR_STATUS_OK)
+                return 0;
+            return JsonOutput::string_size (stringval ? stringval : "");
+        case DISIR_VALUE_TYPE_INTEGER:
+            if (dc_get_value_integer (context, &intval) != DISIR_STATUS_OK)
+                return 0;
+            return JsonOutput::format_integer (buffer, intval);
+        case DISIR_VALUE_TYPE_FLOAT:
+            if (dc_get_value_float (context, &floatval) != DISIR_STATUS_OK)
+                return 0;
+            return JsonOutput::format_float (buffer, floatval);
+        case DISIR_VALUE_TYPE_BOOLEAN:
+            if (dc_get_value_boolean (context, &boolval) != DISIR_STATUS_OK)
+                return 0;
+            return (boolval ? 4 : 5);
+        case DISIR_VALUE_TYPE_ENUM:
+            if (dc_get_value_enum (context, &stringval, NULL) != DISIR_STATUS_OK)
+                return 0;
+            return JsonOutput::string_size (stringval ? stringval : "");
+        case DISIR_VALUE_TYPE_UNKNOWN:
+            return JsonOutput::string_size (dc_value_type_string (context));
+        default:
+            return 4;
     }
 }
 
 // Wraps libdisir dc_get_value to handle arbitrary value sizes
 enum disir_status
-ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json::Value& node)
+ConfigWriter::write_keyval (struct disir_context *context, JsonOutput& output)
 {
     enum disir_status status;
     enum disir_value_type type;
@@ -210,8 +365,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
     int64_t intval;
     const char *stringval;
     uint8_t boolval;
-    std::string buf;
-    Json::Value keyval;
+    const char *name;
 
     status = dc_get_value_type (context, &type);
     if (status != DISIR_STATUS_OK)
@@ -229,7 +383,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = stringval;
+            output.value_string (stringval ? stringval : "");
             break;
         case DISIR_VALUE_TYPE_INTEGER:
             status = dc_get_value_integer (context, &intval);
@@ -238,7 +392,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = (Json::Int64)intval;
+            output.value_integer (intval);
             break;
         case DISIR_VALUE_TYPE_FLOAT:
             status = dc_get_value_float (context, &floatval);
@@ -247,7 +401,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = floatval;
+            output.value_float (floatval);
             break;
         case DISIR_VALUE_TYPE_BOOLEAN:
             status = dc_get_value_boolean (context, &boolval);
@@ -256,7 +410,7 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
                 goto error;
             }
 
-            keyval = !!boolval;
+            output.value_boolean (!!boolval);
             break;
         case DISIR_VALUE_TYPE_ENUM:
             status = dc_get_value_enum (context, &stringval, NULL);
@@ -264,110 +418,28 @@ ConfigWriter::set_keyval (struct disir_context *context, std::string name, Json:
             {
                 goto error;
             }
-            keyval = stringval;
+            output.value_string (stringval ? stringval : "");
             break;
         case DISIR_VALUE_TYPE_UNKNOWN:
             // If type is not know, we mark it
             // as unkwnown
-            keyval = dc_value_type_string (context);
+            output.value_string (dc_value_type_string (context));
             break;
         default:
             // HUH? Type not supported?
             disir_error_set (m_disir, "Got an unsupported disir value type: %s",
                                        dc_value_type_string (context));
+            output.value_null ();
             break;
     }
 
-    serialize_duplicate_entries (node, keyval, name);
-
     return status;
 error:
-    disir_error_set (m_disir, "Unable to fetch value from keyval with name: %s and type %s",
-                               name.c_str(), dc_value_type_string (context));
-    return status;
-}
-
-enum disir_status
-ConfigWriter::serialize_keyval (struct disir_context *context, Json::Value& node)
-{
-    enum disir_status status;
-    std::string name;
-    status = get_context_key (context, name);
-    if (status != DISIR_STATUS_OK)
+    if (dc_get_name (context, &name, &size) != DISIR_STATUS_OK)
     {
-       return status;
+        name = "";
     }
-
-    return set_keyval (context, name, node);
-}
-
-enum disir_status
-ConfigWriter::_serialize_context (struct disir_context *parent_context, Json::Value& parent)
-{
-    struct disir_collection *collection;
-    struct disir_context *child_context;
-    enum disir_status status;
-
-    child_context = NULL;
-
-    status = dc_get_elements (parent_context, &collection);
-    if (status != DISIR_STATUS_OK)
-    {
-        goto end;
-    }
-
-    status = DISIR_STATUS_OK;
-
-    while (dc_collection_next (collection, &child_context)
-           != DISIR_STATUS_EXHAUSTED)
-    {
-        // per-iteration such that child values
-        // never have old references to pre-marshaled
-        // context objects
-        Json::Value child;
-
-        switch (dc_context_type (child_context))
-        {
-            case DISIR_CONTEXT_SECTION:
-
-                // Initialize child to an empty object, that way we indicate
-                // in the serialized configuration that this section exists,
-                // it just didnt have any children
-                child = Json::objectValue;
-                status = _serialize_context (child_context, child);
-                if (status != DISIR_STATUS_OK)
-                {
-                    goto end;
-                }
-
-                status = set_section_keyname (child_context, parent, child);
-                if (status != DISIR_STATUS_OK)
-                {
-                    // logged
-                    return status;
-                }
-                break;
-            case DISIR_CONTEXT_KEYVAL:
-                status = serialize_keyval (child_context, parent);
-                if (status != DISIR_STATUS_OK)
-                {
-                    goto end;
-                }
-                break;
-            default:
-                break;
-        }
-        dc_putcontext (&child_context);
-    }
-
-end:
-    if (child_context)
-    {
-        dc_putcontext (&child_context);
-    }
-
-    dc_collection_finished (&collection);
-
+    disir_error_set (m_disir, "Unable to fetch value from keyval with name: %s and type %s",
+                               name, dc_value_type_string (context));
     return status;
 }
-
@@ -6,7 +6,9 @@
 #include <disir/disir.h>
 
 // standard
+#include <errno.h>
 #include <iostream>
+#include <string.h>
 
 using namespace dio;
 
@@ -15,7 +17,7 @@ MoldWriter::MoldWriter (struct disir_instance *disir) : JsonIO (disir)
 }
 
 enum disir_status
-MoldWriter::serialize_deprecated (struct disir_context *context, Json::Value& current)
+MoldWriter::serialize_deprecated (struct disir_context *context, JsonOutput& output)
 {
     char buf[500];
     enum disir_status status;
@@ -42,13 +44,14 @@ MoldWriter::serialize_deprecated (struct disir_context *context, Json::Value& cu
 
     auto version_string = dc_version_string (buf, 500, &version);
 
-    current[ATTRIBUTE_KEY_DEPRECATED] = version_string;
+    output.key (ATTRIBUTE_KEY_DEPRECATED);
+    output.value_string (version_string);
 
     return status;
 }
 
 enum disir_status
-MoldWriter::serialize_introduced (struct disir_context *context, Json::Value& current)
+MoldWriter::serialize_introduced (struct disir_context *context, JsonOutput& output)
 {
     char buf[500];
     enum disir_status status;
@@ -67,7 +70,8 @@ MoldWriter::serialize_introduced (struct disir_context *context, Json::Value& cu
 
     auto version_string = dc_version_string (buf, 500, &version);
 
-    current[ATTRIBUTE_KEY_INTRODUCED] = version_string;
+    output.key (ATTRIBUTE_KEY_INTRODUCED);
+    output.value_string (version_string);
 
     return status;
 }
@@ -75,47 +79,45 @@ MoldWriter::serialize_introduced (struct disir_context *context, Json::Value& cu
 enum disir_status
 MoldWriter::serialize (struct disir_mold *mold, std::string& mold_json)
 {
-    struct disir_context *context_mold;
     enum disir_status status;
-    Json::StyledWriter writer;
-    Json::Value root;
 
     if (mold == NULL)
     {
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    context_mold = dc_mold_getcontext (mold);
-    if (context_mold == NULL)
-    {
-        disir_error_set (m_disir, "Could not retrieve context mold from mold");
-        return DISIR_STATUS_INTERNAL_ERROR;
-    }
+    JsonOutput output (mold_json, m_compact);
 
-    status = serialize_attributes (context_mold, root, DISIR_CONTEXT_MOLD);
+    status = write_mold (mold, output);
     if (status != DISIR_STATUS_OK)
     {
-        return status;
+        mold_json.clear ();
     }
 
-    status = _serialize_mold_contexts (context_mold, root[ATTRIBUTE_KEY_MOLD]);
-    if (status != DISIR_STATUS_OK)
-        goto end;
-
-    mold_json = writer.writeOrdered (root);
-
-end:
-    dc_putcontext (&context_mold);
     return status;
 }
 
 enum disir_status
 MoldWriter::serialize (struct disir_mold *mold, std::ostream& stream)
+{
+    JsonOutput output (stream, m_compact);
+
+    return write_mold (mold, output);
+}
+
+enum disir_status
+MoldWriter::serialize (struct disir_mold *mold, int fd)
+{
+    JsonOutput output (fd, m_compact);
+
+    return write_mold (mold, output);
+}
+
+enum disir_status
+MoldWriter::write_mold (struct disir_mold *mold, JsonOutput& output)
 {
     struct disir_context *context_mold;
     enum disir_status status;
-    Json::StyledWriter writer;
-    Json::Value root;
 
     context_mold = dc_mold_getcontext (mold);
     if (context_mold == NULL)
@@ -123,17 +125,26 @@ MoldWriter::serialize (struct disir_mold *mold, std::ostream& stream)
         disir_error_set (m_disir, "Could not retrieve context mold from mold");
         return DISIR_STATUS_INTERNAL_ERROR;
     }
-    status = serialize_attributes (context_mold, root, DISIR_CONTEXT_MOLD);
+
+    output.begin_object ();
+
+    status = serialize_attributes (context_mold, output, DISIR_CONTEXT_MOLD);
     if (status != DISIR_STATUS_OK)
     {
-        return status;
+        goto end;
     }
 
-    status = _serialize_mold_contexts (context_mold, root[ATTRIBUTE_KEY_MOLD]);
+    output.key (ATTRIBUTE_KEY_MOLD);
+    status = _serialize_mold_contexts (context_mold, output);
     if (status != DISIR_STATUS_OK)
         goto end;
 
-    stream << writer.writeOrdered (root);
+    output.end_object ();
+    if (output.finish () == false)
+    {
+        disir_error_set (m_disir, "could not write serialized mold: %s", strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+    }
 
 end:
     dc_putcontext (&context_mold);
@@ -141,7 +152,7 @@ end:
 }
 
 enum disir_status
-MoldWriter::serialize_attributes (struct disir_context *context, Json::Value& current,
+MoldWriter::serialize_attributes (struct disir_context *context, JsonOutput& output,
                                   enum disir_context_type type)
 {
     enum disir_status status;
@@ -151,30 +162,46 @@ MoldWriter::serialize_attributes (struct disir_context *context, Json::Value& cu
     {
     case DISIR_CONTEXT_KEYVAL:
     {
-        status = serialize_deprecated (context, current);
+        status = serialize_deprecated (context, output);
         if (status != DISIR_STATUS_OK)
         {
             return status;
         }
-        current[ATTRIBUTE_KEY_TYPE] = dc_value_type_string (context);
+        output.key (ATTRIBUTE_KEY_TYPE);
+        output.value_string (dc_value_type_string (context));
         break;
     }
     case DISIR_CONTEXT_SECTION:
-    case DISIR_CONTEXT_DEFAULT:
-    case DISIR_CONTEXT_RESTRICTION:
     {
-        status = serialize_deprecated (context, current);
+        status = serialize_deprecated (context, output);
         if (status != DISIR_STATUS_OK)
         {
             return status;
         }
-        status = serialize_introduced (context, current);
+        status = serialize_introduced (context, output);
         if (status != DISIR_STATUS_OK)
         {
             return status;
         }
         break;
     }
+    case DISIR_CONTEXT_DEFAULT:
+    case DISIR_CONTEXT_RESTRICTION:
+    {
+        // Entries of arrays are written with their members in name order.
+        status = serialize_deprecated (context, output);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+        status = dc_get_documentation (context, NULL, &doc, NULL);
+        if (status == DISIR_STATUS_OK)
+        {
+            output.key (ATTRIBUTE_KEY_DOCUMENTATION);
+            output.value_string (doc);
+        }
+        return serialize_introduced (context, output);
+    }
     case DISIR_CONTEXT_MOLD:
     case DISIR_CONTEXT_CONFIG:
     case DISIR_CONTEXT_UNKNOWN:
@@ -186,52 +213,64 @@ MoldWriter::serialize_attributes (struct disir_context *context, Json::Value& cu
     if (status == DISIR_STATUS_OK)
     {
         //! Doc is set only when present in context
-        current[ATTRIBUTE_KEY_DOCUMENTATION] = doc;
+        output.key (ATTRIBUTE_KEY_DOCUMENTATION);
+        output.value_string (doc);
     }
     return DISIR_STATUS_OK;
 }
 
 enum disir_status
-MoldWriter::serialize_mold_keyval (struct disir_context *context_keyval, Json::Value& keyval)
+MoldWriter::serialize_mold_keyval (struct disir_context *context_keyval, JsonOutput& output)
 {
     enum disir_status status;
     struct disir_collection *coll;
     struct disir_context *context;
-    Json::Value defaults;
 
     status = dc_get_default_contexts (context_keyval, &coll);
     if (status != DISIR_STATUS_OK)
     {
         disir_error_set (m_disir, "Could not acquire defualt context on keyval. Error (%s)",
                                    disir_status_string (status));
-        goto out;
+        return status;
     }
 
-    status = serialize_attributes (context_keyval, keyval, DISIR_CONTEXT_KEYVAL);
+    output.begin_object ();
+
+    status = serialize_attributes (context_keyval, output, DISIR_CONTEXT_KEYVAL);
     if (status != DISIR_STATUS_OK)
     {
-        return status;
+        goto out;
     }
 
-    while (dc_collection_next (coll, &context)
-            != DISIR_STATUS_EXHAUSTED)
+    status = serialize_restrictions (context_keyval, output);
+    if (status != DISIR_STATUS_OK)
     {
-        status = serialize_default (context, defaults);
-        if (status != DISIR_STATUS_OK)
-        {
-            return status;
-        }
-
-        dc_putcontext (&context);
+        goto out;
     }
 
-    status = serialize_restrictions (context_keyval, keyval);
-    if (status != DISIR_STATUS_OK)
+    output.key (ATTRIBUTE_KEY_DEFAULTS);
+    if (dc_collection_size (coll) == 0)
     {
-        goto out;
+        output.value_null ();
+    }
+    else
+    {
+        // Every default is a non-empty object.
+        output.begin_array (true);
+        while (dc_collection_next (coll, &context)
+                != DISIR_STATUS_EXHAUSTED)
+        {
+            status = serialize_default (context, output);
+            dc_putcontext (&context);
+            if (status != DISIR_STATUS_OK)
+            {
+                goto out;
+            }
+        }
+        output.end_array ();
     }
 
-    keyval[ATTRIBUTE_KEY_DEFAULTS] = defaults;
+    output.end_object ();
 out:
      dc_collection_finished (&coll);
 
@@ -239,14 +278,15 @@ out:
 }
 
 enum disir_status
-MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value& current)
+MoldWriter::serialize_restrictions (struct disir_context *context, JsonOutput& output)
 {
     enum disir_status status;
+    enum disir_status status_restriction;
     enum disir_restriction_type rtype;
     struct disir_collection *collection;
     struct disir_context *restriction;
     enum disir_value_type value_type;
-    Json::Value restrictions = Json::arrayValue;
+    char buffer[32];
 
     status = dc_restriction_collection (context, &collection);
     if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
@@ -260,12 +300,18 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
         return DISIR_STATUS_OK;
     }
 
+    output.key (ATTRIBUTE_KEY_RESTRICTIONS);
+    // Every restriction is a non-empty object.
+    output.begin_array (true);
+
+    // An unknown restriction is reported, unless a later restriction
+    // overwrites the status.
+    status_restriction = DISIR_STATUS_OK;
     while (dc_collection_next (collection, &restriction) != DISIR_STATUS_EXHAUSTED)
     {
-        Json::Value current_restriction;
+        output.begin_object ();
 
-        status = serialize_attributes (restriction, current_restriction,
-                                       DISIR_CONTEXT_RESTRICTION);
+        status = serialize_attributes (restriction, output, DISIR_CONTEXT_RESTRICTION);
         if (status != DISIR_STATUS_OK)
         {
             goto out;
@@ -280,10 +326,12 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
 
         auto restriction_enum_string = dc_restriction_enum_string (rtype);
 
-        current_restriction[ATTRIBUTE_KEY_TYPE] = restriction_enum_string;
+        output.key (ATTRIBUTE_KEY_TYPE);
+        output.value_string (restriction_enum_string);
 
         dc_get_value_type (context, &value_type);
 
+        status_restriction = DISIR_STATUS_OK;
         switch (rtype)
         {
         case DISIR_RESTRICTION_INC_ENTRY_MIN:
@@ -296,22 +344,24 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
             status = dc_restriction_get_numeric (restriction, &value);
             if (status != DISIR_STATUS_OK)
             {
-                return status;
+                goto out;
             }
 
+            output.key (ATTRIBUTE_KEY_VALUE);
             if (value_type == DISIR_VALUE_TYPE_FLOAT)
             {
-                current_restriction[ATTRIBUTE_KEY_VALUE] = value;
+                output.value_float (value);
             }
             else
             {
-                current_restriction[ATTRIBUTE_KEY_VALUE] = (Json::Int64)value;
+                output.value_integer ((int64_t)value);
             }
             break;
         }
         case DISIR_RESTRICTION_EXC_VALUE_RANGE:
         {
             double min, max;
+            size_t line_size;
 
             status = dc_restriction_get_range (restriction, &min, &max);
             if (status != DISIR_STATUS_OK)
@@ -319,16 +369,24 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
                 goto out;
             }
 
+            output.key (ATTRIBUTE_KEY_VALUE);
             if (value_type == DISIR_VALUE_TYPE_FLOAT)
             {
-                current_restriction[ATTRIBUTE_KEY_VALUE].append (min);
-                current_restriction[ATTRIBUTE_KEY_VALUE].append (max);
+                line_size = JsonOutput::format_float (buffer, min) +
+                            JsonOutput::format_float (buffer, max);
+                output.begin_array (JsonOutput::multiline_array (2, line_size));
+                output.value_float (min);
+                output.value_float (max);
             }
             else
             {
-                current_restriction[ATTRIBUTE_KEY_VALUE].append ((Json::Int64)min);
-                current_restriction[ATTRIBUTE_KEY_VALUE].append ((Json::Int64)max);
+                line_size = JsonOutput::format_integer (buffer, (int64_t)min) +
+                            JsonOutput::format_integer (buffer, (int64_t)max);
+                output.begin_array (JsonOutput::multiline_array (2, line_size));
+                output.value_integer ((int64_t)min);
+                output.value_integer ((int64_t)max);
             }
+            output.end_array ();
 
             break;
         }
@@ -343,7 +401,8 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
                 goto out;
             }
 
-            current_restriction[ATTRIBUTE_KEY_VALUE] = enum_value;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_string (enum_value);
 
             break;
         }
@@ -351,99 +410,115 @@ MoldWriter::serialize_restrictions (struct disir_context *context, Json::Value&
             disir_error_set (m_disir, "Got unknown restriction type %s\n",
                                        restriction_enum_string);
 
-            status = DISIR_STATUS_INVALID_CONTEXT;
+            status_restriction = DISIR_STATUS_INVALID_CONTEXT;
             break;
         default:
             break;
         }
 
-        restrictions.append (current_restriction);
+        output.end_object ();
 
         dc_putcontext(&restriction);
     }
 
-    current[ATTRIBUTE_KEY_RESTRICTIONS] = restrictions;
+    output.end_array ();
+    status = status_restriction;
 out:
     dc_collection_finished (&collection);
     return status;
 }
 
 enum disir_status
-MoldWriter::_serialize_mold_contexts (struct disir_context *parent_context, Json::Value& parent)
+MoldWriter::_serialize_mold_contexts (struct disir_context *parent_context, JsonOutput& output)
 {
-    struct disir_collection *coll;
+    struct disir_element_iter iter;
     struct disir_context *context;
     enum disir_status status;
-    Json::Value child;
     const char *name;
     int32_t size;
+    bool empty = true;
 
     status = DISIR_STATUS_OK;
 
-    status = dc_get_elements (parent_context, &coll);
+    status = dc_element_iter_begin (parent_context, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         return status;
     }
 
-    while (dc_collection_next (coll, &context)
+    while (dc_element_iter_next (&iter, &context)
             != DISIR_STATUS_EXHAUSTED)
     {
+        if (dc_context_type (context) != DISIR_CONTEXT_KEYVAL &&
+            dc_context_type (context) != DISIR_CONTEXT_SECTION)
+        {
+            disir_error_set (m_disir, "Got unrecognizable context object: %s",
+                                       dc_value_type_string (context));
+            break;
+        }
+
+        status = dc_get_name (context, &name, &size);
+        if (status != DISIR_STATUS_OK)
+            goto end;
+
+        if (empty)
+        {
+            output.begin_object ();
+            empty = false;
+        }
+        output.key (name);
+
         switch (dc_context_type (context))
         {
             case DISIR_CONTEXT_KEYVAL:
-                status = serialize_mold_keyval (context, child);
+                status = serialize_mold_keyval (context, output);
                 if (status != DISIR_STATUS_OK)
                     goto end;
 
                 break;
             case DISIR_CONTEXT_SECTION:
-                status = serialize_attributes (context, child, DISIR_CONTEXT_SECTION);
+                output.begin_object ();
+
+                status = serialize_attributes (context, output, DISIR_CONTEXT_SECTION);
                 if (status != DISIR_STATUS_OK)
                 {
                     return status;
                 }
 
-                status = serialize_restrictions (context, child);
+                status = serialize_restrictions (context, output);
                 if (status != DISIR_STATUS_OK)
                 {
                     return status;
                 }
 
-                status = _serialize_mold_contexts (context, child[ATTRIBUTE_KEY_ELEMENTS]);
+                output.key (ATTRIBUTE_KEY_ELEMENTS);
+                status = _serialize_mold_contexts (context, output);
                 if (status != DISIR_STATUS_OK)
                     goto end;
 
+                output.end_object ();
                 break;
             default:
-                disir_error_set (m_disir, "Got unrecognizable context object: %s",
-                                           dc_value_type_string (context));
-                goto end;
+                break;
         }
+    }
 
-        status = dc_get_name (context, &name, &size);
-        if (status != DISIR_STATUS_OK)
-            goto end;
-
-        parent[name] = child;
-        child = Json::nullValue;
-
-        dc_putcontext (&context);
+    // A context without elements is written as null.
+    if (empty)
+    {
+        output.value_null ();
     }
-end:
-    if (context)
+    else
     {
-        dc_putcontext (&context);
+        output.end_object ();
     }
-
-    dc_collection_finished (&coll);
-
+end:
     return status;
 }
 
 // Wraps libdisir dc_get_value to handle arbitrary value sizes
 enum disir_status
-MoldWriter::serialize_default (struct disir_context *context, Json::Value& defaults)
+MoldWriter::serialize_default (struct disir_context *context, JsonOutput& output)
 {
     enum disir_status status;
     enum disir_value_type type;
@@ -452,8 +527,6 @@ MoldWriter::serialize_default (struct disir_context *context, Json::Value& defau
     int64_t intval;
     const char *stringval;
     uint8_t boolval;
-    std::string buf;
-    Json::Value current;
 
     status = dc_get_value_type (context, &type);
     if (status != DISIR_STATUS_OK)
@@ -463,54 +536,61 @@ MoldWriter::serialize_default (struct disir_context *context, Json::Value& defau
         goto error;
     }
 
+    output.begin_object ();
+
+    status = serialize_attributes (context, output, DISIR_CONTEXT_DEFAULT);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
     switch (type) {
         case DISIR_VALUE_TYPE_STRING:
             status = dc_get_value_string (context, &stringval, &size);
             if (status != DISIR_STATUS_OK)
                 goto error;
 
-            current[ATTRIBUTE_KEY_VALUE] = stringval;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_string (stringval ? stringval : "");
             break;
         case DISIR_VALUE_TYPE_INTEGER:
             status = dc_get_value_integer (context, &intval);
             if (status != DISIR_STATUS_OK)
                 goto error;
 
-            current[ATTRIBUTE_KEY_VALUE] = (Json::Int64)intval;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_integer (intval);
             break;
         case DISIR_VALUE_TYPE_FLOAT:
             status = dc_get_value_float (context, &floatval);
             if (status != DISIR_STATUS_OK)
                 goto error;
 
-            current[ATTRIBUTE_KEY_VALUE] = floatval;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_float (floatval);
             break;
         case DISIR_VALUE_TYPE_BOOLEAN:
             status = dc_get_value_boolean (context, &boolval);
             if  (status != DISIR_STATUS_OK)
                 goto error;
 
-            current[ATTRIBUTE_KEY_VALUE] = !!boolval;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_boolean (!!boolval);
             break;
         case DISIR_VALUE_TYPE_ENUM:
             status = dc_get_value_enum (context, &stringval, &size);
             if (status != DISIR_STATUS_OK)
                 goto error;
 
-            current[ATTRIBUTE_KEY_VALUE] = stringval;
+            output.key (ATTRIBUTE_KEY_VALUE);
+            output.value_string (stringval ? stringval : "");
             break;
         default:
             // HUH? Type not supported?
             disir_error_set (m_disir, "Got an unsupported disir value type");
     }
 
-    status = serialize_attributes (context, current, DISIR_CONTEXT_DEFAULT);
-    if (status != DISIR_STATUS_OK)
-    {
-        return status;
-    }
-
-    defaults.append (current);
+    output.end_object ();
 
     return status;
 error:
@@ -518,5 +598,3 @@ error:
                                dc_value_type_string (context), disir_status_string (status));
     return status;
 }
-
-
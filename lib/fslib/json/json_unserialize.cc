@@ -16,6 +16,22 @@ dio_json_unserialize_config (struct disir_instance *instance, FILE *input,
                              struct disir_mold *mold, struct disir_config **config)
 {
     disir_log_user (instance, "TRACE ENTER dio_json_unserialize_config");
+
+    if (fileno (input) < 0)
+    {
+        enum disir_status status;
+        char *data;
+        size_t size;
+
+        status = fslib_read_stream (instance, input, &data, &size);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        status = dio_json_unserialize_config_span (instance, data, size, mold, config);
+        free (data);
+        return status;
+    }
+
     try
     {
         boost::fdistream file(fileno(input));
@@ -32,6 +48,28 @@ dio_json_unserialize_config (struct disir_instance *instance, FILE *input,
     return DISIR_STATUS_OK;
 }
 
+//! FSLIB API
+enum disir_status
+dio_json_unserialize_config_span (struct disir_instance *instance,
+                                  const char *data, size_t size,
+                                  struct disir_mold *mold, struct disir_config **config)
+{
+    disir_log_user (instance, "TRACE ENTER dio_json_unserialize_config_span");
+    try
+    {
+        dio::ConfigReader reader (instance, mold);
+
+        return reader.unserialize (config, data, size);
+    }
+    catch (std::exception& e)
+    {
+        disir_log_user (instance, "JSON: fatal exception in unserialize_config_span");
+        return DISIR_STATUS_INTERNAL_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 //! FSLIB API
 enum disir_status
 dio_json_unserialize_mold (struct disir_instance *instance,
@@ -55,6 +93,28 @@ dio_json_unserialize_mold (struct disir_instance *instance,
     return DISIR_STATUS_OK;
 }
 
+//! FSLIB API
+enum disir_status
+dio_json_unserialize_mold_span (struct disir_instance *instance,
+                                const char *data, size_t size, struct disir_mold **mold)
+{
+    disir_log_user (instance, "TRACE ENTER dio_json_unserialize_mold_span");
+
+    try
+    {
+        dio::MoldReader reader (instance);
+
+        return reader.unserialize (data, size, mold);
+    }
+    catch (std::exception& e)
+    {
+        disir_log_user (instance, "JSON: fatal exception in unserialize_mold_span");
+        return DISIR_STATUS_INTERNAL_ERROR;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
 enum disir_status
 dio_json_unserialize_mold_override (struct disir_instance *instance,
                                     FILE *namespace_input , FILE *override_input,
@@ -87,6 +147,33 @@ dio_json_unserialize_mold_override (struct disir_instance *instance,
     return DISIR_STATUS_OK;
 }
 
+static enum disir_status
+unserialize_mold_override_span (struct disir_instance *instance,
+                                const char *namespace_data, size_t namespace_size,
+                                const char *override_data, size_t override_size,
+                                struct disir_mold **mold)
+{
+    enum disir_status status;
+
+    try
+    {
+        dio::MoldReader reader (instance);
+
+        status = reader.set_mold_override (override_data, override_size);
+        if (status != DISIR_STATUS_OK)
+        {
+            return status;
+        }
+
+        return reader.unserialize (namespace_data, namespace_size, mold);
+    }
+    catch (std::exception& e)
+    {
+        disir_log_user (instance, "JSON: fatal exception in unserialize_mold_override");
+        return DISIR_STATUS_INTERNAL_ERROR;
+    }
+}
+
 enum disir_status
 dio_json_determine_mold_override (struct disir_instance *instance, FILE *input)
 {
@@ -112,8 +199,10 @@ dio_json_unserialize_mold_filepath (struct disir_instance *instance,
 {
     enum disir_status status;
     struct stat statbuf;
-    FILE *mold_file = NULL;
-    FILE *override_file = NULL;
+    char *mold_data = NULL;
+    char *override_data = NULL;
+    size_t mold_size;
+    size_t override_size;
 
     disir_log_user (instance, "TRACE ENTER dio_json_unserialize_mold");
 
@@ -124,37 +213,33 @@ dio_json_unserialize_mold_filepath (struct disir_instance *instance,
         return status;
     }
 
-    mold_file = fopen (filepath, "r");
-    if (mold_file == NULL)
+    status = fslib_read_filepath (instance, filepath, &mold_data, &mold_size);
+    if (status != DISIR_STATUS_OK)
     {
-        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
-        return DISIR_STATUS_FS_ERROR;
+        return status;
     }
 
     if (override_filepath)
     {
-        override_file = fopen (override_filepath, "r");
-        if (override_file == NULL)
+        status = fslib_read_filepath (instance, override_filepath,
+                                      &override_data, &override_size);
+        if (status != DISIR_STATUS_OK)
         {
-            disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
-            status = DISIR_STATUS_FS_ERROR;
             goto out;
         }
 
-        status = dio_json_unserialize_mold_override (instance, mold_file, override_file, mold);
+        status = unserialize_mold_override_span (instance, mold_data, mold_size,
+                                                 override_data, override_size, mold);
     }
     else
     {
         // Regular mold
-        status = dio_json_unserialize_mold (instance, mold_file, mold);
+        status = dio_json_unserialize_mold_span (instance, mold_data, mold_size, mold);
     }
     // FALL-THROUGH
 out:
-    if (mold_file)
-        fclose (mold_file);
-    if (override_file)
-        fclose (override_file);
+    free (mold_data);
+    free (override_data);
 
     return status;
 }
-
@@ -7,6 +7,7 @@
 // standard
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <stdint.h>
 
 
@@ -25,12 +26,35 @@ ConfigReader::ConfigReader (struct disir_instance *disir, struct disir_mold *mol
 //! PUBLIC
 enum disir_status
 ConfigReader::unserialize (struct disir_config **config, std::istream& stream)
+{
+    // Json::Reader reads the whole stream into memory as well. Its error
+    // messages refer to that memory, so it must outlive the reader.
+    std::string document ((std::istreambuf_iterator<char> (stream)),
+                          std::istreambuf_iterator<char> ());
+
+    return unserialize (config, document.data (), document.size ());
+}
+
+//! PUBLIC
+enum disir_status
+ConfigReader::unserialize (struct disir_config **config, const std::string string)
+{
+    return unserialize (config, string.data (), string.size ());
+}
+
+//! PUBLIC
+enum disir_status
+ConfigReader::unserialize (struct disir_config **config, const char *data, size_t size)
 {
     Json::Reader reader;
     Json::Value root;
 
-    bool success = reader.parse (stream, root);
+    if (m_streaming)
+    {
+        return unserialize_document (config, data, data + size);
+    }
 
+    bool success = reader.parse (data, data + size, root);
     if (!success)
     {
         disir_error_set (m_disir, "Parse error: %s",
@@ -41,22 +65,42 @@ ConfigReader::unserialize (struct disir_config **config, std::istream& stream)
     return construct_config (root, config);
 }
 
-//! PUBLIC
+//! PRIVATE
 enum disir_status
-ConfigReader::unserialize (struct disir_config **config, const std::string string)
+ConfigReader::begin_config (struct disir_context **context_config)
 {
-    Json::Reader reader;
-    Json::Value root;
+    enum disir_status status;
 
-    bool success = reader.parse (string, root);
-    if (!success)
+    status = dc_config_begin (m_mold, context_config);
+    if (status != DISIR_STATUS_OK)
     {
-        disir_error_set (m_disir, "Parse error: %s",
-                                   reader.getFormattedErrorMessages ().c_str());
-        return DISIR_STATUS_FS_ERROR;
+        disir_log_user (m_disir, "Could not create config context from mold");
+        return status;
     }
 
-    return construct_config (root, config);
+    if (disir_arena_enabled (m_disir))
+    {
+        return dc_enable_arena (*context_config);
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PRIVATE
+enum disir_status
+ConfigReader::finalize_config (struct disir_context **context_config,
+                               struct disir_config **config)
+{
+    enum disir_status status;
+
+    status = dc_config_finalize (context_config, config);
+    if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+    {
+        disir_log_user (m_disir, "could not finalize config context: %s",
+                        disir_status_string (status));
+    }
+
+    return status;
 }
 
 enum disir_status
@@ -67,10 +111,9 @@ ConfigReader::construct_config (Json::Value& root, struct disir_config **config)
 
     *config = NULL;
 
-    status = dc_config_begin (m_mold, &context_config);
+    status = begin_config (&context_config);
     if (status != DISIR_STATUS_OK)
     {
-        disir_log_user (m_disir, "Could not create config context from mold");
         goto error;
     }
 
@@ -95,11 +138,9 @@ ConfigReader::construct_config (Json::Value& root, struct disir_config **config)
         goto error;
 
 finalize:
-    status = dc_config_finalize (&context_config, config);
+    status = finalize_config (&context_config, config);
     if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
     {
-        disir_log_user (m_disir, "could not finalize config context: %s",
-                        disir_status_string (status));
         goto error;
     }
 
@@ -221,6 +262,59 @@ error:
 }
 
 
+//! PRIVATE
+enum disir_status
+ConfigReader::begin_section (struct disir_context *parent_context, std::string& name,
+                             struct disir_context **context_section)
+{
+    enum disir_status status;
+
+    status = dc_begin (parent_context, DISIR_CONTEXT_SECTION, context_section);
+    if (status != DISIR_STATUS_OK)
+    {
+        // This error cannot pass, crash hard!
+        disir_log_user (m_disir, "could not start DISIR_CONTEXT_SECTION");
+        return status;
+    }
+
+    status = dc_set_name (*context_section, name.c_str (), name.size ());
+    if (status != DISIR_STATUS_OK &&
+        status != DISIR_STATUS_NOT_EXIST)
+    {
+        // THis is unexpected, crash hard!
+        disir_log_user (m_disir, "Could not set name (%s) : %s", name.c_str (),
+                                  disir_status_string (status));
+        return status;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PRIVATE
+enum disir_status
+ConfigReader::finalize_section (struct disir_context **context_section)
+{
+    enum disir_status status;
+
+    status = dc_finalize (context_section);
+    if (status != DISIR_STATUS_OK &&
+        status != DISIR_STATUS_INVALID_CONTEXT)
+    {
+        // Reeling us in by only loggin the error
+        disir_log_user (m_disir, "Could not finalize context: %s",
+                                 disir_status_string (status));
+    }
+
+    // If context is invalid we need to
+    // get rid of our reference to it.
+    if (status == DISIR_STATUS_INVALID_CONTEXT)
+    {
+        dc_putcontext (context_section);
+    }
+
+    return status;
+}
+
 enum disir_status
 ConfigReader::unserialize_array (struct disir_context *parent, Json::Value& array, std::string& name)
 {
@@ -247,21 +341,9 @@ ConfigReader::unserialize_type (struct disir_context *context, Json::Value& valu
     switch (value.type ())
     {
     case Json::objectValue:
-        status = dc_begin (context, DISIR_CONTEXT_SECTION, &child_context);
+        status = begin_section (context, name, &child_context);
         if (status != DISIR_STATUS_OK)
         {
-            // This error cannot pass, crash hard!
-            disir_log_user (m_disir, "could not start DISIR_CONTEXT_SECTION");
-            goto error;
-        }
-
-        status = dc_set_name (child_context, name.c_str (), name.size ());
-        if (status != DISIR_STATUS_OK &&
-            status != DISIR_STATUS_NOT_EXIST)
-        {
-            // THis is unexpected, crash hard!
-            disir_log_user (m_disir, "Could not set name (%s) : %s", name.c_str (),
-                                      disir_status_string (status));
             goto error;
         }
 
@@ -272,21 +354,7 @@ ConfigReader::unserialize_type (struct disir_context *context, Json::Value& valu
             return status;
         }
 
-        status = dc_finalize (&child_context);
-        if (status != DISIR_STATUS_OK &&
-            status != DISIR_STATUS_INVALID_CONTEXT)
-        {
-            // Reeling us in by only loggin the error
-            disir_log_user (m_disir, "Could not finalize context: %s",
-                                     disir_status_string (status));
-        }
-
-        // If context is invalid we need to
-        // get rid of our reference to it.
-        if (status == DISIR_STATUS_INVALID_CONTEXT)
-        {
-            dc_putcontext (&child_context);
-        }
+        status = finalize_section (&child_context);
         break;
     case Json::arrayValue:
         status = unserialize_array (context, value, name);
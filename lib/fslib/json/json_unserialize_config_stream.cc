@@ -0,0 +1,770 @@
+// JSON private
+#include "json/json_unserialize.h"
+
+// public
+#include <disir/disir.h>
+
+// standard
+#include <algorithm>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+
+#define VERSION "version"
+
+//! Json::Reader throws when values nest 1000 deep. Leave deep documents to it.
+#define STREAM_DEPTH_LIMIT 900
+
+using namespace dio;
+
+//! Reads a JSON config document front to back, and builds the config contexts
+//! as each value is read - no Json::Value DOM of the document is ever built.
+//!
+//! The parser only accepts documents it reads with the same result as the DOM reader.
+//! On anything else - syntax errors, duplicate keys, null values, a config element
+//! preceding the version, ... - it gives up, and the document is left to the DOM reader.
+//! The DOM reader thus still produces every parse error message.
+//!
+//! Once a context operation fails hard, no more contexts are built, but the rest of
+//! the document is still read: the DOM reader reports parse errors before such failures.
+//!
+class ConfigReader::StreamParser
+{
+public:
+    StreamParser (ConfigReader& reader, const char *begin, const char *end)
+        : m_reader (reader), m_current (begin), m_end (end) {};
+
+    //! \brief Construct config from the document.
+    //!
+    //! \return false if the parser gave up on the document. Nothing is constructed.
+    //! \return true otherwise. status holds the result of the construction.
+    //!
+    bool
+    construct_config (struct disir_config **config, enum disir_status& status);
+
+private:
+    //! Read the members of the object whose opening brace was just consumed.
+    bool
+    read_object (struct disir_context *parent, bool build, bool root);
+
+    //! Read a member of the root object. The value follows.
+    bool
+    read_root_member (std::string& key);
+
+    //! Read a value named name into parent. built is incremented per context built.
+    bool
+    read_value (struct disir_context *parent, std::string& name, bool build, int& built);
+
+    //! Read a string, starting at its opening quote.
+    bool
+    read_string (std::string& out);
+
+    //! Read the four hex digits of an \u escape, and any low surrogate following it.
+    bool
+    read_unicode (std::string& out);
+
+    //! Read a number the way Json::Reader tokenizes and decodes it.
+    bool
+    read_number (Json::Value& value);
+
+    bool
+    read_literal (const char *literal, int length);
+
+    //! Skip whitespace and comments. Returns false on a malformed comment.
+    bool
+    skip_comments ();
+
+    void
+    skip_spaces ();
+
+    bool
+    building (bool build) { return build && m_status == DISIR_STATUS_OK; }
+
+    bool
+    peek (char c) { return m_current != m_end && *m_current == c; }
+
+    //! Whether parent already holds an element named name.
+    bool
+    has_element (struct disir_context *parent, std::string& name);
+
+private:
+    ConfigReader& m_reader;
+    const char *m_current;
+    const char *m_end;
+    int m_depth = 0;
+
+    //! First hard failure of a context operation.
+    enum disir_status m_status = DISIR_STATUS_OK;
+
+    struct disir_context *m_config = nullptr;
+    bool m_seen_version = false;
+    bool m_seen_config = false;
+    //! Cleared when the version is invalid - the config element is then ignored.
+    bool m_build_config = true;
+};
+
+//! PRIVATE
+enum disir_status
+ConfigReader::unserialize_document (struct disir_config **config,
+                                    const char *begin, const char *end)
+{
+    enum disir_status status;
+    Json::Reader reader;
+    Json::Value root;
+
+    StreamParser parser (*this, begin, end);
+    if (parser.construct_config (config, status))
+    {
+        return status;
+    }
+
+    // The streaming parser gave up on this document - parse it into a DOM instead.
+    bool success = reader.parse (begin, end, root);
+    if (!success)
+    {
+        disir_error_set (m_disir, "Parse error: %s",
+                                   reader.getFormattedErrorMessages ().c_str());
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    return construct_config (root, config);
+}
+
+//! Same encoding as Json::Reader.
+static void
+append_code_point (std::string& out, unsigned int cp)
+{
+    if (cp <= 0x7f)
+    {
+        out += static_cast<char> (cp);
+    }
+    else if (cp <= 0x7ff)
+    {
+        out += static_cast<char> (0xc0 | (0x1f & (cp >> 6)));
+        out += static_cast<char> (0x80 | (0x3f & cp));
+    }
+    else if (cp <= 0xffff)
+    {
+        out += static_cast<char> (0xe0 | (0xf & (cp >> 12)));
+        out += static_cast<char> (0x80 | (0x3f & (cp >> 6)));
+        out += static_cast<char> (0x80 | (0x3f & cp));
+    }
+    else if (cp <= 0x10ffff)
+    {
+        out += static_cast<char> (0xf0 | (0x7 & (cp >> 18)));
+        out += static_cast<char> (0x80 | (0x3f & (cp >> 12)));
+        out += static_cast<char> (0x80 | (0x3f & (cp >> 6)));
+        out += static_cast<char> (0x80 | (0x3f & cp));
+    }
+}
+
+static bool
+read_hex4 (const char *current, const char *end, unsigned int& value)
+{
+    int i;
+    char c;
+
+    if (end - current < 4)
+        return false;
+
+    value = 0;
+    for (i = 0; i < 4; i++)
+    {
+        c = current[i];
+        value *= 16;
+        if (c >= '0' && c <= '9')
+            value += c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value += c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value += c - 'A' + 10;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+is_digit (char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+bool
+ConfigReader::StreamParser::construct_config (struct disir_config **config,
+                                              enum disir_status& status)
+{
+    if (!skip_comments () || !peek ('{'))
+        return false;
+    m_current++;
+
+    status = m_reader.begin_config (&m_config);
+    if (status != DISIR_STATUS_OK)
+    {
+        m_status = status;
+    }
+
+    // Json::Reader ignores whatever follows the root value.
+    if (!read_object (NULL, false, true) || !m_seen_version || !m_seen_config)
+    {
+        if (m_config)
+        {
+            dc_destroy (&m_config);
+        }
+        return false;
+    }
+
+    *config = NULL;
+
+    if (m_status != DISIR_STATUS_OK)
+    {
+        status = m_status;
+        goto error;
+    }
+
+    status = m_reader.finalize_config (&m_config, config);
+    if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+    {
+        goto error;
+    }
+
+    return true;
+error:
+    if (m_config)
+    {
+        dc_destroy (&m_config);
+    }
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::read_object (struct disir_context *parent, bool build, bool root)
+{
+    std::string key;
+    // Keys whose value built no context, e.g., empty arrays
+    std::vector<std::string> empty_keys;
+    int built;
+
+    if (++m_depth >= STREAM_DEPTH_LIMIT)
+        return false;
+
+    if (!skip_comments ())
+        return false;
+    if (peek ('}'))
+    {
+        m_current++;
+        m_depth--;
+        return true;
+    }
+
+    while (1)
+    {
+        if (!peek ('"') || !read_string (key))
+            return false;
+
+        // Json::Reader does not allow comments before the member separator.
+        skip_spaces ();
+        if (!peek (':'))
+            return false;
+        m_current++;
+
+        if (root)
+        {
+            if (!read_root_member (key))
+                return false;
+        }
+        else
+        {
+            // The DOM holds a single value per key. Leave duplicate keys to it.
+            if (building (build)
+                && (has_element (parent, key)
+                    || std::find (empty_keys.begin (), empty_keys.end (), key)
+                        != empty_keys.end ()))
+            {
+                return false;
+            }
+
+            built = 0;
+            if (!read_value (parent, key, build, built))
+                return false;
+
+            if (built == 0 && building (build))
+            {
+                empty_keys.push_back (key);
+            }
+        }
+
+        if (!skip_comments ())
+            return false;
+        if (peek ('}'))
+        {
+            m_current++;
+            break;
+        }
+        if (!peek (','))
+            return false;
+        m_current++;
+
+        if (!skip_comments ())
+            return false;
+    }
+
+    m_depth--;
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::read_root_member (std::string& key)
+{
+    enum disir_status status;
+    std::string version_string;
+    int built = 0;
+
+    if (key == VERSION)
+    {
+        // The version must be read before the config element is built.
+        if (m_seen_version || m_seen_config)
+            return false;
+        m_seen_version = true;
+
+        // Leave the version type error to the DOM reader
+        if (!skip_comments () || !peek ('"') || !read_string (version_string))
+            return false;
+
+        if (building (true))
+        {
+            Json::Value version (version_string);
+
+            status = m_reader.set_config_version (m_config, version);
+            if (status == DISIR_STATUS_INVALID_CONTEXT)
+            {
+                m_build_config = false;
+            }
+            else if (status != DISIR_STATUS_OK)
+            {
+                m_status = status;
+            }
+        }
+        return true;
+    }
+
+    if (key == ATTRIBUTE_KEY_CONFIG)
+    {
+        if (!m_seen_version || m_seen_config)
+            return false;
+        m_seen_config = true;
+
+        if (!skip_comments () || !peek ('{'))
+            return false;
+        m_current++;
+
+        return read_object (m_config, m_build_config, false);
+    }
+
+    // Any other member is ignored.
+    return read_value (NULL, key, false, built);
+}
+
+bool
+ConfigReader::StreamParser::read_value (struct disir_context *parent, std::string& name,
+                                        bool build, int& built)
+{
+    enum disir_status status;
+    struct disir_context *context_section = NULL;
+    std::string string;
+    Json::Value value;
+
+    if (!skip_comments () || m_current == m_end)
+        return false;
+
+    switch (*m_current)
+    {
+    case '{':
+        m_current++;
+        if (building (build))
+        {
+            status = m_reader.begin_section (parent, name, &context_section);
+            if (status != DISIR_STATUS_OK)
+            {
+                m_status = status;
+                if (context_section)
+                {
+                    dc_destroy (&context_section);
+                }
+            }
+        }
+
+        if (!read_object (context_section, context_section != NULL, false))
+        {
+            if (context_section)
+            {
+                dc_destroy (&context_section);
+            }
+            return false;
+        }
+
+        if (context_section)
+        {
+            // A child failed hard - no need to keep the section
+            if (m_status != DISIR_STATUS_OK)
+            {
+                dc_destroy (&context_section);
+                return true;
+            }
+
+            status = m_reader.finalize_section (&context_section);
+            if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+            {
+                m_status = status;
+                if (context_section)
+                {
+                    dc_destroy (&context_section);
+                }
+                return true;
+            }
+            built++;
+        }
+        return true;
+    case '[':
+        m_current++;
+        if (++m_depth >= STREAM_DEPTH_LIMIT)
+            return false;
+
+        // Json::Reader only looks for the end of an empty array past whitespace.
+        skip_spaces ();
+        if (peek (']'))
+        {
+            m_current++;
+            m_depth--;
+            return true;
+        }
+
+        // Every entry is an element of the same name.
+        while (1)
+        {
+            if (!read_value (parent, name, build, built))
+                return false;
+
+            if (!skip_comments ())
+                return false;
+            if (peek (']'))
+            {
+                m_current++;
+                break;
+            }
+            if (!peek (','))
+                return false;
+            m_current++;
+        }
+
+        m_depth--;
+        return true;
+    case '"':
+        if (!read_string (string))
+            return false;
+        value = Json::Value (string);
+        break;
+    case 't':
+        if (!read_literal ("true", 4))
+            return false;
+        value = Json::Value (true);
+        break;
+    case 'f':
+        if (!read_literal ("false", 5))
+            return false;
+        value = Json::Value (false);
+        break;
+    case 'n':
+        if (!read_literal ("null", 4))
+            return false;
+        break;
+    default:
+        if (*m_current != '-' && !is_digit (*m_current))
+            return false;
+        if (!read_number (value))
+            return false;
+        break;
+    }
+
+    if (!building (build))
+        return true;
+
+    switch (value.type ())
+    {
+    case Json::intValue:
+    case Json::stringValue:
+    case Json::realValue:
+    case Json::booleanValue:
+        status = m_reader.set_keyval (parent, name, value);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_INVALID_CONTEXT)
+        {
+            m_status = status;
+            return true;
+        }
+        built++;
+        break;
+    default:
+        // Like the DOM reader, fail on null and unsigned values.
+        m_status = DISIR_STATUS_INTERNAL_ERROR;
+        break;
+    }
+
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::read_string (std::string& out)
+{
+    const char *start;
+
+    out.clear ();
+
+    // Opening quote
+    m_current++;
+    start = m_current;
+
+    while (m_current != m_end)
+    {
+        if (*m_current == '"')
+        {
+            out.append (start, m_current);
+            m_current++;
+            return true;
+        }
+
+        if (*m_current != '\\')
+        {
+            m_current++;
+            continue;
+        }
+
+        out.append (start, m_current);
+        m_current++;
+        if (m_current == m_end)
+            return false;
+
+        switch (*m_current++)
+        {
+        case '"':
+            out += '"';
+            break;
+        case '/':
+            out += '/';
+            break;
+        case '\\':
+            out += '\\';
+            break;
+        case 'b':
+            out += '\b';
+            break;
+        case 'f':
+            out += '\f';
+            break;
+        case 'n':
+            out += '\n';
+            break;
+        case 'r':
+            out += '\r';
+            break;
+        case 't':
+            out += '\t';
+            break;
+        case 'u':
+            if (!read_unicode (out))
+                return false;
+            break;
+        default:
+            return false;
+        }
+        start = m_current;
+    }
+
+    return false;
+}
+
+bool
+ConfigReader::StreamParser::read_unicode (std::string& out)
+{
+    unsigned int unicode;
+    unsigned int surrogate;
+
+    if (!read_hex4 (m_current, m_end, unicode))
+        return false;
+    m_current += 4;
+
+    if (unicode >= 0xd800 && unicode <= 0xdbff)
+    {
+        if (m_end - m_current < 6 || m_current[0] != '\\' || m_current[1] != 'u'
+            || !read_hex4 (m_current + 2, m_end, surrogate))
+        {
+            return false;
+        }
+        m_current += 6;
+        unicode = 0x10000 + ((unicode & 0x3ff) << 10) + (surrogate & 0x3ff);
+    }
+
+    append_code_point (out, unicode);
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::read_number (Json::Value& value)
+{
+    const char *start;
+    const char *current;
+    const char *p;
+    bool is_negative;
+    bool is_integer;
+    Json::Value::LargestUInt max_value;
+    Json::Value::LargestUInt threshold;
+    Json::Value::LargestUInt integer;
+    unsigned int digit;
+    char buffer[64];
+    char *parsed;
+    double real;
+
+    // Tokenize - the first character is a digit or minus.
+    start = m_current;
+    p = m_current + 1;
+    while (p < m_end && is_digit (*p))
+        p++;
+    if (p < m_end && *p == '.')
+    {
+        p++;
+        while (p < m_end && is_digit (*p))
+            p++;
+    }
+    if (p < m_end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < m_end && (*p == '+' || *p == '-'))
+            p++;
+        while (p < m_end && is_digit (*p))
+            p++;
+    }
+    m_current = p;
+
+    // Decode as an integer - unless it does not fit.
+    is_negative = (*start == '-');
+    current = (is_negative ? start + 1 : start);
+    max_value = (is_negative ? Json::Value::LargestUInt (Json::Value::maxLargestInt) + 1
+                             : Json::Value::maxLargestUInt);
+    threshold = max_value / 10;
+    integer = 0;
+    is_integer = true;
+    while (current < p)
+    {
+        if (!is_digit (*current))
+        {
+            is_integer = false;
+            break;
+        }
+        digit = static_cast<unsigned int> (*current++ - '0');
+        if (integer >= threshold
+            && (integer > threshold || current != p || digit > max_value % 10))
+        {
+            is_integer = false;
+            break;
+        }
+        integer = integer * 10 + digit;
+    }
+
+    if (is_integer)
+    {
+        if (is_negative && integer == max_value)
+            value = Json::Value (Json::Value::minLargestInt);
+        else if (is_negative)
+            value = Json::Value (-Json::Value::LargestInt (integer));
+        else if (integer <= Json::Value::LargestUInt (Json::Value::maxInt))
+            value = Json::Value (Json::Value::LargestInt (integer));
+        else
+            value = Json::Value (integer);
+        return true;
+    }
+
+    // Leave anything strtod does not consume entirely, or cannot represent, to Json::Reader.
+    if (p - start >= (long) sizeof (buffer))
+        return false;
+    std::copy (start, p, buffer);
+    buffer[p - start] = '\0';
+
+    errno = 0;
+    real = strtod (buffer, &parsed);
+    if (parsed != buffer + (p - start) || errno == ERANGE)
+        return false;
+
+    value = Json::Value (real);
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::read_literal (const char *literal, int length)
+{
+    if (m_end - m_current < length || !std::equal (literal, literal + length, m_current))
+        return false;
+
+    m_current += length;
+    return true;
+}
+
+bool
+ConfigReader::StreamParser::skip_comments ()
+{
+    while (1)
+    {
+        skip_spaces ();
+        if (!peek ('/'))
+            return true;
+        m_current++;
+
+        if (peek ('*'))
+        {
+            m_current++;
+            while (1)
+            {
+                if (m_end - m_current < 2)
+                    return false;
+                if (m_current[0] == '*' && m_current[1] == '/')
+                    break;
+                m_current++;
+            }
+            m_current += 2;
+        }
+        else if (peek ('/'))
+        {
+            while (m_current != m_end && *m_current != '\n' && *m_current != '\r')
+                m_current++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+}
+
+void
+ConfigReader::StreamParser::skip_spaces ()
+{
+    while (m_current != m_end
+           && (*m_current == ' ' || *m_current == '\t'
+               || *m_current == '\r' || *m_current == '\n'))
+    {
+        m_current++;
+    }
+}
+
+bool
+ConfigReader::StreamParser::has_element (struct disir_context *parent, std::string& name)
+{
+    struct disir_element_iter iter;
+    struct disir_context *element;
+
+    if (dc_element_iter_begin (parent, name.c_str (), &iter) != DISIR_STATUS_OK)
+        return false;
+
+    return (dc_element_iter_next (&iter, &element) == DISIR_STATUS_OK);
+}
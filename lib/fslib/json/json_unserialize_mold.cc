@@ -7,6 +7,7 @@
 #include <iostream>
 #include <stdarg.h>
 #include <cstring>
+#include <iterator>
 
 using namespace dio;
 
@@ -21,7 +22,16 @@ MoldReader::~MoldReader ()
 enum disir_status
 MoldReader::set_mold_override (std::istream& entry)
 {
-    auto status = m_override_reader.parse_mold_override_entry (m_disir, entry);
+    std::string document ((std::istreambuf_iterator<char> (entry)),
+                          std::istreambuf_iterator<char> ());
+
+    return set_mold_override (document.data (), document.size ());
+}
+
+enum disir_status
+MoldReader::set_mold_override (const char *data, size_t size)
+{
+    auto status = m_override_reader.parse_mold_override_entry (m_disir, data, data + size);
     if (status != DISIR_STATUS_OK)
     {
         return status;
@@ -47,10 +57,17 @@ MoldReader::is_override_mold_entry (std::istream& entry)
 //! PUBLIC
 enum disir_status
 MoldReader::unserialize (std::string mold_json, struct disir_mold **mold)
+{
+    return unserialize (mold_json.data (), mold_json.size (), mold);
+}
+
+//! PUBLIC
+enum disir_status
+MoldReader::unserialize (const char *data, size_t size, struct disir_mold **mold)
 {
     Json::Reader reader;
 
-    bool success = reader.parse (mold_json, m_moldRoot);
+    bool success = reader.parse (data, data + size, m_moldRoot);
     if (!success)
     {
         disir_error_set (m_disir, "Parse error: %s",
@@ -65,17 +82,11 @@ MoldReader::unserialize (std::string mold_json, struct disir_mold **mold)
 enum disir_status
 MoldReader::unserialize (std::istream& stream, struct disir_mold **mold)
 {
-    Json::Reader reader;
+    // Parse error messages refer to the document - it must outlive the reader.
+    std::string document ((std::istreambuf_iterator<char> (stream)),
+                          std::istreambuf_iterator<char> ());
 
-    bool success = reader.parse (stream, m_moldRoot);
-    if (!success)
-    {
-        disir_error_set (m_disir, "Parse error: %s",
-                                  reader.getFormattedErrorMessages().c_str());
-        return DISIR_STATUS_FS_ERROR;
-    }
-
-    return construct_mold (mold);
+    return unserialize (document.data (), document.size (), mold);
 }
 
 enum disir_status
@@ -90,6 +101,15 @@ MoldReader::construct_mold (struct disir_mold **mold)
         goto error;
     }
 
+    if (disir_arena_enabled (m_disir))
+    {
+        status = dc_enable_arena (context_mold);
+        if (status != DISIR_STATUS_OK)
+        {
+            goto error;
+        }
+    }
+
     if (mold_has_documentation (m_moldRoot))
     {
         auto doc = m_moldRoot[ATTRIBUTE_KEY_DOCUMENTATION].asString ();
@@ -3,20 +3,85 @@
 
 // system
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
 
+// private
+#include "disir_private.h"
+#include "log.h"
+#include "stats.h"
 
-//! FSLIB API
-enum disir_status
-fslib_plugin_config_read (struct disir_instance *instance,
-                          struct disir_register_plugin *plugin, const char *entry_id,
-                          struct disir_mold *mold, struct disir_config **config,
-                          dio_unserialize_config func_unserialize)
+
+//! STATIC API
+//!
+//! Read the mold for entry_id through the plugin, reusing the mold cached in the
+//! instance for as long as the resolved mold and override files are unchanged on disk.
+//!
+static enum disir_status
+read_mold_cached (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                  const char *entry_id, struct disir_mold **mold)
+{
+    enum disir_status status;
+    char mold_filepath[PATH_MAX];
+    char override_filepath[PATH_MAX];
+    char *override_ref;
+    struct stat mold_stat;
+    struct stat override_stat;
+
+    status = fslib_mold_resolve_entry_id (instance, plugin, entry_id,
+                                          mold_filepath, override_filepath, &mold_stat, NULL);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Let the plugin report why the mold cannot be read.
+        disir_error_clear (instance);
+        return plugin->dp_mold_read (instance, plugin, entry_id, mold);
+    }
+
+    override_ref = NULL;
+    if (*override_filepath != '\0')
+    {
+        if (stat (override_filepath, &override_stat) != 0)
+        {
+            return plugin->dp_mold_read (instance, plugin, entry_id, mold);
+        }
+        override_ref = override_filepath;
+    }
+
+    status = dx_mold_cache_lookup (instance, plugin, mold_filepath, &mold_stat,
+                                   override_ref, (override_ref ? &override_stat : NULL), mold);
+    if (status == DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = plugin->dp_mold_read (instance, plugin, entry_id, mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    // Failing to cache the mold does not fail the read.
+    dx_mold_cache_store (instance, plugin, mold_filepath, &mold_stat,
+                         override_ref, (override_ref ? &override_stat : NULL), mold);
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! Resolve the config filepath of entry_id, and the mold to read it with.
+//! resolved_mold is only referenced by us if mold is NULL.
+//!
+static enum disir_status
+config_read_resolve (struct disir_instance *instance,
+                     struct disir_register_plugin *plugin, const char *entry_id,
+                     struct disir_mold *mold, char *filepath,
+                     struct disir_mold **resolved_mold)
 {
     enum disir_status status;
-    char filepath[PATH_MAX];
     struct stat statbuf;
-    struct disir_mold *resolved_mold;
 
     status = fslib_config_resolve_filepath (instance, plugin, entry_id, filepath);
     if (status != DISIR_STATUS_OK)
@@ -36,7 +101,7 @@ fslib_plugin_config_read (struct disir_instance *instance,
     // Locate mold from plugin
     if (mold == NULL)
     {
-        status = plugin->dp_mold_read (instance, plugin, entry_id, &resolved_mold);
+        status = read_mold_cached (instance, plugin, entry_id, resolved_mold);
         if (status != DISIR_STATUS_OK)
         {
             if (status == DISIR_STATUS_INVALID_CONTEXT)
@@ -50,24 +115,282 @@ fslib_plugin_config_read (struct disir_instance *instance,
     }
     else
     {
-        resolved_mold = mold;
+        *resolved_mold = mold;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Return non-zero if the file of compiled was modified after the file of source.
+static int
+compiled_is_newer (const struct stat *compiled, const struct stat *source)
+{
+    if (compiled->st_mtim.tv_sec != source->st_mtim.tv_sec)
+        return (compiled->st_mtim.tv_sec > source->st_mtim.tv_sec);
+
+    return (compiled->st_mtim.tv_nsec > source->st_mtim.tv_nsec);
+}
+
+//! FSLIB API
+enum disir_status
+fslib_mold_read_compiled (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                          const char *entry_id,
+                          const char *mold_filepath, const struct stat *mold_statbuf,
+                          const char *override_filepath, struct disir_mold **mold)
+{
+    enum disir_status status;
+    char filepath[PATH_MAX];
+    struct stat statbuf;
+    struct stat override_statbuf;
+
+    status = fslib_mold_compiled_filepath (instance, plugin, entry_id,
+                                           mold_filepath, override_filepath, filepath);
+    if (status != DISIR_STATUS_OK || stat (filepath, &statbuf) != 0)
+    {
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    if (compiled_is_newer (&statbuf, mold_statbuf) == 0)
+    {
+        log_debug (2, "compiled mold %s is older than its mold entry - ignoring it.", filepath);
+        return DISIR_STATUS_NOT_EXIST;
+    }
+    if (override_filepath && *override_filepath != '\0'
+        && (stat (override_filepath, &override_statbuf) != 0
+            || compiled_is_newer (&statbuf, &override_statbuf) == 0))
+    {
+        log_debug (2, "compiled mold %s is older than its override entry - ignoring it.",
+                   filepath);
+        return DISIR_STATUS_NOT_EXIST;
+    }
+
+    status = disir_mold_load_compiled (instance, filepath, mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        log_warn ("ignoring compiled mold %s: %s", filepath, disir_error (instance));
+        disir_error_clear (instance);
+    }
+
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+fslib_read_filepath (struct disir_instance *instance, const char *filepath,
+                     char **data, size_t *size)
+{
+    enum disir_status status;
+    struct stat statbuf;
+    char *buffer;
+    char *grown;
+    size_t capacity;
+    size_t used;
+    ssize_t res;
+    int fd;
+
+    buffer = NULL;
+    used = 0;
+
+    fd = open (filepath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        // TODO: Use threadsafe strerror
+        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    if (fstat (fd, &statbuf) != 0)
+    {
+        disir_error_set (instance, "stat %s: %s", filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    // One byte past the size reported by stat lets a single read detect the end
+    // of a regular file. Anything else is read until EOF in growing chunks.
+    capacity = (S_ISREG (statbuf.st_mode) ? (size_t) statbuf.st_size : 4095) + 1;
+    buffer = malloc (capacity + 1);
+    if (buffer == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
+    while (1)
+    {
+        if (used == capacity)
+        {
+            capacity *= 2;
+            grown = realloc (buffer, capacity + 1);
+            if (grown == NULL)
+            {
+                status = DISIR_STATUS_NO_MEMORY;
+                goto error;
+            }
+            buffer = grown;
+        }
+
+        res = read (fd, buffer + used, capacity - used);
+        if (res == 0)
+        {
+            break;
+        }
+        if (res < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            disir_error_set (instance, "reading %s: %s", filepath, strerror (errno));
+            status = DISIR_STATUS_FS_ERROR;
+            goto error;
+        }
+        used += res;
+    }
+
+    close (fd);
+
+    buffer[used] = '\0';
+    *data = buffer;
+    *size = used;
+    return DISIR_STATUS_OK;
+error:
+    close (fd);
+    free (buffer);
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+fslib_read_stream (struct disir_instance *instance, FILE *input, char **data, size_t *size)
+{
+    char *buffer;
+    char *grown;
+    size_t capacity;
+    size_t used;
+    size_t res;
+
+    used = 0;
+    capacity = 8192;
+    buffer = malloc (capacity + 1);
+    if (buffer == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
     }
 
+    while (1)
+    {
+        if (used == capacity)
+        {
+            capacity *= 2;
+            grown = realloc (buffer, capacity + 1);
+            if (grown == NULL)
+            {
+                free (buffer);
+                return DISIR_STATUS_NO_MEMORY;
+            }
+            buffer = grown;
+        }
 
+        res = fread (buffer + used, 1, capacity - used, input);
+        used += res;
+        if (res == 0)
+        {
+            break;
+        }
+    }
+
+    if (ferror (input))
+    {
+        disir_error_set (instance, "reading stream: %s", strerror (errno));
+        free (buffer);
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    buffer[used] = '\0';
+    *data = buffer;
+    *size = used;
+    return DISIR_STATUS_OK;
+}
+
+//! FSLIB API
+enum disir_status
+fslib_plugin_config_read (struct disir_instance *instance,
+                          struct disir_register_plugin *plugin, const char *entry_id,
+                          struct disir_mold *mold, struct disir_config **config,
+                          dio_unserialize_config func_unserialize)
+{
+    enum disir_status status;
+    char filepath[PATH_MAX];
+    struct disir_mold *resolved_mold;
     FILE *file;
+    struct dx_stats_timer timer;
+
+    status = config_read_resolve (instance, plugin, entry_id, mold, filepath, &resolved_mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
     file = fopen (filepath, "r");
     if (file == NULL)
     {
         // TODO: Check errno and set appropriate error
         // TODO: Use threadsafe strerror, or refactor entirely
         disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
-        return DISIR_STATUS_FS_ERROR;
+        status = DISIR_STATUS_FS_ERROR;
+        goto out;
     }
 
+    dx_stats_begin (instance, &timer);
     status = func_unserialize (instance, file, resolved_mold, config);
+    dx_stats_end (&timer, DISIR_STATS_PARSE, status);
 
-    // Cleanup
     fclose (file);
+    // FALL-THROUGH
+out:
+    if (mold == NULL)
+    {
+        // We only decref the mold if we were the one allocating it
+        disir_mold_finished (&resolved_mold);
+    }
+
+    return status;
+}
+
+//! FSLIB API
+enum disir_status
+fslib_plugin_config_read_span (struct disir_instance *instance,
+                               struct disir_register_plugin *plugin, const char *entry_id,
+                               struct disir_mold *mold, struct disir_config **config,
+                               dio_unserialize_config_span func_unserialize)
+{
+    enum disir_status status;
+    char filepath[PATH_MAX];
+    struct disir_mold *resolved_mold;
+    char *data;
+    size_t size;
+    struct dx_stats_timer timer;
+
+    status = config_read_resolve (instance, plugin, entry_id, mold, filepath, &resolved_mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = fslib_read_filepath (instance, filepath, &data, &size);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto out;
+    }
+
+    dx_stats_begin (instance, &timer);
+    status = func_unserialize (instance, data, size, resolved_mold, config);
+    dx_stats_end (&timer, DISIR_STATS_PARSE, status);
+
+    free (data);
+    // FALL-THROUGH
+out:
     if (mold == NULL)
     {
         // We only decref the mold if we were the one allocating it
@@ -86,19 +409,29 @@ fslib_plugin_mold_read (struct disir_instance *instance,
 {
     enum disir_status status;
     char filepath[PATH_MAX];
+    char override_filepath[PATH_MAX];
     struct stat statbuf;
     int namespace_entry;
     FILE *file;
+    struct dx_stats_timer timer;
 
     namespace_entry = 0;
 
     status = fslib_mold_resolve_entry_id (instance, plugin, entry_id,
-                                          filepath, NULL, &statbuf, &namespace_entry);
+                                          filepath, override_filepath, &statbuf,
+                                          &namespace_entry);
     if (status != DISIR_STATUS_OK)
     {
         return status;
     }
 
+    status = fslib_mold_read_compiled (instance, plugin, entry_id, filepath, &statbuf,
+                                       override_filepath, mold);
+    if (status == DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
     file = fopen (filepath, "r");
     if (file == NULL)
     {
@@ -108,10 +441,59 @@ fslib_plugin_mold_read (struct disir_instance *instance,
         return DISIR_STATUS_FS_ERROR;
     }
 
+    dx_stats_begin (instance, &timer);
     status = func_unserialize (instance, file, mold);
+    dx_stats_end (&timer, DISIR_STATS_PARSE, status);
     // Cleanup
     fclose (file);
 
     return status;
 }
 
+
+//! FSLIB API
+enum disir_status
+fslib_plugin_mold_read_span (struct disir_instance *instance,
+                             struct disir_register_plugin *plugin, const char *entry_id,
+                             struct disir_mold **mold,
+                             dio_unserialize_mold_span func_unserialize)
+{
+    enum disir_status status;
+    char filepath[PATH_MAX];
+    char override_filepath[PATH_MAX];
+    struct stat statbuf;
+    int namespace_entry;
+    char *data;
+    size_t size;
+    struct dx_stats_timer timer;
+
+    namespace_entry = 0;
+
+    status = fslib_mold_resolve_entry_id (instance, plugin, entry_id,
+                                          filepath, override_filepath, &statbuf,
+                                          &namespace_entry);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = fslib_mold_read_compiled (instance, plugin, entry_id, filepath, &statbuf,
+                                       override_filepath, mold);
+    if (status == DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = fslib_read_filepath (instance, filepath, &data, &size);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    dx_stats_begin (instance, &timer);
+    status = func_unserialize (instance, data, size, mold);
+    dx_stats_end (&timer, DISIR_STATS_PARSE, status);
+    free (data);
+
+    return status;
+}
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include <disir/disir.h>
 #include <disir/fslib/toml.h>
@@ -202,12 +203,9 @@ toml_serialize_elements (struct disir_context *context, toml::Value* current)
     enum disir_status status;
     const char *name;
     struct disir_context *element;
-    struct disir_collection *collection;
+    struct disir_element_iter iter;
 
-    collection = NULL;
-    element = NULL;
-
-    status = dc_get_elements (context, &collection);
+    status = dc_element_iter_begin (context, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         disir_log_user (NULL, "Get elements failed with status: %s", disir_status_string (status));
@@ -216,17 +214,11 @@ toml_serialize_elements (struct disir_context *context, toml::Value* current)
 
     do
     {
-        status = dc_collection_next (collection, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             break;
         }
-        if (status != DISIR_STATUS_OK)
-        {
-            // log error - get out of town.
-            disir_log_user (NULL, "Collection returned non-OK status: %s", disir_status_string (status));
-            goto out;
-        }
 
         status = dc_get_name (element, &name, NULL);
         if (status != DISIR_STATUS_OK)
@@ -244,21 +236,11 @@ toml_serialize_elements (struct disir_context *context, toml::Value* current)
         if (status != DISIR_STATUS_OK)
             goto out;
 
-        dc_putcontext (&element);
-
     } while (1);
 
     status = DISIR_STATUS_OK;
     // FALL-THROUGH
 out:
-    if (collection)
-    {
-        dc_collection_finished (&collection);
-    }
-    if (element)
-    {
-        dc_putcontext (&element);
-    }
     return status;
 }
 
@@ -303,8 +285,23 @@ dio_toml_serialize_config (struct disir_instance *instance,
     // Mjes
     status = toml_serialize_elements (context_config, current);
 
-    boost::fdostream file(fileno(output));
-    root.write (&file);
+    if (fileno (output) < 0)
+    {
+        // A memory stream has no file descriptor to write to.
+        std::ostringstream document;
+        root.write (&document);
+        auto str = document.str();
+        if (fwrite (str.data(), 1, str.size(), output) != str.size() || ferror (output))
+        {
+            disir_log_user (instance, "TOML: failed to write config to memory stream");
+            return DISIR_STATUS_FS_ERROR;
+        }
+    }
+    else
+    {
+        boost::fdostream file(fileno(output));
+        root.write (&file);
+    }
 
     disir_log_user (instance, "TRACE EXIT serialize_config");
     return DISIR_STATUS_OK;
@@ -5,6 +5,7 @@
 
 #include <disir/disir.h>
 #include <disir/fslib/toml.h>
+#include <disir/fslib/util.h>
 
 #include "tinytoml/toml.h"
 #include "fdstream.hpp"
@@ -230,27 +231,28 @@ dio_toml_unserialize_all (struct disir_instance *instance, const char *key,
     return status;
 }
 
-//! FSLIB API
-enum disir_status
-dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
-                             struct disir_mold *mold, struct disir_config **config)
+//! Read-only stream buffer over the contiguous bytes of a span.
+class span_streambuf : public std::streambuf
 {
-    enum disir_status status;
-    struct disir_context *context_config;
-
-    if (instance == NULL || input == NULL || mold == NULL || config == NULL)
+public:
+    span_streambuf (const char *data, size_t size)
     {
-        // LOG debug 0
-        return DISIR_STATUS_INVALID_ARGUMENT;
+        // The get area is never written through.
+        char *begin = const_cast<char *> (data);
+        setg (begin, begin, begin + size);
     }
+};
 
-    disir_log_user (instance, "TRACE ENTER dio_toml_unserialize_config");
-
-    boost::fdistream file(fileno(input));
-    // XXX: Check file
+//! STATIC API
+static enum disir_status
+unserialize_config (struct disir_instance *instance, std::istream& input,
+                    struct disir_mold *mold, struct disir_config **config)
+{
+    enum disir_status status;
+    struct disir_context *context_config;
 
     // Pare the TOML formatted file and extract it into a toml::Value object
-    toml::ParseResult pr = toml::parse (file);
+    toml::ParseResult pr = toml::parse (input);
     if (pr.valid() == false)
     {
         disir_log_user (instance, "TOML: Parse error: %s", pr.errorReason.c_str());
@@ -267,6 +269,16 @@ dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
         return status;
     }
 
+    if (disir_arena_enabled (instance))
+    {
+        status = dc_enable_arena (context_config);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context_config);
+            return status;
+        }
+    }
+
     // Check if root contains version
     const toml::Value* version = root.findChild (ATTRIBUTE_KEY_DISIR_CONFIG_VERSION);
     if (version != nullptr)
@@ -328,3 +340,56 @@ dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
     return status;
 }
 
+//! FSLIB API
+enum disir_status
+dio_toml_unserialize_config (struct disir_instance *instance, FILE *input,
+                             struct disir_mold *mold, struct disir_config **config)
+{
+    if (instance == NULL || input == NULL || mold == NULL || config == NULL)
+    {
+        // LOG debug 0
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    disir_log_user (instance, "TRACE ENTER dio_toml_unserialize_config");
+
+    if (fileno (input) < 0)
+    {
+        enum disir_status status;
+        char *data;
+        size_t size;
+
+        status = fslib_read_stream (instance, input, &data, &size);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        status = dio_toml_unserialize_config_span (instance, data, size, mold, config);
+        free (data);
+        return status;
+    }
+
+    boost::fdistream file(fileno(input));
+    // XXX: Check file
+
+    return unserialize_config (instance, file, mold, config);
+}
+
+//! FSLIB API
+enum disir_status
+dio_toml_unserialize_config_span (struct disir_instance *instance,
+                                  const char *data, size_t size,
+                                  struct disir_mold *mold, struct disir_config **config)
+{
+    if (instance == NULL || data == NULL || mold == NULL || config == NULL)
+    {
+        // LOG debug 0
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    disir_log_user (instance, "TRACE ENTER dio_toml_unserialize_config_span");
+
+    span_streambuf buffer (data, size);
+    std::istream stream (&buffer);
+
+    return unserialize_config (instance, stream, mold, config);
+}
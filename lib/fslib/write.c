@@ -229,3 +229,49 @@ fslib_plugin_config_remove (struct disir_instance *instance,
 
     return status;
 }
+
+//! FSLIB API
+enum disir_status
+fslib_plugin_mold_compile (struct disir_instance *instance,
+                           struct disir_register_plugin *plugin,
+                           const char *entry_id)
+{
+    enum disir_status status;
+    char filepath[PATH_MAX];
+    char mold_filepath[PATH_MAX];
+    char override_filepath[PATH_MAX];
+    struct stat statbuf;
+    struct disir_mold *mold;
+
+    mold = NULL;
+
+    status = fslib_mold_resolve_entry_id (instance, plugin, entry_id,
+                                          mold_filepath, override_filepath, &statbuf, NULL);
+    if (status != DISIR_STATUS_OK)
+    {
+        return status;
+    }
+
+    status = fslib_mold_compiled_filepath (instance, plugin, entry_id,
+                                           mold_filepath, override_filepath, filepath);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "compiled mold filepath too long for entry %s", entry_id);
+        return status;
+    }
+
+    status = plugin->dp_mold_read (instance, plugin, entry_id, &mold);
+    if (status != DISIR_STATUS_OK)
+    {
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+        return status;
+    }
+
+    status = disir_mold_compile (instance, mold, filepath);
+    disir_mold_finished (&mold);
+
+    return status;
+}
@@ -29,7 +29,7 @@ generate_config_from_mold_recursive_step (struct disir_context *mold_parent,
                                           int generate_zero_min)
 {
     enum disir_status status;
-    struct disir_collection *collection;
+    struct disir_element_iter iter;
     struct disir_context *equiv;
     struct disir_context *context;
     struct disir_default *def;
@@ -39,13 +39,13 @@ generate_config_from_mold_recursive_step (struct disir_context *mold_parent,
     int i;
 
     // Get each element from the element storage of mold_parent
-    status = dc_get_elements (mold_parent, &collection);
+    status = dc_element_iter_begin (mold_parent, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         goto error;
     }
 
-    while (dc_collection_next (collection, &equiv) != DISIR_STATUS_EXHAUSTED)
+    while (dc_element_iter_next (&iter, &equiv) != DISIR_STATUS_EXHAUSTED)
     {
 
         status = dx_restriction_entries_value (equiv, DISIR_RESTRICTION_INC_ENTRY_MIN,
@@ -112,17 +112,10 @@ generate_config_from_mold_recursive_step (struct disir_context *mold_parent,
                 goto error;
             }
         }
-
-        dc_putcontext (&equiv);
     }
 
     status = DISIR_STATUS_OK;
 error:
-    if (collection)
-    {
-        dc_collection_finished (&collection);
-    }
-
     return status;
 
 }
@@ -4,7 +4,11 @@
 #include "tinytoml/toml.h"
 #include <disir/archive.h>
 #include <set>
+#include <map>
+#include <string>
+#include <vector>
 #include <libgen.h>
+#include <stdint.h>
 
 //! Convenience macros:
 //! toml key for a backend table
@@ -15,6 +19,44 @@
 #define ATTRIBUTE_KEY_GROUPS "groups"
 //! name of metadata file in archive
 #define METADATA_FILENAME "metadata.toml"
+//! name of the entry index, the last member of the trailer of an archive
+#define INDEX_FILENAME "entries.index"
+//! Leading field of the first line of the entry index.
+//!
+//! The index is a line of tab separated fields per config entry in the archive,
+//! following a header line:
+//!
+//!     disir-index <disir_org_version> <implementation>
+//!     <offset> <size> <hash> <backend> <group> <version> <entry_id>
+//!
+//! offset is where the member begins in the uncompressed tar stream, its header
+//! included, and size the size of the serialized config. hash is the binary_checksum
+//! of the serialized config, in hexadecimal.
+#define INDEX_MAGIC "disir-index"
+//! disir_org_version written to, and required of, the metadata and index of an archive.
+#define ARCHIVE_ORG_VERSION "0/1-draft"
+
+//! Uncompressed size after which the archive writer starts a new xz block
+//! at the next member. A member never spans two blocks, such that reading one
+//! member decompresses at most the block holding it.
+#define ARCHIVE_BLOCK_SIZE (1024 * 1024)
+
+//! Suffix of the journal kept next to an archive while it is appended to in place.
+//!
+//! The journal holds what the append overwrites, following a header line:
+//!
+//!     disir-splice <offset> <size>
+//!
+//! size bytes are restored to the archive at offset, and the archive truncated after them,
+//! should the journal still exist the next time the archive is opened.
+#define SPLICE_JOURNAL_SUFFIX ".journal"
+//! Leading field of the header line of the splice journal.
+#define SPLICE_JOURNAL_MAGIC "disir-splice"
+
+//! Largest uncompressed member, or block of members, read into memory.
+//! Sizes read from the archive itself are untrusted; anything larger is
+//! taken to be a corrupt archive rather than allocated for.
+#define ARCHIVE_MEMBER_SIZE_MAX (256 * 1024 * 1024)
 
 // Spesifies a config entry in a disir archive
 struct disir_archive_entry
@@ -25,10 +67,16 @@ struct disir_archive_entry
     std::string de_group_id;
     // The entry if of the config
     std::string de_entry_id;
-    // path to its location on disk
-    std::string de_filepath;
+    // path of the serialized config within the archive
+    std::string de_archive_path;
     // archive entry version (config)
     std::string de_version;
+    // offset of the member in the uncompressed tar stream, its header included
+    uint64_t de_offset;
+    // size of the serialized config
+    uint64_t de_size;
+    // binary_checksum of the serialized config
+    uint64_t de_hash;
 };
 
 // compare function for disir_archive_entry
@@ -41,13 +89,17 @@ struct cmp_entry
     }
 };
 
+// Forward declarations - xz stream writer and reader of an archive.
+struct disir_archive_writer;
+struct disir_archive_reader;
+
 //! Holding structures involving archive operations
 struct disir_archive
 {
     // libarchive object
     struct archive *da_archive;
-    // Path for temporary extraction
-    char *da_extract_folder_path;
+    // Compressed stream da_archive is written to
+    struct disir_archive_writer *da_writer;
     // Temp archive path for until finalize
     char *da_temp_archive_path;
     // Existing archive path
@@ -58,41 +110,70 @@ struct disir_archive
     std::map<std::string, toml::Value*> *da_entries;
     // Config entries in open disir_archive
     std::set<struct disir_archive_entry, cmp_entry> *da_config_entries;
+    // Location of each member written to the archive, keyed by its path
+    std::map<std::string, struct disir_archive_entry> *da_members;
+    // Compression of the archive written
+    enum disir_archive_codec da_codec;
+    int da_level;
+    // Offset in the existing archive where the temp archive is spliced in on finalize.
+    // Zero unless appending to the existing archive in place.
+    uint64_t da_append_offset;
 };
 
 //! Create a disir_archive
 enum disir_status
 dx_archive_create (struct disir_archive **archive);
 
-//! Extracts the contents of archive to 'extract_path' on disk and populate
-//! 'extract_content' with all its entries and their location on disk.
+//! Reads every member of the archive into memory, populating 'archive_content'
+//! with their content keyed by their path within the archive.
 enum disir_status
-dx_archive_extract (const char *archive_path, std::map<std::string, std::string>& extract_content,
-                    const char *extract_path);
+dx_archive_read (const char *archive_path, std::map<std::string, std::string>& archive_content);
 
-//! Opens the archive in write-mode.
+//! Read the data of the current member 'entry' of 'read_archive' into 'content'.
+enum disir_status
+dx_archive_read_data (struct archive *read_archive, struct archive_entry *entry,
+                      std::string& content);
+
+//! Opens the archive in write-mode, compressed by its codec.
+//! If 'existing' is not NULL, the archive continues the archive it reads from the
+//! start of its trailer, to be spliced onto it on finalize.
 //! Caller is responsible for closing archive, unless disir_archive_finalize is called.
 enum disir_status
-dx_archive_open_write (struct disir_archive *archive);
+dx_archive_open_write (struct disir_archive *archive, struct disir_archive_reader *existing);
 
 //! Opens the archive in read-mode.
 //! Caller is responsible for closing archive when finished.
 enum disir_status
 dx_archive_open_read (const char *archive_path, struct archive **archive);
 
-//! Validates the integrity of the entries retrieved from dx_archive_extract
+//! Restore the archive from its splice journal, if an append in place was interrupted.
+//! An incomplete journal is discarded, as the archive is not written to before
+//! the journal is complete.
+//! Returns DISIR_STATUS_OK if there is no journal.
+enum disir_status
+dx_archive_journal_recover (const char *archive_path);
+
+//! Validates that the archive was written by a compatible implementation.
+enum disir_status
+dx_archive_validate_implementation (const std::string& org_version,
+                                    const std::string& implementation);
+
+//! Validates the integrity of the members retrieved from dx_archive_read
 enum disir_status
 dx_archive_validate (struct disir_archive *archive,
-                     std::map<std::string, std::string>& archive_entries);
+                     std::map<std::string, std::string>& archive_content);
 
-//! Begin existing archive referred to by 'archive_path'
+//! Begin existing archive referred to by 'archive_path', to be written with 'codec'.
 enum disir_status
 dx_archive_begin_existing (struct disir_instance *instance, const char *archive_path,
+                           enum disir_archive_codec codec, int level,
                            struct disir_archive **archive);
 
-//! Begin new archive open for appends
+//! Begin new archive open for appends, compressed with 'codec'.
+//! See dx_archive_open_write for 'existing'.
 enum disir_status
-dx_archive_begin_new (struct disir_archive **archive);
+dx_archive_begin_new (enum disir_archive_codec codec, int level,
+                      struct disir_archive_reader *existing, struct disir_archive **archive);
 
 //! Write config entries to archive.
 enum disir_status
@@ -113,17 +194,81 @@ dx_assert_write_permission (const char *path);
 enum disir_status
 dx_archive_metadata_write (struct disir_archive *archive);
 
-//! Create a temporary folder in /tmp
-char *
-dx_archive_create_temp_folder (void);
-
 //! Move archive to given location on disk. Overwrite existing archive with backup.
 enum disir_status
 dx_archive_disk_append (const char *new_archive_path, const char *existing_archive_path,
                         const char *temp_archive_path);
 
-//! Clean up temporary files and free data structures
+//! Splice the temp archive onto the existing archive at 'offset', replacing its trailer.
+//! The existing archive is only rewritten in its entirety if moved to a new location.
+//! What is replaced is journaled first, see SPLICE_JOURNAL_SUFFIX.
+enum disir_status
+dx_archive_disk_splice (const char *new_archive_path, const char *existing_archive_path,
+                        const char *temp_archive_path, uint64_t offset);
+
+//! Free data structures
 enum disir_status
 dx_archive_destroy (struct disir_archive *ar);
 
+//! Open 'archive' for writing, xz compressed at 'level' to a new file at 'filepath'.
+//! The writer is owned by the caller, and outlives the archive.
+enum disir_status
+dx_archive_writer_open (struct archive *archive, const char *filepath, int level,
+                        struct disir_archive_writer **writer);
+
+//! Open 'archive' for writing, continuing the archive read by 'existing'
+//! from the start of its trailer. Only the blocks written after it go to the new file
+//! at 'filepath', followed by an xz index of every block. 'append_offset' is populated
+//! with the offset in the existing archive where the new file is to be spliced in.
+enum disir_status
+dx_archive_writer_open_append (struct archive *archive, const char *filepath, int level,
+                               struct disir_archive_reader *existing, uint64_t *append_offset,
+                               struct disir_archive_writer **writer);
+
+//! Offset in the uncompressed tar stream where the next member begins.
+//! Starts a new xz block if the current one exceeds ARCHIVE_BLOCK_SIZE.
+enum disir_status
+dx_archive_writer_member_begin (struct disir_archive_writer *writer, uint64_t *offset);
+
+//! Ends the current xz block, such that the next member begins a new one.
+enum disir_status
+dx_archive_writer_block_end (struct disir_archive_writer *writer);
+
+//! Free the writer, and close its file if the archive has not already.
+void
+dx_archive_writer_destroy (struct disir_archive_writer **writer);
+
+//! Open the archive at 'archive_path' for reading individual members.
+//! Returns DISIR_STATUS_NOT_EXIST if the archive cannot be read at random
+//! (not a single xz stream of several blocks).
+enum disir_status
+dx_archive_reader_open (const char *archive_path, struct disir_archive_reader **reader);
+
+//! Read the members of the trailer, the last block of the archive, into 'trailer'.
+//! Returns DISIR_STATUS_NOT_EXIST if the archive carries no entry index.
+enum disir_status
+dx_archive_trailer_read (struct disir_archive_reader *reader,
+                         std::map<std::string, std::string>& trailer);
+
+//! Parse the content of the entry index into 'entries'.
+enum disir_status
+dx_archive_index_parse (const std::string& index,
+                        std::vector<struct disir_archive_entry>& entries);
+
+//! Read the entry index, in the trailer of the archive, into 'entries'.
+//! Returns DISIR_STATUS_NOT_EXIST if the archive carries no index.
+enum disir_status
+dx_archive_index_read (struct disir_archive_reader *reader,
+                       std::vector<struct disir_archive_entry>& entries);
+
+//! Read the member of 'entry', from the index, into 'content'.
+//! Only the block holding the member is decompressed.
+enum disir_status
+dx_archive_index_member_read (struct disir_archive_reader *reader,
+                              const struct disir_archive_entry& entry, std::string& content);
+
+//! Close the archive opened by dx_archive_reader_open.
+void
+dx_archive_reader_close (struct disir_archive_reader **reader);
+
 #endif // _LIBDISIR_PRIVATE_ARCHIVE_H
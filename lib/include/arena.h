@@ -0,0 +1,97 @@
+#ifndef _LIBDISIR_PRIVATE_ARENA_H
+#define _LIBDISIR_PRIVATE_ARENA_H
+
+#include <stddef.h>
+
+#include <disir/context.h>
+
+//! Forward declare the Disir Arena structure.
+//! An arena hands out memory from a few large blocks, and releases every block
+//! at once when the last reference to it is released. Individual allocations are never free'd.
+struct disir_arena;
+
+//! \brief Allocate a new, empty arena with a single reference.
+//!
+//! \return NULL if the allocation failed.
+//! \return Pointer to the newly allocated arena.
+//!
+struct disir_arena *
+dx_arena_create (void);
+
+//! \brief Take a reference on the arena.
+//!
+//! \return The input arena, which may be NULL.
+//!
+struct disir_arena *
+dx_arena_incref (struct disir_arena *arena);
+
+//! \brief Release a reference on the arena.
+//!
+//! When the last reference is released, every block held by the arena
+//! is released along with the arena itself.
+//!
+//! \param[in,out] arena Double-pointer to the arena. Sat to NULL.
+//!
+void
+dx_arena_decref (struct disir_arena **arena);
+
+//! \brief Allocate zero-initialized memory.
+//!
+//! If the input arena is NULL, the memory is allocated with calloc()
+//! and must be released with dx_arena_free().
+//!
+//! \param[in] arena Arena to allocate from. May be NULL.
+//! \param[in] size Number of bytes to allocate.
+//!
+//! \return NULL if the allocation failed.
+//! \return Pointer to size bytes of zeroed memory, suitably aligned for any type.
+//!
+void *
+dx_arena_calloc (struct disir_arena *arena, size_t size);
+
+//! \brief Release memory obtained through dx_arena_calloc() with the same arena.
+//!
+//! Memory allocated from an arena is only released when the arena is destroyed;
+//! this is a no-op unless arena is NULL.
+//!
+void
+dx_arena_free (struct disir_arena *arena, void *memory);
+
+//! \brief Hand memory obtained through dx_arena_calloc() back to the arena for reuse.
+//!
+//! Later allocations of the same size are served from released memory, such that
+//! replacing a value over and over does not grow the arena. Unlike dx_arena_free(),
+//! the caller must hold the tree exclusively - i.e., not on destroy, where contexts
+//! of a frozen tree may be released concurrently. Frees memory if arena is NULL.
+//!
+//! \param[in] size Number of bytes the memory was allocated with, or fewer.
+//!
+void
+dx_arena_release (struct disir_arena *arena, void *memory, size_t size);
+
+//! \brief Hand ownership of a memory mapping over to the arena.
+//!
+//! Objects allocated from the arena may then point into the mapping. It is
+//! unmapped along with every block when the last reference to the arena is released.
+//! An arena holds at most one mapping.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if arena or address are NULL.
+//! \return DISIR_STATUS_EXISTS if the arena already holds a mapping.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_arena_adopt_mapping (struct disir_arena *arena, void *address, size_t size);
+
+//! \brief Number of bytes handed out by the arena, and number of blocks backing them.
+void
+dx_arena_usage (struct disir_arena *arena, size_t *bytes, size_t *blocks);
+
+//! \brief Retrieve the arena the object of the input context is allocated from.
+//!
+//! \return NULL if the tree of context does not allocate from an arena.
+//! \return The arena shared by every context in the tree of context.
+//!
+struct disir_arena *
+dx_context_arena (struct disir_context *context);
+
+#endif // _LIBDISIR_PRIVATE_ARENA_H
@@ -0,0 +1,94 @@
+#ifndef _LIBDISIR_PRIVATE_BINARY_FORMAT_H
+#define _LIBDISIR_PRIVATE_BINARY_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//!
+//! Layout of the binary config image written by dio_binary_serialize_config().
+//!
+//! The image is a header followed by the element block of the config.
+//! An element block is a uint32_t count of records, followed by that many records.
+//! Each record is:
+//!
+//!     uint32_t    size of the record, this field included
+//!     uint8_t     context type (DISIR_CONTEXT_KEYVAL or DISIR_CONTEXT_SECTION)
+//!     uint8_t     value type of a keyval, zero for a section
+//!     uint16_t    reserved, zero
+//!     uint32_t    size of the name, excluding its null terminator
+//!     char[]      name, null terminated
+//!
+//! followed by the element block of a section, or the value of a keyval:
+//!
+//!     STRING, ENUM    uint32_t size excluding the null terminator, null terminated string
+//!     INTEGER         int64_t
+//!     FLOAT           double
+//!     BOOLEAN         uint8_t
+//!     UNKNOWN         nothing
+//!
+//! Every field is stored in host byte order, without any alignment.
+//! Since each record is prefixed by its size, a reader may skip over
+//! the complete subtree of a section without decoding it.
+//!
+
+//! Magic bytes leading every binary config image.
+#define BINARY_CONFIG_MAGIC "DISIRCFG"
+
+//! Format version of the image. Bumped on any incompatible layout change.
+#define BINARY_CONFIG_FORMAT 1
+
+//! Written in host byte order. Images of another byte order are not read.
+#define BINARY_CONFIG_BYTE_ORDER 0x01020304
+
+//! Flag set in the header if the config was valid when it was written.
+#define BINARY_CONFIG_FLAG_VALID 0x1
+
+//! Deepest nesting of sections accepted when reading an image.
+#define BINARY_CONFIG_MAX_DEPTH 256
+
+//! Size of the fixed part of a record, before the name.
+#define BINARY_CONFIG_RECORD_HEADER_SIZE 12
+
+struct binary_config_header
+{
+    char        bh_magic[8];
+    uint32_t    bh_format;
+    uint32_t    bh_byte_order;
+    //! Size of the complete image, header included.
+    uint64_t    bh_size;
+    //! Checksum of every byte following the header. See binary_checksum().
+    uint64_t    bh_checksum;
+    uint32_t    bh_config_version_major;
+    uint32_t    bh_config_version_minor;
+    //! Version of the mold the config was written with.
+    uint32_t    bh_mold_version_major;
+    uint32_t    bh_mold_version_minor;
+    uint32_t    bh_flags;
+    uint32_t    bh_reserved;
+};
+
+//! \brief Checksum size bytes of data.
+//!
+//! 64-bit FNV-1a over 8-byte words, such that verifying a large image is cheap
+//! compared to decoding it.
+//!
+static inline uint64_t
+binary_checksum (const char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t word;
+
+    for (; size >= sizeof (word); data += sizeof (word), size -= sizeof (word))
+    {
+        __builtin_memcpy (&word, data, sizeof (word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; size > 0; data++, size--)
+    {
+        hash = (hash ^ (unsigned char) *data) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+#endif // _LIBDISIR_PRIVATE_BINARY_FORMAT_H
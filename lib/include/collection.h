@@ -25,12 +25,17 @@ struct disir_collection
 
     //! Index into cc_collection the iterator is presently at.
     int32_t         cc_iterator_index;
+
+    //! Destroy generation the collection was last coalesced at.
+    //! Coalescing is skipped while this equals dx_context_destroy_generation().
+    uint64_t        cc_generation;
 };
 
 //! INTERNAL API
 //! Make sure every entry in collection is valid and stored sequentially.
 //! Modify iterator index and numentries if context(s) are found to be invalid.
 //! Decref and lose invalid context pointers.
+//! Nothing is done unless a context has been destroyed since the last coalesce.
 enum disir_status dx_collection_coalesce (struct disir_collection *collection);
 
 //! \brief Return the next entry in the collection without coalescing.
@@ -45,6 +45,18 @@ struct disir_config *dx_config_create (struct disir_context *context);
 //!
 enum disir_status dx_config_destroy (struct disir_config **config);
 
+//! \brief Finalize a config context without validating it.
+//!
+//! Only intended for configs read from a source known to hold a valid config,
+//! whose elements may not all be constructed yet. The config is considered valid.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if either of the arguments are NULL.
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is not a DISIR_CONTEXT_CONFIG.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status dx_config_finalize_trusted (struct disir_context **context,
+                                              struct disir_config **config);
+
 
 #endif // _LIBDISIR_PRIVATE_CONFIG_H
 
@@ -25,6 +25,10 @@ struct disir_context
                          CONTEXT_STATE_FATAL                    : 4,
                          CONTEXT_STATE_DESTROYED                : 5,
                          CONTEXT_STATE_IN_PARENT                : 6,
+                         CONTEXT_STATE_FROZEN                   : 1,
+                         CONTEXT_STATE_DIRTY                    : 1,
+                         CONTEXT_STATE_DIRTY_ELEMENTS           : 1,
+                         CONTEXT_STATE_ELEMENTS_INVALID         : 1,
                                                                 : 0;
         };
     };
@@ -52,11 +56,22 @@ struct disir_context
     //!     * DISIR_CONTEXT_MOLD
     struct disir_context                        *cx_root_context;
 
+    //! Arena the object of this context is allocated from, shared by the whole tree.
+    //! Each context holds a reference, such that the arena outlives every object
+    //! allocated from it. NULL if the tree allocates each object individually.
+    struct disir_arena                          *cx_arena;
+
 
     //! Reference count on how many context pointers the user
-    //! is in possession of.
+    //! is in possession of. Modified atomically, since mold contexts
+    //! are referenced by configs built in different threads.
     int64_t                     cx_refcount;
 
+    //! Generation of the elements of the tree - only maintained on its root context.
+    //! Takes a new value whenever a context is added to or removed from any element
+    //! storage of the tree. See dx_context_generation_bump(). Accessed atomically.
+    uint64_t                    cx_elements_generation;
+
     //! Allocated and populated if an error message occurs.
     //! Should probably be a stack of messages, with a counter.
     //! and a state counter!
@@ -85,6 +100,11 @@ struct disir_context
 #define CONTEXT_DOUBLE_NULL_INVALID_TYPE_CHECK(context) \
     dx_context_dp_full_check_log_error (context, __func__)
 
+//! Check that the passed context is not part of a frozen snapshot.
+//! Returns DISIR_STATUS_CONTEXT_IN_WRONG_STATE if it is.
+#define CONTEXT_FROZEN_CHECK(context) \
+    dx_context_frozen_check_log_error (context, __func__)
+
 
 //
 // Utility context prototypes
@@ -109,6 +129,14 @@ void dx_context_decref (struct disir_context **context);
 //! Attach 'parent' as parent context to 'context'
 void dx_context_attach (struct disir_context *parent, struct disir_context *context);
 
+//! \brief Mark a finalized context as modified since it was last validated.
+//!
+//! Sets CONTEXT_STATE_DIRTY on context and CONTEXT_STATE_DIRTY_ELEMENTS on
+//! each of its ancestors, such that dx_validate_dirty() may find it.
+//! Constructing contexts are left alone - they are validated when finalized.
+//!
+void dx_context_mark_dirty (struct disir_context *context);
+
 //! Return the string representation of the disir_context_type enumeration
 const char * dx_context_type_string (enum disir_context_type type);
 
@@ -135,6 +163,34 @@ struct disir_context * dx_context_create (enum disir_context_type type);
 //! Free an allocated disir_context
 void dx_context_destroy (struct disir_context **context);
 
+//! \brief Set CONTEXT_STATE_DESTROYED on context.
+//!
+//! Bumps the destroy generation, such that collections holding a reference
+//! to context drop it on their next coalesce.
+//!
+void dx_context_mark_destroyed (struct disir_context *context);
+
+//! \brief Return the destroy generation.
+//!
+//! The generation is bumped every time any context is marked destroyed.
+//! A collection coalesced at the current generation holds no destroyed contexts.
+//!
+uint64_t dx_context_destroy_generation (void);
+
+//! \brief Assign a new generation to the counter of a tree.
+//!
+//! The value is drawn from a sequence shared by every tree, such that a generation
+//! is never repeated - not even by a tree allocated where a destroyed one used to be.
+//!
+void dx_context_generation_bump (uint64_t *generation);
+
+//! \brief Return the generation of the elements of the tree holding context.
+//!
+//! Equal values returned by two calls guarantee that no element storage of the
+//! tree has changed in between. Unrelated trees do not affect the value.
+//!
+uint64_t dx_context_elements_generation (struct disir_context *context);
+
 //! \brief Associate the input config related context with its equiv mold related context
 //!
 //! The input context must have root CONFIG context, where valid contexts are:
@@ -215,6 +271,19 @@ enum disir_status dx_get_mold_equiv_type (struct disir_context *parent,
 //!
 enum disir_status dx_validate_context (struct disir_context *context);
 
+//! \brief Re-validate only the parts of a finalized tree modified since it was last validated.
+//!
+//! Contexts marked with dx_context_mark_dirty() are validated as with
+//! dx_validate_context(), except that their children are only revisited if they too
+//! are dirty. Every other context keeps the state from when it was last validated.
+//!
+//! \return any status of dx_validate_context() if context itself is dirty.
+//! \return DISIR_STATUS_INVALID_CONTEXT if context is not dirty, but invalid.
+//! \return DISIR_STATUS_ELEMENTS_INVALID if any of its children are deemed invalid.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status dx_validate_dirty (struct disir_context *context);
+
 //! \brief Retrieve all elements that are invalid.
 enum disir_status
 dx_invalid_elements (struct disir_context *context, struct disir_collection *collection);
@@ -263,6 +332,13 @@ enum disir_status dx_context_sp_full_check_log_error (struct disir_context *cont
 enum disir_status dx_context_dp_full_check_log_error (struct disir_context **context,
                                                       const char *function_name);
 
+//! Check if the passed context is part of a frozen snapshot.
+//! The error is not stored on the context - frozen contexts are never modified.
+//! \return DISIR_STATUS_CONTEXT_IN_WRONG_STATE if the passed context is FROZEN.
+//! \return DISIR_STATUS_OK otherwise.
+enum disir_status dx_context_frozen_check_log_error (struct disir_context *context,
+                                                     const char *function_name);
+
 // Transfer the logwarn entry from source to destination
 void dx_context_transfer_logwarn (struct disir_context *destination, struct disir_context *source);
 
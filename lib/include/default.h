@@ -49,6 +49,17 @@ void
 dx_default_get_active (struct disir_context *keyval, struct disir_version *version,
                        struct disir_default **def);
 
+//! \brief Index the default entries of a mold keyval by version.
+//!
+//! The index is left out if the default queue is empty, or not sorted by version.
+//! dx_default_get_active falls back to searching the queue.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if allocation failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_default_index_build (struct disir_context *keyval);
+
 
 #endif // _LIBDISIR_PRIVATE_DEFAULT_H
 
@@ -4,6 +4,10 @@
 #include <disir/disir.h>
 #include <disir/plugin.h>
 
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
 //! Internal plugin structure
 struct disir_register_plugin_internal
 {
@@ -39,8 +43,79 @@ struct disir_instance
     char                            *disir_error_message;
     //! Bytes allocated/occupied by the disir_error_message.
     int32_t                         disir_error_message_size;
+
+    //! Molds read on behalf of config reads, reused while their files are unchanged.
+    struct dx_mold_cache_entry      *mold_cache;
+    //! Number of mold cache lookups served from mold_cache.
+    uint64_t                        mold_cache_hits;
+    //! Number of mold cache lookups that had to read the mold.
+    uint64_t                        mold_cache_misses;
+    //! Serializes access to the mold cache, which is shared with worker instances.
+    pthread_mutex_t                 mold_cache_lock;
+
+    //! Counters of the operations performed through this instance.
+    //! NULL until enabled by disir_stats_enable(). Accessed atomically.
+    struct dx_stats                 *dio_stats;
+
+    //! Non-zero if configs and molds read through this instance are allocated
+    //! from an arena. See disir_arena_enable().
+    int                             dio_arena;
+
+    //! Instance a worker instance reads on behalf of, sharing its plugins and mold cache.
+    //! NULL unless allocated by dx_instance_worker_create().
+    struct disir_instance           *dio_parent;
 };
 
+//! \brief Allocate a worker instance, used to read entries through parent from another thread.
+//!
+//! The worker shares the plugins and mold cache of parent, but holds its own error message.
+//! parent must outlive the worker, and must not be used to read entries while
+//! the worker is in use.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if the worker could not be allocated.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_instance_worker_create (struct disir_instance *parent, struct disir_instance **worker);
+
+//! \brief Free a worker instance allocated by dx_instance_worker_create().
+void
+dx_instance_worker_destroy (struct disir_instance **worker);
+
+//! \brief Lookup a mold cached for plugin, read from mold_filepath and override_filepath.
+//!
+//! The cached entry is only served if the identity (device, inode, mtime and size)
+//! of both files still match mold_stat and override_stat.
+//!
+//! \param[in] override_filepath Override entry the mold was read with. May be NULL.
+//! \param[in] override_stat Stat of override_filepath. NULL if override_filepath is NULL.
+//! \param[out] mold Populated with the cached mold. The caller acquires a reference.
+//!
+//! \return DISIR_STATUS_NOT_EXIST if there is no up-to-date cache entry.
+//! \return DISIR_STATUS_OK if mold is populated.
+//!
+enum disir_status
+dx_mold_cache_lookup (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                      const char *mold_filepath, const struct stat *mold_stat,
+                      const char *override_filepath, const struct stat *override_stat,
+                      struct disir_mold **mold);
+
+//! \brief Store mold in the cache, replacing any outdated entry with the same key.
+//!
+//! The cache acquires its own reference to mold. If another thread already stored
+//! an up-to-date mold for the same key, the reference to the input mold is released
+//! and mold is populated with the cached one instead - such that readers share it.
+//! Arguments are otherwise the same as for dx_mold_cache_lookup().
+//!
+//! \return DISIR_STATUS_NO_MEMORY if the entry could not be allocated.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_mold_cache_store (struct disir_instance *instance, struct disir_register_plugin *plugin,
+                     const char *mold_filepath, const struct stat *mold_stat,
+                     const char *override_filepath, const struct stat *override_stat,
+                     struct disir_mold **mold);
+
 //! \brief get disir_register_plugin by group id
 enum disir_status
 dx_retrieve_plugin_by_group (struct disir_instance *instance, const char *group_id,
@@ -11,9 +11,14 @@ struct disir_element_storage;
 
 //! \brief Allocate a new instance of the Disir Element Storage
 //!
+//! \param[in] generation Generation of the tree the storage belongs to, bumped
+//!     by dx_context_generation_bump() whenever a context is added to or removed
+//!     from the storage - and when the storage is allocated. May be NULL.
+//!     Must outlive the storage.
+//!
 //! \return Pointer to the newly allocated instance. NULL if the allocation failed.
 struct disir_element_storage *
-dx_element_storage_create (void);
+dx_element_storage_create (uint64_t *generation);
 
 //! \brief Destroy a previously allocated instance of Disir Element Storage
 //!
@@ -34,6 +39,16 @@ dx_element_storage_destroy (struct disir_element_storage **storage);
 int32_t
 dx_element_storage_numentries (struct disir_element_storage *storage);
 
+//! \brief Return the number of contexts stored with input name.
+//!
+//! \param[in] storage Pointer to the element storage to query entries from.
+//! \param[in] name Query parameter to count contexts by.
+//!
+//! \return number of contexts stored by name, zero if there are none.
+//!
+int32_t
+dx_element_storage_count (struct disir_element_storage *storage, const char *name);
+
 //! \brief Add a context with the given name to the storage.
 //!
 //! No validation/business logic is performed. This is a raw context storage.
@@ -46,7 +61,8 @@ dx_element_storage_numentries (struct disir_element_storage *storage);
 //!
 //! \return DISIR_STATUS_INVALID_ARGUMENT if either storage, name or context are NULL.
 //! \return DISIR_STATUS_NO_MEMORY if no memory could be allocated for internal storage mechanism
-//! \return DISIR_STATUS_EXISTS if the context is already stored in storage (by the input name)
+//! \return DISIR_STATUS_EXISTS if the context is already stored in a parent storage
+//!     (CONTEXT_STATE_IN_PARENT is set on it).
 //! \return DISIR_STATUS_OK on success.
 //!
 enum disir_status
@@ -54,11 +70,59 @@ dx_element_storage_add (struct disir_element_storage *storage,
                         const char *name,
                         struct disir_context *context);
 
+//! \brief Callback constructing the deferred element identified by token.
+//!
+//! The callback shall construct the element and add it to the storage by the name
+//! its slot was deferred with, through dx_element_storage_add(). The context added
+//! takes the place of the deferred slot, preserving the insertion order.
+//!
+//! \param[in] data Loader data registered with dx_element_storage_set_loader().
+//! \param[in] token Token the element was deferred with.
+//!
+typedef enum disir_status (*dx_element_loader) (void *data, uint64_t token);
+
+//! \brief Register the loader constructing deferred elements of storage.
+//!
+//! The loader data is not owned by the storage, and must outlive every deferred slot.
+//! Registering a NULL loader leaves the remaining deferred slots unconstructed;
+//! they are then skipped by every lookup. Used when the storage is torn down.
+//!
+void
+dx_element_storage_set_loader (struct disir_element_storage *storage,
+                               dx_element_loader loader, void *data);
+
+//! \brief Add a deferred slot for an element with the given name to the storage.
+//!
+//! The slot counts as an element stored by name, but its context is only constructed
+//! by the loader of storage when the slot is first accessed, be it by name, by
+//! index or by iterating the storage. A slot whose element cannot be constructed
+//! is dropped from the storage.
+//!
+//! \param[in] storage The storage to add the slot to. Must have a loader registered.
+//! \param[in] name Name the element shall be stored by.
+//! \param[in] token Opaque value identifying the element to the loader.
+//!     Zero and UINT64_MAX are reserved.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if storage or name are NULL, if storage
+//!     has no loader or if token is reserved.
+//! \return DISIR_STATUS_NO_MEMORY if no memory could be allocated for the slot.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_element_storage_add_deferred (struct disir_element_storage *storage,
+                                 const char *name, uint64_t token);
+
 //! \brief Remove a context from the element storage
 //!
-//! TODO: Not implemented
+//! The reference held by the storage on the context is released.
+//! Removing a context that is not stored is not an error.
 //!
-//! \return DISIR_STATUS_INTERNAL_ERROR
+//! \param[in] storage The storage to remove the context from.
+//! \param[in] name Name the context was stored by.
+//! \param[in] context The context to remove.
+//!
+//! \return DISIR_STATUS_INVALID_ARGUMENT if storage or context are NULL.
+//! \return DISIR_STATUS_OK on success.
 enum disir_status
 dx_element_storage_remove (struct disir_element_storage *storage,
                            const char * const name,
@@ -111,5 +175,43 @@ dx_element_storage_get_first (struct disir_element_storage *storage,
                               const char *name,
                               struct disir_context **context);
 
+//! \brief Get the context at position index among the contexts with input name.
+//!
+//! Index is counted in insertion order, as with dx_element_storage_get().
+//! The output context is not incref'ed.
+//!
+//! \param[in] storage Query storage to retrieve context from.
+//! \param[in] name Query parameter to locate context by in storage.
+//! \param[in] index Zero-based position among the contexts stored by name.
+//! \param[out] context Populated context on success.
+//!
+//! \return DISIR_STATUS_NOT_EXIST if there is no such entry.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_element_storage_get_index (struct disir_element_storage *storage,
+                              const char *name, int32_t index,
+                              struct disir_context **context);
+
+//! \brief Initialize a borrowed iterator over the contexts in storage.
+//!
+//! \param[in] storage Storage to iterate.
+//! \param[in] name Only iterate contexts stored by name. NULL iterates every context.
+//! \param[out] iter Iterator to initialize.
+//!
+void
+dx_element_storage_iter_begin (struct disir_element_storage *storage, const char *name,
+                               struct disir_element_iter *iter);
+
+//! \brief Retrieve the next context from a borrowed iterator, in insertion order.
+//!
+//! The output context is not incref'ed.
+//!
+//! \return DISIR_STATUS_EXHAUSTED when there are no more contexts.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_element_storage_iter_next (struct disir_element_iter *iter, struct disir_context **context);
+
 #endif // _LIBDISIR_PRIVATE_ELEMENT_STORAGE_H
 
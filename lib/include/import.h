@@ -49,9 +49,12 @@ dx_import_entry_destroy (struct disir_import_entry *entry);
 
 //! \brief Determine whether an archive entry conflicts or
 //!     simply cannot be imported.
+//!
+//! The archive entry is read from the serialized config held in data.
+//!
 enum disir_status
 dx_resolve_config_import_status (struct disir_instance *instance,
-                                 const char *config_path,
+                                 const char *data, size_t size,
                                  struct disir_import_entry *import);
 
 #endif // _LIBDISIR_IMPORT_H
@@ -74,8 +74,17 @@ namespace dio
         enum disir_status
         parse_mold_override_entry (struct disir_instance *instance, std::istream& entry);
 
+        //! \brief Unserialize mold override entry from the JSON document in [begin, end).
+        enum disir_status
+        parse_mold_override_entry (struct disir_instance *instance,
+                                   const char *begin, const char *end);
+
     private:
 
+        //! \brief Validate and unserialize the parsed mold override entry root.
+        enum disir_status
+        read_mold_override_entry (struct disir_instance *instance, Json::Value& root);
+
         //! \brief Unserialize disir version
         enum disir_status
         string_to_disir_version (Json::Value& current, const char *attribute_key,
@@ -4,8 +4,98 @@
 #include "dplugin_json.h"
 #include <json/json.h>
 
+// standard
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
 namespace dio
 {
+    //! \brief Buffered JSON output, emitted one token at a time.
+    //!
+    //! Output is collected in a fixed size buffer and flushed to a file descriptor,
+    //! a stream or a string. The styled layout is identical to Json::StyledWriter;
+    //! the compact layout has no whitespace between tokens.
+    //! Whether a styled array is written on multiple lines is decided by the caller,
+    //! see multiline_array ().
+    class JsonOutput
+    {
+    public:
+        JsonOutput (int fd, bool compact);
+        JsonOutput (std::ostream& stream, bool compact);
+        JsonOutput (std::string& output, bool compact);
+
+        void begin_object ();
+        void end_object ();
+        void begin_array (bool multiline);
+        void end_array ();
+
+        //! \brief Write the key of the next object member.
+        void key (const char *name);
+
+        void value_string (const char *value);
+        void value_integer (int64_t value);
+        void value_float (double value);
+        void value_boolean (bool value);
+        void value_null ();
+
+        //! \brief End the document and flush the buffered output.
+        //!
+        //! \return false if writing the output failed. errno is set for file descriptors.
+        //!
+        bool finish ();
+
+        bool compact () { return m_compact; }
+
+        //! \brief Whether Json::StyledWriter puts an array on multiple lines.
+        //!
+        //! \param[in] count Number of entries in the array.
+        //! \param[in] line_size Summed size of the formatted entries. Ignored if
+        //!     count is large enough to break the array regardless.
+        //!
+        static bool
+        multiline_array (size_t count, size_t line_size);
+
+        //! Size of value formatted as a quoted JSON string.
+        static size_t
+        string_size (const char *value);
+
+        //! Format value into buffer, which holds at least 32 bytes. Return the size written.
+        static size_t
+        format_integer (char *buffer, int64_t value);
+
+        //! Format value into buffer, which holds at least 32 bytes. Return the size written.
+        static size_t
+        format_float (char *buffer, double value);
+
+    private:
+        //! Write separator and indentation ahead of a value.
+        void begin_value ();
+        void indent (size_t depth);
+        void write_string (const char *value);
+        void write (const char *data, size_t size);
+        void put (char c);
+        bool flush ();
+
+        // Containers opened, innermost last.
+        struct Frame
+        {
+            bool f_multiline;
+            size_t f_count;
+        };
+
+        int m_fd = -1;
+        std::ostream *m_stream = nullptr;
+        std::string *m_string = nullptr;
+        bool m_compact;
+        bool m_failed = false;
+        //! Set after a key - the member value follows on the same line.
+        bool m_after_key = false;
+        std::vector<Frame> m_frames;
+        size_t m_used = 0;
+        char m_buffer[8192];
+    };
+
     // A Class implementing o a
     // disir_config object in json
     class ConfigWriter : public JsonIO
@@ -35,41 +125,59 @@ namespace dio
         enum disir_status
         serialize (struct disir_config *config, std::ostream& stream);
 
+        //! \brief Serialize config to json, written to a file descriptor.
+        //!
+        //! \param[in] config Config object to be serialize.
+        //! \param[in] fd File descriptor open for writing.
+        //!
+        //! \return DISIR_STATUS_FS_ERROR if writing to fd failed.
+        //! \return DISIR_STATUS_OK on success.
+        //!
+        enum disir_status
+        serialize (struct disir_config *config, int fd);
+
+        //! Write the compact layout instead of the styled layout.
+        bool m_compact = false;
+
      private:
         // Variables
-        Json::Value m_configRoot;
         struct disir_context *m_contextConfig;
 
-        //! \brief Retrive context name
+        //! \brief Write the config document to output.
         enum disir_status
-        get_context_key (struct disir_context *context, std::string& key);
+        write_config (struct disir_config *config, JsonOutput& output);
 
-        //! \brief Serialize section name
+        //! \brief Serialize config version
         enum disir_status
-        set_section_keyname (struct disir_context *context, Json::Value& parent,
-                             Json::Value& sectionVal);
+        write_config_version (struct disir_context *context_config, JsonOutput& output);
 
-        // \brief Serialize keyval value
+        //! \brief Write all elements of parent_context as object members.
+        //!
+        //! Elements with identical names are merged into an array, at the position
+        //! of the first of them. Members are written in name order if sorted is set.
+        //!
         enum disir_status
-        set_keyval (struct disir_context *context, std::string name, Json::Value& node);
+        write_elements (struct disir_context *parent_context, JsonOutput& output, bool sorted);
 
-        // \brief Serialize keyval name and value
+        //! \brief Write the member of all elements named name, the first of which is context.
         enum disir_status
-        serialize_keyval (struct disir_context *context, Json::Value& parent);
+        write_member (struct disir_context *parent_context, struct disir_context *context,
+                      const char *name, JsonOutput& output, bool sorted);
 
-        //! \brief Serialize config version
+        //! \brief Write a section as object, or a keyval as its value.
         enum disir_status
-        set_config_version (struct disir_context *context_config, Json::Value& root);
+        write_element (struct disir_context *context, JsonOutput& output, bool sorted);
 
-        //! \brief recursive function that extracts an entire config starting from root
+        // \brief Serialize keyval value
         enum disir_status
-        _serialize_context (struct disir_context *parent_context, Json::Value& parent);
+        write_keyval (struct disir_context *context, JsonOutput& output);
 
-        //! \brief if a config has keyvals or sections with identical names
-        //! under the same root, we merge them into an array.
-        void
-        serialize_duplicate_entries (Json::Value& parent, Json::Value& child,
-                                     const std::string name);
+        //! \brief Size of the element written on a single line, as an array entry.
+        //!
+        //! \return 0 if the element cannot be written on a single line.
+        //!
+        size_t
+        element_size (struct disir_context *context);
     };
 
     // Class implementing outputting a
@@ -97,39 +205,58 @@ namespace dio
         enum disir_status
         serialize (struct disir_mold *mold, std::ostream& stream);
 
+        //! \brief Serialize disir_mold, written to a file descriptor.
+        //!
+        //! \param[in] mold The disir mold.
+        //! \param[in] fd File descriptor open for writing.
+        //!
+        //! \return DISIR_STATUS_FS_ERROR if writing to fd failed.
+        //! \return DISIR_STATUS_OK on success.
+        //!
+        enum disir_status
+        serialize (struct disir_mold *mold, int fd);
+
         //! \brief Constructor
         MoldWriter (struct disir_instance *disir);
 
         virtual ~MoldWriter () {};
+
+        //! Write the compact layout instead of the styled layout.
+        bool m_compact = false;
+
     private:
+        //! \brief Write the mold document to output.
+        enum disir_status
+        write_mold (struct disir_mold *mold, JsonOutput& output);
+
         //! \brief Serialize introduced version.
         enum disir_status
-        serialize_introduced (struct disir_context *context, Json::Value& element);
+        serialize_introduced (struct disir_context *context, JsonOutput& output);
 
         //! \brief Serialize depricated version.
         enum disir_status
-        serialize_deprecated (struct disir_context *context, Json::Value& element);
+        serialize_deprecated (struct disir_context *context, JsonOutput& output);
 
         //! \brief Serialize mold keyval
         enum disir_status
-        serialize_mold_keyval (struct disir_context *context_keyval, Json::Value& keyval);
+        serialize_mold_keyval (struct disir_context *context_keyval, JsonOutput& output);
 
         //! \brief Serialize mold restriction type
         enum disir_status
-        serialize_restrictions (struct disir_context *context, Json::Value& restriction);
+        serialize_restrictions (struct disir_context *context, JsonOutput& output);
 
         //! \brief Serialize context attributes, depending on its spesification
         enum disir_status
-        serialize_attributes (struct disir_context *context, Json::Value& current,
+        serialize_attributes (struct disir_context *context, JsonOutput& output,
                               enum disir_context_type type);
 
         //! \brief Recursively serialize context based on type
         enum disir_status
-        _serialize_mold_contexts (struct disir_context *parent_context, Json::Value& parent);
+        _serialize_mold_contexts (struct disir_context *parent_context, JsonOutput& output);
 
-        //! \brief fetch all default contexts from keyval and serialize them into an array
+        //! \brief Serialize a single default context as an array entry.
         enum disir_status
-        serialize_default (struct disir_context *context, Json::Value& defaults);
+        serialize_default (struct disir_context *context, JsonOutput& output);
 
         /* MEMBERS */
         struct disir_mold *m_mold = nullptr;
@@ -137,4 +264,3 @@ namespace dio
 }
 
 #endif // DIO_JSON_OUTPUT
-
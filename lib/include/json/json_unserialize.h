@@ -31,7 +31,38 @@ namespace dio
         enum disir_status
         unserialize (struct disir_config **config, const std::string Json);
 
+        //! \brief Read a disir_config from the JSON document in [data, data + size)
+        enum disir_status
+        unserialize (struct disir_config **config, const char *data, size_t size);
+
     private:
+        //! Builds config contexts directly from parse events, without a Json::Value DOM.
+        class StreamParser;
+
+        //! \brief Read a disir_config from the JSON document in [begin, end).
+        //!
+        //! The document is read by the StreamParser. Documents it gives up on
+        //! are parsed into a Json::Value DOM and read from there instead.
+        //!
+        enum disir_status
+        unserialize_document (struct disir_config **config, const char *begin, const char *end);
+
+        //! \brief Begin the config context, with an arena enabled.
+        enum disir_status
+        begin_config (struct disir_context **context_config);
+
+        //! \brief Finalize the config context into config.
+        enum disir_status
+        finalize_config (struct disir_context **context_config, struct disir_config **config);
+
+        //! \brief Begin a named section context on parent_context.
+        enum disir_status
+        begin_section (struct disir_context *parent_context, std::string& name,
+                       struct disir_context **context_section);
+
+        //! \brief Finalize a section context begun by begin_section.
+        enum disir_status
+        finalize_section (struct disir_context **context_section);
 
         //! \brief Sets a version on the config
         //!
@@ -72,6 +103,9 @@ namespace dio
     public:
         //! holding the mold reference
         struct disir_mold *m_mold = nullptr;
+
+        //! Read configs with the StreamParser. If false, always parse into a Json::Value DOM.
+        bool m_streaming = true;
     };
 
     //! Class that unmarshals a json mold representation into a mold object
@@ -109,6 +143,16 @@ namespace dio
             enum disir_status
             unserialize (std::string mold_json, struct disir_mold **mold);
 
+            //! \brief Construct a disir_mold from the JSON document in [data, data + size)
+            //!
+            //! \return DISIR_STATUS_OK on success.
+            //! \return DISIR_STATUS_INVALID_CONTEXT if serialized mold
+            //!     contains elements that are not according to spesification.
+            //! \return DISIR_STATUS_FS_ERROR if json object is unparasable.
+            //!
+            enum disir_status
+            unserialize (const char *data, size_t size, struct disir_mold **mold);
+
             //! \brief Set mold override
             //!
             //! param[in] stream Mold override
@@ -120,6 +164,10 @@ namespace dio
             enum disir_status
             set_mold_override (std::istream& stream);
 
+            //! \brief Set mold override from the JSON document in [data, data + size)
+            enum disir_status
+            set_mold_override (const char *data, size_t size);
+
             //! \brief Check if contents of entry is a mold override entry.
             //!
             //! param[in] entry Mold override.
@@ -6,6 +6,7 @@
 
 #include "value.h"
 #include "default.h"
+#include "version_index.h"
 
 struct disir_keyval
 {
@@ -23,6 +24,10 @@ struct disir_keyval
     //! Default entry queue
     struct disir_default        *kv_default_queue;
 
+    //! Default entries indexed by version when the mold is finalized.
+    //! NULL if not indexed, or if the default entries have changed since.
+    struct disir_version_index  *kv_default_index;
+
     //! Queue of documentation entries
     struct disir_documentation  *kv_documentation_queue;
 
@@ -37,6 +42,10 @@ struct disir_keyval
     uint32_t                    kv_disabled;
 
     struct disir_restriction    *kv_restrictions_queue;
+
+    //! Exclusive restrictions compiled when the mold is finalized.
+    //! NULL if not compiled, or if the restrictions have changed since.
+    struct disir_restriction_evaluator  *kv_restriction_evaluator;
 };
 
 //! Construct a DISIR_CONTEXT_KEYVAL as a child of parent.
@@ -38,6 +38,37 @@ enum disir_log_level {
     DISIR_LOG_LEVEL_TRACE_EXIT = 52,
 };
 
+//! Least severe log level compiled into the library. Entries of a level above it
+//! are removed by the preprocessor and compiler. Set through the CMake option of the same name.
+#ifndef DISIR_LOG_MIN_LEVEL
+#define DISIR_LOG_MIN_LEVEL DISIR_LOG_LEVEL_DEBUG_10
+#endif
+
+//! Runtime log level. Entries above it are discarded.
+extern enum disir_log_level runtime_loglevel;
+
+//! Whether TRACE entries are logged regardless of runtime_loglevel.
+extern int force_enable_trace;
+
+//! Map the debug severity onto its DISIR_LOG_LEVEL_DEBUG_XX level.
+//! A constant expression whenever level and severity are, such that the
+//! compile-time check in _log_disir_full folds away.
+#define _log_disir_normalize(level, severity) \
+    ((level) != DISIR_LOG_LEVEL_DEBUG || (severity) <= 0 ? (int) (level) \
+        : (severity) >= 10 ? (int) DISIR_LOG_LEVEL_DEBUG_10 : (severity) * 10)
+
+//! Whether an entry of the normalized level dll shall be written to the log.
+static inline int
+dx_log_level_enabled (int dll)
+{
+    // Let TRACE messages through if force_enable_trace is set
+    if (dll == DISIR_LOG_LEVEL_TRACE_ENTER || dll == DISIR_LOG_LEVEL_TRACE_EXIT)
+    {
+        return (dll <= (int) runtime_loglevel || force_enable_trace);
+    }
+
+    return (dll <= (int) runtime_loglevel);
+}
 
 //! Generic function signature for all logging methods
 void dx_log_disir (enum disir_log_level dll,
@@ -63,17 +94,27 @@ void dx_log_disir_va (enum disir_log_level dll,
                 const char *fmt_message, ...);
 
 
+//! Entries that are not stored as the error of a context or instance
+//! are only formatted if their level is both compiled in and enabled.
+//! The arguments of other entries are not evaluated; they shall have no side effects.
 #define _log_disir_full(level, severity, context, instance, log_context, prefix, ...) \
-    dx_log_disir_va (level, \
-                 severity, \
-                 context, \
-                 instance, \
-                 log_context, \
-                 __FILE__, \
-                 __func__, \
-                 __LINE__, \
-                 prefix, \
-                 ##__VA_ARGS__)
+    do { \
+        if ((log_context) || (instance) != NULL || \
+            (_log_disir_normalize (level, severity) <= (int) DISIR_LOG_MIN_LEVEL && \
+             dx_log_level_enabled (_log_disir_normalize (level, severity)))) \
+        { \
+            dx_log_disir_va (level, \
+                         severity, \
+                         context, \
+                         instance, \
+                         log_context, \
+                         __FILE__, \
+                         __func__, \
+                         __LINE__, \
+                         prefix, \
+                         ##__VA_ARGS__); \
+        } \
+    } while (0)
 
 // Hide away some details for log_disir
 #define _log_disir_level(level, ...) \
@@ -112,6 +153,12 @@ void dx_log_disir_va (enum disir_log_level dll,
     _log_disir_full(DISIR_LOG_LEVEL_ERROR, 0, context, NULL, 1, NULL, ##__VA_ARGS__)
 
 
+//! Install the sink log entries are written to. See disir_log_set_sink().
+void dx_log_set_sink (disir_log_sink sink, void *data);
+
+//! Write every queued log entry to the sink before returning.
+void dx_log_flush (void);
+
 //! Crash and burn.. Output message on stderr before it aborts.
 //! USE WITH EXTREME CARE
 void dx_crash_and_burn(const char* message, ...);
@@ -12,6 +12,7 @@ struct disir_mold
     struct disir_context                            *mo_context;
 
     //! Count of how many ADT structure pointers the user posesses.
+    //! Modified atomically, since a mold may be shared by configs built in different threads.
     int                             mo_reference_count;
 
     //! Version of this mold.
@@ -34,6 +35,23 @@ struct disir_mold *dx_mold_create (struct disir_context *context);
 //! Destroy the passed struct disir_mold
 enum disir_status dx_mold_destroy (struct disir_mold **mold);
 
+//! INTERNAL API
+//! \brief Finalize a mold context whose contents are known to be valid.
+//!
+//! Like dc_mold_finalize(), without validating the tree of contexts.
+//! Only for molds constructed from a source that was validated when it was produced,
+//! such as a compiled mold image.
+//!
+//! \return DISIR_STATUS_WRONG_CONTEXT if context is not a MOLD.
+//! \return DISIR_STATUS_OK on success. context is sat to NULL, and mold is populated.
+//!
+enum disir_status
+dx_mold_finalize_trusted (struct disir_context **context, struct disir_mold **mold);
+
+//! INTERNAL API
+//! Acquire a reference to mold. Released with disir_mold_finished().
+void dx_mold_incref (struct disir_mold *mold);
+
 //! \brief Conditionally update the version number of the mold if input version is greater.
 //!
 //! \param mold Input mold to update the version number of
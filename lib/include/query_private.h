@@ -89,5 +89,50 @@ dx_query_ensure_ancestors (struct disir_context *config,
                            char *element_child_name, int *element_child_index);
 
 
+//! One name@index component of a compiled query.
+struct disir_query_segment
+{
+    //! Name of the element, pointing into dq_names.
+    const char          *qs_name;
+
+    //! Index among the elements with this name.
+    int32_t             qs_index;
+};
+
+struct disir_query
+{
+    //! The formatted query string, as passed to disir_query_compile().
+    char                        *dq_string;
+
+    //! Copy of dq_string, split into NULL terminated names.
+    char                        *dq_names;
+
+    //! Parsed components of the query, from the root and out.
+    struct disir_query_segment  *dq_segments;
+    int32_t                     dq_numsegments;
+
+    //! Context the query was last resolved from.
+    struct disir_context        *dq_parent;
+
+    //! Context the query last resolved to. Not referenced - only valid as long as
+    //! dq_generation equals dx_context_elements_generation() of dq_parent; any addition
+    //! or removal of elements in its tree invalidates it. Generations are never reused,
+    //! so a new tree allocated at the address of dq_parent does not match either.
+    struct disir_context        *dq_context;
+    uint64_t                    dq_generation;
+};
+
+//! \brief Resolve a compiled query relative to parent.
+//!
+//! The same semantics as dc_query_resolve_context() apply. The output context is incref'ed.
+//!
+//! \return DISIR_STATUS_NOT_EXIST if any element in the query does not exist.
+//! \return DISIR_STATUS_WRONG_CONTEXT if an intermediate element is not a section.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_query_compiled_resolve (struct disir_context *parent, struct disir_query *query,
+                           struct disir_context **out);
+
 #endif // _LIBDISIR_PRIVATE_QUERY_H
 
@@ -75,6 +75,45 @@ enum disir_status dx_restriction_exclusive_value_check (struct disir_context *co
                                                         double float_value,
                                                         const char *string_value);
 
+//! Forward declare the compiled exclusive restrictions of a mold keyval.
+struct disir_restriction_evaluator;
+
+//! \brief Compile the exclusive restrictions of a mold keyval.
+//!
+//! The active restrictions are resolved for each span of versions between where
+//! a restriction is introduced or deprecated. Each span holds a sorted table of
+//! value ranges and enum values, such that a value is checked with a binary search.
+//!
+//! \return DISIR_STATUS_NO_MEMORY if allocation failed.
+//! \return DISIR_STATUS_OK on success.
+//!
+enum disir_status
+dx_restriction_evaluator_compile (struct disir_context *keyval,
+                                  struct disir_restriction_evaluator **evaluator);
+
+//! \brief Free a compiled evaluator. The pointer is set to NULL.
+void dx_restriction_evaluator_destroy (struct disir_restriction_evaluator **evaluator);
+
+//! \brief Release the compiled evaluator of the keyval the restriction belongs to.
+//!
+//! Invoked whenever a restriction is added, removed or modified. The keyval is
+//! checked by its restriction queue until its mold is finalized again.
+//!
+void dx_restriction_evaluator_invalidate (struct disir_context *restriction);
+
+//! \brief Check value against the compiled exclusive restrictions active for version.
+//!
+//! string_value is checked against enum restrictions if not NULL,
+//! otherwise value is checked against range and numeric restrictions.
+//!
+//! \return 1 if value fulfills an active restriction.
+//! \return 0 if there are no active exclusive restrictions.
+//! \return -1 if value fulfills none of the active restrictions.
+//!
+int dx_restriction_evaluator_check (struct disir_restriction_evaluator *evaluator,
+                                    struct disir_version *version,
+                                    double value, const char *string_value);
+
 //! \brief Retrieve the minimum or maximum entries allowed for input context.
 //!
 //! The default minimum entry is 0.
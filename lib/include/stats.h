@@ -0,0 +1,61 @@
+#ifndef _LIBDISIR_PRIVATE_STATS_H
+#define _LIBDISIR_PRIVATE_STATS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include <disir/disir.h>
+
+//! Counters of a single operation, updated concurrently by every thread using an instance.
+struct dx_stats_counter
+{
+    _Atomic uint64_t    sc_calls;
+    _Atomic uint64_t    sc_failures;
+    _Atomic uint64_t    sc_total_ns;
+    _Atomic uint64_t    sc_max_ns;
+    _Atomic uint64_t    sc_contexts;
+    _Atomic uint64_t    sc_contexts_max;
+    _Atomic uint64_t    sc_histogram[DISIR_STATS_HISTOGRAM_BUCKETS];
+};
+
+//! Stats of an instance, or of the process. See disir_stats_enable().
+struct dx_stats
+{
+    //! Whether operations are counted.
+    _Atomic int             st_enabled;
+    struct dx_stats_counter st_counters[DISIR_STATS_OPERATION_COUNT];
+};
+
+//! A single timed operation, between dx_stats_begin() and dx_stats_end().
+struct dx_stats_timer
+{
+    //! Stats the operation counts towards. NULL if it is not counted.
+    struct dx_stats     *st_stats;
+    //! Stats of the enclosing operation on this thread, restored by dx_stats_end().
+    struct dx_stats     *st_previous;
+    uint64_t            st_start_ns;
+    uint64_t            st_contexts;
+};
+
+//! Number of contexts allocated by the calling thread.
+extern _Thread_local uint64_t dx_stats_contexts_allocated;
+
+//! \brief Start timing an operation performed on behalf of instance.
+//!
+//! If instance is NULL, the operation counts towards the enclosing operation
+//! of an instance on this thread, or else towards the process wide stats.
+//! Only a flag is checked unless the stats it counts towards are enabled.
+//!
+void
+dx_stats_begin (struct disir_instance *instance, struct dx_stats_timer *timer);
+
+//! \brief Count the operation started by dx_stats_begin(), which returned status.
+void
+dx_stats_end (struct dx_stats_timer *timer, enum disir_stats_operation operation,
+              enum disir_status status);
+
+//! \brief Free the stats held by instance. Called when the instance is destroyed.
+void
+dx_stats_destroy (struct disir_instance *instance);
+
+#endif // _LIBDISIR_PRIVATE_STATS_H
@@ -1,6 +1,8 @@
 #ifndef _LIBDISIR_PRIVATE_VALUE_H
 #define _LIBDISIR_PRIVATE_VALUE_H
 
+struct disir_arena;
+
 struct disir_value
 {
     enum disir_value_type dv_type;
@@ -15,8 +17,17 @@ struct disir_value
     };
 
     int64_t         dv_size;
+
+    //! Non-zero if dv_string is allocated from an arena (DX_VALUE_ARENA), or points
+    //! into a mapping owned by one (DX_VALUE_MAPPED), and must not be free'd.
+    uint32_t        dv_arena;
 };
 
+//! dv_arena of a string allocated from the arena of its context.
+#define DX_VALUE_ARENA 1
+//! dv_arena of a string pointing into a mapping, shared with the strings next to it.
+#define DX_VALUE_MAPPED 2
+
 //! \brief Return a string represetation of the passed value type enum
 //!
 //! \param[in] type Enumeration that describes some value type
@@ -97,6 +108,22 @@ enum disir_status dx_value_copy (struct disir_value *destination, struct disir_v
 enum disir_status
 dx_value_set_string (struct disir_value *value, const char *input, int32_t size);
 
+//! \brief Set the input 'value' with the contents of 'input', allocated from 'arena'
+//!
+//! \see dx_value_set_string()
+//! If arena is NULL, this is equivalent to dx_value_set_string().
+//!
+enum disir_status
+dx_value_set_string_arena (struct disir_arena *arena, struct disir_value *value,
+                           const char *input, int32_t size);
+
+//! \brief Release the string held by value, if any, and reset it to zero length.
+//!
+//! Strings allocated from an arena are left for the arena to release.
+//!
+void
+dx_value_free_string (struct disir_value *value);
+
 //! \brief Reterieve the string type stored in value
 //!
 //! \param[in] value Value object to retrieve the string value from.
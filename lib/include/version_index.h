@@ -0,0 +1,39 @@
+#ifndef _LIBDISIR_PRIVATE_VERSION_INDEX_H
+#define _LIBDISIR_PRIVATE_VERSION_INDEX_H
+
+#include <disir/disir.h>
+
+//! Forward declare the version index structure.
+//! Entries of a version-sorted queue, stored contiguously to be searched by version.
+struct disir_version_index;
+
+//! \brief Allocate a version index with room for count entries.
+//!
+//! \return NULL if allocation failed, or count is less than one.
+//!
+struct disir_version_index *
+dx_version_index_create (int32_t count);
+
+//! \brief Free a version index. The pointer is set to NULL.
+void
+dx_version_index_destroy (struct disir_version_index **index);
+
+//! \brief Store entry, introduced at version, at position i of the index.
+//!
+//! Entries must be stored in ascending order of introduced version.
+//!
+void
+dx_version_index_set (struct disir_version_index *index, int32_t i,
+                      struct disir_version *introduced, void *entry);
+
+//! \brief Look up the entry active for version.
+//!
+//! The active entry is the one with the greatest introduced version not greater than version.
+//! If every entry is introduced after version, the first entry is returned.
+//! NULL version returns the last entry.
+//!
+void *
+dx_version_index_lookup (struct disir_version_index *index, struct disir_version *version);
+
+#endif // _LIBDISIR_PRIVATE_VERSION_INDEX_H
+
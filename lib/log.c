@@ -1,8 +1,12 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include <disir/disir.h>
 
@@ -20,6 +24,62 @@ enum disir_log_level runtime_loglevel = DISIR_LOG_LEVEL_DEBUG_01;
 //! Hardcode default for now.
 int force_enable_trace = 0;
 
+//! Log file written to unless a sink is installed with disir_log_set_sink().
+#define LOG_DEFAULT_FILEPATH "/var/log/disir.log"
+
+//! Number of entries the log ring holds. Must be a power of two.
+#define LOG_RING_SLOTS 1024
+
+//! Size of the text of a single entry. Longer messages are truncated.
+#define LOG_ENTRY_TEXT_SIZE 1000
+
+//! Longest the flusher sleeps before it looks for entries on its own.
+#define LOG_FLUSH_INTERVAL_MS 1000
+
+//! One formatted log entry, lacking its timestamp.
+struct log_entry
+{
+    //! Position in the ring this slot is next written at, plus one once written.
+    atomic_size_t   le_sequence;
+    time_t          le_time;
+    int             le_size;
+    char            le_text[LOG_ENTRY_TEXT_SIZE];
+};
+
+enum log_state
+{
+    //! No entry logged yet - the ring is set up on first use.
+    LOG_STATE_IDLE = 0,
+    //! Entries are written by the flusher thread.
+    LOG_STATE_RUNNING,
+    //! Entries are written by the thread logging them.
+    //! Used when no flusher could be started, and after process exit has begun.
+    LOG_STATE_SYNCHRONOUS,
+};
+
+//! Entries are formatted into the ring by the logging thread without taking
+//! any lock, and written to the sink by the flusher thread in batches.
+static struct log_entry *log_ring;
+static atomic_size_t log_enqueue_position;
+static atomic_size_t log_dequeue_position;
+static atomic_size_t log_dropped;
+static atomic_int log_state;
+
+//! Held by whoever writes entries out of the ring. Guards the sink and log file.
+static pthread_mutex_t log_consumer_lock = PTHREAD_MUTEX_INITIALIZER;
+static disir_log_sink log_sink;
+static void *log_sink_data;
+static FILE *log_file;
+static time_t log_file_attempt;
+
+static pthread_t log_flusher_thread;
+static sem_t log_wakeup;
+static atomic_int log_flusher_sleeping;
+static atomic_int log_stopping;
+
+//! Set while the thread writes entries to the sink.
+static _Thread_local int log_draining;
+
 //! STATIC USAGE
 static const char *
 map_dll_to_string (enum disir_log_level dll)
@@ -55,6 +115,10 @@ void
 dx_crash_and_burn (const char* message, ...)
 {
     va_list args;
+
+    // Do not lose whatever was logged up to this point.
+    dx_log_flush ();
+
     va_start (args, message);
     vfprintf (stderr, message, args);
     fprintf (stderr, "\n");
@@ -63,86 +127,350 @@ dx_crash_and_burn (const char* message, ...)
     abort ();
 }
 
-//! implements the actual stream logging
-//! prefix is injected between the fmt message and the timestamp/loglevel
-//! Ignored if null
+//! STATIC API
+//! Format the timestamp of an entry written at time now.
+//! Consecutive entries mostly share their second, so the last one formatted is kept.
+static const char *
+log_timestamp (time_t now, size_t *size)
+{
+    static time_t stamp_time = (time_t) -1;
+    static char stamp[32];
+    static size_t stamp_size;
+    struct tm utctime;
+
+    if (now != stamp_time)
+    {
+        gmtime_r (&now, &utctime);
+        stamp_size = strftime (stamp, sizeof (stamp), "[%Y-%m-%d %H:%M:%S]", &utctime);
+        if (stamp_size == 0)
+        {
+            dx_crash_and_burn ("strftime returned: %zu - not within buffer size: %zu",
+                               stamp_size, sizeof (stamp));
+        }
+        stamp_time = now;
+    }
+
+    *size = stamp_size;
+    return stamp;
+}
+
+//! STATIC API
+//! Hand one complete log line to the sink. Requires log_consumer_lock.
 static void
-dx_log_format (enum disir_log_level dll, int severity, const char *prefix,
-               const char *suffix, const char* fmt_message, va_list args)
+log_write_line (const char *line, size_t size)
 {
-    char buffer[512];
-    size_t time_written;
-    int res;
-    size_t buffer_size;
-    FILE *stream;
-    time_t now;
-    struct tm *utctime;
-    char dll_prefix[10];
+    struct timespec now;
 
-    buffer_size = 512;
+    if (log_sink != NULL)
+    {
+        log_sink (log_sink_data, line, size);
+        return;
+    }
 
-    // Normalize debug level
-    if (dll == DISIR_LOG_LEVEL_DEBUG)
+    // Retry opening the default log file at most once a second.
+    if (log_file == NULL)
     {
-        switch (severity)
-        {
-        case 0:
-            dll = DISIR_LOG_LEVEL_DEBUG;
-            break;
-        case 1:
-            dll = DISIR_LOG_LEVEL_DEBUG_01;
-            break;
-        case 2:
-            dll = DISIR_LOG_LEVEL_DEBUG_02;
-            break;
-        case 3:
-            dll = DISIR_LOG_LEVEL_DEBUG_03;
-            break;
-        case 4:
-            dll = DISIR_LOG_LEVEL_DEBUG_04;
-            break;
-        case 5:
-            dll = DISIR_LOG_LEVEL_DEBUG_05;
-            break;
-        case 6:
-            dll = DISIR_LOG_LEVEL_DEBUG_06;
-            break;
-        case 7:
-            dll = DISIR_LOG_LEVEL_DEBUG_07;
-            break;
-        case 8:
-            dll = DISIR_LOG_LEVEL_DEBUG_08;
-            break;
-        case 9:
-            dll = DISIR_LOG_LEVEL_DEBUG_09;
-            break;
-        case 10:
-            dll = DISIR_LOG_LEVEL_DEBUG_10;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        if (log_file_attempt != 0 && now.tv_sec == log_file_attempt)
+            return;
+        log_file_attempt = now.tv_sec;
+
+        log_file = fopen (LOG_DEFAULT_FILEPATH, "a");
+        if (log_file == NULL)
+            return;
+    }
+
+    fwrite (line, sizeof (char), size, log_file);
+    fputc ('\n', log_file);
+}
+
+//! STATIC API
+//! Write every published entry of the ring to the sink, in order.
+//! Requires log_consumer_lock.
+//!
+//! \return Number of entries written.
+//!
+static size_t
+log_drain (void)
+{
+    struct log_entry *entry;
+    char line[64 + LOG_ENTRY_TEXT_SIZE];
+    const char *stamp;
+    size_t stamp_size;
+    size_t written;
+    size_t dropped;
+    size_t sequence;
+    size_t position;
+    int size;
+
+    if (log_ring == NULL)
+        return 0;
+
+    log_draining = 1;
+    written = 0;
+    position = atomic_load_explicit (&log_dequeue_position, memory_order_relaxed);
+    for (;;)
+    {
+        entry = &log_ring[position & (LOG_RING_SLOTS - 1)];
+        sequence = atomic_load_explicit (&entry->le_sequence, memory_order_acquire);
+        if (sequence != position + 1)
             break;
+
+        stamp = log_timestamp (entry->le_time, &stamp_size);
+        memcpy (line, stamp, stamp_size);
+        memcpy (line + stamp_size, entry->le_text, entry->le_size);
+        log_write_line (line, stamp_size + entry->le_size);
+
+        // Hand the slot back to the producers, one lap ahead.
+        atomic_store_explicit (&entry->le_sequence, position + LOG_RING_SLOTS,
+                               memory_order_release);
+        position++;
+        atomic_store_explicit (&log_dequeue_position, position, memory_order_relaxed);
+        written++;
+    }
+
+    dropped = atomic_exchange_explicit (&log_dropped, 0, memory_order_relaxed);
+    if (dropped != 0)
+    {
+        stamp = log_timestamp (time (NULL), &stamp_size);
+        memcpy (line, stamp, stamp_size);
+        size = snprintf (line + stamp_size, sizeof (line) - stamp_size,
+                         "-[%s] %zu log entries dropped",
+                         map_dll_to_string (DISIR_LOG_LEVEL_WARNING), dropped);
+        if (size > 0)
+            log_write_line (line, stamp_size + size);
+        written++;
+    }
+
+    if (written != 0 && log_sink == NULL && log_file != NULL)
+    {
+        fflush (log_file);
+    }
+
+    log_draining = 0;
+    return written;
+}
+
+//! STATIC API
+//! Background thread writing the log ring to the sink.
+static void *
+log_flusher (void *data)
+{
+    struct timespec deadline;
+
+    (void) data;
+
+    while (atomic_load (&log_stopping) == 0)
+    {
+        pthread_mutex_lock (&log_consumer_lock);
+        log_drain ();
+        pthread_mutex_unlock (&log_consumer_lock);
+
+        // Producers only wake us once we announce that we sleep. Check the ring
+        // again after the announcement, such that no entry is left waiting.
+        atomic_store (&log_flusher_sleeping, 1);
+        if (atomic_load (&log_enqueue_position) == atomic_load (&log_dequeue_position))
+        {
+            clock_gettime (CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            sem_timedwait (&log_wakeup, &deadline);
         }
+        atomic_store (&log_flusher_sleeping, 0);
     }
 
-    // Dont log anything if loglevel doesnt match
-    // Let TRACE messages through if force_enable_trace is set
-    if (dll != DISIR_LOG_LEVEL_TRACE_ENTER && dll != DISIR_LOG_LEVEL_TRACE_EXIT)
+    return NULL;
+}
+
+//! STATIC API
+//! Stop the flusher at process exit, writing every queued entry.
+//! Entries logged after this point are written synchronously.
+static void
+log_stop (void)
+{
+    int running;
+
+    pthread_mutex_lock (&log_consumer_lock);
+    running = (atomic_load (&log_state) == LOG_STATE_RUNNING);
+    atomic_store (&log_state, LOG_STATE_SYNCHRONOUS);
+    pthread_mutex_unlock (&log_consumer_lock);
+
+    if (running)
     {
-        if (dll > runtime_loglevel)
-            return;
+        atomic_store (&log_stopping, 1);
+        sem_post (&log_wakeup);
+        pthread_join (log_flusher_thread, NULL);
+    }
+
+    pthread_mutex_lock (&log_consumer_lock);
+    log_drain ();
+    pthread_mutex_unlock (&log_consumer_lock);
+}
+
+//! STATIC API
+static void
+log_fork_prepare (void)
+{
+    pthread_mutex_lock (&log_consumer_lock);
+}
+
+//! STATIC API
+static void
+log_fork_parent (void)
+{
+    pthread_mutex_unlock (&log_consumer_lock);
+}
+
+//! STATIC API
+//! The flusher thread does not survive into the child - start another on demand.
+//! Neither do threads of the parent that were queuing an entry, such that slots
+//! they claimed are never published. The child is single threaded: reset the ring,
+//! dropping every entry still queued - those are written by the parent.
+static void
+log_fork_child (void)
+{
+    size_t enqueue;
+    size_t dequeue;
+    size_t i;
+
+    if (log_ring != NULL)
+    {
+        enqueue = atomic_load (&log_enqueue_position);
+        dequeue = atomic_load (&log_dequeue_position);
+        if (enqueue != dequeue)
+        {
+            atomic_fetch_add (&log_dropped, enqueue - dequeue);
+        }
+
+        for (i = 0; i < LOG_RING_SLOTS; i++)
+        {
+            atomic_store (&log_ring[i].le_sequence, i);
+        }
+        atomic_store (&log_enqueue_position, 0);
+        atomic_store (&log_dequeue_position, 0);
+
+        sem_init (&log_wakeup, 0, 0);
     }
-    else if (dll > runtime_loglevel && !force_enable_trace)
+    atomic_store (&log_flusher_sleeping, 0);
+
+    pthread_mutex_unlock (&log_consumer_lock);
+    if (atomic_load (&log_state) == LOG_STATE_RUNNING)
+    {
+        atomic_store (&log_state, LOG_STATE_IDLE);
+    }
+}
+
+//! STATIC API
+//! Allocate the ring and start the flusher thread, on first use.
+static void
+log_start (void)
+{
+    static int registered = 0;
+    size_t i;
+
+    pthread_mutex_lock (&log_consumer_lock);
+    if (atomic_load (&log_state) != LOG_STATE_IDLE)
     {
+        pthread_mutex_unlock (&log_consumer_lock);
         return;
     }
 
-    // Get UTC time
-    time (&now);
-    utctime = gmtime (&now);
+    if (log_ring == NULL)
+    {
+        log_ring = calloc (LOG_RING_SLOTS, sizeof (struct log_entry));
+        if (log_ring == NULL)
+        {
+            pthread_mutex_unlock (&log_consumer_lock);
+            return;
+        }
+        for (i = 0; i < LOG_RING_SLOTS; i++)
+        {
+            atomic_init (&log_ring[i].le_sequence, i);
+        }
+    }
+
+    if (registered == 0)
+    {
+        sem_init (&log_wakeup, 0, 0);
+        pthread_atfork (log_fork_prepare, log_fork_parent, log_fork_child);
+        atexit (log_stop);
+        registered = 1;
+    }
 
-    time_written = strftime (buffer, buffer_size, "[%Y-%m-%d %H:%M:%S]", utctime);
-    if (time_written >= buffer_size || time_written == 0)
+    atomic_store (&log_stopping, 0);
+    if (pthread_create (&log_flusher_thread, NULL, log_flusher, NULL) == 0)
+    {
+        atomic_store (&log_state, LOG_STATE_RUNNING);
+    }
+    else
     {
-        dx_crash_and_burn ("strftime returned: %d - not within buffer size: %d",
-            time_written, buffer_size);
+        atomic_store (&log_state, LOG_STATE_SYNCHRONOUS);
+    }
+    pthread_mutex_unlock (&log_consumer_lock);
+}
+
+//! STATIC API
+//! Queue a log entry of the normalized level dll onto the ring.
+//! prefix is injected between the level and the message. Ignored if NULL.
+static void
+log_enqueue (enum disir_log_level dll, int severity, const char *prefix,
+             const char *suffix, const char* fmt_message, va_list args)
+{
+    struct log_entry *entry;
+    size_t position;
+    size_t sequence;
+    intptr_t difference;
+    int state;
+    int size;
+    int res;
+    char dll_prefix[10];
+
+    state = atomic_load_explicit (&log_state, memory_order_acquire);
+    if (state == LOG_STATE_IDLE)
+    {
+        log_start ();
+        state = atomic_load (&log_state);
+    }
+    if (log_ring == NULL)
+        return;
+
+    // Claim a slot - bounded multi-producer ring, each slot carrying the
+    // position it is next free to be written at.
+    position = atomic_load_explicit (&log_enqueue_position, memory_order_relaxed);
+    for (;;)
+    {
+        entry = &log_ring[position & (LOG_RING_SLOTS - 1)];
+        sequence = atomic_load_explicit (&entry->le_sequence, memory_order_acquire);
+        difference = (intptr_t) (sequence - position);
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit (&log_enqueue_position, &position, position + 1,
+                                                       memory_order_relaxed,
+                                                       memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The ring is full. Rather than losing the entry, help writing it out.
+            // An entry logged by the sink itself cannot wait for the sink.
+            if (log_draining)
+            {
+                atomic_fetch_add_explicit (&log_dropped, 1, memory_order_relaxed);
+                return;
+            }
+            dx_log_flush ();
+            position = atomic_load_explicit (&log_enqueue_position, memory_order_relaxed);
+        }
+        else
+        {
+            position = atomic_load_explicit (&log_enqueue_position, memory_order_relaxed);
+        }
     }
 
     // Prepare the log level prefix string
@@ -165,44 +493,78 @@ dx_log_format (enum disir_log_level dll, int severity, const char *prefix,
         snprintf (dll_prefix, 6, "%s", map_dll_to_string (dll));
     }
 
-    res = snprintf (buffer + time_written, buffer_size - time_written,
-            "-[%s] %s%s",
-            dll_prefix,
-            (prefix != NULL ? prefix : ""),
-            (prefix != NULL ? " " : "")
-            );
-    if (res >= (int)(buffer_size - time_written) || res < 0)
+    entry->le_time = time (NULL);
+    size = snprintf (entry->le_text, LOG_ENTRY_TEXT_SIZE, "-[%s] %s%s",
+                     dll_prefix,
+                     (prefix != NULL ? prefix : ""),
+                     (prefix != NULL ? " " : ""));
+    if (size < 0 || size >= LOG_ENTRY_TEXT_SIZE)
     {
-        // Buffer not large enough, or encoding error..
-        dx_crash_and_burn ("snprintf() returned res: %d - size: %d",
-            res, buffer_size - time_written);
+        size = 0;
     }
 
-    // Prepare outgoing stream
-    stream = fopen ("/var/log/disir.log", "a");
+    res = vsnprintf (entry->le_text + size, LOG_ENTRY_TEXT_SIZE - size, fmt_message, args);
+    if (res > 0)
+    {
+        // Truncate overlong messages to the entry
+        size += (res < LOG_ENTRY_TEXT_SIZE - size ? res : LOG_ENTRY_TEXT_SIZE - size - 1);
+    }
 
-    // Cant open file output stream! Bleh!
-    if (stream == NULL)
+    if (suffix != NULL)
     {
-      // Throw a tantrum?
-      return;
+        res = snprintf (entry->le_text + size, LOG_ENTRY_TEXT_SIZE - size, "%s", suffix);
+        if (res > 0)
+            size += (res < LOG_ENTRY_TEXT_SIZE - size ? res : LOG_ENTRY_TEXT_SIZE - size - 1);
     }
+    entry->le_size = size;
 
-    // Output buffer with time, loglevel and context
-    fwrite (buffer, time_written + res, sizeof (char), stream);
+    // Publish the entry to the consumer
+    atomic_store_explicit (&entry->le_sequence, position + 1, memory_order_release);
 
-    // Write incomming log message
-    vfprintf (stream, fmt_message, args);
+    if (state == LOG_STATE_RUNNING)
+    {
+        // Only the first entry logged while the flusher sleeps wakes it up.
+        if (atomic_load_explicit (&log_flusher_sleeping, memory_order_relaxed) &&
+            atomic_exchange (&log_flusher_sleeping, 0))
+        {
+            sem_post (&log_wakeup);
+        }
+    }
+    else if (!log_draining)
+    {
+        // Without a flusher, whoever logs writes the entry out.
+        dx_log_flush ();
+    }
+}
 
-    // Write suffix
-    if (suffix != NULL)
-        fwrite (suffix, strlen (suffix), sizeof (char), stream); // XXX
+//! INTERNAL API
+void
+dx_log_set_sink (disir_log_sink sink, void *data)
+{
+    pthread_mutex_lock (&log_consumer_lock);
 
-    // Append newline to log message
-    fprintf (stream, "\n");
+    // Entries already queued go where they were logged to.
+    log_drain ();
 
-    // close output stream. We dont want to keep it open forever, atleast not yet.
-    fclose (stream);
+    if (sink != NULL && log_file != NULL)
+    {
+        fclose (log_file);
+        log_file = NULL;
+        log_file_attempt = 0;
+    }
+    log_sink = sink;
+    log_sink_data = data;
+
+    pthread_mutex_unlock (&log_consumer_lock);
+}
+
+//! INTERNAL API
+void
+dx_log_flush (void)
+{
+    pthread_mutex_lock (&log_consumer_lock);
+    log_drain ();
+    pthread_mutex_unlock (&log_consumer_lock);
 }
 
 //! INTERNAL API
@@ -273,6 +635,10 @@ dx_context_error_set_va (struct disir_context *context, const char* fmt_message,
     if (context == NULL)
         return;
 
+    // Frozen contexts are shared between threads - they never store an error message.
+    if (context->CONTEXT_STATE_FROZEN)
+        return;
+
     dx_internal_log_to_storage (&context->cx_error_message,
                                 &context->cx_error_message_size, fmt_message, args);
 }
@@ -320,11 +686,19 @@ dx_log_disir (enum disir_log_level dll,
 
     char enter_string[] = "ENTER";
     char exit_string[] = "EXIT";
+    enum disir_log_level level;
+    int enabled;
 
     (void) &file;
     prefix = NULL;
     suffix = NULL;
 
+    // Decide on the level before doing any formatting work.
+    level = _log_disir_normalize (dll, severity);
+    enabled = dx_log_level_enabled (level);
+    if (!enabled && !log_context && instance == NULL)
+        return;
+
     if (log_context)
     {
         va_copy (args_copy, args);
@@ -341,6 +715,9 @@ dx_log_disir (enum disir_log_level dll,
         va_end (args_copy);
     }
 
+    if (!enabled)
+        return;
+
     if (context)
     {
         //! Prepare the log prefix message.
@@ -379,7 +756,7 @@ dx_log_disir (enum disir_log_level dll,
         }
     }
 
-    dx_log_format (dll,
+    log_enqueue (level,
             severity,
             (prefix != NULL ? prefix : message_prefix),
             (suffix != NULL ? suffix : ""),
@@ -0,0 +1,954 @@
+// external public includes
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/context.h>
+
+// private
+#include "context_private.h"
+#include "arena.h"
+#include "default.h"
+#include "documentation.h"
+#include "element_storage.h"
+#include "keyval.h"
+#include "log.h"
+#include "mold.h"
+#include "mqueue.h"
+#include "restriction.h"
+#include "section.h"
+
+//
+// A compiled mold image is a single, relocatable file laid out as:
+//
+//  struct mold_image_header
+//  struct mold_image_node[mi_numnodes]     - every context of the mold, in pre-order.
+//  char strings[mi_strings_size]           - null-terminated strings referenced by the nodes.
+//
+// Each node is followed by its mn_children direct children. A keyval lists its
+// documentation, defaults (in ascending version order) and restrictions, in that order.
+// The first node is the mold itself.
+//
+// Images are written in host byte order, and are only loaded by a host of the same.
+// They are produced from a validated mold, so the loader only checks that the image
+// is structurally sound - the tree of contexts is not validated again.
+//
+
+//! Identifies a compiled mold image.
+#define MOLD_IMAGE_MAGIC "DISIRMLD"
+
+//! Bumped whenever the layout of the image changes. Other formats are rejected.
+#define MOLD_IMAGE_FORMAT 1
+
+//! Read back as a different value on a host of different byte order.
+#define MOLD_IMAGE_BYTE_ORDER 0x01020304
+
+//! Sections may nest no deeper than this in a loaded image.
+#define MOLD_IMAGE_MAX_DEPTH 256
+
+//! The node references a string in the string table.
+#define MOLD_IMAGE_NODE_STRING 0x1
+
+struct mold_image_header
+{
+    char        mi_magic[8];
+    uint32_t    mi_format;
+    uint32_t    mi_byte_order;
+    uint64_t    mi_size;
+    uint32_t    mi_nodes_offset;
+    uint32_t    mi_numnodes;
+    uint32_t    mi_strings_offset;
+    uint32_t    mi_strings_size;
+    uint32_t    mi_version_major;
+    uint32_t    mi_version_minor;
+};
+
+struct mold_image_node
+{
+    uint8_t     mn_context_type;
+    uint8_t     mn_value_type;
+    uint8_t     mn_restriction_type;
+    uint8_t     mn_flags;
+    //! Number of direct children following this node.
+    uint32_t    mn_children;
+    //! Name of keyval and section, value of default, documentation and restriction.
+    uint32_t    mn_string_offset;
+    uint32_t    mn_string_size;
+    uint32_t    mn_introduced_major;
+    uint32_t    mn_introduced_minor;
+    uint32_t    mn_deprecated_major;
+    uint32_t    mn_deprecated_minor;
+    //! Integer and boolean value of default.
+    int64_t     mn_integer;
+    //! Float value of default, numeric value of restriction.
+    double      mn_float;
+    double      mn_min;
+    double      mn_max;
+};
+
+struct mold_image_writer
+{
+    struct mold_image_node      *mw_nodes;
+    uint32_t                    mw_numnodes;
+    uint32_t                    mw_nodes_capacity;
+    char                        *mw_strings;
+    size_t                      mw_strings_size;
+    size_t                      mw_strings_capacity;
+};
+
+struct mold_image_loader
+{
+    const struct mold_image_node *ml_nodes;
+    uint32_t                    ml_numnodes;
+    uint32_t                    ml_index;
+    char                        *ml_strings;
+    uint32_t                    ml_strings_size;
+};
+
+//! STATIC API
+//! Append a zeroed node of type to the image, and return its index in index.
+static enum disir_status
+image_add_node (struct mold_image_writer *writer, enum disir_context_type type, uint32_t *index)
+{
+    struct mold_image_node *nodes;
+    uint32_t capacity;
+
+    if (writer->mw_numnodes == writer->mw_nodes_capacity)
+    {
+        if (writer->mw_nodes_capacity >= UINT32_MAX / 2)
+            return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+
+        capacity = (writer->mw_nodes_capacity ? writer->mw_nodes_capacity * 2 : 256);
+        nodes = realloc (writer->mw_nodes, capacity * sizeof (struct mold_image_node));
+        if (nodes == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+
+        writer->mw_nodes = nodes;
+        writer->mw_nodes_capacity = capacity;
+    }
+
+    *index = writer->mw_numnodes++;
+    memset (&writer->mw_nodes[*index], 0, sizeof (struct mold_image_node));
+    writer->mw_nodes[*index].mn_context_type = type;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Copy string into the string table, referenced by the node at index.
+//! Every string gets its own copy, such that values may be rewritten in place once loaded.
+static enum disir_status
+image_add_string (struct mold_image_writer *writer, uint32_t index,
+                  const char *string, size_t size)
+{
+    struct mold_image_node *node;
+    size_t capacity;
+    char *strings;
+
+    if (string == NULL)
+        return DISIR_STATUS_OK;
+
+    if (writer->mw_strings_size + size + 1 > UINT32_MAX)
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+
+    if (writer->mw_strings_size + size + 1 > writer->mw_strings_capacity)
+    {
+        capacity = (writer->mw_strings_capacity ? writer->mw_strings_capacity : 4096);
+        while (capacity < writer->mw_strings_size + size + 1)
+            capacity *= 2;
+
+        strings = realloc (writer->mw_strings, capacity);
+        if (strings == NULL)
+            return DISIR_STATUS_NO_MEMORY;
+
+        writer->mw_strings = strings;
+        writer->mw_strings_capacity = capacity;
+    }
+
+    node = &writer->mw_nodes[index];
+    node->mn_flags |= MOLD_IMAGE_NODE_STRING;
+    node->mn_string_offset = writer->mw_strings_size;
+    node->mn_string_size = size;
+
+    memcpy (writer->mw_strings + writer->mw_strings_size, string, size);
+    writer->mw_strings[writer->mw_strings_size + size] = '\0';
+    writer->mw_strings_size += size + 1;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static void
+image_set_version (uint32_t *major, uint32_t *minor, struct disir_version *version)
+{
+    *major = version->sv_major;
+    *minor = version->sv_minor;
+}
+
+static enum disir_status
+image_write_context (struct mold_image_writer *writer, struct disir_context *context);
+
+//! STATIC API
+//! Write every entry in the documentation queue. Increments children by the number written.
+static enum disir_status
+image_write_documentation (struct mold_image_writer *writer,
+                           struct disir_documentation *queue, uint32_t *children)
+{
+    enum disir_status status;
+    struct disir_documentation *doc;
+
+    for (doc = queue; doc != NULL; doc = doc->next)
+    {
+        status = image_write_context (writer, doc->dd_context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        (*children)++;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static enum disir_status
+image_write_restrictions (struct mold_image_writer *writer,
+                          struct disir_restriction *queue, uint32_t *children)
+{
+    enum disir_status status;
+    struct disir_restriction *restriction;
+
+    for (restriction = queue; restriction != NULL; restriction = restriction->next)
+    {
+        status = image_write_context (writer, restriction->re_context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        (*children)++;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static enum disir_status
+image_write_elements (struct mold_image_writer *writer,
+                      struct disir_element_storage *storage, uint32_t *children)
+{
+    enum disir_status status;
+    struct disir_element_iter iter;
+    struct disir_context *element;
+
+    dx_element_storage_iter_begin (storage, NULL, &iter);
+    while (dx_element_storage_iter_next (&iter, &element) == DISIR_STATUS_OK)
+    {
+        status = image_write_context (writer, element);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        (*children)++;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Append the node of context, followed by the nodes of its children.
+static enum disir_status
+image_write_context (struct mold_image_writer *writer, struct disir_context *context)
+{
+    enum disir_status status;
+    struct disir_mold *mold;
+    struct disir_keyval *keyval;
+    struct disir_section *section;
+    struct disir_default *def;
+    struct disir_documentation *doc;
+    struct disir_restriction *restriction;
+    struct mold_image_node *node;
+    uint32_t children;
+    uint32_t index;
+
+    status = image_add_node (writer, dc_context_type (context), &index);
+    if (status != DISIR_STATUS_OK)
+        return status;
+
+    children = 0;
+    node = &writer->mw_nodes[index];
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_MOLD:
+    {
+        mold = context->cx_mold;
+        status = image_write_documentation (writer, mold->mo_documentation_queue, &children);
+        if (status == DISIR_STATUS_OK)
+            status = image_write_elements (writer, mold->mo_elements, &children);
+        break;
+    }
+    case DISIR_CONTEXT_KEYVAL:
+    {
+        keyval = context->cx_keyval;
+        node->mn_value_type = keyval->kv_value.dv_type;
+        image_set_version (&node->mn_deprecated_major, &node->mn_deprecated_minor,
+                           &keyval->kv_deprecated);
+        status = image_add_string (writer, index, keyval->kv_name.dv_string,
+                                   keyval->kv_name.dv_size);
+        if (status == DISIR_STATUS_OK)
+            status = image_write_documentation (writer, keyval->kv_documentation_queue,
+                                                &children);
+        for (def = keyval->kv_default_queue;
+             status == DISIR_STATUS_OK && def != NULL; def = def->next)
+        {
+            status = image_write_context (writer, def->de_context);
+            children++;
+        }
+        if (status == DISIR_STATUS_OK)
+            status = image_write_restrictions (writer, keyval->kv_restrictions_queue, &children);
+        break;
+    }
+    case DISIR_CONTEXT_SECTION:
+    {
+        section = context->cx_section;
+        image_set_version (&node->mn_introduced_major, &node->mn_introduced_minor,
+                           &section->se_introduced);
+        image_set_version (&node->mn_deprecated_major, &node->mn_deprecated_minor,
+                           &section->se_deprecated);
+        status = image_add_string (writer, index, section->se_name.dv_string,
+                                   section->se_name.dv_size);
+        if (status == DISIR_STATUS_OK)
+            status = image_write_documentation (writer, section->se_documentation_queue,
+                                                &children);
+        if (status == DISIR_STATUS_OK)
+            status = image_write_restrictions (writer, section->se_restrictions_queue, &children);
+        if (status == DISIR_STATUS_OK)
+            status = image_write_elements (writer, section->se_elements, &children);
+        break;
+    }
+    case DISIR_CONTEXT_DEFAULT:
+    {
+        def = context->cx_default;
+        node->mn_value_type = def->de_value.dv_type;
+        image_set_version (&node->mn_introduced_major, &node->mn_introduced_minor,
+                           &def->de_introduced);
+        switch (dx_value_type_sanify (def->de_value.dv_type))
+        {
+        case DISIR_VALUE_TYPE_STRING:
+        case DISIR_VALUE_TYPE_ENUM:
+            status = image_add_string (writer, index, def->de_value.dv_string,
+                                       def->de_value.dv_size);
+            break;
+        case DISIR_VALUE_TYPE_INTEGER:
+            node->mn_integer = def->de_value.dv_integer;
+            break;
+        case DISIR_VALUE_TYPE_BOOLEAN:
+            node->mn_integer = def->de_value.dv_boolean;
+            break;
+        case DISIR_VALUE_TYPE_FLOAT:
+            node->mn_float = def->de_value.dv_float;
+            break;
+        case DISIR_VALUE_TYPE_UNKNOWN:
+            break;
+        }
+        break;
+    }
+    case DISIR_CONTEXT_DOCUMENTATION:
+    {
+        doc = context->cx_documentation;
+        image_set_version (&node->mn_introduced_major, &node->mn_introduced_minor,
+                           &doc->dd_introduced);
+        status = image_add_string (writer, index, doc->dd_value.dv_string,
+                                   doc->dd_value.dv_size);
+        break;
+    }
+    case DISIR_CONTEXT_RESTRICTION:
+    {
+        restriction = context->cx_restriction;
+        node->mn_restriction_type = restriction->re_type;
+        image_set_version (&node->mn_introduced_major, &node->mn_introduced_minor,
+                           &restriction->re_introduced);
+        image_set_version (&node->mn_deprecated_major, &node->mn_deprecated_minor,
+                           &restriction->re_deprecated);
+        node->mn_float = restriction->re_value_numeric;
+        node->mn_min = restriction->re_value_min;
+        node->mn_max = restriction->re_value_max;
+        if (restriction->re_value_string)
+        {
+            status = image_add_string (writer, index, restriction->re_value_string,
+                                       strlen (restriction->re_value_string));
+        }
+        if (status == DISIR_STATUS_OK)
+            status = image_write_documentation (writer, restriction->re_documentation_queue,
+                                                &children);
+        break;
+    }
+    case DISIR_CONTEXT_CONFIG:
+    case DISIR_CONTEXT_UNKNOWN:
+    {
+        status = DISIR_STATUS_WRONG_CONTEXT;
+        break;
+    }
+    }
+
+    // Children may have grown the node array - node is no longer valid.
+    writer->mw_nodes[index].mn_children = children;
+
+    return status;
+}
+
+//! STATIC API
+static enum disir_status
+image_write_all (int fd, const void *data, size_t size)
+{
+    const char *position = data;
+    ssize_t res;
+
+    while (size > 0)
+    {
+        res = write (fd, position, size);
+        if (res == -1 && errno == EINTR)
+            continue;
+        if (res <= 0)
+            return DISIR_STATUS_FS_ERROR;
+
+        position += res;
+        size -= res;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Write the image to a temporary file next to filepath, and rename it into place.
+//! A loaded image is memory mapped - it must never be rewritten in place.
+static enum disir_status
+image_write_filepath (struct disir_instance *instance, const char *filepath,
+                      struct mold_image_header *header, struct mold_image_writer *writer)
+{
+    enum disir_status status;
+    char tmp_filepath[PATH_MAX];
+    int fd;
+    int res;
+
+    res = snprintf (tmp_filepath, PATH_MAX, "%s.XXXXXX", filepath);
+    if (res < 0 || res >= PATH_MAX)
+    {
+        disir_error_set (instance, "filepath too long: %s", filepath);
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    fd = mkstemp (tmp_filepath);
+    if (fd == -1)
+    {
+        disir_error_set (instance, "creating %s: %s", tmp_filepath, strerror (errno));
+        return DISIR_STATUS_FS_ERROR;
+    }
+
+    status = image_write_all (fd, header, sizeof (struct mold_image_header));
+    if (status == DISIR_STATUS_OK)
+    {
+        status = image_write_all (fd, writer->mw_nodes,
+                                  writer->mw_numnodes * sizeof (struct mold_image_node));
+    }
+    if (status == DISIR_STATUS_OK)
+    {
+        status = image_write_all (fd, writer->mw_strings, writer->mw_strings_size);
+    }
+    if (status == DISIR_STATUS_OK && (fchmod (fd, 0644) != 0 || fsync (fd) != 0))
+    {
+        status = DISIR_STATUS_FS_ERROR;
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "writing %s: %s", tmp_filepath, strerror (errno));
+        goto error;
+    }
+
+    if (close (fd) != 0)
+    {
+        fd = -1;
+        disir_error_set (instance, "writing %s: %s", tmp_filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+    fd = -1;
+
+    if (rename (tmp_filepath, filepath) != 0)
+    {
+        disir_error_set (instance, "renaming %s to %s: %s",
+                         tmp_filepath, filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto error;
+    }
+
+    return DISIR_STATUS_OK;
+error:
+    if (fd != -1)
+    {
+        close (fd);
+    }
+    unlink (tmp_filepath);
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_compile (struct disir_instance *instance, struct disir_mold *mold,
+                    const char *filepath)
+{
+    enum disir_status status;
+    struct mold_image_writer writer;
+    struct mold_image_header header;
+
+    if (instance == NULL || mold == NULL || filepath == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), mold (%p), filepath (%p)",
+                   instance, mold, filepath);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) mold (%p) filepath (%s)", instance, mold, filepath);
+
+    disir_error_clear (instance);
+    memset (&writer, 0, sizeof (struct mold_image_writer));
+
+    // The image is loaded without validation - only valid molds are compiled.
+    status = disir_mold_valid (mold, NULL);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "mold is not valid. Cannot compile it.");
+        status = DISIR_STATUS_INVALID_CONTEXT;
+        goto out;
+    }
+
+    status = image_write_context (&writer, mold->mo_context);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "failed to compile mold: %s", disir_status_string (status));
+        goto out;
+    }
+
+    memset (&header, 0, sizeof (struct mold_image_header));
+    memcpy (header.mi_magic, MOLD_IMAGE_MAGIC, sizeof (header.mi_magic));
+    header.mi_format = MOLD_IMAGE_FORMAT;
+    header.mi_byte_order = MOLD_IMAGE_BYTE_ORDER;
+    header.mi_nodes_offset = sizeof (struct mold_image_header);
+    header.mi_numnodes = writer.mw_numnodes;
+    header.mi_strings_offset = header.mi_nodes_offset
+                               + writer.mw_numnodes * sizeof (struct mold_image_node);
+    header.mi_strings_size = writer.mw_strings_size;
+    header.mi_size = (uint64_t) header.mi_strings_offset + header.mi_strings_size;
+    header.mi_version_major = mold->mo_version.sv_major;
+    header.mi_version_minor = mold->mo_version.sv_minor;
+
+    status = image_write_filepath (instance, filepath, &header, &writer);
+out:
+    free (writer.mw_nodes);
+    free (writer.mw_strings);
+
+    TRACE_EXIT ("status: %s", disir_status_string (status));
+    return status;
+}
+
+//! STATIC API
+//! Point value at the string of node, inside the mapping. The string is never free'd.
+static enum disir_status
+image_load_string (struct mold_image_loader *loader, const struct mold_image_node *node,
+                   struct disir_value *value)
+{
+    if ((node->mn_flags & MOLD_IMAGE_NODE_STRING) == 0)
+        return DISIR_STATUS_OK;
+
+    if (node->mn_string_offset >= loader->ml_strings_size
+        || node->mn_string_size >= loader->ml_strings_size - node->mn_string_offset
+        || loader->ml_strings[node->mn_string_offset + node->mn_string_size] != '\0')
+    {
+        return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+    }
+
+    value->dv_string = loader->ml_strings + node->mn_string_offset;
+    value->dv_size = node->mn_string_size;
+    value->dv_arena = DX_VALUE_MAPPED;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+static void
+image_load_version (struct disir_version *version, uint32_t major, uint32_t minor)
+{
+    version->sv_major = major;
+    version->sv_minor = minor;
+}
+
+//! STATIC API
+//! Populate the object of context from node, and insert it into its parent
+//! as finalizing it would, without validating it.
+static enum disir_status
+image_load_context (struct mold_image_loader *loader, const struct mold_image_node *node,
+                    struct disir_context *context)
+{
+    enum disir_status status;
+    struct disir_context *parent;
+    struct disir_element_storage *storage;
+    struct disir_keyval *keyval;
+    struct disir_section *section;
+    struct disir_default *def;
+    struct disir_documentation *doc;
+    struct disir_restriction *restriction;
+    struct disir_restriction **queue;
+    struct disir_value value;
+
+    parent = context->cx_parent_context;
+
+    switch (dc_context_type (context))
+    {
+    case DISIR_CONTEXT_KEYVAL:
+    {
+        keyval = context->cx_keyval;
+        if (dx_value_type_sanify (node->mn_value_type) == DISIR_VALUE_TYPE_UNKNOWN)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        keyval->kv_value.dv_type = node->mn_value_type;
+        image_load_version (&keyval->kv_deprecated,
+                            node->mn_deprecated_major, node->mn_deprecated_minor);
+        status = image_load_string (loader, node, &keyval->kv_name);
+        if (status != DISIR_STATUS_OK || keyval->kv_name.dv_string == NULL)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        storage = (dc_context_type (parent) == DISIR_CONTEXT_SECTION
+                   ? parent->cx_section->se_elements : parent->cx_mold->mo_elements);
+        status = dx_element_storage_add (storage, keyval->kv_name.dv_string, context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        context->CONTEXT_STATE_IN_PARENT = 1;
+        break;
+    }
+    case DISIR_CONTEXT_SECTION:
+    {
+        section = context->cx_section;
+        image_load_version (&section->se_introduced,
+                            node->mn_introduced_major, node->mn_introduced_minor);
+        image_load_version (&section->se_deprecated,
+                            node->mn_deprecated_major, node->mn_deprecated_minor);
+        status = image_load_string (loader, node, &section->se_name);
+        if (status != DISIR_STATUS_OK || section->se_name.dv_string == NULL)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        storage = (dc_context_type (parent) == DISIR_CONTEXT_SECTION
+                   ? parent->cx_section->se_elements : parent->cx_mold->mo_elements);
+        status = dx_element_storage_add (storage, section->se_name.dv_string, context);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        context->CONTEXT_STATE_IN_PARENT = 1;
+        break;
+    }
+    case DISIR_CONTEXT_DEFAULT:
+    {
+        def = context->cx_default;
+        // The value type is inherited from the keyval when the default begins.
+        if (node->mn_value_type != def->de_value.dv_type)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        image_load_version (&def->de_introduced,
+                            node->mn_introduced_major, node->mn_introduced_minor);
+        switch (dx_value_type_sanify (def->de_value.dv_type))
+        {
+        case DISIR_VALUE_TYPE_STRING:
+        case DISIR_VALUE_TYPE_ENUM:
+            status = image_load_string (loader, node, &def->de_value);
+            if (status != DISIR_STATUS_OK)
+                return status;
+            break;
+        case DISIR_VALUE_TYPE_INTEGER:
+            def->de_value.dv_integer = node->mn_integer;
+            break;
+        case DISIR_VALUE_TYPE_BOOLEAN:
+            def->de_value.dv_boolean = (node->mn_integer != 0);
+            break;
+        case DISIR_VALUE_TYPE_FLOAT:
+            def->de_value.dv_float = node->mn_float;
+            break;
+        case DISIR_VALUE_TYPE_UNKNOWN:
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+        }
+
+        // Defaults are stored in ascending version order.
+        MQ_ENQUEUE (parent->cx_keyval->kv_default_queue, def);
+        context->CONTEXT_STATE_IN_PARENT = 1;
+        break;
+    }
+    case DISIR_CONTEXT_DOCUMENTATION:
+    {
+        doc = context->cx_documentation;
+        image_load_version (&doc->dd_introduced,
+                            node->mn_introduced_major, node->mn_introduced_minor);
+        status = image_load_string (loader, node, &doc->dd_value);
+        if (status != DISIR_STATUS_OK)
+            return status;
+
+        status = dx_documentation_add (parent, doc);
+        if (status != DISIR_STATUS_OK)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+        break;
+    }
+    case DISIR_CONTEXT_RESTRICTION:
+    {
+        restriction = context->cx_restriction;
+        if (dx_restriction_type_sanify (node->mn_restriction_type) == DISIR_RESTRICTION_UNKNOWN)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        restriction->re_type = node->mn_restriction_type;
+        image_load_version (&restriction->re_introduced,
+                            node->mn_introduced_major, node->mn_introduced_minor);
+        image_load_version (&restriction->re_deprecated,
+                            node->mn_deprecated_major, node->mn_deprecated_minor);
+        restriction->re_value_numeric = node->mn_float;
+        restriction->re_value_min = node->mn_min;
+        restriction->re_value_max = node->mn_max;
+
+        memset (&value, 0, sizeof (struct disir_value));
+        status = image_load_string (loader, node, &value);
+        if (status != DISIR_STATUS_OK)
+            return status;
+        if (value.dv_string)
+        {
+            // Restrictions own their string value.
+            restriction->re_value_string = strdup (value.dv_string);
+            if (restriction->re_value_string == NULL)
+                return DISIR_STATUS_NO_MEMORY;
+        }
+
+        status = dx_restriction_get_queue (context, &queue);
+        if (status != DISIR_STATUS_OK)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+        MQ_ENQUEUE (*queue, restriction);
+        context->CONTEXT_STATE_IN_PARENT = 1;
+        break;
+    }
+    case DISIR_CONTEXT_MOLD:
+    case DISIR_CONTEXT_CONFIG:
+    case DISIR_CONTEXT_UNKNOWN:
+        return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+    }
+
+    context->CONTEXT_STATE_FINALIZED = 1;
+    context->CONTEXT_STATE_CONSTRUCTING = 0;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Construct the next children nodes of the image as children of parent.
+static enum disir_status
+image_load_children (struct mold_image_loader *loader, struct disir_context *parent,
+                     uint32_t children, uint32_t depth)
+{
+    enum disir_status status;
+    const struct mold_image_node *node;
+    struct disir_context *context;
+    enum disir_context_type type;
+    uint32_t i;
+
+    if (depth > MOLD_IMAGE_MAX_DEPTH)
+        return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+    for (i = 0; i < children; i++)
+    {
+        if (loader->ml_index >= loader->ml_numnodes)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        node = &loader->ml_nodes[loader->ml_index++];
+        type = dx_context_type_sanify (node->mn_context_type);
+        if (type == DISIR_CONTEXT_UNKNOWN || dx_context_type_is_toplevel (type))
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        // Rejects children the parent does not accept.
+        status = dc_begin (parent, type, &context);
+        if (status != DISIR_STATUS_OK)
+            return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+
+        status = image_load_context (loader, node, context);
+        if (status != DISIR_STATUS_OK)
+        {
+            dc_destroy (&context);
+            return status;
+        }
+
+        // context is owned by its parent.
+        status = image_load_children (loader, context, node->mn_children, depth + 1);
+        if (status != DISIR_STATUS_OK)
+            return status;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Check that the header describes an image that fits within size bytes.
+static enum disir_status
+image_check_header (const struct mold_image_header *header, size_t size)
+{
+    if (size < sizeof (struct mold_image_header)
+        || memcmp (header->mi_magic, MOLD_IMAGE_MAGIC, sizeof (header->mi_magic)) != 0)
+    {
+        return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+    }
+    if (header->mi_format != MOLD_IMAGE_FORMAT
+        || header->mi_byte_order != MOLD_IMAGE_BYTE_ORDER)
+    {
+        return DISIR_STATUS_NO_CAN_DO;
+    }
+    if (header->mi_size != size
+        || header->mi_nodes_offset < sizeof (struct mold_image_header)
+        || header->mi_nodes_offset > size
+        || header->mi_nodes_offset % sizeof (uint64_t) != 0
+        || header->mi_numnodes == 0
+        || header->mi_numnodes > (size - header->mi_nodes_offset)
+                                 / sizeof (struct mold_image_node)
+        || header->mi_strings_offset < header->mi_nodes_offset
+                                       + (uint64_t) header->mi_numnodes
+                                         * sizeof (struct mold_image_node)
+        || header->mi_strings_offset > size
+        || header->mi_strings_size > size - header->mi_strings_offset)
+    {
+        return DISIR_STATUS_BAD_CONTEXT_OBJECT;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_mold_load_compiled (struct disir_instance *instance, const char *filepath,
+                          struct disir_mold **mold)
+{
+    enum disir_status status;
+    struct mold_image_loader loader;
+    const struct mold_image_header *header;
+    struct disir_context *context_mold;
+    struct stat statbuf;
+    void *mapping;
+    size_t size;
+    int fd;
+
+    if (instance == NULL || filepath == NULL || mold == NULL)
+    {
+        log_debug (0, "invoked with NULL argument(s). instance (%p), filepath (%p), mold (%p)",
+                   instance, filepath, mold);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    TRACE_ENTER ("instance (%p) filepath (%s) mold (%p)", instance, filepath, mold);
+
+    disir_error_clear (instance);
+    context_mold = NULL;
+    mapping = MAP_FAILED;
+    size = 0;
+
+    fd = open (filepath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        disir_error_set (instance, "opening for reading %s: %s", filepath, strerror (errno));
+        status = (errno == ENOENT ? DISIR_STATUS_NOT_EXIST : DISIR_STATUS_FS_ERROR);
+        goto out;
+    }
+    if (fstat (fd, &statbuf) != 0)
+    {
+        disir_error_set (instance, "stat %s: %s", filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        close (fd);
+        goto out;
+    }
+
+    size = statbuf.st_size;
+    if (size < sizeof (struct mold_image_header))
+    {
+        disir_error_set (instance, "%s is not a compiled mold", filepath);
+        status = DISIR_STATUS_BAD_CONTEXT_OBJECT;
+        close (fd);
+        goto out;
+    }
+
+    // A private, writable mapping: strings are referenced in place,
+    // and values rewritten in place are copied on write.
+    mapping = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (mapping == MAP_FAILED)
+    {
+        disir_error_set (instance, "mapping %s: %s", filepath, strerror (errno));
+        status = DISIR_STATUS_FS_ERROR;
+        goto out;
+    }
+
+    header = mapping;
+    status = image_check_header (header, size);
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "%s is not a compiled mold of a supported format", filepath);
+        goto out;
+    }
+
+    loader.ml_nodes = (const struct mold_image_node *)
+                        ((const char *) mapping + header->mi_nodes_offset);
+    loader.ml_numnodes = header->mi_numnodes;
+    loader.ml_index = 1;
+    loader.ml_strings = (char *) mapping + header->mi_strings_offset;
+    loader.ml_strings_size = header->mi_strings_size;
+
+    if (loader.ml_nodes[0].mn_context_type != DISIR_CONTEXT_MOLD)
+    {
+        disir_error_set (instance, "%s is not a compiled mold", filepath);
+        status = DISIR_STATUS_BAD_CONTEXT_OBJECT;
+        goto out;
+    }
+
+    status = dc_mold_begin (&context_mold);
+    if (status == DISIR_STATUS_OK)
+    {
+        status = dc_enable_arena (context_mold);
+    }
+    if (status == DISIR_STATUS_OK)
+    {
+        // The mapping now lives for as long as any context of the mold.
+        status = dx_arena_adopt_mapping (dx_context_arena (context_mold), mapping, size);
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "failed to construct mold: %s", disir_status_string (status));
+        goto out;
+    }
+    mapping = MAP_FAILED;
+
+    status = image_load_children (&loader, context_mold, loader.ml_nodes[0].mn_children, 0);
+    if (status == DISIR_STATUS_OK && loader.ml_index != loader.ml_numnodes)
+    {
+        status = DISIR_STATUS_BAD_CONTEXT_OBJECT;
+    }
+    if (status != DISIR_STATUS_OK)
+    {
+        disir_error_set (instance, "%s is a corrupt compiled mold", filepath);
+        goto out;
+    }
+
+    context_mold->cx_mold->mo_version.sv_major = header->mi_version_major;
+    context_mold->cx_mold->mo_version.sv_minor = header->mi_version_minor;
+
+    status = dx_mold_finalize_trusted (&context_mold, mold);
+out:
+    if (context_mold)
+    {
+        dc_destroy (&context_mold);
+    }
+    if (mapping != MAP_FAILED)
+    {
+        munmap (mapping, size);
+    }
+
+    TRACE_EXIT ("status: %s", disir_status_string (status));
+    return status;
+}
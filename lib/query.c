@@ -7,6 +7,10 @@
 
 #include "context_private.h"
 #include "query_private.h"
+#include "element_storage.h"
+#include "config.h"
+#include "mold.h"
+#include "section.h"
 #include "restriction.h"
 #include "log.h"
 
@@ -578,3 +582,230 @@ dc_query_resolve_context_va (struct disir_context *parent, const char *name,
 }
 
 
+
+//! STATIC API
+//! Split the buffer in-place into name@index segments, following the same rules
+//! as dx_query_resolve_name().
+static enum disir_status
+query_compile_segments (struct disir_query *query)
+{
+    char *name;
+    char *next;
+    char *index_indicator;
+    char *endptr;
+    int32_t count;
+    int32_t i;
+
+    // One segment per key seperator, plus one.
+    count = 1;
+    for (name = query->dq_names; *name != '\0'; name++)
+    {
+        if (*name == '.')
+            count++;
+    }
+
+    query->dq_segments = calloc (count, sizeof (struct disir_query_segment));
+    if (query->dq_segments == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    name = query->dq_names;
+    for (i = 0; i < count; i++)
+    {
+        next = strchr (name, '.');
+        if (next != NULL)
+        {
+            *next = '\0';
+        }
+
+        index_indicator = strchr (name, '@');
+        if (index_indicator != NULL)
+        {
+            *index_indicator = '\0';
+        }
+
+        if (*name == '\0')
+        {
+            log_debug (1, "query '%s' contains a blank key.", query->dq_string);
+            return DISIR_STATUS_INVALID_ARGUMENT;
+        }
+
+        query->dq_segments[i].qs_name = name;
+        query->dq_segments[i].qs_index = 0;
+
+        if (index_indicator != NULL)
+        {
+            query->dq_segments[i].qs_index = strtol (index_indicator + 1, &endptr, 10);
+            if (endptr == index_indicator + 1 || *endptr != '\0')
+            {
+                log_debug (1, "query '%s' contains an invalid index indicator.",
+                           query->dq_string);
+                return DISIR_STATUS_INVALID_ARGUMENT;
+            }
+        }
+
+        if (next != NULL)
+        {
+            name = next + 1;
+        }
+    }
+
+    query->dq_numsegments = count;
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_query_compile (struct disir_query **query, const char *format, ...)
+{
+    enum disir_status status;
+    struct disir_query *compiled;
+    char buffer[2048];
+    va_list args;
+
+    if (query == NULL || format == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer(s) (query %p, format %p)", query, format);
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    va_start (args, format);
+    if (vsnprintf (buffer, 2048, format, args) >= 2048)
+    {
+        va_end (args);
+        log_debug (0, "Insufficient buffer. Query exceeded 2048 bytes.");
+        return DISIR_STATUS_INSUFFICIENT_RESOURCES;
+    }
+    va_end (args);
+
+    compiled = calloc (1, sizeof (struct disir_query));
+    if (compiled == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    compiled->dq_string = strdup (buffer);
+    compiled->dq_names = strdup (buffer);
+    if (compiled->dq_string == NULL || compiled->dq_names == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto error;
+    }
+
+    status = query_compile_segments (compiled);
+    if (status != DISIR_STATUS_OK)
+    {
+        goto error;
+    }
+
+    *query = compiled;
+    return DISIR_STATUS_OK;
+error:
+    disir_query_finished (&compiled);
+    return status;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_query_finished (struct disir_query **query)
+{
+    if (query == NULL || *query == NULL)
+    {
+        log_debug (0, "invoked with NULL pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    free ((*query)->dq_string);
+    free ((*query)->dq_names);
+    free ((*query)->dq_segments);
+    free (*query);
+    *query = NULL;
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+const char *
+disir_query_string (struct disir_query *query)
+{
+    if (query == NULL)
+        return NULL;
+
+    return query->dq_string;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_query_compiled_resolve (struct disir_context *parent, struct disir_query *query,
+                           struct disir_context **out)
+{
+    enum disir_status status;
+    struct disir_element_storage *storage;
+    struct disir_context *current;
+    int32_t i;
+
+    status = CONTEXT_NULL_INVALID_TYPE_CHECK (parent);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+
+    status = CONTEXT_TYPE_CHECK (parent, DISIR_CONTEXT_MOLD,
+                                         DISIR_CONTEXT_CONFIG,
+                                         DISIR_CONTEXT_SECTION);
+    if (status != DISIR_STATUS_OK)
+    {
+        // Already logged
+        return status;
+    }
+
+    // Nothing has been added to or removed from the tree since we last resolved this query.
+    if (query->dq_context && query->dq_parent == parent &&
+        query->dq_generation == dx_context_elements_generation (parent))
+    {
+        dx_context_incref (query->dq_context);
+        *out = query->dq_context;
+        return DISIR_STATUS_OK;
+    }
+
+    query->dq_context = NULL;
+
+    current = parent;
+    for (i = 0; i < query->dq_numsegments; i++)
+    {
+        switch (dc_context_type (current))
+        {
+        case DISIR_CONTEXT_CONFIG:
+            storage = current->cx_config->cf_elements;
+            break;
+        case DISIR_CONTEXT_MOLD:
+            storage = current->cx_mold->mo_elements;
+            break;
+        case DISIR_CONTEXT_SECTION:
+            storage = current->cx_section->se_elements;
+            break;
+        default:
+            dx_log_context (parent, "'%s' - element '%s' is not a section.",
+                            query->dq_string, query->dq_segments[i - 1].qs_name);
+            return DISIR_STATUS_WRONG_CONTEXT;
+        }
+
+        status = dx_element_storage_get_index (storage, query->dq_segments[i].qs_name,
+                                               query->dq_segments[i].qs_index, &current);
+        if (status != DISIR_STATUS_OK)
+        {
+            log_info ("element not found: %s", query->dq_string);
+            return status;
+        }
+    }
+
+    query->dq_parent = parent;
+    query->dq_context = current;
+    query->dq_generation = dx_context_elements_generation (parent);
+
+    dx_context_incref (current);
+    *out = current;
+    return DISIR_STATUS_OK;
+}
@@ -0,0 +1,380 @@
+// external public includes
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/context.h>
+
+// private
+#include "context_private.h"
+#include "keyval.h"
+#include "log.h"
+#include "mqueue.h"
+#include "restriction.h"
+
+
+//! The exclusive restrictions of a keyval active for a span of versions.
+struct restriction_span
+{
+    //! Number of exclusive restrictions active in this span.
+    uint32_t                    rs_active;
+
+    //! Sorted, non-overlapping [min, max] pairs of every active range and numeric restriction.
+    //! A numeric restriction is the range [value, value].
+    double                      *rs_ranges;
+    uint32_t                    rs_ranges_count;
+
+    //! Sorted values of every active enum restriction.
+    //! The strings are owned by the restrictions.
+    const char                  **rs_enums;
+    uint32_t                    rs_enums_count;
+};
+
+//! Exclusive restrictions of a mold keyval, compiled per version span.
+struct disir_restriction_evaluator
+{
+    //! Sorted versions where the set of active restrictions changes.
+    //! Span i applies to versions from rv_versions[i] up to (excluding) rv_versions[i + 1].
+    //! No restriction is active for versions less than rv_versions[0].
+    struct disir_version        *rv_versions;
+    struct restriction_span     *rv_spans;
+    uint32_t                    rv_spans_count;
+};
+
+//! STATIC API
+static int
+restriction_exclusive (enum disir_restriction_type type)
+{
+    return (type == DISIR_RESTRICTION_EXC_VALUE_ENUM
+            || type == DISIR_RESTRICTION_EXC_VALUE_RANGE
+            || type == DISIR_RESTRICTION_EXC_VALUE_NUMERIC);
+}
+
+//! STATIC API
+//! Whether restriction is active for version. Mirrors dx_restriction_exclusive_value_check.
+static int
+restriction_active (struct disir_restriction *restriction, struct disir_version *version)
+{
+    if (dc_version_compare (version, &restriction->re_introduced) < 0)
+        return 0;
+
+    if ((restriction->re_deprecated.sv_major != 0 || restriction->re_deprecated.sv_minor != 0)
+        && dc_version_compare (version, &restriction->re_deprecated) >= 0)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+//! STATIC API
+static int
+restriction_compare_version (const void *a, const void *b)
+{
+    struct disir_version lhs = *(const struct disir_version *) a;
+    struct disir_version rhs = *(const struct disir_version *) b;
+
+    return dc_version_compare (&lhs, &rhs);
+}
+
+//! STATIC API
+static int
+restriction_compare_range (const void *a, const void *b)
+{
+    const double *lhs = a;
+    const double *rhs = b;
+
+    return (lhs[0] > rhs[0]) - (lhs[0] < rhs[0]);
+}
+
+//! STATIC API
+static int
+restriction_compare_enum (const void *a, const void *b)
+{
+    return strcmp (*(const char * const *) a, *(const char * const *) b);
+}
+
+//! STATIC API
+//! Populate span with every exclusive restriction in queue active for version.
+static enum disir_status
+restriction_span_compile (struct restriction_span *span, struct disir_restriction *queue,
+                          int restrictions, struct disir_version *version)
+{
+    uint32_t merged;
+    uint32_t i;
+
+    span->rs_ranges = calloc (restrictions, 2 * sizeof (double));
+    span->rs_enums = calloc (restrictions, sizeof (const char *));
+    if (span->rs_ranges == NULL || span->rs_enums == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    MQ_FOREACH (queue,
+    {
+        if (restriction_exclusive (entry->re_type) && restriction_active (entry, version))
+        {
+            span->rs_active++;
+
+            switch (entry->re_type)
+            {
+            case DISIR_RESTRICTION_EXC_VALUE_RANGE:
+            {
+                // A NaN bound never matches any value - leave it out of the table.
+                if (isnan (entry->re_value_min) || isnan (entry->re_value_max))
+                    break;
+                span->rs_ranges[2 * span->rs_ranges_count] = entry->re_value_min;
+                span->rs_ranges[2 * span->rs_ranges_count + 1] = entry->re_value_max;
+                span->rs_ranges_count++;
+                break;
+            }
+            case DISIR_RESTRICTION_EXC_VALUE_NUMERIC:
+            {
+                if (isnan (entry->re_value_numeric))
+                    break;
+                span->rs_ranges[2 * span->rs_ranges_count] = entry->re_value_numeric;
+                span->rs_ranges[2 * span->rs_ranges_count + 1] = entry->re_value_numeric;
+                span->rs_ranges_count++;
+                break;
+            }
+            case DISIR_RESTRICTION_EXC_VALUE_ENUM:
+            {
+                if (entry->re_value_string == NULL)
+                    break;
+                span->rs_enums[span->rs_enums_count++] = entry->re_value_string;
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    });
+
+    qsort (span->rs_enums, span->rs_enums_count, sizeof (const char *),
+           restriction_compare_enum);
+
+    // Sort the ranges by their minimum and merge the overlapping ones,
+    // such that a value is within at most one range.
+    qsort (span->rs_ranges, span->rs_ranges_count, 2 * sizeof (double),
+           restriction_compare_range);
+    merged = 0;
+    for (i = 0; i < span->rs_ranges_count; i++)
+    {
+        // Empty range (min > max) never matches any value.
+        if (span->rs_ranges[2 * i] > span->rs_ranges[2 * i + 1])
+            continue;
+
+        if (merged != 0 && span->rs_ranges[2 * i] <= span->rs_ranges[2 * merged - 1])
+        {
+            if (span->rs_ranges[2 * i + 1] > span->rs_ranges[2 * merged - 1])
+            {
+                span->rs_ranges[2 * merged - 1] = span->rs_ranges[2 * i + 1];
+            }
+            continue;
+        }
+
+        span->rs_ranges[2 * merged] = span->rs_ranges[2 * i];
+        span->rs_ranges[2 * merged + 1] = span->rs_ranges[2 * i + 1];
+        merged++;
+    }
+    span->rs_ranges_count = merged;
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//! Locate the span applicable to version. NULL if no restriction is active for version.
+static struct restriction_span *
+restriction_span_find (struct disir_restriction_evaluator *evaluator,
+                       struct disir_version *version)
+{
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+
+    // Find the number of span versions less than or equal to version.
+    low = 0;
+    high = evaluator->rv_spans_count;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (dc_version_compare (&evaluator->rv_versions[middle], version) <= 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return (low == 0 ? NULL : &evaluator->rv_spans[low - 1]);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_restriction_evaluator_compile (struct disir_context *keyval,
+                                  struct disir_restriction_evaluator **evaluator)
+{
+    enum disir_status status;
+    struct disir_restriction *queue;
+    struct disir_restriction_evaluator *compiled;
+    int restrictions;
+    uint32_t versions;
+    uint32_t i;
+
+    queue = keyval->cx_keyval->kv_restrictions_queue;
+    restrictions = MQ_SIZE_COND (queue, restriction_exclusive (entry->re_type));
+
+    compiled = calloc (1, sizeof (struct disir_restriction_evaluator));
+    if (compiled == NULL)
+    {
+        return DISIR_STATUS_NO_MEMORY;
+    }
+
+    status = DISIR_STATUS_OK;
+    if (restrictions == 0)
+        goto out;
+
+    // The set of active restrictions may only change where one is introduced or deprecated.
+    compiled->rv_versions = calloc (2 * restrictions, sizeof (struct disir_version));
+    if (compiled->rv_versions == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+    versions = 0;
+    MQ_FOREACH (queue,
+    {
+        if (restriction_exclusive (entry->re_type))
+        {
+            compiled->rv_versions[versions++] = entry->re_introduced;
+            if (entry->re_deprecated.sv_major != 0 || entry->re_deprecated.sv_minor != 0)
+            {
+                compiled->rv_versions[versions++] = entry->re_deprecated;
+            }
+        }
+    });
+    qsort (compiled->rv_versions, versions, sizeof (struct disir_version),
+           restriction_compare_version);
+    compiled->rv_spans_count = 0;
+    for (i = 0; i < versions; i++)
+    {
+        if (compiled->rv_spans_count != 0
+            && dc_version_compare (&compiled->rv_versions[compiled->rv_spans_count - 1],
+                                   &compiled->rv_versions[i]) == 0)
+        {
+            continue;
+        }
+        compiled->rv_versions[compiled->rv_spans_count++] = compiled->rv_versions[i];
+    }
+
+    compiled->rv_spans = calloc (compiled->rv_spans_count, sizeof (struct restriction_span));
+    if (compiled->rv_spans == NULL)
+    {
+        status = DISIR_STATUS_NO_MEMORY;
+        goto out;
+    }
+    for (i = 0; i < compiled->rv_spans_count; i++)
+    {
+        status = restriction_span_compile (&compiled->rv_spans[i], queue, restrictions,
+                                           &compiled->rv_versions[i]);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+    }
+
+out:
+    if (status != DISIR_STATUS_OK)
+    {
+        dx_restriction_evaluator_destroy (&compiled);
+        return status;
+    }
+
+    *evaluator = compiled;
+    return DISIR_STATUS_OK;
+}
+
+//! INTERNAL API
+void
+dx_restriction_evaluator_destroy (struct disir_restriction_evaluator **evaluator)
+{
+    uint32_t i;
+
+    if (evaluator == NULL || *evaluator == NULL)
+        return;
+
+    if ((*evaluator)->rv_spans)
+    {
+        for (i = 0; i < (*evaluator)->rv_spans_count; i++)
+        {
+            free ((*evaluator)->rv_spans[i].rs_ranges);
+            free ((*evaluator)->rv_spans[i].rs_enums);
+        }
+    }
+    free ((*evaluator)->rv_spans);
+    free ((*evaluator)->rv_versions);
+    free (*evaluator);
+    *evaluator = NULL;
+}
+
+//! INTERNAL API
+void
+dx_restriction_evaluator_invalidate (struct disir_context *restriction)
+{
+    struct disir_context *parent;
+
+    parent = restriction->cx_parent_context;
+    if (parent && dc_context_type (parent) == DISIR_CONTEXT_KEYVAL)
+    {
+        dx_restriction_evaluator_destroy (&parent->cx_keyval->kv_restriction_evaluator);
+    }
+}
+
+//! INTERNAL API
+int
+dx_restriction_evaluator_check (struct disir_restriction_evaluator *evaluator,
+                                struct disir_version *version,
+                                double value, const char *string_value)
+{
+    struct restriction_span *span;
+    uint32_t low;
+    uint32_t high;
+    uint32_t middle;
+    int compare;
+
+    span = restriction_span_find (evaluator, version);
+    if (span == NULL || span->rs_active == 0)
+        return 0;
+
+    if (string_value)
+    {
+        low = 0;
+        high = span->rs_enums_count;
+        while (low < high)
+        {
+            middle = low + (high - low) / 2;
+            compare = strcmp (string_value, span->rs_enums[middle]);
+            if (compare == 0)
+                return 1;
+            if (compare < 0)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        return -1;
+    }
+
+    // Find the last range whose minimum is less than or equal to value.
+    low = 0;
+    high = span->rs_ranges_count;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (span->rs_ranges[2 * middle] <= value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low != 0 && value <= span->rs_ranges[2 * (low - 1) + 1])
+        return 1;
+
+    return -1;
+}
@@ -0,0 +1,315 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <disir/disir.h>
+
+#include "disir_private.h"
+#include "log.h"
+#include "stats.h"
+
+
+_Thread_local uint64_t dx_stats_contexts_allocated = 0;
+
+//! Stats of operations performed outside the operations of an instance.
+static struct dx_stats stats_process;
+
+//! Stats of the operation of an instance currently performed by this thread.
+static _Thread_local struct dx_stats *stats_current = NULL;
+
+//! STATIC API
+static uint64_t
+stats_now_ns (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+//! STATIC API
+static void
+stats_store_max (_Atomic uint64_t *max, uint64_t value)
+{
+    uint64_t current;
+
+    current = atomic_load_explicit (max, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit (max, &current, value,
+                                                   memory_order_relaxed, memory_order_relaxed))
+    {
+        // current is reloaded by the failed exchange.
+    }
+}
+
+//! STATIC API
+//! Stats held by instance, or by the instance it reads on behalf of. NULL if never enabled.
+static struct dx_stats *
+stats_of (struct disir_instance *instance)
+{
+    if (instance == NULL)
+        return &stats_process;
+
+    if (instance->dio_parent)
+        instance = instance->dio_parent;
+
+    return __atomic_load_n (&instance->dio_stats, __ATOMIC_ACQUIRE);
+}
+
+//! INTERNAL API
+void
+dx_stats_begin (struct disir_instance *instance, struct dx_stats_timer *timer)
+{
+    struct dx_stats *stats;
+
+    timer->st_stats = NULL;
+
+    if (instance == NULL && stats_current != NULL)
+    {
+        stats = stats_current;
+    }
+    else
+    {
+        stats = stats_of (instance);
+    }
+
+    if (stats == NULL || atomic_load_explicit (&stats->st_enabled, memory_order_relaxed) == 0)
+        return;
+
+    timer->st_stats = stats;
+    timer->st_previous = stats_current;
+    timer->st_contexts = dx_stats_contexts_allocated;
+    timer->st_start_ns = stats_now_ns ();
+
+    // Nested operations without an instance count towards the same stats.
+    if (instance != NULL)
+        stats_current = stats;
+}
+
+//! INTERNAL API
+void
+dx_stats_end (struct dx_stats_timer *timer, enum disir_stats_operation operation,
+              enum disir_status status)
+{
+    struct dx_stats_counter *counter;
+    uint64_t elapsed;
+    uint64_t contexts;
+    int bucket;
+
+    if (timer->st_stats == NULL)
+        return;
+
+    elapsed = stats_now_ns () - timer->st_start_ns;
+    contexts = dx_stats_contexts_allocated - timer->st_contexts;
+    stats_current = timer->st_previous;
+
+    bucket = 0;
+    if (elapsed > 1)
+    {
+        bucket = 63 - __builtin_clzll (elapsed);
+        if (bucket >= DISIR_STATS_HISTOGRAM_BUCKETS)
+            bucket = DISIR_STATS_HISTOGRAM_BUCKETS - 1;
+    }
+
+    counter = &timer->st_stats->st_counters[operation];
+    atomic_fetch_add_explicit (&counter->sc_calls, 1, memory_order_relaxed);
+    if (status != DISIR_STATUS_OK)
+    {
+        atomic_fetch_add_explicit (&counter->sc_failures, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit (&counter->sc_total_ns, elapsed, memory_order_relaxed);
+    stats_store_max (&counter->sc_max_ns, elapsed);
+    atomic_fetch_add_explicit (&counter->sc_contexts, contexts, memory_order_relaxed);
+    stats_store_max (&counter->sc_contexts_max, contexts);
+    atomic_fetch_add_explicit (&counter->sc_histogram[bucket], 1, memory_order_relaxed);
+}
+
+//! INTERNAL API
+void
+dx_stats_destroy (struct disir_instance *instance)
+{
+    free (instance->dio_stats);
+    instance->dio_stats = NULL;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_stats_enable (struct disir_instance *instance, int enable)
+{
+    struct dx_stats *stats;
+    struct dx_stats *expected;
+
+    stats = stats_of (instance);
+    if (stats == NULL)
+    {
+        if (enable == 0)
+            return DISIR_STATUS_OK;
+
+        stats = calloc (1, sizeof (struct dx_stats));
+        if (stats == NULL)
+        {
+            return DISIR_STATUS_NO_MEMORY;
+        }
+
+        if (instance->dio_parent)
+            instance = instance->dio_parent;
+
+        // Another thread may have enabled stats in the meantime.
+        expected = NULL;
+        if (!__atomic_compare_exchange_n (&instance->dio_stats, &expected, stats, 0,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            free (stats);
+            stats = expected;
+        }
+    }
+
+    atomic_store (&stats->st_enabled, (enable ? 1 : 0));
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_stats_get (struct disir_instance *instance, struct disir_stats *output)
+{
+    struct dx_stats *stats;
+    struct dx_stats_counter *counter;
+    struct disir_stats_counter *out;
+    int operation;
+    int bucket;
+
+    if (output == NULL)
+    {
+        log_debug (0, "invoked with NULL stats pointer.");
+        return DISIR_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset (output, 0, sizeof (struct disir_stats));
+
+    stats = stats_of (instance);
+    if (stats == NULL)
+        return DISIR_STATUS_OK;
+
+    for (operation = 0; operation < DISIR_STATS_OPERATION_COUNT; operation++)
+    {
+        counter = &stats->st_counters[operation];
+        out = &output->ds_counters[operation];
+
+        out->sc_calls = atomic_load_explicit (&counter->sc_calls, memory_order_relaxed);
+        out->sc_failures = atomic_load_explicit (&counter->sc_failures, memory_order_relaxed);
+        out->sc_total_ns = atomic_load_explicit (&counter->sc_total_ns, memory_order_relaxed);
+        out->sc_max_ns = atomic_load_explicit (&counter->sc_max_ns, memory_order_relaxed);
+        out->sc_contexts = atomic_load_explicit (&counter->sc_contexts, memory_order_relaxed);
+        out->sc_contexts_max = atomic_load_explicit (&counter->sc_contexts_max,
+                                                     memory_order_relaxed);
+        for (bucket = 0; bucket < DISIR_STATS_HISTOGRAM_BUCKETS; bucket++)
+        {
+            out->sc_histogram[bucket] = atomic_load_explicit (&counter->sc_histogram[bucket],
+                                                              memory_order_relaxed);
+        }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+enum disir_status
+disir_stats_reset (struct disir_instance *instance)
+{
+    struct dx_stats *stats;
+    struct dx_stats_counter *counter;
+    int operation;
+    int bucket;
+
+    stats = stats_of (instance);
+    if (stats == NULL)
+        return DISIR_STATUS_OK;
+
+    for (operation = 0; operation < DISIR_STATS_OPERATION_COUNT; operation++)
+    {
+        counter = &stats->st_counters[operation];
+
+        atomic_store_explicit (&counter->sc_calls, 0, memory_order_relaxed);
+        atomic_store_explicit (&counter->sc_failures, 0, memory_order_relaxed);
+        atomic_store_explicit (&counter->sc_total_ns, 0, memory_order_relaxed);
+        atomic_store_explicit (&counter->sc_max_ns, 0, memory_order_relaxed);
+        atomic_store_explicit (&counter->sc_contexts, 0, memory_order_relaxed);
+        atomic_store_explicit (&counter->sc_contexts_max, 0, memory_order_relaxed);
+        for (bucket = 0; bucket < DISIR_STATS_HISTOGRAM_BUCKETS; bucket++)
+        {
+            atomic_store_explicit (&counter->sc_histogram[bucket], 0, memory_order_relaxed);
+        }
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! PUBLIC API
+const char *
+disir_stats_operation_string (enum disir_stats_operation operation)
+{
+    switch (operation)
+    {
+    case DISIR_STATS_CONFIG_READ:
+        return "config_read";
+    case DISIR_STATS_CONFIG_WRITE:
+        return "config_write";
+    case DISIR_STATS_CONFIG_ENTRIES:
+        return "config_entries";
+    case DISIR_STATS_MOLD_READ:
+        return "mold_read";
+    case DISIR_STATS_MOLD_WRITE:
+        return "mold_write";
+    case DISIR_STATS_MOLD_ENTRIES:
+        return "mold_entries";
+    case DISIR_STATS_PARSE:
+        return "parse";
+    case DISIR_STATS_VALIDATE:
+        return "validate";
+    case DISIR_STATS_UPDATE:
+        return "update";
+    case DISIR_STATS_COMPARE:
+        return "compare";
+    case DISIR_STATS_OPERATION_COUNT:
+        break;
+    }
+
+    return "UNKNOWN";
+}
+
+//! PUBLIC API
+uint64_t
+disir_stats_percentile (const struct disir_stats_counter *counter, double percentile)
+{
+    uint64_t target;
+    uint64_t seen;
+    int bucket;
+
+    if (counter == NULL || counter->sc_calls == 0)
+        return 0;
+
+    if (percentile < 0)
+        percentile = 0;
+    if (percentile > 100)
+        percentile = 100;
+
+    // Number of calls that must have completed within the returned latency.
+    target = (uint64_t) ((percentile / 100.0) * counter->sc_calls + 0.5);
+    if (target == 0)
+        target = 1;
+
+    seen = 0;
+    for (bucket = 0; bucket < DISIR_STATS_HISTOGRAM_BUCKETS - 1; bucket++)
+    {
+        seen += counter->sc_histogram[bucket];
+        if (seen >= target)
+        {
+            // No call took longer than the slowest one.
+            if ((2ULL << bucket) > counter->sc_max_ns)
+                return counter->sc_max_ns;
+            return (2ULL << bucket);
+        }
+    }
+
+    return counter->sc_max_ns;
+}
@@ -62,6 +62,17 @@ static std::map<std::string, output_mold> molds = {
     std::make_pair ("multiple_defaults", multiple_defaults),
 };
 
+//! Lookup the mold function stored for id. NULL if there is none.
+//! Does not insert into molds, so that it may be called concurrently.
+static output_mold
+find_mold (const std::string& id)
+{
+    auto it = molds.find (id);
+    if (it == molds.end ())
+        return NULL;
+    return it->second;
+}
+
 
 enum disir_status
 dio_test_config_read (struct disir_instance *instance,
@@ -75,13 +86,13 @@ dio_test_config_read (struct disir_instance *instance,
     (void) &instance;
     (void) &plugin;
 
-    func_mold = molds[std::string(entry_id)];
+    func_mold = find_mold (entry_id);
     if (func_mold == NULL)
     {
         if (fslib_namespace_entry (entry_id, namespace_entry) == NULL)
             return DISIR_STATUS_INVALID_ARGUMENT;
 
-        func_mold = molds[namespace_entry];
+        func_mold = find_mold (namespace_entry);
         if (func_mold == NULL)
             return DISIR_STATUS_INVALID_ARGUMENT;
     }
@@ -110,7 +121,7 @@ dio_test_config_query (struct disir_instance *instance, struct disir_register_pl
     (void) &instance;
     (void) &plugin;
 
-    if (molds[entry_id] == NULL)
+    if (find_mold (entry_id) == NULL)
         return DISIR_STATUS_NOT_EXIST;
     else
     {
@@ -146,14 +157,14 @@ dio_test_mold_read (struct disir_instance *instance, struct disir_register_plugi
     (void) &plugin;
     (void) &entry_id;
 
-    func_mold = molds[entry_id];
+    func_mold = find_mold (entry_id);
     if (func_mold == NULL)
     {
 
         if (fslib_namespace_entry (entry_id, namespace_entry) == NULL)
             return DISIR_STATUS_INVALID_ARGUMENT;
 
-        func_mold = molds[namespace_entry];
+        func_mold = find_mold (namespace_entry);
         if (func_mold == NULL)
         {
             return DISIR_STATUS_INVALID_ARGUMENT;
@@ -12,6 +12,7 @@
 #include "keyval.h"
 #include "log.h"
 #include "mold.h"
+#include "stats.h"
 #include "update_private.h"
 
 //! STATIC FUNCTION
@@ -19,7 +20,7 @@ static enum disir_status
 retrieve_all_keyvals_recursively (struct disir_context *current, struct disir_collection *keyvals)
 {
     enum disir_status status;
-    struct disir_collection *coll = NULL;
+    struct disir_element_iter iter;
     struct disir_context *context = NULL;
     struct disir_element_storage *elements = NULL;
 
@@ -43,38 +44,27 @@ retrieve_all_keyvals_recursively (struct disir_context *current, struct disir_co
         return DISIR_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dx_element_storage_get_all (elements, &coll);
-    if (status != DISIR_STATUS_OK)
-    {
-        return status;
-    }
+    dx_element_storage_iter_begin (elements, NULL, &iter);
 
     do
     {
-        status = dc_collection_next (coll, &context);
+        status = dx_element_storage_iter_next (&iter, &context);
         if (status != DISIR_STATUS_OK)
             break;
 
         status = retrieve_all_keyvals_recursively (context, keyvals);
         if (status != DISIR_STATUS_OK)
             break;
-
-        dc_putcontext (&context);
     }
     while (1);
 
-    if (coll)
-        dc_collection_finished (&coll);
-    if (context)
-        dc_putcontext (&context);
-
     return status;
 }
 
-//! PUBLIC API
-enum disir_status
-disir_update_config (struct disir_config *config,
-                     struct disir_version *target, struct disir_update **update)
+//! STATIC API
+static enum disir_status
+update_config (struct disir_config *config,
+               struct disir_version *target, struct disir_update **update)
 {
     enum disir_status status;
     struct disir_config *config_at_target;
@@ -147,6 +137,21 @@ error:
     return status;
 }
 
+//! PUBLIC API
+enum disir_status
+disir_update_config (struct disir_config *config,
+                     struct disir_version *target, struct disir_update **update)
+{
+    enum disir_status status;
+    struct dx_stats_timer timer;
+
+    dx_stats_begin (NULL, &timer);
+    status = update_config (config, target, update);
+    dx_stats_end (&timer, DISIR_STATS_UPDATE, status);
+
+    return status;
+}
+
 enum disir_status
 disir_update_continue (struct disir_update *update)
 {
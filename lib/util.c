@@ -9,6 +9,7 @@
 
 // Private disir includes
 #include "value.h"
+#include "arena.h"
 #include "log.h"
 
 //! Array of strings describing the various DISIR_STATUS_* enumerations
@@ -419,6 +420,27 @@ dx_value_get_float (struct disir_value *value, double *output_double)
 //! INTERNAL API
 enum disir_status
 dx_value_set_string (struct disir_value *value, const char *input, int32_t size)
+{
+    return dx_value_set_string_arena (NULL, value, input, size);
+}
+
+//! INTERNAL API
+void
+dx_value_free_string (struct disir_value *value)
+{
+    if (value->dv_string != NULL && value->dv_arena == 0)
+    {
+        free (value->dv_string);
+    }
+    value->dv_string = NULL;
+    value->dv_size = 0;
+    value->dv_arena = 0;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_value_set_string_arena (struct disir_arena *arena, struct disir_value *value,
+                           const char *input, int32_t size)
 {
     if (value == NULL)
     {
@@ -434,32 +456,30 @@ dx_value_set_string (struct disir_value *value, const char *input, int32_t size)
     }
     if (input == NULL)
     {
-        if (value->dv_size > 0)
-        {
-            free (value->dv_string);
-        }
-        value->dv_size = 0;
-        value->dv_string = NULL;
+        dx_value_free_string (value);
         return DISIR_STATUS_OK;
     }
 
-    if (value->dv_string == NULL || value->dv_size - 1 < size)
+    // The existing buffer holds dv_size bytes plus the NULL terminator.
+    if (value->dv_string == NULL || value->dv_size < size)
     {
-        // Just free the existing memory. We allocate a larger one below
-        if (value->dv_size - 1 < size)
+        // Hand the existing memory back to the arena for reuse, or just free it.
+        // We allocate a larger one below
+        if (value->dv_string != NULL && value->dv_arena == DX_VALUE_ARENA && arena != NULL)
         {
-            free (value->dv_string);
-            value->dv_string = NULL;
+            dx_arena_release (arena, value->dv_string, value->dv_size + 1);
         }
+        dx_value_free_string (value);
 
         // Size of requested string + 1 for NULL terminator
-        value->dv_string = calloc (1, size + 1);
+        value->dv_string = dx_arena_calloc (arena, size + 1);
         if (value->dv_string == NULL)
         {
             log_error ("failed to allocate sufficient memory for value string (%d)",
                        size + 1);
             return DISIR_STATUS_NO_MEMORY;
         }
+        value->dv_arena = (arena != NULL ? DX_VALUE_ARENA : 0);
     }
 
     // Copy the incoming docstring to freely available space
@@ -18,6 +18,29 @@
 #include "restriction.h"
 
 
+//! Forward declarations - validating children recurses through them.
+static enum disir_status validate_context (struct disir_context *context, int incremental);
+static enum disir_status validate_children (struct disir_context *context, int incremental);
+
+//! STATIC API
+//!
+//! Return the number of elements in parent stored by name.
+//! Counted straight from the element storage, without collecting the elements.
+//!
+static int
+validate_entries_count (struct disir_context *parent, const char *name)
+{
+    switch (dc_context_type (parent))
+    {
+    case DISIR_CONTEXT_CONFIG:
+        return dx_element_storage_count (parent->cx_config->cf_elements, name);
+    case DISIR_CONTEXT_SECTION:
+        return dx_element_storage_count (parent->cx_section->se_elements, name);
+    default:
+        return 0;
+    }
+}
+
 //! STATIC API
 //!
 //! Validate the children of context if they fulfill inclusive restrictions
@@ -33,8 +56,7 @@ validate_inclusive_restrictions (struct disir_context *context)
 {
     enum disir_status status ;
     enum disir_status invalid;
-    struct disir_collection *mold_collection;
-    struct disir_collection *config_elements;
+    struct disir_element_iter iter;
     const char *name;
     struct disir_context *element;
     struct disir_version *target_version = NULL;
@@ -46,7 +68,6 @@ validate_inclusive_restrictions (struct disir_context *context)
 
     invalid = DISIR_STATUS_OK;
     element = NULL;
-    mold_collection = NULL;
     name = NULL;
 
     if (dc_context_type(context->cx_root_context) != DISIR_CONTEXT_CONFIG)
@@ -60,10 +81,10 @@ validate_inclusive_restrictions (struct disir_context *context)
     switch (dc_context_type (context))
     {
     case DISIR_CONTEXT_CONFIG:
-        status = dc_get_elements (context->cx_config->cf_mold->mo_context, &mold_collection);
+        status = dc_element_iter_begin (context->cx_config->cf_mold->mo_context, NULL, &iter);
         break;
     case DISIR_CONTEXT_SECTION:
-        status = dc_get_elements (context->cx_section->se_mold_equiv, &mold_collection);
+        status = dc_element_iter_begin (context->cx_section->se_mold_equiv, NULL, &iter);
         break;
     default:
         log_fatal ("Invoked internal validate with incorrect context %s.",
@@ -81,12 +102,7 @@ validate_inclusive_restrictions (struct disir_context *context)
 
     do
     {
-        if (element)
-        {
-            dc_putcontext (&element);
-        }
-
-        status = dc_collection_next (mold_collection, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
@@ -98,21 +114,7 @@ validate_inclusive_restrictions (struct disir_context *context)
 
         // Query how many elements in config there are of element.name
         dc_get_name (element, &name, NULL);
-        status = dc_find_elements (context, name, &config_elements);
-        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_NOT_EXIST)
-        {
-            break;
-        }
-        if (status == DISIR_STATUS_OK)
-        {
-            size = dc_collection_size (config_elements);
-            dc_collection_finished (&config_elements);
-        }
-        else
-        {
-            // No entries
-            size = 0;
-        }
+        size = validate_entries_count (context, name);
 
         // find maximum/minimum number required.
         dx_restriction_entries_value (element, DISIR_RESTRICTION_INC_ENTRY_MIN,
@@ -156,10 +158,6 @@ validate_inclusive_restrictions (struct disir_context *context)
             invalid = DISIR_STATUS_RESTRICTION_VIOLATED;
         }
     } while (1);
-    if (mold_collection)
-    {
-        dc_collection_finished (&mold_collection);
-    }
 
     return (status == DISIR_STATUS_OK ? invalid : status);
 }
@@ -228,10 +226,8 @@ validate_finalized_parent_constructing_child_violating_max_restriction (struct d
 {
     int max;
     int current_entries_count;
-    struct disir_collection *collection;
     char *name;
 
-    collection = NULL;
     max = 0;
     current_entries_count  = 0;
 
@@ -263,12 +259,7 @@ validate_finalized_parent_constructing_child_violating_max_restriction (struct d
 
     // Query all entries in parent with our name. Check if it is exhausted.
     dx_restriction_entries_value (child, DISIR_RESTRICTION_INC_ENTRY_MAX, NULL, &max);
-    dc_find_elements (child->cx_parent_context, name, &collection);
-    if (collection)
-    {
-        current_entries_count = dc_collection_size (collection);
-        dc_collection_finished (&collection);
-    }
+    current_entries_count = validate_entries_count (child->cx_parent_context, name);
 
     if (max != 0 && max <= current_entries_count)
     {
@@ -282,27 +273,64 @@ validate_finalized_parent_constructing_child_violating_max_restriction (struct d
 
 //! STATIC API
 //!
+//! Re-validate the dirty elements of a context that is not dirty itself.
+//! The state of context itself is kept as it was last validated.
+//!
+//! \return DISIR_STATUS_INVALID_CONTEXT if context is invalid.
+//! \return DISIR_STATUS_ELEMENTS_INVALID if any of context' children are not valid.
+//! \return DISIR_STATUS_OK if neither context nor its children are invalid.
+//!
+static enum disir_status
+validate_dirty_elements (struct disir_context *context)
+{
+    enum disir_status status;
+
+    if (context->CONTEXT_STATE_DIRTY_ELEMENTS)
+    {
+        status = validate_children (context, 1);
+        if (status != DISIR_STATUS_OK && status != DISIR_STATUS_ELEMENTS_INVALID)
+        {
+            return status;
+        }
+        context->CONTEXT_STATE_DIRTY_ELEMENTS = 0;
+    }
+
+    if (context->CONTEXT_STATE_INVALID)
+    {
+        return DISIR_STATUS_INVALID_CONTEXT;
+    }
+    if (context->CONTEXT_STATE_ELEMENTS_INVALID)
+    {
+        return DISIR_STATUS_ELEMENTS_INVALID;
+    }
+
+    return DISIR_STATUS_OK;
+}
+
+//! STATIC API
+//!
+//! If incremental, children not marked dirty are not validated again.
+//! Their state from when they were last validated is used instead.
+//!
 //! \return DISIR_STATUS_ELEMENTS_INVALID if any of context' children are not valid.
 //! \return DISIR_STATUS_OK when all children are valid.
 //!
 static enum disir_status
-validate_children (struct disir_context *context)
+validate_children (struct disir_context *context, int incremental)
 {
     enum disir_status status;
     enum disir_status status_validate;
     enum disir_status invalid;
     struct disir_context *element;
-    struct disir_collection *collection;
+    struct disir_element_iter iter;
 
     invalid = DISIR_STATUS_OK;
     status_validate = DISIR_STATUS_OK;
-    element = NULL;
-    collection = NULL;
 
     log_debug_context(2, context, "validating children");
 
     // Invoke recursively on children
-    status = dc_get_elements (context, &collection);
+    status = dc_element_iter_begin (context, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         log_debug (2, "validating children failed to retrieve elements with status: %s",
@@ -312,14 +340,6 @@ validate_children (struct disir_context *context)
 
     do
     {
-        // Put back the element resource from last iteration
-        if (element)
-        {
-            status = dc_putcontext (&element);
-            if (status != DISIR_STATUS_OK)
-                break;
-        }
-
         // XXX: What if the last context was finalized? We should still validate, shant we?
         // Break out if a serious error occurred in last iteration
         if (status_validate != DISIR_STATUS_OK
@@ -338,7 +358,7 @@ validate_children (struct disir_context *context)
             break;
         }
 
-        status = dc_collection_next (collection, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
@@ -349,14 +369,21 @@ validate_children (struct disir_context *context)
             break;
         }
 
-        status_validate = dx_validate_context (element);
+        if (incremental && element->CONTEXT_STATE_DIRTY == 0)
+        {
+            status_validate = validate_dirty_elements (element);
+        }
+        else
+        {
+            status_validate = validate_context (element, incremental);
+        }
         // Only update invalid with either DISIR_STATUS_OK or the previous value of invalid.
         invalid = (status_validate != DISIR_STATUS_OK ? DISIR_STATUS_ELEMENTS_INVALID : invalid);
     } while (1);
 
-    if (collection)
+    if (status == DISIR_STATUS_OK)
     {
-        dc_collection_finished (&collection);
+        context->CONTEXT_STATE_ELEMENTS_INVALID = (invalid == DISIR_STATUS_ELEMENTS_INVALID);
     }
 
     return (status == DISIR_STATUS_OK ? invalid : status);
@@ -583,7 +610,7 @@ validate_name (struct disir_context *context)
 //! \return DISIR_STATUS_OK on success.
 //!
 static enum disir_status
-validate_context_validity (struct disir_context *context)
+validate_context_validity (struct disir_context *context, int incremental)
 {
     enum disir_status status;
     enum disir_status invalid;
@@ -614,7 +641,7 @@ validate_context_validity (struct disir_context *context)
         log_debug(2, "Validating MOLD for version %s",
                      dc_version_string(buffer, 50, &(context)->cx_mold->mo_version));
         // TODO: Clear error reports
-        status = validate_children (context);
+        status = validate_children (context, incremental);
         // Update invalid with new state, if non were already present.
         invalid = (invalid == DISIR_STATUS_OK ? status : invalid);
         // Clear ELEMENTS_INVALID status if present - its not a fatal error to proagate
@@ -664,7 +691,7 @@ validate_context_validity (struct disir_context *context)
             break;
         }
 
-        status = validate_children (context);
+        status = validate_children (context, incremental);
         // Update invalid with new state, if non were already present.
         invalid = (invalid == DISIR_STATUS_OK ? status : invalid);
         // Clear ELEMENTS_INVALID status if present - its not a fatal error to proagate
@@ -769,13 +796,13 @@ validate_context_validity (struct disir_context *context)
     return (status != DISIR_STATUS_OK ? status : invalid);
 }
 
-//! INTERNAL API
-enum disir_status
-dx_validate_context (struct disir_context *context)
+//! STATIC API
+static enum disir_status
+validate_context (struct disir_context *context, int incremental)
 {
     enum disir_status status;
 
-    TRACE_ENTER ("context %s", dc_context_type_string(context));
+    TRACE_ENTER ("context %s incremental %d", dc_context_type_string(context), incremental);
 
     if (context->CONTEXT_STATE_FATAL)
     {
@@ -797,12 +824,14 @@ dx_validate_context (struct disir_context *context)
 
     // XXX: This validity check may return any number of error conditions.
     // This is used to determine if finalization of calling context may be done.
-    status = validate_context_validity (context);
+    status = validate_context_validity (context, incremental);
 
     // If our parent context is finalized, and we get any sort of error, we mark invalid state
     // and return the original status back - we do not allow this context to be finalized
     // (which means that INVALID_CONTEXT is a terrible status on error conditions - should remove that)
-    if (context->cx_parent_context
+    // A finalized context being re-validated is already in its parent - the checks below apply.
+    if (context->CONTEXT_STATE_FINALIZED == 0
+        && context->cx_parent_context
         && context->cx_parent_context->CONTEXT_STATE_FINALIZED
         && status != DISIR_STATUS_OK)
     {
@@ -854,6 +883,38 @@ dx_validate_context (struct disir_context *context)
     }
 
 out:
+    // Every dirty descendant has been visited.
+    context->CONTEXT_STATE_DIRTY = 0;
+    context->CONTEXT_STATE_DIRTY_ELEMENTS = 0;
+
+    TRACE_EXIT ("%s", disir_status_string (status));
+    return status;
+}
+
+//! INTERNAL API
+enum disir_status
+dx_validate_context (struct disir_context *context)
+{
+    return validate_context (context, 0);
+}
+
+//! INTERNAL API
+enum disir_status
+dx_validate_dirty (struct disir_context *context)
+{
+    enum disir_status status;
+
+    TRACE_ENTER ("context %s", dc_context_type_string(context));
+
+    if (context->CONTEXT_STATE_DIRTY)
+    {
+        status = validate_context (context, 1);
+    }
+    else
+    {
+        status = validate_dirty_elements (context);
+    }
+
     TRACE_EXIT ("%s", disir_status_string (status));
     return status;
 }
@@ -864,7 +925,7 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
 {
     enum disir_status status;
     enum disir_status invalid;
-    struct disir_collection *col;
+    struct disir_element_iter iter;
     struct disir_context *element;
 
     invalid = (context->CONTEXT_STATE_INVALID == 1 ? DISIR_STATUS_INVALID_CONTEXT
@@ -879,7 +940,7 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
         }
     }
 
-    status = dc_get_elements (context, &col);
+    status = dc_element_iter_begin (context, NULL, &iter);
     if (status != DISIR_STATUS_OK)
     {
         log_error ("Failed to retrieve elements from context: %s",
@@ -888,18 +949,12 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
 
     while (status == DISIR_STATUS_OK)
     {
-        status = dc_collection_next (col, &element);
+        status = dc_element_iter_next (&iter, &element);
         if (status == DISIR_STATUS_EXHAUSTED)
         {
             status = DISIR_STATUS_OK;
             break;
         }
-        if (status != DISIR_STATUS_OK)
-        {
-            log_error ("Failed to retrieve element from collection: %s",
-                       disir_status_string (status));
-            break;
-        }
 
         status = dc_context_valid (element);
         if (status == DISIR_STATUS_INVALID_CONTEXT)
@@ -921,12 +976,9 @@ dx_invalid_elements (struct disir_context *context, struct disir_collection *col
             }
         }
 
-        dc_putcontext (&element);
         status = DISIR_STATUS_OK;
     }
 
-    dc_collection_finished (&col);
-
     return (status == DISIR_STATUS_OK ? invalid : status);
 }
 
@@ -0,0 +1,100 @@
+// external public includes
+#include <stdlib.h>
+
+// public disir interface
+#include <disir/disir.h>
+#include <disir/util.h>
+
+// private
+#include "version_index.h"
+
+
+//! A single indexed entry.
+struct version_index_entry
+{
+    struct disir_version        ve_introduced;
+    void                        *ve_entry;
+};
+
+struct disir_version_index
+{
+    struct version_index_entry  *vi_entries;
+    int32_t                     vi_count;
+};
+
+
+//! INTERNAL API
+struct disir_version_index *
+dx_version_index_create (int32_t count)
+{
+    struct disir_version_index *index;
+
+    if (count < 1)
+        return NULL;
+
+    index = calloc (1, sizeof (*index));
+    if (index == NULL)
+        return NULL;
+
+    index->vi_entries = calloc (count, sizeof (*index->vi_entries));
+    if (index->vi_entries == NULL)
+    {
+        free (index);
+        return NULL;
+    }
+    index->vi_count = count;
+
+    return index;
+}
+
+//! INTERNAL API
+void
+dx_version_index_destroy (struct disir_version_index **index)
+{
+    if (index == NULL || *index == NULL)
+        return;
+
+    free ((*index)->vi_entries);
+    free (*index);
+    *index = NULL;
+}
+
+//! INTERNAL API
+void
+dx_version_index_set (struct disir_version_index *index, int32_t i,
+                      struct disir_version *introduced, void *entry)
+{
+    index->vi_entries[i].ve_introduced = *introduced;
+    index->vi_entries[i].ve_entry = entry;
+}
+
+//! INTERNAL API
+void *
+dx_version_index_lookup (struct disir_version_index *index, struct disir_version *version)
+{
+    int32_t low;
+    int32_t high;
+    int32_t mid;
+
+    if (version == NULL)
+        return index->vi_entries[index->vi_count - 1].ve_entry;
+
+    // Find the first entry introduced after version.
+    low = 0;
+    high = index->vi_count;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (dc_version_compare (&index->vi_entries[mid].ve_introduced, version) > 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+
+    // The entry preceding it is active - or the first entry, if none precede it.
+    if (low > 0)
+        low--;
+
+    return index->vi_entries[low].ve_entry;
+}
+
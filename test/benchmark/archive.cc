@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+#include <disir/archive.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+#define ARCHIVE_BENCH_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/export_bench"
+#define ARCHIVE_BENCH_CONFIG_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/config/export_bench"
+#define ARCHIVE_BENCH_ARCHIVE_PATH CMAKE_BUILD_DIRECTORY "/export_bench.disir"
+
+//
+// Export a group holding a large number of json config entries to an archive,
+// import it again - either in its entirety, or a single entry of it - and
+// append a few more entries to it. ArchiveCodecBenchmark compares the
+// throughput and archive size of each codec, on a larger group.
+//
+
+class ArchiveBenchmark : public testing::DisirTestTestPlugin
+{
+protected:
+    void SetUp()
+    {
+        struct disir_mold *mold = NULL;
+        struct disir_config *config = NULL;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_mold_write (instance, "json", "export_bench/__namespace", mold);
+        disir_mold_finished (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (int i = 0; i < entries_count; i++)
+        {
+            names.push_back ("export_bench/entry_" + std::to_string (i));
+            status = disir_config_write (instance, "json", names.back ().c_str (), config);
+            if (status != DISIR_STATUS_OK)
+                break;
+        }
+        disir_config_finished (&config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        for (const auto& name : names)
+        {
+            std::string entry = name.substr (name.find ('/') + 1);
+            std::remove ((ARCHIVE_BENCH_CONFIG_DIRECTORY "/" + entry + ".json").c_str ());
+        }
+        std::remove (ARCHIVE_BENCH_MOLD_DIRECTORY "/__namespace.json");
+        rmdir (ARCHIVE_BENCH_CONFIG_DIRECTORY);
+        rmdir (ARCHIVE_BENCH_MOLD_DIRECTORY);
+        std::remove (ARCHIVE_BENCH_ARCHIVE_PATH);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    std::vector<std::string> names;
+    int entries_count = 1000;
+};
+
+class ArchiveCodecBenchmark : public ArchiveBenchmark
+{
+    void SetUp()
+    {
+        entries_count = 10000;
+        ArchiveBenchmark::SetUp ();
+    }
+};
+
+TEST_F (ArchiveBenchmark, append_group)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_archive *archive = NULL;
+
+    for (int round = 0; round < 3; round++)
+    {
+        disir_mold_cache_clear (instance);
+
+        benchmark::Stopwatch watch;
+        status = disir_archive_export_begin (instance, NULL, &archive);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_archive_append_group (instance, archive, "json");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+        benchmark::report ("archive export json group", watch.elapsed (), entries_count);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+}
+
+TEST_F (ArchiveBenchmark, import)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_archive *archive = NULL;
+    struct disir_import *import = NULL;
+    int entries;
+
+    status = disir_archive_export_begin (instance, NULL, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_group (instance, archive, "json");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (int round = 0; round < 3; round++)
+    {
+        benchmark::Stopwatch watch;
+        status = disir_archive_import (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &import, &entries);
+        benchmark::report ("archive import json group", watch.elapsed (), entries);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_GE (entries, (int) entries_count);
+
+        disir_import_finalize (instance, DISIR_IMPORT_DISCARD, &import, NULL);
+    }
+}
+
+TEST_F (ArchiveBenchmark, import_entry)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_archive *archive = NULL;
+    struct disir_archive_listing *listing = NULL;
+    struct disir_import *import = NULL;
+    int entries;
+
+    status = disir_archive_export_begin (instance, NULL, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_group (instance, archive, "json");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (int round = 0; round < 3; round++)
+    {
+        benchmark::Stopwatch watch;
+        status = disir_archive_list (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &listing);
+        benchmark::report ("archive list json group", watch.elapsed (), 1);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        entries = 0;
+        for (auto current = listing; current != NULL; current = current->next)
+        {
+            entries++;
+        }
+        disir_archive_listing_finished (&listing);
+        EXPECT_GE (entries, (int) entries_count);
+    }
+
+    for (int round = 0; round < 3; round++)
+    {
+        benchmark::Stopwatch watch;
+        status = disir_archive_import_entry (instance, ARCHIVE_BENCH_ARCHIVE_PATH,
+                                             "json", names[entries_count / 2].c_str (),
+                                             &import);
+        benchmark::report ("archive import single json entry", watch.elapsed (), 1);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        disir_import_finalize (instance, DISIR_IMPORT_DISCARD, &import, NULL);
+    }
+}
+
+TEST_F (ArchiveBenchmark, append_entries)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_archive *archive = NULL;
+    struct disir_config *config = NULL;
+
+    status = disir_archive_export_begin (instance, NULL, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_group (instance, archive, "json");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (int round = 0; round < 3; round++)
+    {
+        std::vector<std::string> appended;
+        for (int i = 0; i < 3; i++)
+        {
+            names.push_back ("export_bench/appended_" + std::to_string (round * 3 + i));
+            appended.push_back (names.back ());
+            status = disir_config_write (instance, "json", names.back ().c_str (), config);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        benchmark::Stopwatch watch;
+        status = disir_archive_export_begin (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (const auto& name : appended)
+        {
+            status = disir_archive_append_entry (instance, archive, "json", name.c_str ());
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+        status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+        benchmark::report ("archive append 3 json entries", watch.elapsed (), 3);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    disir_config_finished (&config);
+}
+
+TEST_F (ArchiveCodecBenchmark, export_codecs)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    struct disir_archive *archive = NULL;
+    struct stat st;
+    const std::vector<std::pair<std::string, enum disir_archive_codec>> codecs = {
+        { "xz", DISIR_ARCHIVE_CODEC_XZ },
+        { "zstd", DISIR_ARCHIVE_CODEC_ZSTD },
+        { "gzip", DISIR_ARCHIVE_CODEC_GZIP },
+        { "none", DISIR_ARCHIVE_CODEC_NONE },
+    };
+
+    for (const auto& codec : codecs)
+    {
+        for (int round = 0; round < 3; round++)
+        {
+            disir_mold_cache_clear (instance);
+            std::remove (ARCHIVE_BENCH_ARCHIVE_PATH);
+
+            benchmark::Stopwatch watch;
+            status = disir_archive_export_begin_codec (instance, NULL, codec.second,
+                                                       DISIR_ARCHIVE_LEVEL_DEFAULT, &archive);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = disir_archive_append_group (instance, archive, "json");
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+            status = disir_archive_finalize (instance, ARCHIVE_BENCH_ARCHIVE_PATH, &archive);
+            benchmark::report ("archive export json group (" + codec.first + ")",
+                               watch.elapsed (), entries_count);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        ASSERT_EQ (0, stat (ARCHIVE_BENCH_ARCHIVE_PATH, &st));
+        benchmark::report_size ("archive size (" + codec.first + ")", st.st_size);
+    }
+}
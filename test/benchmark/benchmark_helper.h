@@ -0,0 +1,52 @@
+#ifndef _LIBDISIR_BENCHMARK_HELPER_H
+#define _LIBDISIR_BENCHMARK_HELPER_H
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace benchmark
+{
+    //! Wall-clock stopwatch, started upon construction.
+    class Stopwatch
+    {
+    public:
+        Stopwatch () : m_start (std::chrono::steady_clock::now ()) {}
+
+        void restart () { m_start = std::chrono::steady_clock::now (); }
+
+        //! Seconds elapsed since construction or last restart.
+        double elapsed () const
+        {
+            std::chrono::duration<double> d = std::chrono::steady_clock::now () - m_start;
+            return d.count ();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    //! Print a single benchmark result line: operations per second and nanoseconds per operation.
+    inline void
+    report (const std::string& name, double seconds, long operations)
+    {
+        std::cout << "[ BENCH    ] " << std::left << std::setw (48) << name
+                  << std::right << std::setw (14) << std::fixed << std::setprecision (0)
+                  << (seconds > 0 ? operations / seconds : 0) << " ops/s"
+                  << std::setw (10) << std::setprecision (1)
+                  << (operations > 0 ? (seconds * 1e9) / operations : 0) << " ns/op"
+                  << std::endl;
+    }
+
+    //! Print a single size result line, in kibibytes.
+    inline void
+    report_size (const std::string& name, long bytes)
+    {
+        std::cout << "[ BENCH    ] " << std::left << std::setw (48) << name
+                  << std::right << std::setw (14) << std::fixed << std::setprecision (1)
+                  << bytes / 1024.0 << " KiB" << std::endl;
+    }
+}
+
+#endif // _LIBDISIR_BENCHMARK_HELPER_H
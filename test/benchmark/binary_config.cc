@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/fslib/json.h>
+#include <disir/fslib/binary.h>
+#include <disir/fslib/util.h>
+
+// PRIVATE API
+#include "binary/binary_format.h"
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Write and read a large generated config as json and as a binary image.
+// The binary image is read lazily, either without touching any element,
+// or looking up a few keyvals. The eager decoding is measured by reading
+// the image with a mold version it was not written with.
+//
+
+class BinaryConfigBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_section = NULL;
+        int i, j;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < sections; i++)
+        {
+            std::string name = "section_" + std::to_string (i);
+            status = dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_section, name.c_str (), name.size ());
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 0; j < keyvals; j += 2)
+            {
+                std::string key = "key_" + std::to_string (j);
+                status = dc_add_keyval_string (context_section, key.c_str (),
+                                               "a moderately long string value", "doc",
+                                               NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                key = "key_" + std::to_string (j + 1);
+                status = dc_add_keyval_integer (context_section, key.c_str (), j, "doc",
+                                                NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            status = dc_finalize (&context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        json = write (dio_json_serialize_config);
+        image = write (dio_binary_serialize_config);
+    }
+
+    void TearDown()
+    {
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    std::string write (dio_serialize_config serialize)
+    {
+        std::string output;
+        FILE *file;
+        long size;
+
+        file = tmpfile ();
+        EXPECT_TRUE (file != NULL);
+        status = serialize (instance, config, file);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+        size = ftell (file);
+        output.resize (size);
+        fseek (file, 0, SEEK_SET);
+        EXPECT_EQ (1, fread (&output[0], size, 1, file));
+        fclose (file);
+        return output;
+    }
+
+    void read (const std::string& label, const std::string& data,
+               dio_unserialize_config_span unserialize, int lookups)
+    {
+        benchmark::Stopwatch watch;
+        struct disir_config *parsed;
+        const char *value;
+        int i, j;
+
+        watch.restart ();
+        for (i = 0; i < reads; i++)
+        {
+            status = unserialize (instance, data.data (), data.size (), mold, &parsed);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 0; j < lookups; j++)
+            {
+                status = disir_config_get_keyval_string (parsed, &value, "section_%d.key_%d",
+                                                         (j * 7) % sections, (j * 2) % keyvals);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            disir_config_finished (&parsed);
+        }
+        benchmark::report ("config read " + label, watch.elapsed (), reads);
+    }
+
+public:
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    std::string json;
+    std::string image;
+    static const int sections = 250;
+    static const int keyvals = 200;
+    static const int reads = 3;
+};
+
+TEST_F (BinaryConfigBenchmark, write)
+{
+    benchmark::Stopwatch watch;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    std::cout << "[ BENCH    ] json size: " << json.size () / 1024 << " KiB, binary size: "
+              << image.size () / 1024 << " KiB" << std::endl;
+
+    watch.restart ();
+    for (i = 0; i < reads; i++)
+    {
+        write (dio_json_serialize_config);
+    }
+    benchmark::report ("config write (json)", watch.elapsed (), reads);
+
+    watch.restart ();
+    for (i = 0; i < reads; i++)
+    {
+        write (dio_binary_serialize_config);
+    }
+    benchmark::report ("config write (binary)", watch.elapsed (), reads);
+}
+
+TEST_F (BinaryConfigBenchmark, read)
+{
+    struct binary_config_header *header;
+    std::string eager;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    // Touch 5% of the keyvals after reading.
+    const int lookups = sections * keyvals / 20;
+
+    read ("(json)", json, dio_json_unserialize_config_span, 0);
+    read ("(binary lazy)", image, dio_binary_unserialize_config_span, 0);
+    read ("(json, 5% lookups)", json, dio_json_unserialize_config_span, lookups);
+    read ("(binary lazy, 5% lookups)", image, dio_binary_unserialize_config_span, lookups);
+
+    eager = image;
+    header = (struct binary_config_header *) &eager[0];
+    header->bh_mold_version_minor += 1;
+    read ("(binary eager)", eager, dio_binary_unserialize_config_span, 0);
+}
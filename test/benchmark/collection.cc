@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// PRIVATE API
+extern "C" {
+#include "collection.h"
+}
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Iterate large collections with dc_collection_next.
+// Compare iterating without destroyed contexts against coalescing on every step.
+//
+
+class CollectionBenchmark : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        struct disir_context *context;
+        int i;
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        collection = dc_collection_create ();
+        ASSERT_TRUE (collection != NULL);
+
+        for (i = 0; i < entries; i++)
+        {
+            status = dc_begin (context_mold, DISIR_CONTEXT_KEYVAL, &context);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_collection_push_context (collection, context);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            contexts.push_back (context);
+        }
+    }
+
+    void TearDown()
+    {
+        for (auto context : contexts)
+        {
+            dc_destroy (&context);
+        }
+        if (collection)
+        {
+            dc_collection_finished (&collection);
+        }
+        if (context_mold)
+        {
+            dc_destroy (&context_mold);
+        }
+    }
+
+public:
+    //! Iterate count entries of the collection from the start.
+    //! Force a coalesce before every step if coalesce is set.
+    void iterate (int count, bool coalesce)
+    {
+        struct disir_context *context;
+        int i;
+
+        dc_collection_reset (collection);
+        for (i = 0; i < count; i++)
+        {
+            if (coalesce)
+            {
+                collection->cc_generation = 0;
+            }
+            status = dc_collection_next (collection, &context);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            dc_putcontext (&context);
+        }
+    }
+
+public:
+    enum disir_status status;
+    struct disir_context *context_mold = NULL;
+    struct disir_collection *collection = NULL;
+    std::vector<struct disir_context *> contexts;
+    static const int entries = 100000;
+};
+
+TEST_F (CollectionBenchmark, iterate)
+{
+    benchmark::Stopwatch watch;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    watch.restart ();
+    iterate (entries, false);
+    benchmark::report ("dc_collection_next 100k entries", watch.elapsed (), entries);
+
+    // Every step scans the whole collection - only iterate a part of it.
+    watch.restart ();
+    iterate (entries / 100, true);
+    benchmark::report ("dc_collection_next 100k entries, coalesce every step",
+                       watch.elapsed (), entries / 100);
+}
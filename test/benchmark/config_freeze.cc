@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Read a frozen config snapshot concurrently from an increasing number of threads.
+// With no shared state mutated on read, throughput shall scale with the thread count.
+//
+
+class ConfigFreezeBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_freeze (config, &snapshot);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        if (snapshot)
+        {
+            disir_config_finished (&snapshot);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    struct disir_config *config = NULL;
+    struct disir_config *snapshot = NULL;
+    const std::vector<const char *> queries = {
+        "first.key_string", "first@0.key_string", "first@1.key_string",
+    };
+    static const int rounds = 20000;
+};
+
+TEST_F (ConfigFreezeBenchmark, get_keyval_string_threads)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    for (int numthreads : {1, 2, 4, 8})
+    {
+        benchmark::Stopwatch watch;
+        std::vector<std::thread> threads;
+        std::vector<int> failures (numthreads, 0);
+
+        watch.restart ();
+        for (int i = 0; i < numthreads; i++)
+        {
+            threads.emplace_back ([this, i, &failures] ()
+            {
+                const char *value;
+                for (int round = 0; round < rounds; round++)
+                {
+                    for (auto query : queries)
+                    {
+                        if (disir_config_get_keyval_string (snapshot, &value, query)
+                            != DISIR_STATUS_OK)
+                        {
+                            failures[i]++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join ();
+        }
+
+        std::string name = "get_keyval_string snapshot " + std::to_string (numthreads)
+                           + " thread(s)";
+        benchmark::report (name, watch.elapsed (),
+                           (long) numthreads * rounds * queries.size ());
+
+        for (auto failed : failures)
+        {
+            ASSERT_EQ (0, failed);
+        }
+    }
+}
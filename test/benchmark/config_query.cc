@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Compare reading keyvals through a query string, parsed on every call,
+// against reading them through a compiled query.
+//
+
+class ConfigQueryBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        for (auto query : compiled)
+        {
+            disir_query_finished (&query);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    struct disir_config *config = NULL;
+    std::vector<struct disir_query *> compiled;
+    const std::vector<const char *> queries = {
+        "first.key_string", "first@0.key_string", "first@1.key_string",
+    };
+    static const int rounds = 20000;
+};
+
+TEST_F (ConfigQueryBenchmark, get_keyval_string)
+{
+    benchmark::Stopwatch watch;
+    const char *value;
+    int round;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    for (auto query : queries)
+    {
+        struct disir_query *q = NULL;
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&q, "%s", query));
+        compiled.push_back (q);
+    }
+
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        for (auto query : queries)
+        {
+            status = disir_config_get_keyval_string (config, &value, query);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+    }
+    benchmark::report ("get_keyval_string query string", watch.elapsed (),
+                       (long) rounds * queries.size ());
+
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        for (auto query : compiled)
+        {
+            status = disir_config_get_keyval_string_compiled (config, &value, query);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+    }
+    benchmark::report ("get_keyval_string compiled", watch.elapsed (),
+                       (long) rounds * compiled.size ());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+#define READ_MANY_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/read_many_bench"
+#define READ_MANY_CONFIG_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/config/read_many_bench"
+
+//
+// Read a group of json config entries sharing a namespace mold
+// with disir_config_read_many, using an increasing number of threads.
+//
+
+class ConfigReadManyBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_mold *mold = NULL;
+        struct disir_config *config = NULL;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_mold_write (instance, "json", "read_many_bench/__namespace", mold);
+        disir_mold_finished (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (int i = 0; i < entries_count; i++)
+        {
+            names.push_back ("read_many_bench/entry_" + std::to_string (i));
+            status = disir_config_write (instance, "json", names.back ().c_str (), config);
+            if (status != DISIR_STATUS_OK)
+                break;
+        }
+        disir_config_finished (&config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        for (const auto& name : names)
+        {
+            std::string entry = name.substr (name.find ('/') + 1);
+            std::remove ((READ_MANY_CONFIG_DIRECTORY "/" + entry + ".json").c_str ());
+        }
+        std::remove (READ_MANY_MOLD_DIRECTORY "/__namespace.json");
+        rmdir (READ_MANY_CONFIG_DIRECTORY);
+        rmdir (READ_MANY_MOLD_DIRECTORY);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    std::vector<std::string> names;
+    static const int entries_count = 500;
+};
+
+TEST_F (ConfigReadManyBenchmark, read_many_threads)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    std::vector<const char *> entries;
+    for (const auto& name : names)
+    {
+        entries.push_back (name.c_str ());
+    }
+
+    for (int numthreads : {1, 2, 4, 8})
+    {
+        std::vector<struct disir_config *> configs (entries.size (), NULL);
+        std::vector<enum disir_status> statuses (entries.size (), DISIR_STATUS_OK);
+
+        disir_mold_cache_clear (instance);
+
+        benchmark::Stopwatch watch;
+        status = disir_config_read_many (instance, "json", entries.data (), entries.size (),
+                                         configs.data (), statuses.data (), numthreads);
+        benchmark::report ("config_read_many json " + std::to_string (numthreads)
+                           + " thread(s)", watch.elapsed (), entries.size ());
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        for (size_t i = 0; i < entries.size (); i++)
+        {
+            EXPECT_STATUS (DISIR_STATUS_OK, statuses[i]);
+            disir_config_finished (&configs[i]);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Walk the children of a large mold.
+// Compare the borrowed element iterator against the refcounted collection from dc_get_elements.
+//
+
+class ElementIterBenchmark : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        int i;
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        for (i = 0; i < entries; i++)
+        {
+            std::string name = "key_" + std::to_string (i);
+            status = dc_add_keyval_integer (context_mold, name.c_str (), i, "doc", NULL, NULL);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+    }
+
+    void TearDown()
+    {
+        if (context_mold)
+        {
+            dc_destroy (&context_mold);
+        }
+    }
+
+public:
+    enum disir_status status;
+    struct disir_context *context_mold = NULL;
+    static const int entries = 100000;
+    static const int walks = 20;
+};
+
+TEST_F (ElementIterBenchmark, walk_children)
+{
+    benchmark::Stopwatch watch;
+    struct disir_collection *collection;
+    struct disir_element_iter iter;
+    struct disir_context *context;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    watch.restart ();
+    for (i = 0; i < walks; i++)
+    {
+        status = dc_get_elements (context_mold, &collection);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        while (dc_collection_next (collection, &context) != DISIR_STATUS_EXHAUSTED)
+        {
+            dc_putcontext (&context);
+        }
+        dc_collection_finished (&collection);
+    }
+    benchmark::report ("dc_get_elements walk 100k children", watch.elapsed (), walks * entries);
+
+    watch.restart ();
+    for (i = 0; i < walks; i++)
+    {
+        status = dc_element_iter_begin (context_mold, NULL, &iter);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        while (dc_element_iter_next (&iter, &context) != DISIR_STATUS_EXHAUSTED)
+        {
+            // Borrowed - nothing to put back.
+        }
+    }
+    benchmark::report ("dc_element_iter walk 100k children", watch.elapsed (), walks * entries);
+}
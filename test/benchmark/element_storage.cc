@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <string.h>
+
+// PRIVATE API
+extern "C" {
+#include "disir_private.h"
+#include "context_private.h"
+#include "element_storage.h"
+#include "multimap.h"
+}
+#include <list.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Compare the element storage against the multimap + list pair it replaced.
+// The baseline below mirrors the previous implementation of
+// dx_element_storage_add, dx_element_storage_get_first and dx_element_storage_get_all.
+//
+
+static unsigned long
+baseline_djb2 (const char *str)
+{
+    unsigned long hash = 5381;
+    char c;
+    while ((c = *str++))
+    {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+struct baseline_storage
+{
+    struct multimap *map;
+    struct list *list;
+};
+
+static void
+baseline_add (struct baseline_storage *storage, const char *name, struct disir_context *context)
+{
+    char *key = NULL;
+    int keys_in_map;
+
+    keys_in_map = multimap_contains_key (storage->map, name);
+    if (keys_in_map == 0)
+    {
+        key = strdup (name);
+    }
+    multimap_push_value (storage->map, (keys_in_map ? name : key), context);
+    list_rpush (storage->list, context);
+    dx_context_incref (context);
+}
+
+static void
+baseline_destroy (struct baseline_storage *storage, std::vector<struct disir_context *>& contexts)
+{
+    list_destroy (&storage->list);
+    multimap_destroy (storage->map, free, NULL);
+    for (auto context : contexts)
+    {
+        dx_context_decref (&context);
+    }
+}
+
+class ElementStorageBenchmark : public testing::DisirTestWrapper,
+                                public testing::WithParamInterface<int>
+{
+protected:
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter();
+
+        int i;
+        char name[64];
+
+        for (i = 0; i < GetParam (); i++)
+        {
+            snprintf (name, 64, "keyval_name_%d", i);
+            names.push_back (name);
+            contexts.push_back (dx_context_create (DISIR_CONTEXT_KEYVAL));
+        }
+    }
+
+    void TearDown()
+    {
+        for (auto context : contexts)
+        {
+            dx_context_destroy (&context);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+    std::string label (const char *operation, const char *implementation)
+    {
+        return std::string (operation) + " " + implementation + " (n=" +
+               std::to_string (GetParam ()) + ")";
+    }
+
+public:
+    std::vector<std::string> names;
+    std::vector<struct disir_context *> contexts;
+    static const int rounds = 50;
+};
+
+TEST_P (ElementStorageBenchmark, insert_lookup_iterate)
+{
+    struct disir_element_storage *storage;
+    struct disir_collection *collection;
+    struct baseline_storage baseline;
+    struct disir_context *context;
+    benchmark::Stopwatch watch;
+    double seconds;
+    uint64_t generation = 0;
+    int round;
+    size_t i;
+
+    // Insert - element storage
+    seconds = 0;
+    storage = NULL;
+    for (round = 0; round < rounds; round++)
+    {
+        storage = dx_element_storage_create (&generation);
+        watch.restart ();
+        for (i = 0; i < names.size (); i++)
+        {
+            dx_element_storage_add (storage, names[i].c_str (), contexts[i]);
+        }
+        seconds += watch.elapsed ();
+        if (round != rounds - 1)
+        {
+            // Release the references held by the storage without destroying the contexts
+            for (i = 0; i < names.size (); i++)
+                dx_element_storage_remove (storage, names[i].c_str (), contexts[i]);
+            dx_element_storage_destroy (&storage);
+        }
+    }
+    benchmark::report (label ("insert", "element_storage"), seconds, rounds * names.size ());
+
+    // Insert - baseline
+    seconds = 0;
+    for (round = 0; round < rounds; round++)
+    {
+        baseline.map = multimap_create ((int (*)(const void *, const void*)) strcmp,
+                                        (unsigned long (*)(const void*)) baseline_djb2);
+        baseline.list = list_create ();
+        watch.restart ();
+        for (i = 0; i < names.size (); i++)
+        {
+            baseline_add (&baseline, names[i].c_str (), contexts[i]);
+        }
+        seconds += watch.elapsed ();
+        if (round != rounds - 1)
+        {
+            baseline_destroy (&baseline, contexts);
+        }
+    }
+    benchmark::report (label ("insert", "multimap+list"), seconds, rounds * names.size ());
+
+    // Lookup - element storage
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < names.size (); i++)
+        {
+            dx_element_storage_get_first (storage, names[i].c_str (), &context);
+            ASSERT_EQ (contexts[i], context);
+        }
+    }
+    benchmark::report (label ("lookup", "element_storage"), watch.elapsed (),
+                       rounds * names.size ());
+
+    // Lookup - baseline
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < names.size (); i++)
+        {
+            context = (struct disir_context *) multimap_get_first (baseline.map,
+                                                                  names[i].c_str ());
+            ASSERT_EQ (contexts[i], context);
+        }
+    }
+    benchmark::report (label ("lookup", "multimap+list"), watch.elapsed (),
+                       rounds * names.size ());
+
+    // Iterate - element storage
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        dx_element_storage_get_all (storage, &collection);
+        while (dx_collection_next_noncoalesce (collection, &context) == DISIR_STATUS_OK)
+        {
+            dx_context_decref (&context);
+        }
+        dc_collection_finished (&collection);
+    }
+    benchmark::report (label ("iterate", "element_storage"), watch.elapsed (),
+                       rounds * names.size ());
+
+    // Iterate - baseline
+    watch.restart ();
+    for (round = 0; round < rounds; round++)
+    {
+        list_iterator_t *iter = list_iterator_create (baseline.list, LIST_HEAD);
+        collection = dc_collection_create ();
+        while ((context = (struct disir_context *) list_iterator_next (iter)))
+        {
+            dc_collection_push_context (collection, context);
+        }
+        list_iterator_destroy (&iter);
+        while (dx_collection_next_noncoalesce (collection, &context) == DISIR_STATUS_OK)
+        {
+            dx_context_decref (&context);
+        }
+        dc_collection_finished (&collection);
+    }
+    benchmark::report (label ("iterate", "multimap+list"), watch.elapsed (),
+                       rounds * names.size ());
+
+    for (i = 0; i < names.size (); i++)
+        dx_element_storage_remove (storage, names[i].c_str (), contexts[i]);
+    dx_element_storage_destroy (&storage);
+    baseline_destroy (&baseline, contexts);
+}
+
+INSTANTIATE_TEST_CASE_P (StorageSize, ElementStorageBenchmark,
+                         ::testing::Values (10, 1000, 10000));
+
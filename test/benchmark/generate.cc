@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <string.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// PRIVATE API
+extern "C" {
+#include "context_private.h"
+#include "keyval.h"
+}
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Look up defaults, and generate configs, at arbitrary versions from a large mold
+// whose keyvals hold many versioned default entries.
+// Compare the version indexed defaults against walking the default queue.
+//
+
+class GenerateBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_keyval = NULL;
+        struct disir_version version;
+        int i, j;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < keyvals; i++)
+        {
+            std::string name = "key_" + std::to_string (i);
+            status = dc_add_keyval_integer (context_mold, name.c_str (), 0, "doc",
+                                            NULL, &context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 2; j <= defaults; j++)
+            {
+                version.sv_major = j;
+                version.sv_minor = 0;
+                status = dc_add_default_integer (context_keyval, j, &version);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            contexts.push_back (context_keyval);
+        }
+        version.sv_major = defaults;
+        version.sv_minor = 0;
+        status = dc_set_version (context_mold, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        for (auto context : contexts)
+        {
+            dc_putcontext (&context);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    void generate (const std::string& label)
+    {
+        benchmark::Stopwatch watch;
+        struct disir_config *config;
+        struct disir_version version;
+        char buffer[32];
+        int32_t size;
+        int i;
+
+        watch.restart ();
+        for (i = 0; i < keyvals * 10; i++)
+        {
+            version.sv_major = 1 + (i * 7) % defaults;
+            version.sv_minor = 0;
+            status = dc_get_default (contexts[i % keyvals], &version, sizeof (buffer), buffer, &size);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        benchmark::report ("dc_get_default " + label, watch.elapsed (), keyvals * 10);
+
+        watch.restart ();
+        for (i = 0; i < configs; i++)
+        {
+            version.sv_major = 1 + (i * 7) % defaults;
+            version.sv_minor = 0;
+            status = disir_generate_config_from_mold (mold, &version, &config);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            disir_config_finished (&config);
+        }
+        benchmark::report ("generate_config_from_mold " + label, watch.elapsed (), configs);
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    std::vector<struct disir_context *> contexts;
+    static const int keyvals = 5000;
+    static const int defaults = 50;
+    static const int configs = 5;
+};
+
+TEST_F (GenerateBenchmark, generate_at_version)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    generate ("(version index)");
+
+    // Release the default indexes; defaults are found by walking the default queue.
+    for (auto context : contexts)
+    {
+        dx_version_index_destroy (&context->cx_keyval->kv_default_index);
+    }
+
+    generate ("(default queue)");
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/fslib/json.h>
+#include <disir/fslib/util.h>
+
+// PRIVATE API
+#include "json/json_serialize.h"
+#include "json/json_unserialize.h"
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Read a large generated json config, with the streaming reader
+// and with the reader parsing the document into a Json::Value DOM first.
+// Read it from a file as well, through a FILE and as a single span.
+//
+
+class JsonConfigReadBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_section = NULL;
+        struct disir_config *config = NULL;
+        int i, j;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < sections; i++)
+        {
+            std::string name = "section_" + std::to_string (i);
+            status = dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_section, name.c_str (), name.size ());
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 0; j < keyvals; j += 3)
+            {
+                std::string key = "key_" + std::to_string (j);
+                status = dc_add_keyval_string (context_section, key.c_str (),
+                                               "a moderately long string value", "doc",
+                                               NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                key = "key_" + std::to_string (j + 1);
+                status = dc_add_keyval_integer (context_section, key.c_str (), j, "doc",
+                                                NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                key = "key_" + std::to_string (j + 2);
+                status = dc_add_keyval_float (context_section, key.c_str (), j / 3.0, "doc",
+                                              NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            status = dc_finalize (&context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        dio::ConfigWriter writer (instance);
+        status = writer.serialize (config, document);
+        disir_config_finished (&config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    void read (const std::string& label, bool streaming)
+    {
+        benchmark::Stopwatch watch;
+        struct disir_config *config;
+        std::stringstream stream;
+        int i;
+
+        dio::ConfigReader reader (instance, mold);
+        reader.m_streaming = streaming;
+
+        watch.restart ();
+        for (i = 0; i < reads; i++)
+        {
+            stream.str (document);
+            stream.clear ();
+            status = reader.unserialize (&config, stream);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            disir_config_finished (&config);
+        }
+        benchmark::report ("json config read " + label, watch.elapsed (), reads);
+        benchmark::report ("json config read " + label + " (per keyval)", watch.elapsed (),
+                           (long) reads * sections * keyvals);
+    }
+
+public:
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    std::string document;
+    static const int sections = 200;
+    static const int keyvals = 150;
+    static const int reads = 5;
+};
+
+TEST_F (JsonConfigReadBenchmark, read)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    std::cout << "[ BENCH    ] document size: " << document.size () / 1024 << " KiB" << std::endl;
+
+    read ("(streaming)", true);
+    read ("(DOM)", false);
+}
+
+TEST_F (JsonConfigReadBenchmark, file)
+{
+    const char *filepath = "/tmp/disir_benchmark_json_config_read.json";
+    benchmark::Stopwatch watch;
+    struct disir_config *config;
+    FILE *file;
+    char *data;
+    size_t size;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    file = fopen (filepath, "w");
+    ASSERT_TRUE (file != NULL);
+    fwrite (document.data (), 1, document.size (), file);
+    fclose (file);
+
+    watch.restart ();
+    for (i = 0; i < reads; i++)
+    {
+        file = fopen (filepath, "r");
+        ASSERT_TRUE (file != NULL);
+        status = dio_json_unserialize_config (instance, file, mold, &config);
+        fclose (file);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_config_finished (&config);
+    }
+    benchmark::report ("json config read (FILE)", watch.elapsed (), reads);
+
+    watch.restart ();
+    for (i = 0; i < reads; i++)
+    {
+        status = fslib_read_filepath (instance, filepath, &data, &size);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dio_json_unserialize_config_span (instance, data, size, mold, &config);
+        free (data);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_config_finished (&config);
+    }
+    benchmark::report ("json config read (span)", watch.elapsed (), reads);
+
+    unlink (filepath);
+}
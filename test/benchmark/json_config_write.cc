@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/fslib/json.h>
+
+// PRIVATE API
+#include "json/json_serialize.h"
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Write a large generated config and its mold as json, in the styled
+// and the compact layout, to a string and to a file descriptor.
+//
+
+class JsonConfigWriteBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_section = NULL;
+        int i, j;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < sections; i++)
+        {
+            std::string name = "section_" + std::to_string (i);
+            status = dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_section, name.c_str (), name.size ());
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 0; j < keyvals; j += 3)
+            {
+                std::string key = "key_" + std::to_string (j);
+                status = dc_add_keyval_string (context_section, key.c_str (),
+                                               "a moderately long string value", "doc",
+                                               NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                key = "key_" + std::to_string (j + 1);
+                status = dc_add_keyval_integer (context_section, key.c_str (), j, "doc",
+                                                NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                key = "key_" + std::to_string (j + 2);
+                status = dc_add_keyval_float (context_section, key.c_str (), j / 3.0, "doc",
+                                              NULL, NULL);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            status = dc_finalize (&context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        devnull = fopen ("/dev/null", "w");
+        ASSERT_TRUE (devnull != NULL);
+    }
+
+    void TearDown()
+    {
+        if (devnull)
+        {
+            fclose (devnull);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    void write_string (const std::string& label, bool compact)
+    {
+        benchmark::Stopwatch watch;
+        std::string document;
+        int i;
+
+        watch.restart ();
+        for (i = 0; i < writes; i++)
+        {
+            dio::ConfigWriter writer (instance);
+            writer.m_compact = compact;
+            status = writer.serialize (config, document);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        benchmark::report ("json config write " + label, watch.elapsed (), writes);
+        std::cout << "[ BENCH    ] document size: " << document.size () / 1024 << " KiB"
+                  << std::endl;
+    }
+
+    void write_fd (const std::string& label, bool compact)
+    {
+        benchmark::Stopwatch watch;
+        int i;
+
+        watch.restart ();
+        for (i = 0; i < writes; i++)
+        {
+            if (compact)
+            {
+                status = dio_json_serialize_config_compact (instance, config, devnull);
+            }
+            else
+            {
+                status = dio_json_serialize_config (instance, config, devnull);
+            }
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        benchmark::report ("json config write " + label, watch.elapsed (), writes);
+    }
+
+public:
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    FILE *devnull = NULL;
+    static const int sections = 200;
+    static const int keyvals = 150;
+    static const int writes = 5;
+};
+
+TEST_F (JsonConfigWriteBenchmark, config)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    write_string ("(styled, string)", false);
+    write_fd ("(styled, fd)", false);
+    write_string ("(compact, string)", true);
+    write_fd ("(compact, fd)", true);
+}
+
+TEST_F (JsonConfigWriteBenchmark, mold)
+{
+    benchmark::Stopwatch watch;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    watch.restart ();
+    for (i = 0; i < writes; i++)
+    {
+        status = dio_json_serialize_mold (instance, mold, devnull);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+    benchmark::report ("json mold write (fd)", watch.elapsed (), writes);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Log USER entries through the queued logger, into a file and into a custom sink.
+// The baseline opens, writes and closes the log file for every entry,
+// formatting the timestamp each time - as the logger did before.
+//
+
+class LogBenchmark : public testing::DisirTestWrapper
+{
+    void TearDown()
+    {
+        disir_log_set_sink (NULL, NULL);
+        unlink (filepath);
+    }
+
+public:
+    static void
+    write_entry (const char *message, ...)
+    {
+        char stamp[64];
+        time_t now;
+        struct tm utctime;
+        va_list args;
+        FILE *stream;
+
+        time (&now);
+        gmtime_r (&now, &utctime);
+        strftime (stamp, sizeof (stamp), "[%Y-%m-%d %H:%M:%S]", &utctime);
+
+        stream = fopen (filepath, "a");
+        if (stream == NULL)
+            return;
+        fprintf (stream, "%s-[USER ] ", stamp);
+        va_start (args, message);
+        vfprintf (stream, message, args);
+        va_end (args);
+        fprintf (stream, "\n");
+        fclose (stream);
+    }
+
+    static void
+    file_sink (void *data, const char *line, size_t size)
+    {
+        fwrite (line, 1, size, (FILE *) data);
+        fputc ('\n', (FILE *) data);
+    }
+
+    static void
+    null_sink (void *data, const char *line, size_t size)
+    {
+        (void) data;
+        (void) line;
+        (void) size;
+    }
+
+    static constexpr const char *filepath = "/tmp/disir_benchmark_log.log";
+    static const int entries = 100000;
+};
+
+TEST_F (LogBenchmark, user_entry)
+{
+    benchmark::Stopwatch watch;
+    FILE *file;
+    int i;
+
+    watch.restart ();
+    for (i = 0; i < entries; i++)
+    {
+        write_entry ("benchmark entry %d of %s", i, "log");
+    }
+    benchmark::report ("log entry (open/write/close)", watch.elapsed (), entries);
+
+    file = fopen (filepath, "w");
+    ASSERT_TRUE (file != NULL);
+    disir_log_set_sink (file_sink, file);
+
+    watch.restart ();
+    for (i = 0; i < entries; i++)
+    {
+        disir_log_user (NULL, "benchmark entry %d of %s", i, "log");
+    }
+    benchmark::report ("log entry (queued, caller)", watch.elapsed (), entries);
+    disir_log_flush ();
+    benchmark::report ("log entry (queued, written)", watch.elapsed (), entries);
+
+    disir_log_set_sink (null_sink, NULL);
+    fclose (file);
+
+    watch.restart ();
+    for (i = 0; i < entries; i++)
+    {
+        disir_log_user (NULL, "benchmark entry %d of %s", i, "log");
+    }
+    disir_log_flush ();
+    benchmark::report ("log entry (queued, null sink)", watch.elapsed (), entries);
+}
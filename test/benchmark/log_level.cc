@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <string>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// PRIVATE API
+extern "C" {
+#include "log.h"
+}
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Cost of debug entries that are not logged, and of the hot paths that log them.
+// A disabled log_debug is compared against calling into the logger, as it expanded to before.
+// Build with -DDISIR_LOG_MIN_LEVEL=INFO to measure the hot paths with debug entries compiled out.
+//
+
+class LogLevelBenchmark : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        int i;
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        for (i = 0; i < entries; i++)
+        {
+            std::string name = "key_" + std::to_string (i);
+            status = dc_add_keyval_integer (context_mold, name.c_str (), i, "doc", NULL, NULL);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+    }
+
+    void TearDown()
+    {
+        if (context_mold)
+        {
+            dc_destroy (&context_mold);
+        }
+    }
+
+public:
+    enum disir_status status;
+    struct disir_context *context_mold = NULL;
+    static const int entries = 10000;
+    static const int calls = 1000000;
+};
+
+TEST_F (LogLevelBenchmark, disabled_entry)
+{
+    benchmark::Stopwatch watch;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    watch.restart ();
+    for (i = 0; i < calls; i++)
+    {
+        dx_log_disir_va (DISIR_LOG_LEVEL_DEBUG, 9, NULL, NULL, 0, __FILE__, __func__, __LINE__,
+                         NULL, "Next context( %p ) at index( %d )", &i, i);
+    }
+    benchmark::report ("log_debug (9) disabled, called", watch.elapsed (), calls);
+
+    watch.restart ();
+    for (i = 0; i < calls; i++)
+    {
+        log_debug (9, "Next context( %p ) at index( %d )", &i, i);
+    }
+    benchmark::report ("log_debug (9) disabled, inline gate", watch.elapsed (), calls);
+}
+
+TEST_F (LogLevelBenchmark, hot_paths)
+{
+    benchmark::Stopwatch watch;
+    struct disir_collection *collection;
+    struct disir_context *context;
+    int walks = calls / entries;
+    int i;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = dc_get_elements (context_mold, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    watch.restart ();
+    for (i = 0; i < walks; i++)
+    {
+        dc_collection_reset (collection);
+        while (dc_collection_next (collection, &context) != DISIR_STATUS_EXHAUSTED)
+        {
+            dc_putcontext (&context);
+        }
+    }
+    benchmark::report ("dc_collection_next", watch.elapsed (), (long) walks * entries);
+    dc_collection_finished (&collection);
+
+    watch.restart ();
+    for (i = 0; i < calls / 10; i++)
+    {
+        std::string name = "key_" + std::to_string (i % entries);
+        status = dc_find_element (context_mold, name.c_str (), 0, &context);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context);
+    }
+    benchmark::report ("dc_find_element", watch.elapsed (), calls / 10);
+}
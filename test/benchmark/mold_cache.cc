@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+#define MOLD_CACHE_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/mold_cache_bench"
+#define MOLD_CACHE_CONFIG_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/config/mold_cache_bench"
+
+//
+// Read config entries sharing a namespace mold from the json plugin,
+// with and without reusing the mold cached in the instance.
+//
+
+class MoldCacheBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_mold *mold = NULL;
+        struct disir_config *config = NULL;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_mold_write (instance, "json", "mold_cache_bench/__namespace", mold);
+        disir_mold_finished (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_write (instance, "json", "mold_cache_bench/entry", config);
+        disir_config_finished (&config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        std::remove (MOLD_CACHE_CONFIG_DIRECTORY "/entry.json");
+        std::remove (MOLD_CACHE_MOLD_DIRECTORY "/__namespace.json");
+        rmdir (MOLD_CACHE_CONFIG_DIRECTORY);
+        rmdir (MOLD_CACHE_MOLD_DIRECTORY);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Read the config entry rounds times, optionally clearing the mold cache before each read.
+    void read_configs (const char *name, bool clear)
+    {
+        struct disir_config *config;
+
+        benchmark::Stopwatch watch;
+        for (int i = 0; i < rounds; i++)
+        {
+            if (clear)
+            {
+                disir_mold_cache_clear (instance);
+            }
+            status = disir_config_read (instance, "json", "mold_cache_bench/entry", NULL, &config);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            disir_config_finished (&config);
+        }
+        benchmark::report (name, watch.elapsed (), rounds);
+    }
+
+    static const int rounds = 500;
+};
+
+TEST_F (MoldCacheBenchmark, config_read)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    read_configs ("config_read json uncached mold", true);
+    read_configs ("config_read json cached mold", false);
+}
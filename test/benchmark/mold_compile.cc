@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+#define MOLD_COMPILE_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/mold_compile_bench"
+
+//
+// Read a mold entry from the json plugin, first parsing the json document
+// and then loading the compiled image of the same entry.
+//
+
+class MoldCompileBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_mold *mold = NULL;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_mold_write (instance, "json", "mold_compile_bench/entry", mold);
+        disir_mold_finished (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/entry.json.compiled");
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/entry.json");
+        rmdir (MOLD_COMPILE_MOLD_DIRECTORY);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Read the mold entry rounds times.
+    void read_molds (const char *name)
+    {
+        struct disir_mold *mold;
+
+        benchmark::Stopwatch watch;
+        for (int i = 0; i < rounds; i++)
+        {
+            status = disir_mold_read (instance, "json", "mold_compile_bench/entry", &mold);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            disir_mold_finished (&mold);
+        }
+        benchmark::report (name, watch.elapsed (), rounds);
+    }
+
+    static const int rounds = 500;
+};
+
+TEST_F (MoldCompileBenchmark, mold_read)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    read_molds ("mold_read json document");
+
+    status = disir_mold_compile_entry (instance, "json", "mold_compile_bench/entry");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    read_molds ("mold_read json compiled image");
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// PRIVATE API
+extern "C" {
+#include "context_private.h"
+#include "keyval.h"
+#include "restriction.h"
+}
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Set values on config keyvals whose mold keyval holds many exclusive restrictions.
+// Compare the compiled evaluator against walking the restriction queue.
+//
+
+class RestrictionBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_keyval = NULL;
+        struct disir_context *context_config = NULL;
+        int i;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_add_keyval_integer (context_mold, "integer", 0, "doc", NULL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < restrictions; i++)
+        {
+            status = dc_add_restriction_value_range (context_keyval, i * 10, i * 10 + 5,
+                                                     NULL, NULL, NULL);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        mold_integer = context_keyval;
+
+        status = dc_add_keyval_enum (context_mold, "enum", "value_0", "doc", NULL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < restrictions; i++)
+        {
+            std::string value = "value_" + std::to_string (i);
+            status = dc_add_restriction_value_enum (context_keyval, value.c_str (), "doc",
+                                                    NULL, NULL);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        mold_enum = context_keyval;
+
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_config_begin (mold, &context_config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &config_integer);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (config_integer, "integer", strlen ("integer"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &config_enum);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (config_enum, "enum", strlen ("enum"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_config);
+    }
+
+    void TearDown()
+    {
+        if (config_integer)
+        {
+            dc_destroy (&config_integer);
+        }
+        if (config_enum)
+        {
+            dc_destroy (&config_enum);
+        }
+        if (mold_integer)
+        {
+            dc_putcontext (&mold_integer);
+        }
+        if (mold_enum)
+        {
+            dc_putcontext (&mold_enum);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    void set_values (const std::string& label, int iterations)
+    {
+        benchmark::Stopwatch watch;
+        int i;
+
+        watch.restart ();
+        for (i = 0; i < iterations; i++)
+        {
+            status = dc_set_value_integer (config_integer, ((i * 7919) % restrictions) * 10 + 3);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        benchmark::report ("set_value_integer " + label, watch.elapsed (), iterations);
+
+        watch.restart ();
+        for (i = 0; i < iterations; i++)
+        {
+            std::string value = "value_" + std::to_string ((i * 7919) % restrictions);
+            status = dc_set_value_enum (config_enum, value.c_str (), value.size ());
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        benchmark::report ("set_value_enum " + label, watch.elapsed (), iterations);
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    struct disir_context *mold_integer = NULL;
+    struct disir_context *mold_enum = NULL;
+    struct disir_context *config_integer = NULL;
+    struct disir_context *config_enum = NULL;
+    static const int restrictions = 1000;
+};
+
+TEST_F (RestrictionBenchmark, exclusive_value_check)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    set_values ("(compiled evaluator)", 100000);
+
+    // Release the compiled evaluators; values are checked by walking the restriction queue.
+    dx_restriction_evaluator_destroy (&mold_integer->cx_keyval->kv_restriction_evaluator);
+    dx_restriction_evaluator_destroy (&mold_enum->cx_keyval->kv_restriction_evaluator);
+
+    // Fewer iterations, since each one visits every restriction.
+    set_values ("(restriction queue)", 1000);
+}
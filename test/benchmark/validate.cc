@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <string.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+// PRIVATE API
+extern "C" {
+#include "context_private.h"
+}
+
+#include "test_helper.h"
+#include "benchmark_helper.h"
+
+//
+// Edit single keyvals in a large config, re-validating the config after each edit.
+// Compare re-validating only the modified contexts (disir_config_valid)
+// against re-validating the entire tree.
+//
+
+class ValidateBenchmark : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_section = NULL;
+        struct disir_context *context_keyval = NULL;
+        struct disir_context *context_config = NULL;
+        int i, j;
+
+        DisirTestTestPlugin::SetUp ();
+
+        // Mold: a repeatable section of integer keyvals with value restrictions.
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_begin (context_mold, DISIR_CONTEXT_SECTION, &context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_section, "section", strlen ("section"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_section, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_entries_max (context_section, sections, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (j = 0; j < keyvals; j++)
+        {
+            std::string name = "key_" + std::to_string (j);
+            status = dc_add_keyval_integer (context_section, name.c_str (), 0, "doc",
+                                            NULL, &context_keyval);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_add_restriction_value_range (context_keyval, 0, 1000, NULL, NULL, NULL);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            dc_putcontext (&context_keyval);
+        }
+        status = dc_finalize (&context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        // Config: every section and keyval of the mold.
+        status = dc_config_begin (mold, &context_config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        for (i = 0; i < sections; i++)
+        {
+            status = dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            status = dc_set_name (context_section, "section", strlen ("section"));
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            for (j = 0; j < keyvals; j++)
+            {
+                std::string name = "key_" + std::to_string (j);
+                status = dc_begin (context_section, DISIR_CONTEXT_KEYVAL, &context_keyval);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                status = dc_set_name (context_keyval, name.c_str (), name.size ());
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                status = dc_set_value_integer (context_keyval, j);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+                dx_context_incref (context_keyval);
+                contexts.push_back (context_keyval);
+                status = dc_finalize (&context_keyval);
+                ASSERT_STATUS (DISIR_STATUS_OK, status);
+            }
+            status = dc_finalize (&context_section);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+        status = dc_config_finalize (&context_config, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        for (auto context : contexts)
+        {
+            dc_putcontext (&context);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    std::vector<struct disir_context *> contexts;
+    static const int sections = 100;
+    static const int keyvals = 100;
+    static const int edits = 10000;
+};
+
+TEST_F (ValidateBenchmark, single_keyval_edits)
+{
+    benchmark::Stopwatch watch;
+    struct disir_context *context_config;
+    int edit;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    context_config = dc_config_getcontext (config);
+
+    // Baseline: validate the entire tree after each edit.
+    // Fewer edits, since each one visits every context.
+    watch.restart ();
+    for (edit = 0; edit < edits / 1000; edit++)
+    {
+        status = dc_set_value_integer (contexts[(edit * 7919) % contexts.size ()], edit % 1000);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dx_validate_context (context_config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+    benchmark::report ("set_value + full tree validation", watch.elapsed (), edits / 1000);
+
+    watch.restart ();
+    for (edit = 0; edit < edits; edit++)
+    {
+        status = dc_set_value_integer (contexts[(edit * 7919) % contexts.size ()], edit % 1000);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_valid (config, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+    benchmark::report ("set_value + disir_config_valid", watch.elapsed (), edits);
+
+    dc_putcontext (&context_config);
+}
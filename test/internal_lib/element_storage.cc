@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <list>
+#include <vector>
 
 // PRIVATE API
 extern "C" {
@@ -41,7 +42,8 @@ protected:
         context = NULL;
         collection = NULL;
 
-        storage = dx_element_storage_create ();
+        generation = 0;
+        storage = dx_element_storage_create (&generation);
         ASSERT_TRUE (storage != NULL);
     }
 
@@ -64,6 +66,7 @@ public:
     struct disir_element_storage *storage;
     struct disir_context *context;
     struct disir_collection *collection;
+    uint64_t generation;
 };
 
 class ElementStoragePopulatedTest : public ElementStorageEmptyTest
@@ -143,6 +146,31 @@ TEST_F (ElementStorageEmptyTest, add)
     // Hard to verify that memory has been free'd. Rely on memcheck tools.
 }
 
+TEST_F (ElementStorageEmptyTest, generation_shall_only_follow_own_tree)
+{
+    struct disir_element_storage *other;
+    uint64_t other_generation = 0;
+    uint64_t before;
+
+    // A new storage takes a fresh generation, never repeated by another tree.
+    EXPECT_NE (0, generation);
+    other = dx_element_storage_create (&other_generation);
+    ASSERT_TRUE (other != NULL);
+    EXPECT_NE (0, other_generation);
+    EXPECT_NE (generation, other_generation);
+
+    before = generation;
+    context = dx_context_create (DISIR_CONTEXT_KEYVAL);
+    ASSERT_TRUE (context != NULL);
+    status = dx_element_storage_add (other, keyval_names[0], context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    dx_context_decref (&context);
+    EXPECT_EQ (before, generation);
+
+    dx_element_storage_destroy (&other);
+    EXPECT_EQ (before, generation);
+}
+
 TEST_F (ElementStorageEmptyTest, add_with_duplicate_keys_shall_succeed)
 {
     unsigned int i;
@@ -225,3 +253,261 @@ TEST_F (ElementStoragePopulatedTest, get_all_collection_shall_be_in_insert_order
     ASSERT_STATUS (DISIR_STATUS_EXHAUSTED, status);
 }
 
+
+TEST_F (ElementStoragePopulatedTest, remove_shall_preserve_insert_order)
+{
+    struct disir_context *c;
+    int removed;
+
+    // Remove two thirds of the entries, enough to trigger storage compaction.
+    removed = 0;
+    for (auto it = list.begin(); it != list.end();)
+    {
+        if (removed < (int)(2 * KEYVAL_NUMENTRIES))
+        {
+            status = dx_element_storage_remove (storage, keyval_names[removed % KEYVAL_NUMENTRIES],
+                                                *it);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+            it = list.erase (it);
+            removed++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ (KEYVAL_NUMENTRIES, dx_element_storage_numentries (storage));
+
+    status = dx_element_storage_get_all (storage, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (auto it = list.begin(); it != list.end(); ++it)
+    {
+        c = *it;
+        status = dc_collection_next (collection, &context);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        ASSERT_EQ (c, context);
+        dx_context_decref (&context);
+    }
+}
+
+TEST_F (ElementStoragePopulatedTest, get_after_remove_shall_exclude_removed)
+{
+    struct disir_context *first;
+
+    first = list.front ();
+    status = dx_element_storage_remove (storage, keyval_names[0], first);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    list.pop_front ();
+
+    status = dx_element_storage_get (storage, keyval_names[0], &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (2, dc_collection_size (collection));
+
+    status = dx_element_storage_get_first (storage, keyval_names[0], &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_NE (first, context);
+}
+
+TEST_F (ElementStoragePopulatedTest, get_index_shall_count_live_entries_by_name)
+{
+    std::vector<struct disir_context *> entries (list.begin (), list.end ());
+    uint64_t before;
+
+    status = dx_element_storage_get_index (storage, keyval_names[0], 2, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (entries[2 * KEYVAL_NUMENTRIES], context);
+
+    status = dx_element_storage_get_index (storage, keyval_names[0], 3, &context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    before = generation;
+    status = dx_element_storage_remove (storage, keyval_names[0], entries[0]);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    list.pop_front ();
+    EXPECT_NE (before, generation);
+
+    status = dx_element_storage_get_index (storage, keyval_names[0], 1, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (entries[2 * KEYVAL_NUMENTRIES], context);
+}
+
+class ElementStorageDeferredTest : public ElementStorageEmptyTest
+{
+    void SetUp()
+    {
+        ElementStorageEmptyTest::SetUp();
+
+        unsigned int i;
+
+        loaded.assign (KEYVAL_NUMENTRIES + 1, NULL);
+        failing = 0;
+
+        dx_element_storage_set_loader (storage, load, this);
+
+        // Token i + 1 identifies the element named keyval_names[i].
+        for (i = 0; i < KEYVAL_NUMENTRIES; i++)
+        {
+            status = dx_element_storage_add_deferred (storage, keyval_names[i], i + 1);
+            ASSERT_STATUS (DISIR_STATUS_OK, status);
+        }
+    }
+
+    void TearDown()
+    {
+        int before = loaded_count ();
+
+        ElementStorageEmptyTest::TearDown();
+
+        // Destroying the storage shall release deferred slots without loading them.
+        EXPECT_EQ (before, loaded_count ());
+
+        for (auto context : created)
+        {
+            // The storage destroyed every context it held. Outside of a parent,
+            // its reference is left for us to drop along with our own.
+            EXPECT_TRUE (context->CONTEXT_STATE_DESTROYED);
+            EXPECT_EQ (2, context->cx_refcount);
+            dx_context_decref (&context);
+            dx_context_decref (&context);
+        }
+    }
+
+    static enum disir_status
+    load (void *data, uint64_t token)
+    {
+        ElementStorageDeferredTest *test = (ElementStorageDeferredTest *) data;
+        struct disir_context *context;
+        enum disir_status status;
+
+        if (token == test->failing)
+            return DISIR_STATUS_NO_CAN_DO;
+
+        context = dx_context_create (DISIR_CONTEXT_KEYVAL);
+        status = dx_element_storage_add (test->storage, keyval_names[token - 1], context);
+
+        test->created.push_back (context);
+        test->loaded[token] = context;
+        return status;
+    }
+
+public:
+    int
+    loaded_count ()
+    {
+        int count = 0;
+        for (auto context : loaded)
+        {
+            count += (context != NULL);
+        }
+        return count;
+    }
+
+    std::vector<struct disir_context *> loaded;
+    //! Every context created by the test, holding a reference on each.
+    std::vector<struct disir_context *> created;
+    uint64_t failing;
+};
+
+TEST_F (ElementStorageDeferredTest, add_deferred_invalid_argument_shall_fail)
+{
+    struct disir_element_storage *unloaded;
+
+    status = dx_element_storage_add_deferred (NULL, "name", 1);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = dx_element_storage_add_deferred (storage, NULL, 1);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = dx_element_storage_add_deferred (storage, "name", 0);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = dx_element_storage_add_deferred (storage, "name", UINT64_MAX);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    unloaded = dx_element_storage_create (NULL);
+    status = dx_element_storage_add_deferred (unloaded, "name", 1);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    dx_element_storage_destroy (&unloaded);
+}
+
+TEST_F (ElementStorageDeferredTest, deferred_slots_shall_count_without_loading)
+{
+    EXPECT_EQ (KEYVAL_NUMENTRIES, dx_element_storage_numentries (storage));
+    EXPECT_EQ (1, dx_element_storage_count (storage, keyval_names[3]));
+    EXPECT_EQ (0, loaded_count ());
+}
+
+TEST_F (ElementStorageDeferredTest, get_first_shall_only_load_that_slot)
+{
+    status = dx_element_storage_get_first (storage, keyval_names[3], &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (loaded[4], context);
+    EXPECT_EQ (1, loaded_count ());
+    EXPECT_EQ (KEYVAL_NUMENTRIES, dx_element_storage_numentries (storage));
+
+    // A second lookup shall find the loaded context.
+    status = dx_element_storage_get_first (storage, keyval_names[3], &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (loaded[4], context);
+    EXPECT_EQ (1, loaded_count ());
+}
+
+TEST_F (ElementStorageDeferredTest, iteration_shall_preserve_insert_order)
+{
+    struct disir_element_iter iter;
+    struct disir_context *first;
+    unsigned int i;
+
+    // Load a slot out of order, and add a context after the deferred slots.
+    status = dx_element_storage_get_first (storage, keyval_names[5], &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    first = dx_context_create (DISIR_CONTEXT_KEYVAL);
+    status = dx_element_storage_add (storage, keyval_names[0], first);
+    created.push_back (first);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    dx_element_storage_iter_begin (storage, NULL, &iter);
+    for (i = 0; i < KEYVAL_NUMENTRIES; i++)
+    {
+        status = dx_element_storage_iter_next (&iter, &context);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_EQ (loaded[i + 1], context);
+    }
+    status = dx_element_storage_iter_next (&iter, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (first, context);
+
+    status = dx_element_storage_iter_next (&iter, &context);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+
+    status = dx_element_storage_get_index (storage, keyval_names[0], 1, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (first, context);
+}
+
+TEST_F (ElementStorageDeferredTest, slot_failing_to_load_shall_be_dropped)
+{
+    failing = 3;
+
+    status = dx_element_storage_get_first (storage, keyval_names[2], &context);
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    EXPECT_EQ (KEYVAL_NUMENTRIES - 1, dx_element_storage_numentries (storage));
+    EXPECT_EQ (0, dx_element_storage_count (storage, keyval_names[2]));
+
+    status = dx_element_storage_get_all (storage, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (KEYVAL_NUMENTRIES - 1, dc_collection_size (collection));
+    EXPECT_EQ (KEYVAL_NUMENTRIES - 1, loaded_count ());
+}
+
+TEST_F (ElementStorageDeferredTest, destroy_shall_not_load_without_loader)
+{
+    dx_element_storage_set_loader (storage, NULL, NULL);
+
+    status = dx_element_storage_get_all (storage, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0, dc_collection_size (collection));
+    EXPECT_EQ (0, loaded_count ());
+}
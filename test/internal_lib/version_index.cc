@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+// PRIVATE API
+extern "C" {
+#include "version_index.h"
+}
+
+#include "test_helper.h"
+
+
+// Entries introduced in 1.0, 1.5, 2.0 and 4.0.
+class VersionIndexTest : public testing::DisirTestWrapper
+{
+protected:
+    void SetUp()
+    {
+        struct disir_version version;
+        int i;
+
+        DisirLogCurrentTestEnter();
+
+        index = dx_version_index_create (4);
+        ASSERT_TRUE (index != NULL);
+
+        for (i = 0; i < 4; i++)
+        {
+            version.sv_major = introduced[i][0];
+            version.sv_minor = introduced[i][1];
+            dx_version_index_set (index, i, &version, &entries[i]);
+        }
+    }
+
+    void TearDown()
+    {
+        dx_version_index_destroy (&index);
+        EXPECT_TRUE (index == NULL);
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Return the position of the entry active for major.minor.
+    int lookup (int major, int minor)
+    {
+        struct disir_version version;
+
+        version.sv_major = major;
+        version.sv_minor = minor;
+        return (int *) dx_version_index_lookup (index, &version) - entries;
+    }
+
+public:
+    struct disir_version_index *index = NULL;
+    int entries[4];
+    const unsigned int introduced[4][2] = {{1, 0}, {1, 5}, {2, 0}, {4, 0}};
+};
+
+TEST (VersionIndexCreateTest, empty_index_shall_fail)
+{
+    EXPECT_TRUE (dx_version_index_create (0) == NULL);
+}
+
+TEST_F (VersionIndexTest, version_before_first_entry_returns_first)
+{
+    EXPECT_EQ (0, lookup (0, 9));
+}
+
+TEST_F (VersionIndexTest, exact_version_returns_entry)
+{
+    EXPECT_EQ (0, lookup (1, 0));
+    EXPECT_EQ (1, lookup (1, 5));
+    EXPECT_EQ (2, lookup (2, 0));
+    EXPECT_EQ (3, lookup (4, 0));
+}
+
+TEST_F (VersionIndexTest, version_between_entries_returns_preceding)
+{
+    EXPECT_EQ (0, lookup (1, 4));
+    EXPECT_EQ (1, lookup (1, 9));
+    EXPECT_EQ (2, lookup (3, 9));
+}
+
+TEST_F (VersionIndexTest, version_after_last_entry_returns_last)
+{
+    EXPECT_EQ (3, lookup (10, 0));
+}
+
+TEST_F (VersionIndexTest, null_version_returns_last)
+{
+    EXPECT_EQ (&entries[3], dx_version_index_lookup (index, NULL));
+}
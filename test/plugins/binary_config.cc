@@ -0,0 +1,194 @@
+#include "test_helper.h"
+
+#include <disir/fslib/binary.h>
+
+#include <string>
+
+#include "config.h"
+#include "binary/binary_format.h"
+
+
+class BinaryConfigTest : public ::testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        char *data = NULL;
+        size_t size = 0;
+        FILE *file;
+
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        file = open_memstream (&data, &size);
+        ASSERT_TRUE (file != NULL);
+        status = dio_binary_serialize_config (instance, config, file);
+        fclose (file);
+        image.assign (data, size);
+        free (data);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (parsed)
+        {
+            disir_config_finished (&parsed);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status
+    read_image ()
+    {
+        return dio_binary_unserialize_config_span (instance, image.data (), image.size (),
+                                                   config->cf_mold, &parsed);
+    }
+
+    struct binary_config_header *
+    header ()
+    {
+        return (struct binary_config_header *) &image[0];
+    }
+
+    void
+    expect_equal ()
+    {
+        struct disir_context *context_config1 = dc_config_getcontext (config);
+        struct disir_context *context_config2 = dc_config_getcontext (parsed);
+
+        EXPECT_STATUS (DISIR_STATUS_OK, dc_compare (context_config1, context_config2, NULL));
+
+        dc_putcontext (&context_config1);
+        dc_putcontext (&context_config2);
+    }
+
+    enum disir_status status;
+    std::string image;
+    struct disir_config *config = NULL;
+    struct disir_config *parsed = NULL;
+};
+
+TEST_F (BinaryConfigTest, invalid_argument)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = dio_binary_unserialize_config_span (NULL, image.data (), image.size (),
+                                                 config->cf_mold, &parsed);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = dio_binary_unserialize_config_span (instance, NULL, image.size (),
+                                                 config->cf_mold, &parsed);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    status = dio_binary_unserialize_config_span (instance, image.data (), image.size (),
+                                                 NULL, &parsed);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (BinaryConfigTest, valid_config_shall_be_flagged)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    EXPECT_EQ (BINARY_CONFIG_FLAG_VALID, header()->bh_flags & BINARY_CONFIG_FLAG_VALID);
+    EXPECT_EQ (image.size (), header()->bh_size);
+}
+
+TEST_F (BinaryConfigTest, corrupt_body_shall_fail_checksum)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    image[image.size () - 1] ^= 0x40;
+
+    status = read_image ();
+    EXPECT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    EXPECT_EQ (NULL, parsed);
+}
+
+TEST_F (BinaryConfigTest, truncated_image_shall_fail)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = dio_binary_unserialize_config_span (instance, image.data (), image.size () - 1,
+                                                 config->cf_mold, &parsed);
+    EXPECT_STATUS (DISIR_STATUS_FS_ERROR, status);
+
+    status = dio_binary_unserialize_config_span (instance, image.data (), 10,
+                                                 config->cf_mold, &parsed);
+    EXPECT_STATUS (DISIR_STATUS_FS_ERROR, status);
+}
+
+TEST_F (BinaryConfigTest, other_format_shall_not_be_read)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    header()->bh_format = BINARY_CONFIG_FORMAT + 1;
+
+    status = read_image ();
+    EXPECT_STATUS (DISIR_STATUS_NO_CAN_DO, status);
+}
+
+TEST_F (BinaryConfigTest, lazy_config_shall_equal_source)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = read_image ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (parsed, NULL));
+    expect_equal ();
+}
+
+TEST_F (BinaryConfigTest, lazy_config_shall_be_modifiable)
+{
+    const char *value;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = read_image ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string (parsed, &value, "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_set_keyval_string (parsed, "modified", "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_set_keyval_string (config, "modified", "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (parsed, NULL));
+    expect_equal ();
+}
+
+TEST_F (BinaryConfigTest, other_mold_version_shall_decode_eagerly)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    // The header is not covered by the checksum.
+    header()->bh_mold_version_minor += 1;
+
+    status = read_image ();
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    expect_equal ();
+}
+
+TEST_F (BinaryConfigTest, config_version_above_mold_shall_conflict)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    header()->bh_config_version_major += 1;
+
+    status = read_image ();
+    EXPECT_STATUS (DISIR_STATUS_CONFLICTING_SEMVER, status);
+}
@@ -0,0 +1,351 @@
+#include "test_json.h"
+#include "json/json_serialize.h"
+#include "json/json_unserialize.h"
+
+#include <disir/fslib/json.h>
+
+#include <sstream>
+#include <stdio.h>
+
+//
+// The config and mold writers emit the document while walking the contexts.
+// The styled layout shall be identical to Json::StyledWriter, and the compact
+// layout shall hold the same document.
+//
+
+class SerializeOutputTest : public testing::JsonDioTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter();
+
+        status = disir_mold_read (instance, "test", "json_test_mold", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_generate_config_from_mold (mold, NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit();
+
+        if (config)
+        {
+            status = disir_config_finished (&config);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+        if (mold)
+        {
+            status = disir_mold_finished (&mold);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        DisirLogCurrentTestExit();
+    }
+
+public:
+    //! Add a string keyval named name to the config root.
+    void add_string (const char *name, const char *value)
+    {
+        struct disir_context *context_config;
+        struct disir_context *context_keyval;
+
+        context_config = dc_config_getcontext (config);
+        ASSERT_TRUE (context_config != NULL);
+
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_keyval, name, strlen (name));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_value_string (context_keyval, value, strlen (value));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        dc_putcontext (&context_config);
+    }
+
+    //! Add an empty section named name to the config root.
+    void add_section (const char *name)
+    {
+        struct disir_context *context_config;
+        struct disir_context *context_section;
+
+        context_config = dc_config_getcontext (config);
+        ASSERT_TRUE (context_config != NULL);
+
+        status = dc_begin (context_config, DISIR_CONTEXT_SECTION, &context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_section, name, strlen (name));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_section);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        dc_putcontext (&context_config);
+    }
+
+    std::string write_config (bool compact)
+    {
+        std::string output;
+        dio::ConfigWriter writer (instance);
+
+        writer.m_compact = compact;
+        status = writer.serialize (config, output);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        return output;
+    }
+
+    std::string write_mold (bool compact)
+    {
+        std::string output;
+        dio::MoldWriter writer (instance);
+
+        writer.m_compact = compact;
+        status = writer.serialize (mold, output);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        return output;
+    }
+
+    //! Parse document and format it again with Json::StyledWriter.
+    std::string restyle (const std::string& document)
+    {
+        Json::Value root;
+        Json::Reader reader;
+        Json::StyledWriter writer;
+
+        EXPECT_TRUE (reader.parse (document, root));
+        return writer.writeOrdered (root);
+    }
+
+    Json::Value parse (const std::string& document)
+    {
+        Json::Value root;
+        Json::Reader reader;
+
+        EXPECT_TRUE (reader.parse (document, root));
+        return root;
+    }
+
+    //! Write the config with func to a temporary file, and read it back.
+    std::string write_config_file (enum disir_status (*func) (struct disir_instance *,
+                                                              struct disir_config *, FILE *))
+    {
+        std::stringstream content;
+        FILE *file;
+
+        file = tmpfile ();
+        EXPECT_TRUE (file != NULL);
+        if (file == NULL)
+            return "";
+
+        // Buffered output ahead of the document shall not be reordered.
+        fputs ("// header\n", file);
+        status = func (instance, config, file);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+        rewind (file);
+        char buffer[4096];
+        size_t size;
+        while ((size = fread (buffer, 1, sizeof (buffer), file)) > 0)
+        {
+            content.write (buffer, size);
+        }
+        fclose (file);
+
+        return content.str ();
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+};
+
+TEST_F (SerializeOutputTest, config_styled_layout)
+{
+    std::string styled = write_config (false);
+
+    ASSERT_EQ (restyle (styled), styled);
+}
+
+TEST_F (SerializeOutputTest, config_styled_layout_merged_entries)
+{
+    // Entries with identical names are merged into arrays,
+    // written on a single line while they fit the line width.
+    add_string ("test1", "second");
+    add_section ("empty_section");
+    add_section ("empty_section");
+
+    std::string styled = write_config (false);
+    ASSERT_NE (std::string::npos, styled.find ("\"test1\" : [ "));
+    ASSERT_NE (std::string::npos, styled.find ("\"empty_section\" : [ {}, {}, {} ]"));
+    ASSERT_EQ (restyle (styled), styled);
+
+    add_string ("test1", "a value long enough to break the array across lines");
+    styled = write_config (false);
+    ASSERT_NE (std::string::npos, styled.find ("\"test1\" : [\n"));
+    ASSERT_EQ (restyle (styled), styled);
+}
+
+TEST_F (SerializeOutputTest, config_styled_layout_escapes)
+{
+    add_string ("test1", "quote \" backslash \\ tab \t control \x01 newline \n");
+
+    std::string styled = write_config (false);
+    ASSERT_NE (std::string::npos, styled.find ("control \\u0001 newline \\n"));
+    ASSERT_EQ (restyle (styled), styled);
+}
+
+TEST_F (SerializeOutputTest, config_compact)
+{
+    add_string ("test1", "second");
+    add_section ("empty_section");
+
+    std::string styled = write_config (false);
+    std::string compact = write_config (true);
+
+    // Only the trailing newline remains of the whitespace.
+    ASSERT_EQ (compact.find ('\n'), compact.size () - 1);
+    ASSERT_EQ (std::string::npos, compact.find (" : "));
+    ASSERT_LT (compact.size (), styled.size ());
+
+    ASSERT_EQ (parse (styled), parse (compact));
+}
+
+TEST_F (SerializeOutputTest, config_compact_read_back)
+{
+    struct disir_config *config_read = NULL;
+    std::string compact = write_config (true);
+    std::string styled = write_config (false);
+    std::string styled_read;
+
+    dio::ConfigReader reader (instance, mold);
+    status = reader.unserialize (&config_read, compact);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    dio::ConfigWriter writer (instance);
+    status = writer.serialize (config_read, styled_read);
+    disir_config_finished (&config_read);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_EQ (styled, styled_read);
+}
+
+TEST_F (SerializeOutputTest, config_file_descriptor)
+{
+    ASSERT_EQ ("// header\n" + write_config (false),
+               write_config_file (dio_json_serialize_config));
+    ASSERT_EQ ("// header\n" + write_config (true),
+               write_config_file (dio_json_serialize_config_compact));
+}
+
+TEST_F (SerializeOutputTest, config_stream)
+{
+    std::stringstream stream;
+    dio::ConfigWriter writer (instance);
+
+    status = writer.serialize (config, stream);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_EQ (write_config (false), stream.str ());
+}
+
+TEST_F (SerializeOutputTest, mold_styled_layout)
+{
+    std::string styled = write_mold (false);
+
+    ASSERT_EQ (restyle (styled), styled);
+}
+
+TEST_F (SerializeOutputTest, mold_compact)
+{
+    std::string styled = write_mold (false);
+    std::string compact = write_mold (true);
+
+    ASSERT_EQ (compact.find ('\n'), compact.size () - 1);
+    ASSERT_EQ (parse (styled), parse (compact));
+}
+
+TEST_F (SerializeOutputTest, output_array_layout)
+{
+    Json::StyledWriter writer;
+    int count;
+
+    // Arrays break across lines by entry count and by line width.
+    for (count = 1; count < 30; count++)
+    {
+        std::string output;
+        Json::Value root;
+        int i;
+
+        SCOPED_TRACE (count);
+        {
+            dio::JsonOutput json_output (output, false);
+            json_output.begin_object ();
+            json_output.key ("numbers");
+            json_output.begin_array (dio::JsonOutput::multiline_array (count, count));
+            for (i = 0; i < count; i++)
+            {
+                json_output.value_integer (i % 10);
+                root["numbers"].append (i % 10);
+            }
+            json_output.end_array ();
+            json_output.key ("strings");
+            json_output.begin_array (dio::JsonOutput::multiline_array (count, count * 5));
+            for (i = 0; i < count; i++)
+            {
+                json_output.value_string ("abc");
+                root["strings"].append ("abc");
+            }
+            json_output.end_array ();
+            json_output.end_object ();
+            ASSERT_TRUE (json_output.finish ());
+        }
+
+        ASSERT_EQ (writer.writeOrdered (root), output);
+    }
+}
+
+TEST_F (SerializeOutputTest, output_values)
+{
+    std::string output;
+    Json::Value root;
+    Json::StyledWriter writer;
+
+    {
+        dio::JsonOutput json_output (output, false);
+        json_output.begin_object ();
+        json_output.key ("min");
+        json_output.value_integer (INT64_MIN);
+        json_output.key ("max");
+        json_output.value_integer (INT64_MAX);
+        json_output.key ("third");
+        json_output.value_float (1.0 / 3);
+        json_output.key ("whole");
+        json_output.value_float (2.0);
+        json_output.key ("large");
+        json_output.value_float (-1.5e300);
+        json_output.key ("true");
+        json_output.value_boolean (true);
+        json_output.key ("null");
+        json_output.value_null ();
+        json_output.key ("empty");
+        json_output.begin_object ();
+        json_output.end_object ();
+        json_output.end_object ();
+        ASSERT_TRUE (json_output.finish ());
+    }
+
+    root["min"] = (Json::Int64) INT64_MIN;
+    root["max"] = (Json::Int64) INT64_MAX;
+    root["third"] = 1.0 / 3;
+    root["whole"] = 2.0;
+    root["large"] = -1.5e300;
+    root["true"] = true;
+    root["null"] = Json::nullValue;
+    root["empty"] = Json::objectValue;
+
+    ASSERT_EQ (writer.writeOrdered (root), output);
+}
@@ -0,0 +1,211 @@
+#include "test_json.h"
+#include "json/json_serialize.h"
+#include "json/json_unserialize.h"
+
+#include <sstream>
+
+//
+// The streaming config reader shall produce the same config, status and error
+// message as the DOM reader, whether it reads the document itself or leaves it to the DOM reader.
+//
+
+class UnserializeConfigStreamTest : public testing::JsonDioTestWrapper
+{
+    void SetUp()
+    {
+        struct disir_version mold_version;
+        char buffer[32];
+
+        DisirLogCurrentTestEnter();
+
+        status = disir_mold_read (instance, "test", "json_test_mold", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_mold_get_version (mold, &mold_version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        version = dc_version_string (buffer, sizeof (buffer), &mold_version);
+
+        DisirLogTestBodyEnter();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit();
+
+        if (mold)
+        {
+            status = disir_mold_finished (&mold);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        DisirLogCurrentTestExit();
+    }
+
+public:
+    //! Document with the mold version, holding config as its config element.
+    std::string document (const std::string& config)
+    {
+        return "{ \"version\": \"" + version + "\", \"config\": " + config + " }";
+    }
+
+    //! Read document with the given reader mode. Return the status, and
+    //! the serialized config or error message in output.
+    enum disir_status read (const std::string& document, bool streaming, std::string& output)
+    {
+        struct disir_config *config = NULL;
+        struct disir_collection *collection = NULL;
+        enum disir_status status;
+        enum disir_status status_serialize;
+        dio::ConfigReader reader (instance, mold);
+        std::stringstream stream (document);
+
+        reader.m_streaming = streaming;
+        disir_error_clear (instance);
+
+        status = reader.unserialize (&config, stream);
+        if (config == NULL)
+        {
+            output = (disir_error (instance) ? disir_error (instance) : "");
+            return status;
+        }
+
+        // Elements not in the mold cannot be serialized - compare the status as well.
+        dio::ConfigWriter writer (instance);
+        status_serialize = writer.serialize (config, output);
+        output += disir_status_string (status_serialize);
+
+        disir_config_valid (config, &collection);
+        if (collection)
+        {
+            output += "invalid: " + std::to_string (dc_collection_size (collection));
+            dc_collection_finished (&collection);
+        }
+
+        disir_config_finished (&config);
+        return status;
+    }
+
+    void expect_identical (const std::string& document)
+    {
+        std::string streamed;
+        std::string dom;
+
+        SCOPED_TRACE (document);
+
+        enum disir_status status_streamed = read (document, true, streamed);
+        enum disir_status status_dom = read (document, false, dom);
+
+        EXPECT_STATUS (status_dom, status_streamed);
+        EXPECT_EQ (dom, streamed);
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    std::string version;
+};
+
+TEST_F (UnserializeConfigStreamTest, generated_config)
+{
+    struct disir_config *config = NULL;
+    std::string serialized;
+
+    status = disir_generate_config_from_mold (mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    dio::ConfigWriter writer (instance);
+    status = writer.serialize (config, serialized);
+    disir_config_finished (&config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    expect_identical (serialized);
+}
+
+TEST_F (UnserializeConfigStreamTest, sections_and_arrays)
+{
+    expect_identical (document (
+        "{ \"test1\": [\"a\", [\"b\", \"c\"]], \"integer\": 1, \"float\": 12.5,"
+        "  \"boolean\": true,"
+        "  \"section_name\": [ { \"k1\": \"x\", \"section2\": { \"k3\": \"y\" } },"
+        "                      { \"integer\": -5, \"bool\": false } ],"
+        "  \"empty_section\": {} }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, comments)
+{
+    expect_identical ("// leading\n" + document (
+        "{ /* before key */ \"test2\" : /* before value */ \"a\" // after value\n"
+        "  , \"integer\": 2 /* end */ }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, duplicate_keys)
+{
+    expect_identical (document ("{ \"test2\": \"a\", \"integer\": 1, \"test2\": \"b\" }"));
+    expect_identical (document ("{ \"section_name\": { \"k1\": \"a\" },"
+                                "  \"section_name\": { \"k2\": \"b\" } }"));
+    expect_identical (document ("{ \"test2\": [], \"integer\": 1, \"test2\": \"b\" }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, element_not_in_mold)
+{
+    expect_identical (document ("{ \"invalid\": 1, \"nested\": { \"invalid\": [1, 2] } }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, wrong_value_types)
+{
+    expect_identical (document ("{ \"test2\": 2, \"integer\": \"two\", \"float\": 15 }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, null_and_unsigned_values)
+{
+    expect_identical (document ("{ \"test2\": null }"));
+    expect_identical (document ("{ \"integer\": [null] }"));
+    expect_identical (document ("{ \"integer\": 4294967296 }"));
+    expect_identical (document ("{ \"integer\": 18446744073709551615 }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, numbers)
+{
+    expect_identical (document ("{ \"integer\": -9223372036854775808, \"float\": -.5 }"));
+    expect_identical (document ("{ \"integer\": 2147483647, \"float\": 1. }"));
+    expect_identical (document ("{ \"integer\": -, \"float\": 1e2 }"));
+    expect_identical (document ("{ \"float\": 1e999 }"));
+    expect_identical (document ("{ \"float\": 1e }"));
+    expect_identical (document ("{ \"integer\": 99999999999999999999 }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, string_escapes)
+{
+    expect_identical (document ("{ \"test2\": \"\\\"\\\\\\/\\b\\f\\n\\r\\t\","
+                                "  \"section_name\": { \"k1\": \"\\u00e6\\u20ac\\ud83d\\ude00\" } }"));
+    expect_identical (document ("{ \"test2\": \"\\ud83d\" }"));
+    expect_identical (document ("{ \"test2\": \"\\x\" }"));
+}
+
+TEST_F (UnserializeConfigStreamTest, version)
+{
+    expect_identical ("{ \"config\": { \"test2\": \"a\" }, \"version\": \"" + version + "\" }");
+    expect_identical ("{ \"config\": { \"test2\": \"a\" } }");
+    expect_identical ("{ \"version\": 1, \"config\": { \"test2\": \"a\" } }");
+    expect_identical ("{ \"version\": \"x.y\", \"config\": { \"test2\": \"a\" } }");
+    expect_identical ("{ \"version\": \"999.0\", \"config\": { \"test2\": \"a\" } }");
+    expect_identical ("{ \"version\": \"" + version + "\" }");
+    expect_identical ("{ \"version\": \"" + version + "\", \"config\": [] }");
+}
+
+TEST_F (UnserializeConfigStreamTest, ignored_root_members)
+{
+    expect_identical ("{ \"other\": { \"a\": [1, null] }, \"version\": \"" + version + "\","
+                      "  \"config\": { \"test2\": \"a\" }, \"more\": \"b\" } trailing");
+}
+
+TEST_F (UnserializeConfigStreamTest, syntax_errors)
+{
+    expect_identical (document ("{ \"test2\": \"a\", }"));
+    expect_identical (document ("{ \"test2\": [\"a\",] }"));
+    expect_identical (document ("{ \"test2\" /* comment */ : \"a\" }"));
+    expect_identical (document ("{ \"test2\": \"a\" \"integer\": 1 }"));
+    expect_identical (document ("{ \"test2\": tru }"));
+    expect_identical (document ("{ \"test2\": [ /* comment */ ] }"));
+    expect_identical (document ("{ \"test2\": \"a\" }").substr (0, 40));
+    expect_identical ("");
+}
@@ -3,6 +3,7 @@
 #include <disir/fslib/util.h>
 #include <disir/fslib/toml.h>
 #include <disir/fslib/json.h>
+#include <disir/fslib/binary.h>
 
 #include "log.h"
 #include "config.h"
@@ -27,16 +28,33 @@ class SerializeUnserializeTest : public ::testing::DisirTestTestPlugin,
                                  public ::testing::WithParamInterface<const char *>
 {
 public:
+    //! Read the serialized entry at filepath back as a single span.
+    enum disir_status unserialize_span (const char *filepath, char **data, size_t *size)
+    {
+        enum disir_status status;
+
+        status = fslib_read_filepath (instance, filepath, data, size);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        if (status == DISIR_STATUS_OK)
+        {
+            EXPECT_EQ ('\0', (*data)[*size]);
+        }
+        return status;
+    }
+
     void serialize_unserialize_mold (const char *entry,
                                      const char *suffix,
                                      dio_serialize_mold func_serialize,
-                                     dio_unserialize_mold func_unserialize)
+                                     dio_unserialize_mold func_unserialize,
+                                     dio_unserialize_mold_span func_unserialize_span = NULL)
     {
         struct disir_mold *mold_original = NULL;
         struct disir_mold *mold_parsed = NULL;
         struct disir_context *context_mold1 = NULL;
         struct disir_context *context_mold2 = NULL;
         FILE *file = NULL;
+        char *data = NULL;
+        size_t size;
 
         log_test ("SerializeUnserialize mold %s", entry);
 
@@ -64,7 +82,17 @@ public:
 
         fseek (file, 0, SEEK_SET);
 
-        status = func_unserialize (instance, file, &mold_parsed);
+        if (func_unserialize_span)
+        {
+            status = unserialize_span (filepath, &data, &size);
+            if (status != DISIR_STATUS_OK)
+                goto out;
+            status = func_unserialize_span (instance, data, size, &mold_parsed);
+        }
+        else
+        {
+            status = func_unserialize (instance, file, &mold_parsed);
+        }
         EXPECT_STATUS (DISIR_STATUS_OK, status);
         if (status != DISIR_STATUS_OK)
             goto out;
@@ -85,6 +113,7 @@ public:
         {
             fclose (file);
         }
+        free (data);
         dc_putcontext (&context_mold1);
         dc_putcontext (&context_mold2);
         disir_mold_finished (&mold_original);
@@ -93,7 +122,8 @@ public:
 
     void serialize_unserialize_config (const char *entry,
                                        dio_serialize_config func_serialize,
-                                       dio_unserialize_config func_unserialize)
+                                       dio_unserialize_config func_unserialize,
+                                       dio_unserialize_config_span func_unserialize_span = NULL)
     {
         struct disir_config *config_original = NULL;
         struct disir_config *config_parsed = NULL;
@@ -101,6 +131,8 @@ public:
         struct disir_context *context_config2 = NULL;
         FILE *file = NULL;
         struct disir_mold *mold = NULL;
+        char *data = NULL;
+        size_t size;
 
         log_test ("SerializeUnserialize %s", entry);
 
@@ -135,7 +167,17 @@ public:
         // XXX: Cheat by extracting the mold directly from the config.
         mold = config_original->cf_mold;
         fseek (file, 0, SEEK_SET);
-        status = func_unserialize (instance, file, mold, &config_parsed);
+        if (func_unserialize_span)
+        {
+            status = unserialize_span (filepath, &data, &size);
+            if (status != DISIR_STATUS_OK)
+                goto out;
+            status = func_unserialize_span (instance, data, size, mold, &config_parsed);
+        }
+        else
+        {
+            status = func_unserialize (instance, file, mold, &config_parsed);
+        }
         EXPECT_STATUS (DISIR_STATUS_OK, status);
         if (status != DISIR_STATUS_OK)
             goto out;
@@ -157,11 +199,90 @@ public:
         {
             fclose (file);
         }
+        free (data);
         dc_putcontext (&context_config1);
         dc_putcontext (&context_config2);
         disir_config_finished (&config_original);
         disir_config_finished (&config_parsed);
     }
+
+    //! Round-trip the config through memory streams, which have no file descriptor.
+    void serialize_unserialize_config_memory (const char *entry,
+                                              dio_serialize_config func_serialize,
+                                              dio_unserialize_config func_unserialize)
+    {
+        struct disir_config *config_original = NULL;
+        struct disir_config *config_parsed = NULL;
+        struct disir_context *context_config1 = NULL;
+        struct disir_context *context_config2 = NULL;
+        FILE *stream = NULL;
+        char *data = NULL;
+        size_t size = 0;
+
+        log_test ("SerializeUnserialize memory %s", entry);
+
+        status = disir_config_read (instance, "test", entry, NULL, &config_original);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+
+        stream = open_memstream (&data, &size);
+        EXPECT_TRUE (stream != NULL);
+        if (stream == NULL)
+            goto out;
+        status = func_serialize (instance, config_original, stream);
+        fclose (stream);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+
+        stream = fmemopen (data, size, "r");
+        EXPECT_TRUE (stream != NULL);
+        if (stream == NULL)
+            goto out;
+        status = func_unserialize (instance, stream, config_original->cf_mold, &config_parsed);
+        fclose (stream);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+
+        context_config1 = dc_config_getcontext (config_original);
+        context_config2 = dc_config_getcontext (config_parsed);
+        status = dc_compare (context_config1, context_config2, NULL);
+        EXPECT_STATUS (DISIR_STATUS_OK, status)
+    out:
+        free (data);
+        dc_putcontext (&context_config1);
+        dc_putcontext (&context_config2);
+        disir_config_finished (&config_original);
+        disir_config_finished (&config_parsed);
+    }
+
+    //! Serialize the config into a memory stream too small to hold it.
+    void serialize_config_memory_short_write (const char *entry,
+                                              dio_serialize_config func_serialize)
+    {
+        struct disir_config *config = NULL;
+        FILE *stream = NULL;
+        char data[8];
+
+        status = disir_config_read (instance, "test", entry, NULL, &config);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        if (status != DISIR_STATUS_OK)
+            goto out;
+
+        stream = fmemopen (data, sizeof (data), "w");
+        EXPECT_TRUE (stream != NULL);
+        if (stream == NULL)
+            goto out;
+        // Unbuffered, such that the short write is reported by fwrite itself.
+        setvbuf (stream, NULL, _IONBF, 0);
+        status = func_serialize (instance, config, stream);
+        fclose (stream);
+        EXPECT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    out:
+        disir_config_finished (&config);
+    }
 };
 
 TEST_P(SerializeUnserializeTest, toml)
@@ -191,5 +312,128 @@ TEST_P(SerializeUnserializeTest, mold_json)
     );
 }
 
-INSTANTIATE_TEST_CASE_P(MoldKey, SerializeUnserializeTest, ::testing::ValuesIn(molds));
+TEST_P(SerializeUnserializeTest, toml_span)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config (key, dio_toml_serialize_config, NULL,
+                                      dio_toml_unserialize_config_span);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, config_json_span)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config (key, dio_json_serialize_config, NULL,
+                                      dio_json_unserialize_config_span);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, mold_json_span)
+{
+    const char *key= GetParam();
 
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_mold (key, "json", dio_json_serialize_mold, NULL,
+                                    dio_json_unserialize_mold_span);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, config_binary)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config (key, dio_binary_serialize_config,
+                                      dio_binary_unserialize_config);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, config_binary_span)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config (key, dio_binary_serialize_config, NULL,
+                                      dio_binary_unserialize_config_span);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, toml_memory)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config_memory (key, dio_toml_serialize_config,
+                                             dio_toml_unserialize_config);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, toml_memory_short_write)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_config_memory_short_write (key, dio_toml_serialize_config);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, config_json_memory)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config_memory (key, dio_json_serialize_config,
+                                             dio_json_unserialize_config);
+    );
+}
+
+TEST_P(SerializeUnserializeTest, config_binary_memory)
+{
+    const char *key= GetParam();
+
+    ASSERT_NO_FATAL_FAILURE (
+        serialize_unserialize_config_memory (key, dio_binary_serialize_config,
+                                             dio_binary_unserialize_config);
+    );
+}
+
+TEST_F(SerializeUnserializeTest, read_filepath)
+{
+    const char *filepath = "/tmp/disir_plugin_serialize_unserialize_read_filepath";
+    std::string content (10000, 'x');
+    char *data = NULL;
+    size_t size = 1;
+    FILE *file;
+
+    file = fopen (filepath, "w");
+    ASSERT_TRUE (file != NULL);
+    fclose (file);
+
+    status = fslib_read_filepath (instance, filepath, &data, &size);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (0, size);
+    EXPECT_STREQ ("", data);
+    free (data);
+
+    file = fopen (filepath, "w");
+    ASSERT_TRUE (file != NULL);
+    fputs (content.c_str (), file);
+    fclose (file);
+
+    status = fslib_read_filepath (instance, filepath, &data, &size);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (content.size (), size);
+    EXPECT_STREQ (content.c_str (), data);
+    free (data);
+
+    unlink (filepath);
+
+    status = fslib_read_filepath (instance, filepath, &data, &size);
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+}
+
+INSTANTIATE_TEST_CASE_P(MoldKey, SerializeUnserializeTest, ::testing::ValuesIn(molds));
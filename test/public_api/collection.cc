@@ -236,3 +236,29 @@ TEST_F (CollectionTest, push_context_until_internal_resize)
     }
 }
 
+
+TEST_F (CollectionTest, push_destroyed_context)
+{
+    struct disir_collection *holder;
+    struct disir_context *destroyed;
+
+    holder = dc_collection_create ();
+    ASSERT_TRUE (holder != NULL);
+
+    // holder keeps the destroyed context allocated.
+    status = dc_begin (context_mold, DISIR_CONTEXT_KEYVAL, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_collection_push_context (holder, context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    destroyed = context;
+    dc_destroy (&context);
+
+    // Coalesce the collection before pushing - no context is destroyed after the push.
+    EXPECT_EQ (0, dc_collection_size (collection));
+    status = dc_collection_push_context (collection, destroyed);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ (0, dc_collection_size (collection));
+
+    dc_collection_finished (&holder);
+}
@@ -300,3 +300,95 @@ TEST_F (ContextDefaultTest, second_default_with_conflicting_version_is_invalid)
     EXPECT_EQ (2, dc_collection_size(defaults));
     dc_collection_finished (&defaults);
 }
+
+// Default entries of a finalized mold keyval, looked up by version.
+class ContextDefaultFinalizedTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_version version;
+
+        DisirLogCurrentTestEnter();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_keyval_integer (context_mold, "key", 10, "doc", NULL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        version.sv_minor = 0;
+        version.sv_major = 2;
+        status = dc_add_default_integer (context_keyval, 20, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        version.sv_major = 4;
+        status = dc_add_default_integer (context_keyval, 40, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        if (context_keyval)
+        {
+            dc_putcontext (&context_keyval);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Return the default of context_keyval at version major.minor. Negative major is NULL.
+    std::string get_default (int major, int minor)
+    {
+        struct disir_version version;
+        char buffer[64];
+        int32_t size;
+
+        version.sv_major = major;
+        version.sv_minor = minor;
+        status = dc_get_default (context_keyval, (major < 0 ? NULL : &version),
+                                 sizeof (buffer), buffer, &size);
+        if (status != DISIR_STATUS_OK)
+            return disir_status_string (status);
+        return std::string (buffer, size);
+    }
+
+public:
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_context *context_keyval = NULL;
+};
+
+TEST_F (ContextDefaultFinalizedTest, get_default_by_version)
+{
+    EXPECT_EQ ("10", get_default (0, 5));
+    EXPECT_EQ ("10", get_default (1, 0));
+    EXPECT_EQ ("10", get_default (1, 9));
+    EXPECT_EQ ("20", get_default (2, 0));
+    EXPECT_EQ ("20", get_default (3, 5));
+    EXPECT_EQ ("40", get_default (4, 0));
+    EXPECT_EQ ("40", get_default (9, 0));
+    EXPECT_EQ ("40", get_default (-1, 0));
+}
+
+TEST_F (ContextDefaultFinalizedTest, get_default_after_default_added_to_finalized_mold)
+{
+    struct disir_version version;
+
+    version.sv_major = 3;
+    version.sv_minor = 0;
+    status = dc_add_default_integer (context_keyval, 30, &version);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_EQ ("20", get_default (2, 5));
+    EXPECT_EQ ("30", get_default (3, 5));
+    EXPECT_EQ ("40", get_default (4, 0));
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+#include "test_helper.h"
+
+
+//
+// Exclusive value restrictions of a mold keyval are compiled per version span
+// when the mold is finalized. These tests exercise overlapping, introduced and
+// deprecated restrictions, and restrictions modified after the mold is finalized.
+//
+class ContextRestrictionEvaluatorTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        struct disir_context *context_mold = NULL;
+        struct disir_context *context_keyval = NULL;
+        struct disir_context *context_restriction = NULL;
+        struct disir_version version;
+
+        DisirLogCurrentTestEnter ();
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_documentation (context_mold, "doc", strlen ("doc"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        // integer: [0, 10] and [5, 20] from 1.0, 100 from 2.0, [5, 20] deprecated in 3.0
+        status = dc_add_keyval_integer (context_mold, "integer", 5, "doc", NULL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_value_range (context_keyval, 0, 10, NULL, NULL, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_value_range (context_keyval, 5, 20, NULL, NULL,
+                                                 &context_restriction);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        version.sv_major = 3;
+        version.sv_minor = 0;
+        status = dc_add_deprecated (context_restriction, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_restriction);
+        version.sv_major = 2;
+        status = dc_add_restriction_value_numeric (context_keyval, 100, NULL, &version, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_value_range (context_keyval, 500, 600, NULL, NULL,
+                                                 &range_restriction);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_keyval);
+
+        // enum: 'a' always, 'b' deprecated in 2.0, 'c' from 2.0
+        status = dc_add_keyval_enum (context_mold, "enum", "a", "doc", NULL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_value_enum (context_keyval, "a", "doc", NULL, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_restriction_value_enum (context_keyval, "b", "doc", NULL,
+                                                &context_restriction);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_add_deprecated (context_restriction, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_restriction);
+        status = dc_add_restriction_value_enum (context_keyval, "c", "doc", &version, NULL);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        dc_putcontext (&context_keyval);
+
+        version.sv_major = 3;
+        status = dc_set_version (context_mold, &version);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = dc_mold_finalize (&context_mold, &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (range_restriction)
+        {
+            dc_putcontext (&range_restriction);
+        }
+        if (mold)
+        {
+            status = disir_mold_finished (&mold);
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    //! Set the value of keyval name in a new config of major version.
+    //! A string value is set as enum.
+    enum disir_status set_value (int major, const char *name,
+                                 int64_t integer_value, const char *string_value)
+    {
+        enum disir_status result;
+        struct disir_context *context_config = NULL;
+        struct disir_context *context_keyval = NULL;
+        struct disir_version version;
+
+        version.sv_major = major;
+        version.sv_minor = 0;
+
+        result = dc_config_begin (mold, &context_config);
+        if (result != DISIR_STATUS_OK)
+            return result;
+        result = dc_set_version (context_config, &version);
+        if (result != DISIR_STATUS_OK)
+            goto out;
+        result = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        if (result != DISIR_STATUS_OK)
+            goto out;
+        result = dc_set_name (context_keyval, name, strlen (name));
+        if (result != DISIR_STATUS_OK)
+            goto out;
+
+        if (string_value)
+            result = dc_set_value_enum (context_keyval, string_value, strlen (string_value));
+        else
+            result = dc_set_value_integer (context_keyval, integer_value);
+
+    out:
+        if (context_keyval)
+            dc_destroy (&context_keyval);
+        dc_destroy (&context_config);
+        return result;
+    }
+
+public:
+    enum disir_status status;
+    struct disir_mold *mold = NULL;
+    struct disir_context *range_restriction = NULL;
+};
+
+TEST_F (ContextRestrictionEvaluatorTest, overlapping_ranges_are_merged)
+{
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 0, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 10, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 15, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 20, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 550, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", -1, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 21, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 499, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 601, NULL));
+}
+
+TEST_F (ContextRestrictionEvaluatorTest, numeric_introduced_in_later_version)
+{
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 100, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (2, "integer", 100, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (3, "integer", 100, NULL));
+}
+
+TEST_F (ContextRestrictionEvaluatorTest, deprecated_range_is_inactive)
+{
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (2, "integer", 15, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (3, "integer", 15, NULL));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (3, "integer", 10, NULL));
+}
+
+TEST_F (ContextRestrictionEvaluatorTest, enum_values_per_version)
+{
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "enum", 0, "a"));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "enum", 0, "b"));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "enum", 0, "c"));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "enum", 0, "d"));
+
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (2, "enum", 0, "a"));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (2, "enum", 0, "b"));
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (2, "enum", 0, "c"));
+}
+
+TEST_F (ContextRestrictionEvaluatorTest, restriction_modified_after_mold_finalize)
+{
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 700, NULL));
+
+    status = dc_restriction_set_range (range_restriction, 500, 800);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    EXPECT_STATUS (DISIR_STATUS_OK, set_value (1, "integer", 700, NULL));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, set_value (1, "integer", 801, NULL));
+}
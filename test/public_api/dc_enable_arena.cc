@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+#include "test_helper.h"
+
+
+class EnableArenaTest : public testing::DisirTestWrapper
+{
+    void SetUp()
+    {
+        DisirLogCurrentTestEnter ();
+
+        context_mold = NULL;
+        context_keyval = NULL;
+        mold = NULL;
+        config = NULL;
+
+        status = dc_mold_begin (&context_mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    void TearDown()
+    {
+        if (context_keyval)
+        {
+            dc_putcontext (&context_keyval);
+        }
+        if (context_mold)
+        {
+            dc_destroy (&context_mold);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        DisirLogCurrentTestExit ();
+    }
+
+public:
+    enum disir_status status;
+    struct disir_context *context_mold;
+    struct disir_context *context_keyval;
+    struct disir_mold *mold;
+    struct disir_config *config;
+};
+
+TEST_F (EnableArenaTest, invalid_argument)
+{
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, dc_enable_arena (NULL));
+}
+
+TEST_F (EnableArenaTest, root_context_shall_succeed)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_enable_arena (context_mold));
+}
+
+TEST_F (EnableArenaTest, enabled_twice_shall_succeed)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_enable_arena (context_mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_enable_arena (context_mold));
+}
+
+TEST_F (EnableArenaTest, non_root_context_shall_fail)
+{
+    status = dc_add_keyval_integer (context_mold, "keyval", 1, "doc", NULL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_STATUS (DISIR_STATUS_WRONG_CONTEXT, dc_enable_arena (context_keyval));
+}
+
+TEST_F (EnableArenaTest, root_with_children_shall_fail)
+{
+    status = dc_add_keyval_integer (context_mold, "keyval", 1, "doc", NULL, NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, dc_enable_arena (context_mold));
+}
+
+TEST_F (EnableArenaTest, mold_and_generated_config_shall_be_usable)
+{
+    struct disir_context *context_section;
+    struct disir_context *context_config;
+    const char *value;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_enable_arena (context_mold));
+
+    status = dc_add_keyval_string (context_mold, "name", "default_value",
+                                   "documentation", NULL, NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_begin (context_mold, DISIR_CONTEXT_SECTION,
+                                              &context_section));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_set_name (context_section, "section", strlen ("section")));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_add_documentation (context_section, "doc", strlen ("doc")));
+    status = dc_add_keyval_integer (context_section, "integer", 42, "doc", NULL, NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    // Destroy a keyval allocated from the arena before the rest of the tree.
+    status = dc_add_keyval_string (context_section, "discarded", "value", "doc",
+                                   NULL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_destroy (&context_keyval));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_finalize (&context_section));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_finalize (&context_mold, &mold));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_generate_config_from_mold (mold, NULL, &config));
+    context_config = dc_config_getcontext (config);
+    ASSERT_TRUE (context_config != NULL);
+
+    status = dc_config_get_keyval_string (context_config, &value, "name");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("default_value", value);
+
+    status = dc_config_set_keyval_string (context_config, "a considerably longer value", "name");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_config_get_keyval_string (context_config, &value, "name");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("a considerably longer value", value);
+
+    dc_putcontext (&context_config);
+}
+
+TEST_F (EnableArenaTest, replaced_strings_shall_be_reused)
+{
+    struct disir_context *context_config;
+    const char *value;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_enable_arena (context_mold));
+    status = dc_add_keyval_string (context_mold, "name", "default_value",
+                                   "documentation", NULL, NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_mold_finalize (&context_mold, &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_generate_config_from_mold (mold, NULL, &config));
+    context_config = dc_config_getcontext (config);
+    ASSERT_TRUE (context_config != NULL);
+
+    // Alternate between a short and a longer value - the replaced strings are
+    // handed back to the arena, and served to the next string of their size.
+    for (int i = 0; i < 100; i++)
+    {
+        std::string longer = "value of round " + std::to_string (i);
+
+        status = dc_config_set_keyval_string (context_config, "short", "name");
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_config_set_keyval_string (context_config, longer.c_str (), "name");
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_config_get_keyval_string (context_config, &value, "name");
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        ASSERT_STREQ (longer.c_str (), value);
+    }
+
+    dc_putcontext (&context_config);
+}
+
+//
+// This class tests the public API functions:
+//  disir_arena_enable
+//  disir_arena_enabled
+//
+class DisirArenaEnable : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        // The instance is shared by every test.
+        disir_arena_enable (instance, 0);
+        std::remove (CMAKE_BUILD_DIRECTORY "/tree/json/config/arena_test.json");
+        std::remove (CMAKE_BUILD_DIRECTORY "/tree/json/mold/arena_test.json");
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status status;
+};
+
+TEST_F (DisirArenaEnable, invalid_argument)
+{
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_arena_enable (NULL, 1));
+    ASSERT_EQ (0, disir_arena_enabled (NULL));
+}
+
+TEST_F (DisirArenaEnable, disabled_by_default)
+{
+    ASSERT_EQ (0, disir_arena_enabled (instance));
+}
+
+TEST_F (DisirArenaEnable, enable_and_disable)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_arena_enable (instance, 1));
+    ASSERT_EQ (1, disir_arena_enabled (instance));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_arena_enable (instance, 0));
+    ASSERT_EQ (0, disir_arena_enabled (instance));
+}
+
+TEST_F (DisirArenaEnable, config_read_shall_match_without_arena)
+{
+    struct disir_mold *mold = NULL;
+    struct disir_config *source = NULL;
+    struct disir_config *config = NULL;
+    struct disir_config *config_arena = NULL;
+    const char *value;
+
+    // Store a mold and config in the filesystem backed json group.
+    status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_mold_write (instance, "json", "arena_test", mold);
+    disir_mold_finished (&mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_read (instance, "test", "config_query_permutations", NULL, &source);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_write (instance, "json", "arena_test", source);
+    disir_config_finished (&source);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "json", "arena_test", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    disir_mold_cache_clear (instance);
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_arena_enable (instance, 1));
+    status = disir_config_read (instance, "json", "arena_test", NULL, &config_arena);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+    if (config_arena)
+    {
+        struct disir_context *lhs = dc_config_getcontext (config);
+        struct disir_context *rhs = dc_config_getcontext (config_arena);
+        EXPECT_STATUS (DISIR_STATUS_OK, dc_compare (lhs, rhs, NULL));
+        dc_putcontext (&lhs);
+        dc_putcontext (&rhs);
+
+        status = disir_config_set_keyval_string (config_arena, "a considerably longer value",
+                                                 "first.key_string");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_get_keyval_string (config_arena, &value, "first.key_string");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_STREQ ("a considerably longer value", value);
+
+        disir_config_finished (&config_arena);
+    }
+    disir_config_finished (&config);
+    disir_mold_cache_clear (instance);
+}
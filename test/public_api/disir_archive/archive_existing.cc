@@ -7,6 +7,8 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <map>
+#include <fstream>
+#include <sstream>
 
 
 //! Contains tests that test the public disir_archive_begin API with an existing archive.
@@ -867,7 +869,7 @@ TEST_F (ArchiveExistingTest, append_entry)
 
     archive_diff (old_content, new_content, diff);
 
-    ASSERT_TRUE (diff.size() == 4); // 2 entries + metadata.toml and entries.toml
+    ASSERT_TRUE (diff.size() == 5); // 2 entries + metadata.toml, entries.toml and entries.index
     ASSERT_TRUE (std::find(diff.begin(), diff.end(), "JSON/JSON/config_query_permutations")
                  != diff.end());
     ASSERT_TRUE (std::find(diff.begin(), diff.end(),
@@ -1029,3 +1031,281 @@ TEST_F (ArchiveExistingTest, not_permitted_to_read_archive)
 
     ASSERT_STREQ ("unable to read archive: '/tmp/archive.disir'", disir_error (instance_export));
 }
+
+TEST_F (ArchiveExistingTest, list_archive_without_index)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_archive_listing *current;
+    std::set<std::string> entries;
+
+    create_mockup_archive ();
+
+    // Read in its entirety.
+    status = disir_archive_list (instance_export, archive_path_out, &listing);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (current = listing; current != NULL; current = current->next)
+    {
+        EXPECT_STREQ ("Random", current->al_group_id);
+        EXPECT_STREQ ("1.0.0", current->al_version);
+        entries.insert (current->al_entry_id);
+    }
+    disir_archive_listing_finished (&listing);
+
+    ASSERT_EQ (std::set<std::string> ({"basic_keyval", "basic_section", "nested/basic_keyval",
+                                       "super/nested/basic_keyval"}), entries);
+}
+
+TEST_F (ArchiveExistingTest, list_re_exported_archive)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_archive_listing *current;
+    std::vector<std::string> content;
+    int count = 0;
+
+    create_mockup_archive ();
+
+    // The archive is written with an index when it is exported again.
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    get_archive_content (archive_path_out, content);
+    ASSERT_TRUE (std::find (content.begin(), content.end(), "entries.index") != content.end());
+
+    status = disir_archive_list (instance_export, archive_path_out, &listing);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (current = listing; current != NULL; current = current->next)
+    {
+        count++;
+    }
+    disir_archive_listing_finished (&listing);
+
+    ASSERT_EQ (5, count);
+}
+
+TEST_F (ArchiveExistingTest, append_in_place)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_archive_listing *current;
+    std::vector<std::string> content;
+    struct stat before;
+    struct stat after;
+    int count = 0;
+
+    create_mockup_archive ();
+
+    // Copied in its entirety, as the mockup archive has no trailer.
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_EQ (0, stat (archive_path_out, &before));
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_section");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Written to the same file, rather than a copy replacing it.
+    ASSERT_EQ (0, stat (archive_path_out, &after));
+    ASSERT_EQ (before.st_ino, after.st_ino);
+
+    // The trailer of the archive is replaced, not repeated.
+    get_archive_content (archive_path_out, content);
+    ASSERT_EQ (10u, content.size()); // 6 entries + metadata.toml, 2 entries.toml and entries.index
+    ASSERT_EQ (1, std::count (content.begin(), content.end(), "metadata.toml"));
+    ASSERT_EQ (1, std::count (content.begin(), content.end(), "entries.index"));
+    ASSERT_EQ (1, std::count (content.begin(), content.end(), "JSON/JSON/basic_section"));
+
+    status = disir_archive_list (instance_export, archive_path_out, &listing);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (current = listing; current != NULL; current = current->next)
+    {
+        count++;
+    }
+    disir_archive_listing_finished (&listing);
+
+    ASSERT_EQ (6, count);
+}
+
+TEST_F (ArchiveExistingTest, append_in_place_discarded)
+{
+    std::ifstream file;
+    std::stringstream before;
+    std::stringstream after;
+
+    create_mockup_archive ();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    file.open (archive_path_out, std::ios::binary);
+    before << file.rdbuf();
+    file.close();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_section");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    file.open (archive_path_out, std::ios::binary);
+    after << file.rdbuf();
+    file.close();
+
+    ASSERT_TRUE (before.str() == after.str());
+}
+
+TEST_F (ArchiveExistingTest, append_in_place_interrupted)
+{
+    std::ifstream file;
+    std::ofstream journal;
+    std::stringstream before;
+    std::stringstream after;
+    std::string journal_path = std::string (archive_path_out) + ".journal";
+    struct stat st;
+    size_t offset;
+
+    create_mockup_archive ();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    file.open (archive_path_out, std::ios::binary);
+    before << file.rdbuf();
+    file.close();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_section");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // The journal is removed once the append is complete.
+    ASSERT_NE (0, stat (journal_path.c_str(), &st));
+
+    file.open (archive_path_out, std::ios::binary);
+    after << file.rdbuf();
+    file.close();
+    ASSERT_TRUE (before.str() != after.str());
+
+    // Leave behind the journal of the append, as if it was interrupted.
+    for (offset = 0; before.str()[offset] == after.str()[offset]; offset++);
+    journal.open (journal_path, std::ios::binary);
+    journal << "disir-splice " << offset << " " << before.str().size() - offset << "\n";
+    journal << before.str().substr (offset);
+    journal.close();
+
+    // Restored to what it was before the append, the next time it is opened.
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_NE (0, stat (journal_path.c_str(), &st));
+
+    std::stringstream restored;
+    file.open (archive_path_out, std::ios::binary);
+    restored << file.rdbuf();
+    file.close();
+    ASSERT_TRUE (before.str() == restored.str());
+}
+
+TEST_F (ArchiveExistingTest, append_in_place_incomplete_journal)
+{
+    std::ifstream file;
+    std::ofstream journal;
+    std::stringstream before;
+    std::stringstream after;
+    std::string journal_path = std::string (archive_path_out) + ".journal";
+    struct stat st;
+
+    create_mockup_archive ();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    file.open (archive_path_out, std::ios::binary);
+    before << file.rdbuf();
+    file.close();
+
+    // Interrupted while the journal was written, before the archive was touched.
+    journal.open (journal_path, std::ios::binary);
+    journal << "disir-splice 10 4096\nshort";
+    journal.close();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_NE (0, stat (journal_path.c_str(), &st));
+
+    file.open (archive_path_out, std::ios::binary);
+    after << file.rdbuf();
+    file.close();
+    ASSERT_TRUE (before.str() == after.str());
+}
+
+TEST_F (ArchiveExistingTest, append_to_new_location)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_archive_listing *current;
+    struct stat st;
+    const char *moved_path = "/tmp/archive_moved.disir";
+    int count = 0;
+
+    create_mockup_archive ();
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_archive_export_begin (instance_export, archive_path_out, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_section");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_finalize (instance_export, moved_path, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_NE (0, stat (archive_path_out, &st));
+
+    status = disir_archive_list (instance_export, moved_path, &listing);
+    remove_file (moved_path);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (current = listing; current != NULL; current = current->next)
+    {
+        count++;
+    }
+    disir_archive_listing_finished (&listing);
+
+    ASSERT_EQ (6, count);
+}
@@ -2,10 +2,15 @@
 #include <disir/disir.h>
 #include <disir/archive.h>
 #include <stdio.h>
+#include <errno.h>
 #include "archive_test_helper.h"
+#include "archive_private.h"
 #include <archive.h>
 #include <archive_entry.h>
 #include <libgen.h>
+#include <fstream>
+#include <string>
+#include <vector>
 
 
 //! Contains tests that test the public disir_archive_append_group API.
@@ -53,6 +58,58 @@ public:
     struct archive_entry *archive_entry = NULL;
     const char *archive_path_in = "/tmp/testarchive";
     const char *archive_path_out = "/tmp/testarchive.disir";
+
+    //! Leading bytes of the file, enough to hold the tar header of the first member.
+    std::string read_magic (const char *path)
+    {
+        std::ifstream file (path, std::ios::binary);
+        std::string magic (512, '\0');
+
+        file.read (&magic[0], magic.size());
+        magic.resize (file.gcount());
+        return magic;
+    }
+
+    //! archive_write_open callback that accepts the first write, failing every later
+    //! one as a full device would. data points to the number of writes seen.
+    static la_ssize_t
+    write_until_full (struct archive *ar, void *data, const void *buffer, size_t size)
+    {
+        (void) buffer;
+
+        if ((*(int *) data)++ == 0)
+            return size;
+
+        archive_set_error (ar, ENOSPC, "no space left on test device");
+        return -1;
+    }
+
+    static void
+    collect (void *data, const char *line, size_t size)
+    {
+        ((std::vector<std::string> *) data)->push_back (std::string (line, size));
+    }
+
+    std::vector<std::string> read_member_names (const char *path)
+    {
+        std::vector<std::string> names;
+        struct archive *ar;
+        struct archive_entry *entry;
+
+        ar = archive_read_new();
+        archive_read_support_format_tar (ar);
+        archive_read_support_filter_all (ar);
+        if (archive_read_open_filename (ar, path, 10240) == ARCHIVE_OK)
+        {
+            while (archive_read_next_header (ar, &entry) == ARCHIVE_OK)
+            {
+                names.push_back (archive_entry_pathname (entry));
+            }
+        }
+        archive_read_free (ar);
+
+        return names;
+    }
 };
 
 TEST_F (ArchiveAppendNewTest, invalid_arguments)
@@ -218,6 +275,8 @@ TEST_F (ArchiveAppendNewTest, append_single_entry)
             continue;
         if (filename.find ("entries.toml") != std::string::npos)
             continue;
+        if (filename.find ("entries.index") != std::string::npos)
+            continue;
 
         ASSERT_STREQ (filename.c_str(), "JSON/JSON/basic_keyval");
     }
@@ -266,7 +325,8 @@ TEST_F (ArchiveAppendNewTest, multiple_single_entry_appends)
         std::string filename = archive_entry_pathname (archive_entry);
 
         if (filename.find ("metadata.toml") != std::string::npos ||
-            filename.find ("entries.toml") != std::string::npos)
+            filename.find ("entries.toml") != std::string::npos ||
+            filename.find ("entries.index") != std::string::npos)
         {
             continue;
         }
@@ -318,3 +378,149 @@ TEST_F (ArchiveAppendNewTest, finalize_with_path_to_directory)
 
     ASSERT_EQ (stat (archive_path_out, &st), 0);
 }
+
+TEST_F (ArchiveAppendNewTest, export_begin_codec_invalid_arguments)
+{
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_archive_export_begin_codec (instance_export, NULL,
+                                               (enum disir_archive_codec) 42,
+                                               DISIR_ARCHIVE_LEVEL_DEFAULT, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    ASSERT_STREQ ("unknown archive codec: 42", disir_error (instance_export));
+
+    status = disir_archive_export_begin_codec (instance_export, NULL, DISIR_ARCHIVE_CODEC_XZ,
+                                               10, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    ASSERT_STREQ ("compression level 10 out of range [0, 9]", disir_error (instance_export));
+
+    status = disir_archive_export_begin_codec (instance_export, NULL, DISIR_ARCHIVE_CODEC_ZSTD,
+                                               0, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    ASSERT_STREQ ("compression level 0 out of range [1, 22]", disir_error (instance_export));
+
+    status = disir_archive_export_begin_codec (instance_export, NULL, DISIR_ARCHIVE_CODEC_NONE,
+                                               1, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+    ASSERT_STREQ ("uncompressed archives take no compression level",
+                  disir_error (instance_export));
+    ASSERT_TRUE (disir_archive == NULL);
+}
+
+TEST_F (ArchiveAppendNewTest, export_codecs)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_import *import = NULL;
+    const enum disir_archive_codec codecs[] = {
+        DISIR_ARCHIVE_CODEC_XZ, DISIR_ARCHIVE_CODEC_ZSTD,
+        DISIR_ARCHIVE_CODEC_GZIP, DISIR_ARCHIVE_CODEC_NONE,
+    };
+
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (auto codec : codecs)
+    {
+        SCOPED_TRACE (codec);
+
+        status = disir_archive_export_begin_codec (instance_export, NULL, codec,
+                                                   codec == DISIR_ARCHIVE_CODEC_NONE ?
+                                                   DISIR_ARCHIVE_LEVEL_DEFAULT : 1,
+                                                   &disir_archive);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_archive_append_entry (instance_export, disir_archive,
+                                             "JSON", "basic_keyval");
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_archive_finalize (instance_export, archive_path_in, &disir_archive);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        // Compressed with the codec asked for.
+        std::string magic = read_magic (archive_path_out);
+        switch (codec)
+        {
+        case DISIR_ARCHIVE_CODEC_XZ:
+            EXPECT_EQ (std::string ("\xFD" "7zXZ\0", 6), magic.substr (0, 6));
+            break;
+        case DISIR_ARCHIVE_CODEC_ZSTD:
+            EXPECT_EQ (std::string ("\x28\xB5\x2F\xFD", 4), magic.substr (0, 4));
+            break;
+        case DISIR_ARCHIVE_CODEC_GZIP:
+            EXPECT_EQ (std::string ("\x1F\x8B", 2), magic.substr (0, 2));
+            break;
+        default:
+            EXPECT_EQ (std::string ("ustar"), magic.substr (257, 5));
+            break;
+        }
+
+        // Only xz archives are read a member at a time, through the entry index.
+        std::vector<std::string> members = read_member_names (archive_path_out);
+        EXPECT_EQ (codec == DISIR_ARCHIVE_CODEC_XZ ? 1 : 0,
+                   std::count (members.begin(), members.end(), "entries.index"));
+
+        status = disir_archive_list (instance_export, archive_path_out, &listing);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        ASSERT_TRUE (listing != NULL);
+        EXPECT_STREQ ("basic_keyval", listing->al_entry_id);
+        EXPECT_TRUE (listing->next == NULL);
+        disir_archive_listing_finished (&listing);
+
+        status = disir_archive_import_entry (instance_export, archive_path_out,
+                                             "JSON", "basic_keyval", &import);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_import_finalize (instance_export, DISIR_IMPORT_DISCARD, &import, NULL);
+
+        ASSERT_EQ (0, remove (archive_path_out));
+    }
+}
+
+TEST_F (ArchiveAppendNewTest, failing_archive_write_shall_be_reported)
+{
+    struct archive *original;
+    struct disir_archive_writer *writer;
+    std::vector<std::string> lines;
+    int writes = 0;
+    bool reported = false;
+
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_archive_export_begin_codec (instance_export, NULL, DISIR_ARCHIVE_CODEC_NONE,
+                                               DISIR_ARCHIVE_LEVEL_DEFAULT, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Write the tar stream straight to a target that fills up after the member header.
+    archive = archive_write_new ();
+    ASSERT_TRUE (archive != NULL);
+    ASSERT_EQ (ARCHIVE_OK, archive_write_set_format (archive, ARCHIVE_FORMAT_TAR));
+    ASSERT_EQ (ARCHIVE_OK, archive_write_set_bytes_per_block (archive, 0));
+    ASSERT_EQ (ARCHIVE_OK, archive_write_open (archive, &writes, NULL, write_until_full, NULL));
+
+    original = disir_archive->da_archive;
+    writer = disir_archive->da_writer;
+    disir_archive->da_archive = archive;
+    disir_archive->da_writer = NULL;
+
+    disir_log_set_sink (collect, &lines);
+    status = disir_archive_append_entry (instance_export, disir_archive, "JSON", "basic_keyval");
+    disir_log_flush ();
+    disir_log_set_sink (NULL, NULL);
+
+    disir_archive->da_archive = original;
+    disir_archive->da_writer = writer;
+    archive_write_free (archive);
+    archive = NULL;
+
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    for (auto& line : lines)
+    {
+        if (line.find ("error writing to archive: no space left on test device")
+            != std::string::npos)
+        {
+            reported = true;
+        }
+    }
+    EXPECT_TRUE (reported);
+
+    status = disir_archive_finalize (instance_export, NULL, &disir_archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+}
@@ -547,3 +547,157 @@ TEST_F (ImportTest, import_equal_group_yet_no_equal_backend_name)
     disir_mold_finished (&mold);
 }
 
+
+TEST_F (ImportTest, import_entry)
+{
+    setup_export_import_config ("json_test_mold", "json_test_mold_2_0", true, NULL);
+    setup_export_import_config ("multiple_defaults", "multiple_defaults_1_0", true, NULL);
+
+    status = disir_archive_finalize (instance_export, "/tmp/archive.disir", &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_archive_import_entry (instance_import, "/tmp/archive.disir",
+                                         "JSON", "multiple_defaults", &import);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Only the requested entry is part of the import.
+    status = disir_import_entry_status (import, 1, &entry_id, &group_id, &version, &errmsg);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    // Resolved as by disir_archive_import
+    status = disir_import_entry_status (import, 0, &entry_id, &group_id, &version, &errmsg);
+    ASSERT_STATUS (DISIR_STATUS_CONFLICTING_SEMVER, status);
+
+    ASSERT_STREQ ("multiple_defaults", entry_id);
+    ASSERT_STREQ ("JSON", group_id);
+    ASSERT_STREQ ("1.0", version);
+    ASSERT_STREQ ("archive entry version is (1.0) but system version is (1.2)", errmsg);
+
+    status = disir_import_resolve_entry (import, 0, DISIR_IMPORT_UPDATE);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_import_finalize (instance_import, DISIR_IMPORT_DO, &import, NULL);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_NO_FATAL_FAILURE (
+        compare_imported_with_ref ("multiple_defaults",
+                                   m_nondefault_configs["multiple_defaults_1_2"]);
+    );
+}
+
+TEST_F (ImportTest, import_entry_not_in_archive)
+{
+    setup_export_import_config ("json_test_mold", "json_test_mold_2_0", true, NULL);
+
+    status = disir_archive_finalize (instance_export, "/tmp/archive.disir", &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_archive_import_entry (instance_import, "/tmp/archive.disir",
+                                         "JSON", "multiple_defaults", &import);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    ASSERT_STREQ ("entry 'multiple_defaults' in group 'JSON' does not exist in archive",
+                  disir_error (instance_import));
+
+    status = disir_archive_import_entry (instance_import, "/tmp/archive.disir",
+                                         "test", "json_test_mold", &import);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    status = disir_archive_import_entry (instance_import, "/tmp/invalid",
+                                         "JSON", "json_test_mold", &import);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (ImportTest, import_entry_corrupt_member)
+{
+    FILE *file;
+    long size;
+
+    setup_export_import_config ("json_test_mold", "json_test_mold_2_0", true, NULL);
+
+    status = disir_archive_finalize (instance_export, "/tmp/archive.disir", &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // Flip a byte in the block holding the config entry, well ahead of the index.
+    file = fopen ("/tmp/archive.disir", "r+b");
+    ASSERT_TRUE (file != NULL);
+    fseek (file, 0, SEEK_END);
+    size = ftell (file);
+    ASSERT_GT (size, 200);
+    fseek (file, 100, SEEK_SET);
+    int c = fgetc (file);
+    fseek (file, 100, SEEK_SET);
+    fputc (c ^ 0xff, file);
+    fclose (file);
+
+    status = disir_archive_import_entry (instance_import, "/tmp/archive.disir",
+                                         "JSON", "json_test_mold", &import);
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    ASSERT_TRUE (import == NULL);
+}
+
+TEST_F (ImportTest, import_oversized_member)
+{
+    char header[512];
+    unsigned int checksum = 0;
+    FILE *file;
+
+    status = disir_archive_finalize (instance_export, NULL, &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // A lone tar header claiming a member of 8 GiB, without any of its data.
+    memset (header, 0, sizeof (header));
+    strcpy (header, "metadata.toml");
+    strcpy (header + 100, "0000644");
+    strcpy (header + 108, "0000000");
+    strcpy (header + 116, "0000000");
+    strcpy (header + 124, "77777777777");
+    strcpy (header + 136, "00000000000");
+    memset (header + 148, ' ', 8);
+    header[156] = '0';
+    memcpy (header + 257, "ustar\0" "00", 8);
+    for (size_t i = 0; i < sizeof (header); i++)
+        checksum += (unsigned char) header[i];
+    snprintf (header + 148, 8, "%06o", checksum);
+
+    file = fopen ("/tmp/oversized.disir", "wb");
+    ASSERT_TRUE (file != NULL);
+    fwrite (header, 1, sizeof (header), file);
+    fclose (file);
+
+    status = disir_archive_import (instance_import, "/tmp/oversized.disir",
+                                   &import, &import_entries);
+    remove ("/tmp/oversized.disir");
+    ASSERT_STATUS (DISIR_STATUS_FS_ERROR, status);
+    ASSERT_TRUE (import == NULL);
+}
+
+TEST_F (ImportTest, list_archive)
+{
+    struct disir_archive_listing *listing = NULL;
+    struct disir_archive_listing *current;
+    std::map<std::string, std::string> versions;
+
+    setup_export_import_config ("json_test_mold", "json_test_mold_2_0", false, NULL);
+    setup_export_import_config ("multiple_defaults", "multiple_defaults_1_0", false, NULL);
+
+    status = disir_archive_finalize (instance_export, "/tmp/archive.disir", &archive);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_archive_list (instance_import, "/tmp/archive.disir", &listing);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (current = listing; current != NULL; current = current->next)
+    {
+        EXPECT_STREQ ("JSON", current->al_group_id);
+        EXPECT_STREQ ("JSON", current->al_backend_id);
+        versions[current->al_entry_id] = current->al_version;
+    }
+
+    status = disir_archive_listing_finished (&listing);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_TRUE (listing == NULL);
+
+    ASSERT_EQ (2u, versions.size());
+    ASSERT_EQ ("2.0", versions["json_test_mold"]);
+    ASSERT_EQ ("1.0", versions["multiple_defaults"]);
+}
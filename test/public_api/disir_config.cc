@@ -81,3 +81,31 @@ TEST_F (DisirConfigTest, entries)
     ASSERT_GT (count, 0);
 }
 
+
+TEST_F (DisirConfigTest, elements_shall_be_exhausted_after_config_finished)
+{
+    struct disir_config *config = NULL;
+    struct disir_collection *collection = NULL;
+    struct disir_context *context_config;
+    struct disir_context *current;
+
+    status = disir_config_read (instance, "test", "basic_keyval", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    context_config = dc_config_getcontext (config);
+
+    status = dc_get_elements (context_config, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_LT (0, dc_collection_size (collection));
+    dc_putcontext (&context_config);
+
+    // The collection outlives the tree its contexts were part of.
+    status = disir_config_finished (&config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_collection_next (collection, &current);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+    EXPECT_EQ (0, dc_collection_size (collection));
+
+    status = dc_collection_finished (&collection);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+}
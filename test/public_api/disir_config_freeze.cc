@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+#include <disir/config.h>
+
+// TEST API
+#include "test_helper.h"
+
+
+//
+// This class tests the public API function:
+//  disir_config_freeze
+//
+class DisirConfigFreeze : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (snapshot)
+        {
+            disir_config_finished (&snapshot);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status status;
+    const char *string_value = NULL;
+    struct disir_config *config = NULL;
+    struct disir_config *snapshot = NULL;
+};
+
+TEST_F (DisirConfigFreeze, invalid_argument)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_config_freeze (NULL, &snapshot));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_config_freeze (config, NULL));
+}
+
+TEST_F (DisirConfigFreeze, snapshot_shall_equal_source)
+{
+    struct disir_version config_version;
+    struct disir_version snapshot_version;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_config_set_keyval_string (config, "modified", "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (config, &snapshot));
+
+    status = disir_config_get_keyval_string (snapshot, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+    status = disir_config_get_keyval_string (snapshot, &string_value, "first@1.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("modified", string_value);
+    status = disir_config_get_keyval_string (snapshot, &string_value, "first@2.key_string");
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_get_version (config, &config_version));
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_config_get_version (snapshot, &snapshot_version));
+    EXPECT_EQ (0, dc_version_compare (&config_version, &snapshot_version));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_valid (snapshot, NULL));
+}
+
+TEST_F (DisirConfigFreeze, snapshot_shall_not_be_modifiable)
+{
+    struct disir_context *context_config;
+    struct disir_context *context_keyval;
+    struct disir_context *context_section;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (config, &snapshot));
+
+    status = disir_config_set_keyval_string (snapshot, "modified", "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, status);
+    status = disir_config_set_keyval_string (snapshot, "added", "first@1.key_string@1");
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, status);
+
+    context_config = dc_config_getcontext (snapshot);
+    ASSERT_TRUE (context_config != NULL);
+    status = dc_query_resolve_context (context_config, "first.key_string", &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, dc_set_value_string (context_keyval,
+                                                                              "modified", 8));
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, dc_set_name (context_keyval, "key", 3));
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, dc_destroy (&context_keyval));
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, dc_begin (context_config,
+                                                                  DISIR_CONTEXT_SECTION,
+                                                                  &context_section));
+    dc_putcontext (&context_keyval);
+    dc_putcontext (&context_config);
+
+    status = disir_config_get_keyval_string (snapshot, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+}
+
+TEST_F (DisirConfigFreeze, source_shall_remain_modifiable)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (config, &snapshot));
+
+    status = disir_config_set_keyval_string (config, "modified", "first.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string (config, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("modified", string_value);
+    status = disir_config_get_keyval_string (snapshot, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+}
+
+TEST_F (DisirConfigFreeze, snapshot_of_snapshot)
+{
+    struct disir_config *copy = NULL;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (config, &snapshot));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (snapshot, &copy));
+
+    status = disir_config_get_keyval_string (copy, &string_value, "first@1.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_finished (&copy));
+}
+
+TEST_F (DisirConfigFreeze, concurrent_readers)
+{
+    std::vector<std::thread> threads;
+    std::vector<int> failures (4, 0);
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_freeze (config, &snapshot));
+
+    for (size_t i = 0; i < failures.size (); i++)
+    {
+        threads.emplace_back ([this, i, &failures] ()
+        {
+            const char *value;
+            for (int round = 0; round < 2000; round++)
+            {
+                if (disir_config_get_keyval_string (snapshot, &value,
+                                                    "first@%d.key_string", round % 2)
+                    != DISIR_STATUS_OK || strcmp (value, "string_value") != 0)
+                {
+                    failures[i]++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join ();
+    }
+
+    for (auto failed : failures)
+    {
+        EXPECT_EQ (0, failed);
+    }
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+// TEST API
+#include "test_helper.h"
+
+#define READ_MANY_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/read_many"
+#define READ_MANY_CONFIG_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/config/read_many"
+
+
+//
+// This class tests the public API function:
+//  disir_config_read_many
+//
+class DisirConfigReadMany : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        for (auto& config : configs)
+        {
+            if (config)
+            {
+                disir_config_finished (&config);
+            }
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Allocate output arrays for entries.
+    void Prepare (const std::vector<const char *>& input)
+    {
+        entries = input;
+        configs.assign (entries.size (), NULL);
+        statuses.assign (entries.size (), DISIR_STATUS_INTERNAL_ERROR);
+    }
+
+    enum disir_status status;
+    std::vector<const char *> entries;
+    std::vector<struct disir_config *> configs;
+    std::vector<enum disir_status> statuses;
+};
+
+TEST_F (DisirConfigReadMany, invalid_argument)
+{
+    Prepare ({ "basic_keyval" });
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_read_many (NULL, "test", entries.data (), 1,
+                                           configs.data (), statuses.data (), 1));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_read_many (instance, NULL, entries.data (), 1,
+                                           configs.data (), statuses.data (), 1));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_read_many (instance, "test", NULL, 1,
+                                           configs.data (), statuses.data (), 1));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_read_many (instance, "test", entries.data (), 1,
+                                           NULL, statuses.data (), 1));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_read_many (instance, "test", entries.data (), 1,
+                                           configs.data (), NULL, 1));
+}
+
+TEST_F (DisirConfigReadMany, no_entries)
+{
+    Prepare ({ "basic_keyval" });
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_config_read_many (instance, "test", entries.data (), 0,
+                                           configs.data (), statuses.data (), 4));
+    EXPECT_TRUE (configs[0] == NULL);
+    EXPECT_STATUS (DISIR_STATUS_INTERNAL_ERROR, statuses[0]);
+}
+
+TEST_F (DisirConfigReadMany, statuses_shall_match_config_read)
+{
+    Prepare ({ "basic_keyval", "this_entry_does_not_exist", "complex_section",
+               "restriction_entries", "config_query_permutations", "basic_section",
+               "json_test_mold", "nested/basic_keyval" });
+
+    for (int nthreads : { 1, 3, 0 })
+    {
+        SCOPED_TRACE (nthreads);
+
+        status = disir_config_read_many (instance, "test", entries.data (), entries.size (),
+                                         configs.data (), statuses.data (), nthreads);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        // The failed entry is summarized on the instance.
+        EXPECT_TRUE (disir_error (instance) != NULL);
+
+        for (size_t i = 0; i < entries.size (); i++)
+        {
+            struct disir_config *config = NULL;
+            enum disir_status expected;
+
+            SCOPED_TRACE (entries[i]);
+
+            expected = disir_config_read (instance, "test", entries[i], NULL, &config);
+            EXPECT_STATUS (expected, statuses[i]);
+            EXPECT_EQ ((config == NULL), (configs[i] == NULL));
+
+            if (config)
+            {
+                disir_config_finished (&config);
+            }
+            if (configs[i])
+            {
+                disir_config_finished (&configs[i]);
+            }
+        }
+    }
+}
+
+TEST_F (DisirConfigReadMany, entries_shall_share_mold)
+{
+    struct disir_mold *mold = NULL;
+    struct disir_config *config = NULL;
+    struct disir_mold_cache_stats stats;
+    std::vector<std::string> names;
+
+    // Many config entries in the json group, covered by the same namespace mold.
+    status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_mold_write (instance, "json", "read_many/__namespace", mold);
+    disir_mold_finished (&mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    for (int i = 0; i < 32; i++)
+    {
+        names.push_back ("read_many/entry_" + std::to_string (i));
+        EXPECT_STATUS (DISIR_STATUS_OK, disir_config_write (instance, "json",
+                                                            names.back ().c_str (), config));
+    }
+    disir_config_finished (&config);
+
+    Prepare ({});
+    for (const auto& name : names)
+    {
+        entries.push_back (name.c_str ());
+    }
+    configs.assign (entries.size (), NULL);
+    statuses.assign (entries.size (), DISIR_STATUS_INTERNAL_ERROR);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_clear (instance));
+    status = disir_config_read_many (instance, "json", entries.data (), entries.size (),
+                                     configs.data (), statuses.data (), 4);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_stats (instance, &stats));
+    EXPECT_EQ (1, stats.mcs_entries);
+
+    for (size_t i = 0; i < entries.size (); i++)
+    {
+        const char *value;
+        struct disir_mold *config_mold = NULL;
+
+        SCOPED_TRACE (entries[i]);
+        ASSERT_STATUS (DISIR_STATUS_OK, statuses[i]);
+
+        status = disir_config_get_keyval_string (configs[i], &value, "first.key_string");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_STREQ ("string_value", value);
+
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_config_get_mold (configs[i], &config_mold));
+        if (mold == NULL)
+        {
+            mold = config_mold;
+        }
+        else
+        {
+            EXPECT_EQ (mold, config_mold);
+            disir_mold_finished (&config_mold);
+        }
+    }
+    disir_mold_finished (&mold);
+
+    for (const auto& name : names)
+    {
+        std::remove ((READ_MANY_CONFIG_DIRECTORY "/" + name.substr (10) + ".json").c_str ());
+    }
+    std::remove (READ_MANY_MOLD_DIRECTORY "/__namespace.json");
+    rmdir (READ_MANY_CONFIG_DIRECTORY);
+    rmdir (READ_MANY_MOLD_DIRECTORY);
+}
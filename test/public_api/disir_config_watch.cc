@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+
+// TEST API
+#include "test_helper.h"
+
+
+//
+// This class tests the public API functions:
+//  disir_config_watch
+//  disir_watch_acquire
+//  disir_watch_release
+//  disir_watch_reload
+//  disir_watch_generation
+//  disir_watch_finished
+//
+class DisirConfigWatch : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (watch)
+        {
+            disir_watch_finished (&watch);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Wait up to five seconds for the watch to publish generation.
+    bool WaitForGeneration (uint64_t generation)
+    {
+        for (int i = 0; i < 500; i++)
+        {
+            if (disir_watch_generation (watch) >= generation)
+                return true;
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+        return false;
+    }
+
+    enum disir_status status;
+    const char *string_value = NULL;
+    struct disir_watch *watch = NULL;
+    struct disir_config *config = NULL;
+    uint64_t ticket;
+};
+
+TEST_F (DisirConfigWatch, invalid_argument)
+{
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_watch (NULL, "test", "basic_keyval", &watch));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_watch (instance, NULL, "basic_keyval", &watch));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_watch (instance, "test", NULL, &watch));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_config_watch (instance, "test", "basic_keyval", NULL));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_watch_acquire (NULL, &config, &ticket));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_watch_release (NULL, ticket));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_watch_reload (NULL));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_watch_finished (NULL));
+    ASSERT_EQ (0, disir_watch_generation (NULL));
+}
+
+TEST_F (DisirConfigWatch, nonexisting_entry)
+{
+    status = disir_config_watch (instance, "test", "this_entry_does_not_exist", &watch);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    ASSERT_TRUE (watch == NULL);
+}
+
+TEST_F (DisirConfigWatch, acquire_published_snapshot)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_config_watch (instance, "test", "config_query_permutations", &watch));
+    ASSERT_EQ (1, disir_watch_generation (watch));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &config, &ticket));
+    status = disir_config_get_keyval_string (config, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    // The snapshot is read-only
+    status = disir_config_set_keyval_string (config, "modified", "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_CONTEXT_IN_WRONG_STATE, status);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, ticket));
+}
+
+TEST_F (DisirConfigWatch, reload_shall_publish_new_generation)
+{
+    struct disir_config *first;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_config_watch (instance, "test", "config_query_permutations", &watch));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &first, &ticket));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, ticket));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_reload (watch));
+    ASSERT_EQ (2, disir_watch_generation (watch));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &config, &ticket));
+    EXPECT_NE (first, config);
+    status = disir_config_get_keyval_string (config, &string_value, "first@1.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, ticket));
+}
+
+TEST_F (DisirConfigWatch, reload_shall_wait_for_readers_of_replaced_snapshot)
+{
+    struct disir_config *held;
+    uint64_t held_ticket;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_config_watch (instance, "test", "config_query_permutations", &watch));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &held, &held_ticket));
+
+    std::thread reloader ([this] () { disir_watch_reload (watch); });
+    ASSERT_TRUE (WaitForGeneration (2));
+
+    // The new snapshot is published, while the held one is still intact.
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &config, &ticket));
+    EXPECT_NE (held, config);
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, ticket));
+
+    status = disir_config_get_keyval_string (held, &string_value, "first.key_string");
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, held_ticket));
+    reloader.join ();
+}
+
+TEST_F (DisirConfigWatch, file_write_shall_publish_new_generation)
+{
+    struct disir_instance *watch_instance = NULL;
+    struct disir_config *watch_libdisir_config = NULL;
+    struct disir_mold *mold = NULL;
+    struct disir_config *source = NULL;
+
+    // Store a mold and config in the filesystem backed json group.
+    status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_mold_write (instance, "json", "watch_test", mold);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_read (instance, "test", "config_query_permutations", NULL, &source);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_write (instance, "json", "watch_test", source);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    // The watch reads from its own thread - give it a dedicated instance.
+    // The instance takes ownership of its libdisir config; hand it a copy.
+    status = disir_config_freeze (libdisir_config, &watch_libdisir_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_instance_create (NULL, watch_libdisir_config, &watch_instance);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_watch (watch_instance, "json", "watch_test", &watch);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+    if (status == DISIR_STATUS_OK)
+    {
+        status = disir_config_set_keyval_string (source, "modified", "first.key_string");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_write (instance, "json", "watch_test", source);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+
+        EXPECT_TRUE (WaitForGeneration (2));
+
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_acquire (watch, &config, &ticket));
+        status = disir_config_get_keyval_string (config, &string_value, "first.key_string");
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_STREQ ("modified", string_value);
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_watch_release (watch, ticket));
+
+        disir_watch_finished (&watch);
+    }
+
+    disir_instance_destroy (&watch_instance);
+    disir_config_finished (&source);
+    disir_mold_finished (&mold);
+    std::remove (CMAKE_BUILD_DIRECTORY "/tree/json/config/watch_test.json");
+    std::remove (CMAKE_BUILD_DIRECTORY "/tree/json/mold/watch_test.json");
+}
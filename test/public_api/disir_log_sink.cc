@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// TEST API
+#include "test_helper.h"
+
+
+//
+// This class tests the public API functions:
+//  disir_log_set_sink
+//  disir_log_flush
+//
+class DisirLogSink : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        disir_log_set_sink (collect, this);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        disir_log_set_sink (NULL, NULL);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    static void
+    collect (void *data, const char *line, size_t size)
+    {
+        ((DisirLogSink *) data)->lines.push_back (std::string (line, size));
+    }
+
+    //! Lines logged to the sink containing needle.
+    std::vector<std::string>
+    matching (const std::string& needle)
+    {
+        std::vector<std::string> found;
+
+        // Stop collecting before inspecting the lines.
+        disir_log_flush ();
+        disir_log_set_sink (NULL, NULL);
+
+        for (auto& line : lines)
+        {
+            if (line.find (needle) != std::string::npos)
+                found.push_back (line);
+        }
+        return found;
+    }
+
+    std::vector<std::string> lines;
+};
+
+TEST_F (DisirLogSink, entry_shall_reach_sink_formatted)
+{
+    std::vector<std::string> found;
+
+    disir_log_user (instance, "sink entry %d", 42);
+
+    found = matching ("sink entry 42");
+    ASSERT_EQ (1, found.size ());
+
+    // [YYYY-MM-DD HH:MM:SS]-[USER ] sink entry 42
+    EXPECT_EQ ('[', found[0][0]);
+    EXPECT_EQ ("]-[USER ] sink entry 42", found[0].substr (20));
+    EXPECT_EQ (std::string::npos, found[0].find ('\n'));
+}
+
+TEST_F (DisirLogSink, error_set_shall_be_logged)
+{
+    disir_error_set (instance, "sink error %s", "message");
+
+    EXPECT_EQ (1, matching ("sink error message").size ());
+}
+
+TEST_F (DisirLogSink, overlong_entry_shall_be_truncated)
+{
+    std::string message (4000, 'x');
+    std::vector<std::string> found;
+
+    disir_log_user (instance, "overlong %s", message.c_str ());
+
+    found = matching ("overlong ");
+    ASSERT_EQ (1, found.size ());
+    EXPECT_GT (found[0].size (), 500);
+    EXPECT_LT (found[0].size (), message.size ());
+}
+
+TEST_F (DisirLogSink, entries_from_many_threads_shall_all_reach_sink)
+{
+    std::vector<std::thread> threads;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        threads.push_back (std::thread ([this, i] () {
+            int j;
+            for (j = 0; j < 100; j++)
+            {
+                disir_log_user (instance, "threaded entry %d:%d", i, j);
+            }
+        }));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join ();
+    }
+
+    EXPECT_EQ (400, matching ("threaded entry ").size ());
+}
+
+TEST_F (DisirLogSink, child_shall_log_after_fork_during_threaded_logging)
+{
+    std::atomic<bool> stop (false);
+    std::thread thread;
+    pid_t pid;
+    int wstatus;
+    int i;
+
+    thread = std::thread ([this, &stop] () {
+        while (stop == false)
+        {
+            disir_log_user (instance, "parent entry");
+        }
+    });
+
+    for (i = 0; i < 20; i++)
+    {
+        pid = fork ();
+        if (pid == -1)
+        {
+            ADD_FAILURE () << "fork failed";
+            break;
+        }
+        if (pid == 0)
+        {
+            int j;
+
+            // A child stuck on the inherited ring never exits on its own.
+            alarm (10);
+            lines.clear ();
+
+            // Enough entries to fill the ring several times over.
+            for (j = 0; j < 4000; j++)
+            {
+                disir_log_user (instance, "child entry %d", j);
+            }
+            _exit (matching ("child entry ").size () == 4000 ? 0 : 1);
+        }
+
+        EXPECT_EQ (pid, waitpid (pid, &wstatus, 0));
+        EXPECT_TRUE (WIFEXITED (wstatus)) << "child terminated by signal "
+                                          << WTERMSIG (wstatus);
+        EXPECT_EQ (0, WEXITSTATUS (wstatus));
+    }
+
+    stop = true;
+    thread.join ();
+}
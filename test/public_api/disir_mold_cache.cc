@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// TEST API
+#include "test_helper.h"
+
+#define MOLD_CACHE_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/mold_cache"
+#define MOLD_CACHE_CONFIG_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/config/mold_cache"
+
+
+//
+// This class tests the public API functions:
+//  disir_mold_cache_stats
+//  disir_mold_cache_clear
+//
+class DisirMoldCache : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        struct disir_mold *mold = NULL;
+
+        DisirTestTestPlugin::SetUp ();
+
+        // Two config entries in the json group, covered by the same namespace mold.
+        status = disir_mold_read (instance, "test", "config_query_permutations", &mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_mold_write (instance, "json", "mold_cache/__namespace", mold);
+        disir_mold_finished (&mold);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        status = disir_config_read (instance, "test", "config_query_permutations", NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_write (instance, "json", "mold_cache/a", config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = disir_config_write (instance, "json", "mold_cache/b", config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        disir_config_finished (&config);
+
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_clear (instance));
+        ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_stats (instance, &before));
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+        if (other)
+        {
+            disir_config_finished (&other);
+        }
+
+        std::remove (MOLD_CACHE_CONFIG_DIRECTORY "/a.json");
+        std::remove (MOLD_CACHE_CONFIG_DIRECTORY "/b.json");
+        std::remove (MOLD_CACHE_MOLD_DIRECTORY "/__namespace.json");
+        rmdir (MOLD_CACHE_CONFIG_DIRECTORY);
+        rmdir (MOLD_CACHE_MOLD_DIRECTORY);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status status;
+    struct disir_config *config = NULL;
+    struct disir_config *other = NULL;
+    struct disir_mold_cache_stats before;
+    struct disir_mold_cache_stats after;
+};
+
+TEST_F (DisirMoldCache, invalid_argument)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_mold_cache_stats (NULL, &after));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_mold_cache_stats (instance, NULL));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_mold_cache_clear (NULL));
+}
+
+TEST_F (DisirMoldCache, configs_sharing_mold_shall_hit)
+{
+    struct disir_mold *config_mold = NULL;
+    struct disir_mold *other_mold = NULL;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "json", "mold_cache/a",
+                                                       NULL, &config));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "json", "mold_cache/b",
+                                                       NULL, &other));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_stats (instance, &after));
+    EXPECT_EQ (before.mcs_misses + 1, after.mcs_misses);
+    EXPECT_EQ (before.mcs_hits + 1, after.mcs_hits);
+    EXPECT_EQ (1, after.mcs_entries);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_get_mold (config, &config_mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_get_mold (other, &other_mold));
+    EXPECT_EQ (config_mold, other_mold);
+    disir_mold_finished (&config_mold);
+    disir_mold_finished (&other_mold);
+}
+
+TEST_F (DisirMoldCache, modified_mold_shall_miss)
+{
+    struct timeval times[2];
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "json", "mold_cache/a",
+                                                       NULL, &config));
+
+    // Move the modification time of the mold entry
+    times[0].tv_sec = times[1].tv_sec = 1000000000;
+    times[0].tv_usec = times[1].tv_usec = 0;
+    ASSERT_EQ (0, utimes (MOLD_CACHE_MOLD_DIRECTORY "/__namespace.json", times));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "json", "mold_cache/b",
+                                                       NULL, &other));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_stats (instance, &after));
+    EXPECT_EQ (before.mcs_misses + 2, after.mcs_misses);
+    EXPECT_EQ (before.mcs_hits, after.mcs_hits);
+    EXPECT_EQ (1, after.mcs_entries);
+}
+
+TEST_F (DisirMoldCache, clear_shall_not_invalidate_configs)
+{
+    const char *value;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "json", "mold_cache/a",
+                                                       NULL, &config));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_clear (instance));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_cache_stats (instance, &after));
+    EXPECT_EQ (0, after.mcs_entries);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_get_keyval_string (config, &value,
+                                                                    "first.key_string"));
+    EXPECT_STREQ ("string_value", value);
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_valid (config, NULL));
+}
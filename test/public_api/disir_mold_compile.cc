@@ -0,0 +1,365 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// PUBLIC API
+#include <disir/disir.h>
+
+// TEST API
+#include "test_helper.h"
+
+#define MOLD_COMPILE_MOLD_DIRECTORY CMAKE_BUILD_DIRECTORY "/tree/json/mold/mold_compile"
+#define MOLD_COMPILE_IMAGE "/tmp/disir_mold_compile_test.compiled"
+
+
+//
+// This class tests the public API functions:
+//  disir_mold_compile
+//  disir_mold_load_compiled
+//  disir_mold_compile_entry
+//
+class DisirMoldCompile : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+        if (compiled)
+        {
+            disir_mold_finished (&compiled);
+        }
+
+        std::remove (MOLD_COMPILE_IMAGE);
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json");
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json.compiled");
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/__namespace.json");
+        std::remove (MOLD_COMPILE_MOLD_DIRECTORY "/entry.namespace.json.compiled");
+        rmdir (MOLD_COMPILE_MOLD_DIRECTORY);
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Return an empty string if the molds are equal.
+    std::string compare (struct disir_mold *lhs, struct disir_mold *rhs)
+    {
+        struct disir_context *context_lhs;
+        struct disir_context *context_rhs;
+        struct disir_version version_lhs;
+        struct disir_version version_rhs;
+        std::string diff;
+
+        context_lhs = dc_mold_getcontext (lhs);
+        context_rhs = dc_mold_getcontext (rhs);
+        if (dc_compare (context_lhs, context_rhs, NULL) != DISIR_STATUS_OK)
+        {
+            diff = "molds differ";
+        }
+        dc_putcontext (&context_lhs);
+        dc_putcontext (&context_rhs);
+
+        dc_mold_get_version (lhs, &version_lhs);
+        dc_mold_get_version (rhs, &version_rhs);
+        if (dc_version_compare (&version_lhs, &version_rhs) != 0)
+        {
+            diff += "\nmold versions differ";
+        }
+
+        return diff;
+    }
+
+    //! Set the modification time of filepath, in seconds since the epoch.
+    void set_mtime (const char *filepath, time_t seconds)
+    {
+        struct timeval times[2];
+
+        times[0].tv_sec = times[1].tv_sec = seconds;
+        times[0].tv_usec = times[1].tv_usec = 0;
+        ASSERT_EQ (0, utimes (filepath, times));
+    }
+
+    std::string read_file (const char *filepath)
+    {
+        std::ifstream file (filepath, std::ios::binary);
+        return std::string ((std::istreambuf_iterator<char> (file)),
+                            std::istreambuf_iterator<char> ());
+    }
+
+    void write_file (const char *filepath, const std::string& content)
+    {
+        std::ofstream file (filepath, std::ios::binary | std::ios::trunc);
+        file << content;
+    }
+
+public:
+    struct disir_mold *mold = NULL;
+    struct disir_mold *compiled = NULL;
+};
+
+TEST_F (DisirMoldCompile, invalid_argument)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_read (instance, "test", "basic_keyval", &mold));
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_compile (NULL, mold, MOLD_COMPILE_IMAGE));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_compile (instance, NULL, MOLD_COMPILE_IMAGE));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_mold_compile (instance, mold, NULL));
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_load_compiled (NULL, MOLD_COMPILE_IMAGE, &compiled));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_load_compiled (instance, NULL, &compiled));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, NULL));
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_compile_entry (NULL, "test", "basic_keyval"));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_compile_entry (instance, NULL, "basic_keyval"));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT,
+                   disir_mold_compile_entry (instance, "test", NULL));
+}
+
+TEST_F (DisirMoldCompile, load_missing_image_shall_not_exist)
+{
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+    ASSERT_TRUE (compiled == NULL);
+}
+
+TEST_F (DisirMoldCompile, every_test_mold_shall_round_trip)
+{
+    struct disir_entry *entries;
+    struct disir_entry *next;
+    struct disir_entry *current;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_entries (instance, "test", &entries));
+
+    for (current = entries; current != NULL; current = next)
+    {
+        next = current->next;
+        SCOPED_TRACE (current->de_entry_name);
+
+        status = disir_mold_read (instance, "test", current->de_entry_name, &mold);
+        if (status == DISIR_STATUS_INVALID_CONTEXT)
+        {
+            // Invalid molds are not compiled.
+            EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT,
+                           disir_mold_compile (instance, mold, MOLD_COMPILE_IMAGE));
+        }
+        else
+        {
+            EXPECT_STATUS (DISIR_STATUS_OK, status);
+            EXPECT_STATUS (DISIR_STATUS_OK,
+                           disir_mold_compile (instance, mold, MOLD_COMPILE_IMAGE));
+            EXPECT_STATUS (DISIR_STATUS_OK,
+                           disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+            if (compiled)
+            {
+                EXPECT_EQ ("", compare (mold, compiled));
+                EXPECT_STATUS (DISIR_STATUS_OK, disir_mold_valid (compiled, NULL));
+                disir_mold_finished (&compiled);
+            }
+        }
+        if (mold)
+        {
+            disir_mold_finished (&mold);
+        }
+
+        disir_entry_finished (&current);
+    }
+}
+
+TEST_F (DisirMoldCompile, config_generated_from_image_shall_equal_source)
+{
+    struct disir_config *config_source = NULL;
+    struct disir_config *config_compiled = NULL;
+    struct disir_context *context_source;
+    struct disir_context *context_compiled;
+    struct disir_version version;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "test", "json_test_mold", &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_compile (instance, mold, MOLD_COMPILE_IMAGE));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+
+    // Defaults of an earlier version are resolved from the image as well.
+    version.sv_major = 1;
+    version.sv_minor = 0;
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_generate_config_from_mold (mold, &version, &config_source));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_generate_config_from_mold (compiled, &version, &config_compiled));
+
+    context_source = dc_config_getcontext (config_source);
+    context_compiled = dc_config_getcontext (config_compiled);
+    EXPECT_STATUS (DISIR_STATUS_OK, dc_compare (context_source, context_compiled, NULL));
+    dc_putcontext (&context_source);
+    dc_putcontext (&context_compiled);
+
+    // The config outlives the mold it references, and with it, the mapped image.
+    disir_mold_finished (&compiled);
+    EXPECT_STATUS (DISIR_STATUS_OK, disir_config_valid (config_compiled, NULL));
+
+    disir_config_finished (&config_source);
+    disir_config_finished (&config_compiled);
+}
+
+TEST_F (DisirMoldCompile, image_shall_be_replaced_not_rewritten)
+{
+    struct disir_mold *other = NULL;
+    struct stat before;
+    struct stat after;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_read (instance, "test", "basic_keyval", &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_compile (instance, mold, MOLD_COMPILE_IMAGE));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+    ASSERT_EQ (0, stat (MOLD_COMPILE_IMAGE, &before));
+
+    // Compiling another mold over the image in use must not disturb the loaded mold.
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "test", "json_test_mold", &other));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_compile (instance, other, MOLD_COMPILE_IMAGE));
+    disir_mold_finished (&other);
+    ASSERT_EQ (0, stat (MOLD_COMPILE_IMAGE, &after));
+
+    EXPECT_NE (before.st_ino, after.st_ino);
+    EXPECT_EQ ("", compare (mold, compiled));
+}
+
+TEST_F (DisirMoldCompile, corrupt_image_shall_be_rejected)
+{
+    std::string image;
+    std::string corrupt;
+    size_t i;
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "test", "json_test_mold", &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_compile (instance, mold, MOLD_COMPILE_IMAGE));
+    image = read_file (MOLD_COMPILE_IMAGE);
+    ASSERT_GT (image.size (), 64u);
+
+    // Not an image
+    write_file (MOLD_COMPILE_IMAGE, "{ \"mold\" : {} }");
+    EXPECT_STATUS (DISIR_STATUS_BAD_CONTEXT_OBJECT,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+
+    // Unknown format version
+    corrupt = image;
+    corrupt[8] += 1;
+    write_file (MOLD_COMPILE_IMAGE, corrupt);
+    EXPECT_STATUS (DISIR_STATUS_NO_CAN_DO,
+                   disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled));
+
+    // Truncated at every length
+    for (i = 0; i < image.size (); i += 7)
+    {
+        write_file (MOLD_COMPILE_IMAGE, image.substr (0, i));
+        status = disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled);
+        EXPECT_NE (DISIR_STATUS_OK, status) << "truncated to " << i;
+        ASSERT_TRUE (compiled == NULL);
+    }
+
+    // Every byte flipped in turn is either rejected, or loads a mold that can be released.
+    for (i = 0; i < image.size (); i++)
+    {
+        corrupt = image;
+        corrupt[i] ^= 0xff;
+        write_file (MOLD_COMPILE_IMAGE, corrupt);
+        status = disir_mold_load_compiled (instance, MOLD_COMPILE_IMAGE, &compiled);
+        if (status == DISIR_STATUS_OK)
+        {
+            disir_mold_finished (&compiled);
+        }
+        ASSERT_TRUE (compiled == NULL);
+    }
+}
+
+TEST_F (DisirMoldCompile, compile_entry_without_filesystem_shall_fail)
+{
+    ASSERT_STATUS (DISIR_STATUS_NO_CAN_DO,
+                   disir_mold_compile_entry (instance, "test", "basic_keyval"));
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST,
+                   disir_mold_compile_entry (instance, "json", "mold_compile/missing"));
+}
+
+TEST_F (DisirMoldCompile, read_shall_load_image_while_newer)
+{
+    struct disir_mold *other = NULL;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_read (instance, "test", "basic_keyval", &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_write (instance, "json", "mold_compile/basic", mold));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_compile_entry (instance, "json", "mold_compile/basic"));
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "json", "mold_compile/basic", &compiled));
+    EXPECT_EQ ("", compare (mold, compiled));
+    disir_mold_finished (&compiled);
+
+    // Replace the image with another mold, such that we can tell which one is read.
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "test", "json_test_mold", &other));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_compile (instance, other,
+                                       MOLD_COMPILE_MOLD_DIRECTORY "/basic.json.compiled"));
+    set_mtime (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json", 1000000000);
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "json", "mold_compile/basic", &compiled));
+    EXPECT_EQ ("", compare (other, compiled));
+    disir_mold_finished (&compiled);
+
+    // Equal modification times - the image is not newer.
+    set_mtime (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json.compiled", 1000000000);
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "json", "mold_compile/basic", &compiled));
+    EXPECT_EQ ("", compare (mold, compiled));
+    disir_mold_finished (&compiled);
+
+    // A corrupt image is ignored.
+    set_mtime (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json", 900000000);
+    write_file (MOLD_COMPILE_MOLD_DIRECTORY "/basic.json.compiled", "garbage");
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "json", "mold_compile/basic", &compiled));
+    EXPECT_EQ ("", compare (mold, compiled));
+
+    disir_mold_finished (&other);
+}
+
+TEST_F (DisirMoldCompile, namespace_entry_shall_have_image_of_its_own)
+{
+    struct stat statbuf;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_mold_read (instance, "test", "basic_keyval", &mold));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_write (instance, "json", "mold_compile/__namespace", mold));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_compile_entry (instance, "json", "mold_compile/entry"));
+
+    ASSERT_EQ (0, stat (MOLD_COMPILE_MOLD_DIRECTORY "/entry.namespace.json.compiled", &statbuf));
+    ASSERT_NE (0, stat (MOLD_COMPILE_MOLD_DIRECTORY "/entry.json.compiled", &statbuf));
+
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_mold_read (instance, "json", "mold_compile/entry", &compiled));
+    EXPECT_EQ ("", compare (mold, compiled));
+}
@@ -0,0 +1,216 @@
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/context.h>
+#include <disir/config.h>
+
+// TEST API
+#include "test_helper.h"
+
+
+//
+// This class tests the public API functions:
+//  disir_query_compile
+//  disir_query_finished
+//  disir_config_get_keyval_*_compiled
+//  disir_config_set_keyval_*_compiled
+//
+class DisirQueryCompiled : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+
+        status = disir_config_read (instance, "test", "config_query_permutations",
+                                    NULL, &config);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+        DisirLogTestBodyEnter ();
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        if (query)
+        {
+            disir_query_finished (&query);
+        }
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    enum disir_status status;
+    const char *string_value = NULL;
+    struct disir_config *config = NULL;
+    struct disir_query *query = NULL;
+};
+
+TEST_F (DisirQueryCompiled, compile_invalid_argument)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_query_compile (NULL, "first"));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_query_compile (&query, NULL));
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_query_finished (NULL));
+}
+
+TEST_F (DisirQueryCompiled, compile_malformed_query)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    const char *malformed[] = {
+        "", ".first", "first.", "first..key", "@1.key", "first@.key",
+        "first@1x.key", "first@", "first.@2",
+    };
+
+    for (auto q : malformed)
+    {
+        SCOPED_TRACE (q);
+        status = disir_query_compile (&query, "%s", q);
+        EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+        EXPECT_TRUE (query == NULL);
+    }
+}
+
+TEST_F (DisirQueryCompiled, compile_formats_query)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    status = disir_query_compile (&query, "first@%d.key_%s", 1, "string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("first@1.key_string", disir_query_string (query));
+}
+
+TEST_F (DisirQueryCompiled, get_existing_keyval)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first@1.key_string"));
+
+    // Resolve twice - the second resolution is served by the cached context.
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("string_value", string_value);
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("string_value", string_value);
+}
+
+TEST_F (DisirQueryCompiled, get_nonexisting_keyval)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first@1.key_string@1"));
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (DisirQueryCompiled, get_through_keyval_shall_fail)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first.key_string.key"));
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_WRONG_CONTEXT, status);
+}
+
+TEST_F (DisirQueryCompiled, get_wrong_value_type)
+{
+    int64_t integer_value;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first.key_string"));
+
+    status = disir_config_get_keyval_integer_compiled (config, &integer_value, query);
+    ASSERT_STATUS (DISIR_STATUS_WRONG_VALUE_TYPE, status);
+}
+
+TEST_F (DisirQueryCompiled, set_existing_keyval)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first@1.key_string"));
+
+    status = disir_config_set_keyval_string_compiled (config, "bloody", query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string (config, &string_value, "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("bloody", string_value);
+}
+
+TEST_F (DisirQueryCompiled, set_nonexisting_keyval_within_range)
+{
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first@1.key_string@1"));
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+
+    status = disir_config_set_keyval_string_compiled (config, "bloody", query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("bloody", string_value);
+}
+
+TEST_F (DisirQueryCompiled, cached_resolution_shall_follow_removed_element)
+{
+    struct disir_context *context_config;
+    struct disir_context *context_section;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first@1.key_string"));
+    status = disir_config_set_keyval_string (config, "second", "first@1.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STREQ ("second", string_value);
+
+    // Remove first@0 - first@1 no longer exists.
+    context_config = dc_config_getcontext (config);
+    ASSERT_TRUE (context_config != NULL);
+    status = dc_query_resolve_context (context_config, "first@0", &context_section);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_STATUS (DISIR_STATUS_OK, dc_destroy (&context_section));
+    dc_putcontext (&context_config);
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    ASSERT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+}
+
+TEST_F (DisirQueryCompiled, query_shall_be_usable_across_configs)
+{
+    struct disir_config *other = NULL;
+
+    ASSERT_NO_SETUP_FAILURE();
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_query_compile (&query, "first.key_string"));
+    status = disir_config_set_keyval_string (config, "modified", "first.key_string");
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_read (instance, "test", "config_query_permutations", NULL, &other);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_get_keyval_string_compiled (config, &string_value, query);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("modified", string_value);
+
+    status = disir_config_get_keyval_string_compiled (other, &string_value, query);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STREQ ("string_value", string_value);
+
+    disir_config_finished (&other);
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+// PUBLIC API
+#include <disir/disir.h>
+#include <disir/config.h>
+#include <disir/context.h>
+
+// TEST API
+#include "test_helper.h"
+
+
+//
+// This class tests the public API functions:
+//  disir_stats_enable
+//  disir_stats_get
+//  disir_stats_reset
+//  disir_stats_percentile
+//
+class DisirStats : public testing::DisirTestTestPlugin
+{
+    void SetUp()
+    {
+        DisirTestTestPlugin::SetUp ();
+        DisirLogTestBodyEnter ();
+
+        // The instance is shared by every test.
+        disir_stats_reset (instance);
+    }
+
+    void TearDown()
+    {
+        DisirLogTestBodyExit ();
+
+        disir_stats_enable (instance, 0);
+        disir_stats_enable (NULL, 0);
+        disir_stats_reset (NULL);
+
+        if (config)
+        {
+            disir_config_finished (&config);
+        }
+
+        DisirTestTestPlugin::TearDown ();
+    }
+
+public:
+    //! Sum of the histogram buckets of counter.
+    static uint64_t histogram_calls (const struct disir_stats_counter& counter)
+    {
+        uint64_t calls = 0;
+        for (int i = 0; i < DISIR_STATS_HISTOGRAM_BUCKETS; i++)
+        {
+            calls += counter.sc_histogram[i];
+        }
+        return calls;
+    }
+
+    enum disir_status status;
+    struct disir_config *config = NULL;
+    struct disir_stats stats;
+};
+
+TEST_F (DisirStats, invalid_argument)
+{
+    ASSERT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, disir_stats_get (instance, NULL));
+}
+
+TEST_F (DisirStats, disabled_by_default)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "test", "basic_keyval",
+                                                       NULL, &config));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    for (int i = 0; i < DISIR_STATS_OPERATION_COUNT; i++)
+    {
+        EXPECT_EQ (0u, stats.ds_counters[i].sc_calls)
+            << disir_stats_operation_string ((enum disir_stats_operation) i);
+    }
+}
+
+TEST_F (DisirStats, config_read_counted)
+{
+    const struct disir_stats_counter& read = stats.ds_counters[DISIR_STATS_CONFIG_READ];
+    const struct disir_stats_counter& validate = stats.ds_counters[DISIR_STATS_VALIDATE];
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (instance, 1));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "test", "basic_section",
+                                                       NULL, &config));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+
+    EXPECT_EQ (1u, read.sc_calls);
+    EXPECT_EQ (0u, read.sc_failures);
+    EXPECT_EQ (1u, histogram_calls (read));
+    EXPECT_GT (read.sc_total_ns, 0u);
+    EXPECT_EQ (read.sc_total_ns, read.sc_max_ns);
+    // The config tree, and its mold, are constructed by the read.
+    EXPECT_GT (read.sc_contexts, 1u);
+    EXPECT_EQ (read.sc_contexts, read.sc_contexts_max);
+
+    // Finalizing the config read counts towards the instance.
+    EXPECT_GE (validate.sc_calls, 1u);
+
+    // Nothing is attributed to the process wide stats.
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (NULL, &stats));
+    EXPECT_EQ (0u, validate.sc_calls);
+}
+
+TEST_F (DisirStats, entries_counted)
+{
+    struct disir_entry *entries = NULL;
+    struct disir_entry *next;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (instance, 1));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_entries (instance, "test", &entries));
+    while (entries != NULL)
+    {
+        next = entries->next;
+        disir_entry_finished (&entries);
+        entries = next;
+    }
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    EXPECT_EQ (1u, stats.ds_counters[DISIR_STATS_CONFIG_ENTRIES].sc_calls);
+    EXPECT_EQ (0u, stats.ds_counters[DISIR_STATS_MOLD_ENTRIES].sc_calls);
+}
+
+TEST_F (DisirStats, disable_keeps_counters_and_reset_zeroes_them)
+{
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (instance, 1));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "test", "basic_keyval",
+                                                       NULL, &config));
+    disir_config_finished (&config);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (instance, 0));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "test", "basic_keyval",
+                                                       NULL, &config));
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    EXPECT_EQ (1u, stats.ds_counters[DISIR_STATS_CONFIG_READ].sc_calls);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_reset (instance));
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    EXPECT_EQ (0u, stats.ds_counters[DISIR_STATS_CONFIG_READ].sc_calls);
+    EXPECT_EQ (0u, histogram_calls (stats.ds_counters[DISIR_STATS_CONFIG_READ]));
+}
+
+TEST_F (DisirStats, read_many_counts_towards_instance)
+{
+    std::vector<const char *> entries = { "basic_keyval", "basic_section", "complex_section" };
+    std::vector<struct disir_config *> configs (entries.size (), NULL);
+    std::vector<enum disir_status> statuses (entries.size (), DISIR_STATUS_OK);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (instance, 1));
+    ASSERT_STATUS (DISIR_STATUS_OK,
+                   disir_config_read_many (instance, "test", entries.data (), entries.size (),
+                                           configs.data (), statuses.data (), 3));
+    for (auto& c : configs)
+    {
+        if (c)
+        {
+            disir_config_finished (&c);
+        }
+    }
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    EXPECT_EQ (entries.size (), stats.ds_counters[DISIR_STATS_CONFIG_READ].sc_calls);
+}
+
+TEST_F (DisirStats, process_wide_compare)
+{
+    struct disir_context *context_config;
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_config_read (instance, "test", "basic_keyval",
+                                                       NULL, &config));
+    context_config = dc_config_getcontext (config);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_enable (NULL, 1));
+    EXPECT_STATUS (DISIR_STATUS_OK, dc_compare (context_config, context_config, NULL));
+    dc_putcontext (&context_config);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (NULL, &stats));
+    EXPECT_EQ (1u, stats.ds_counters[DISIR_STATS_COMPARE].sc_calls);
+
+    ASSERT_STATUS (DISIR_STATUS_OK, disir_stats_get (instance, &stats));
+    EXPECT_EQ (0u, stats.ds_counters[DISIR_STATS_COMPARE].sc_calls);
+}
+
+TEST_F (DisirStats, percentile)
+{
+    struct disir_stats_counter counter = {};
+
+    EXPECT_EQ (0u, disir_stats_percentile (&counter, 50));
+
+    // 90 calls in [1024, 2048) ns, 10 calls in [65536, 131072) ns.
+    counter.sc_calls = 100;
+    counter.sc_histogram[10] = 90;
+    counter.sc_histogram[16] = 10;
+    counter.sc_max_ns = 100000;
+
+    EXPECT_EQ (2048u, disir_stats_percentile (&counter, 50));
+    EXPECT_EQ (2048u, disir_stats_percentile (&counter, 90));
+    // Bounded by the slowest call.
+    EXPECT_EQ (100000u, disir_stats_percentile (&counter, 99));
+}
+
+TEST_F (DisirStats, operation_string)
+{
+    EXPECT_STREQ ("config_read", disir_stats_operation_string (DISIR_STATS_CONFIG_READ));
+    EXPECT_STREQ ("compare", disir_stats_operation_string (DISIR_STATS_COMPARE));
+    EXPECT_STREQ ("UNKNOWN", disir_stats_operation_string (DISIR_STATS_OPERATION_COUNT));
+}
@@ -250,3 +250,113 @@ TEST_F (QueryTest, get_section_and_keyval_contexts)
     ASSERT_TRUE (dc_context_type (context_section) == DISIR_CONTEXT_SECTION);
 }
 
+
+TEST_F (QueryTest, element_iter_invalid_argument)
+{
+    struct disir_element_iter iter;
+
+    status = dc_element_iter_begin (NULL, NULL, &iter);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_element_iter_begin (context_mold, NULL, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_element_iter_next (NULL, &context);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+
+    status = dc_element_iter_begin (context_mold, NULL, &iter);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_element_iter_next (&iter, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_ARGUMENT, status);
+}
+
+TEST_F (QueryTest, element_iter_wrong_context)
+{
+    struct disir_element_iter iter;
+
+    status = dc_element_iter_begin (context_mold, "key_integer", &iter);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_element_iter_next (&iter, &context);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_element_iter_begin (context, NULL, &iter);
+    EXPECT_STATUS (DISIR_STATUS_WRONG_CONTEXT, status);
+}
+
+TEST_F (QueryTest, element_iter_yields_all_elements_in_order)
+{
+    struct disir_element_iter iter;
+    struct disir_context *element;
+
+    status = dc_get_elements (context_mold, &collection);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    ASSERT_EQ (4, dc_collection_size (collection));
+
+    status = dc_element_iter_begin (context_mold, NULL, &iter);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    while (dc_collection_next (collection, &context) != DISIR_STATUS_EXHAUSTED)
+    {
+        status = dc_element_iter_next (&iter, &element);
+        EXPECT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_EQ (context, element);
+        dc_putcontext (&context);
+    }
+
+    status = dc_element_iter_next (&iter, &element);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+    EXPECT_TRUE (element == NULL);
+
+    // Remains exhausted
+    status = dc_element_iter_next (&iter, &element);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+}
+
+TEST_F (QueryTest, element_iter_by_name)
+{
+    struct disir_element_iter iter;
+    struct disir_context *element;
+    const char *out;
+    const char *values[] = {"first", "second"};
+
+    status = dc_config_begin (mold, &context_config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (i = 0; i < 2; i++)
+    {
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_keyval, "key_string", strlen ("key_string"));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_value_string (context_keyval, values[i], strlen (values[i]));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    status = dc_element_iter_begin (context_config, "key_string", &iter);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    for (i = 0; i < 2; i++)
+    {
+        status = dc_element_iter_next (&iter, &element);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_get_value_string (element, &out, &size);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        EXPECT_STREQ (values[i], out);
+    }
+
+    status = dc_element_iter_next (&iter, &element);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+}
+
+TEST_F (QueryTest, element_iter_missing_name_is_exhausted)
+{
+    struct disir_element_iter iter;
+
+    status = dc_element_iter_begin (context_mold, "no_such_key", &iter);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = dc_element_iter_next (&iter, &context);
+    EXPECT_STATUS (DISIR_STATUS_EXHAUSTED, status);
+}
@@ -294,3 +294,122 @@ TEST_F (ValidateTest, generate_config_version_is_sat_correctly)
     disir_config_finished (&config);
 }
 
+
+TEST_F (ValidateTest, destroying_entry_below_minimum_shall_invalidate_config)
+{
+    struct disir_context *context_root;
+
+    setup_testmold ("restriction_config_parent_keyval_min_entry");
+
+    // Version 2.0.0 - 4 min entries
+    status = disir_generate_config_from_mold (mold, NULL, &config);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    context_root = dc_config_getcontext (config);
+    ASSERT_TRUE (context_root != NULL);
+
+    status = dc_find_element (context_root, "keyval", 0, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_destroy (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    status = disir_config_valid (config, &collection);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    ASSERT_TRUE (collection != NULL);
+    EXPECT_EQ (1, dc_collection_size (collection));
+    dc_collection_finished (&collection);
+
+    // Restore the minimum number of entries.
+    status = dc_begin (context_root, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "keyval", strlen ("keyval"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_value_integer (context_keyval, 42);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_finalize (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_valid (config, &collection);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (NULL, collection);
+
+    dc_putcontext (&context_root);
+}
+
+TEST_F (ValidateTest, destroying_invalid_entry_shall_validate_config)
+{
+    const char *names[] = { "key_string", "key_integer", "key_float", "key_boolean" };
+
+    for (auto name : names)
+    {
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_keyval, name, strlen (name));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "invalid_name", strlen ("invalid_name"));
+    EXPECT_STATUS (DISIR_STATUS_NOT_EXIST, status);
+    status = dc_finalize (&context_keyval);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = dc_config_finalize (&context_config, &config);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = dc_destroy (&context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    status = disir_config_valid (config, &collection);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_EQ (NULL, collection);
+}
+
+TEST_F (ValidateTest, setting_value_on_invalid_keyval_shall_validate_config)
+{
+    const char *names[] = { "key_string", "key_float", "key_boolean" };
+
+    for (auto name : names)
+    {
+        status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_set_name (context_keyval, name, strlen (name));
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+        status = dc_finalize (&context_keyval);
+        ASSERT_STATUS (DISIR_STATUS_OK, status);
+    }
+
+    // Integer keyval assigned a string value.
+    status = dc_begin (context_config, DISIR_CONTEXT_KEYVAL, &context_keyval);
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_name (context_keyval, "key_integer", strlen ("key_integer"));
+    ASSERT_STATUS (DISIR_STATUS_OK, status);
+    status = dc_set_value_string (context_keyval, "string", strlen ("string"));
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    status = dc_finalize (&context_keyval);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = dc_config_finalize (&context_config, &config);
+    ASSERT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = dc_set_value_integer (context_keyval, 42);
+    EXPECT_STATUS (DISIR_STATUS_INVALID_CONTEXT, status);
+
+    status = disir_config_valid (config, NULL);
+    EXPECT_STATUS (DISIR_STATUS_OK, status);
+    EXPECT_STATUS (DISIR_STATUS_OK, dc_context_valid (context_keyval));
+
+    dc_putcontext (&context_keyval);
+}